@@ -0,0 +1,107 @@
+// A process with data at known addresses, for the benchmarks to read and scan. It prints where everything is as one
+// line of JSON, then counts the lines written to its standard input until it is closed.
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+// One of every fixed-size data type, at the offsets a compiler gives them in a struct
+struct Values {
+  int8_t byte;
+  int16_t shortValue;
+  int32_t int32;
+  uint32_t uint32;
+  int64_t int64;
+  uint64_t uint64;
+  float floatValue;
+  double doubleValue;
+  bool boolValue;
+  void* pointer;
+  float vec3[3];
+  float vec4[4];
+};
+
+Values values = {-7, -1234, -123456, 123456, -1234567890123, 1234567890123, 3.5f, 2.25, true, &values,
+                 {1, 2, 3}, {1, 2, 3, 4}};
+
+// One more for every line written to the standard input
+volatile uint32_t ticks = 0;
+
+char shortString[] = "the quick brown fox jumps over the lazy dog";
+char16_t wideString[] = u"the quick brown fox jumps over the lazy dog";
+
+// Zero-initialised, so in .bss, and too large for the page the file maps: most of it is anonymous memory
+unsigned char zeroed[1 << 16];
+
+// Bytes that the scan benchmarks' patterns are made of. Their needles are only at the end of the scan buffer, so
+// every scan goes through all of it.
+const unsigned char rare[] = {0x7A, 0x3B, 0x9E, 0xD1, 0x5F, 0x62, 0xA7, 0x11};
+const unsigned char common[] = {0x00, 0xFF, 0x00, 0xFF, 0x00, 0xFF, 0x00, 0xFF, 0x00, 0xFF, 0x00, 0x00};
+
+// A quarter of the scan buffer is 0x00 and a quarter 0xFF, the rest is spread over the other values, except 0x9E which
+// only the needles have
+void fill(std::vector<unsigned char>& buffer) {
+  uint64_t state = 0x9E3779B97F4A7C15ull;
+
+  for (unsigned char& byte : buffer) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+
+    unsigned pick = (unsigned)(state >> 32);
+    byte = (pick & 3) == 0 ? 0x00 : (pick & 3) == 1 ? 0xFF : (unsigned char)(pick >> 8);
+    if (byte == 0x9E) byte = 0x9F;
+  }
+
+  // Breaks up runs of the common needle that the random bytes happen to make
+  for (size_t i = 0; i + sizeof(common) <= buffer.size(); i += sizeof(common)) buffer[i + sizeof(common) - 1] = 0x01;
+
+  memcpy(&buffer[buffer.size() - 64], rare, sizeof(rare));
+  memcpy(&buffer[buffer.size() - 32], common, sizeof(common));
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  size_t scanSize = (argc > 1 ? (size_t)strtoull(argv[1], nullptr, 10) : 64) << 20;
+  std::vector<unsigned char> scan(scanSize);
+  fill(scan);
+
+  std::string longString(4096, 'x');
+  for (size_t i = 0; i < longString.size(); i++) longString[i] = (char)('a' + i % 26);
+
+  printf(
+      "{\"pid\": %d, \"byte\": %llu, \"short\": %llu, \"int32\": %llu, \"uint32\": %llu, "
+      "\"int64\": %llu, \"uint64\": %llu, \"float\": %llu, \"double\": %llu, \"bool\": %llu, \"ptr\": %llu, "
+      "\"vec3\": %llu, \"vec4\": %llu, \"shortString\": %llu, \"wideString\": %llu, \"longString\": %llu, "
+      "\"zeroed\": %llu, \"ticks\": %llu, \"scan\": %llu, \"scanSize\": %llu}\n",
+      (int)getpid(), (unsigned long long)(uintptr_t)&values.byte,
+      (unsigned long long)(uintptr_t)&values.shortValue, (unsigned long long)(uintptr_t)&values.int32,
+      (unsigned long long)(uintptr_t)&values.uint32, (unsigned long long)(uintptr_t)&values.int64,
+      (unsigned long long)(uintptr_t)&values.uint64, (unsigned long long)(uintptr_t)&values.floatValue,
+      (unsigned long long)(uintptr_t)&values.doubleValue, (unsigned long long)(uintptr_t)&values.boolValue,
+      (unsigned long long)(uintptr_t)&values.pointer, (unsigned long long)(uintptr_t)values.vec3,
+      (unsigned long long)(uintptr_t)values.vec4, (unsigned long long)(uintptr_t)shortString,
+      (unsigned long long)(uintptr_t)wideString, (unsigned long long)(uintptr_t)longString.data(),
+      (unsigned long long)(uintptr_t)&zeroed[sizeof(zeroed) - 1], (unsigned long long)(uintptr_t)&ticks,
+      (unsigned long long)(uintptr_t)scan.data(),
+      (unsigned long long)scan.size());
+  fflush(stdout);
+
+  // Answers every line once it is counted, and returns once the benchmarks close the pipe, or exit
+  for (int c = getchar(); c != EOF; c = getchar()) {
+    if (c != '\n') continue;
+    printf("%u\n", (unsigned)++ticks);
+    fflush(stdout);
+  }
+
+  return 0;
+}
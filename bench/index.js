@@ -0,0 +1,221 @@
+// Benchmarks of the native hot paths, run against the fixture program built next to the addon. Prints the results as
+// one JSON document, so that they can be kept and compared across releases.
+//
+//   node bench/index.js [--filter <regexp>] [--scan-mb <megabytes>] [--output <file>]
+const { spawn } = require('child_process');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const memoryjs = require('..');
+const { version } = require('../package.json');
+
+const FIXTURE = path.join(__dirname, '..', 'build', 'Release', `fixture${process.platform === 'win32' ? '.exe' : ''}`);
+
+// The patterns the fixture plants at the end of its scan buffer, see bench/fixture.cc
+const PATTERNS = {
+  'rare-anchor': '7A 3B 9E D1 5F 62 A7 11',
+  'common-anchor': '00 FF 00 FF 00 FF 00 FF 00 FF 00 00',
+  'leading-wildcards': '? ? ? ? ? ? ? ? 7A 3B 9E D1',
+  'sparse-wildcards': '7A ? 9E ? 5F ? A7 ?',
+};
+
+const MEGABYTE = 1024 * 1024;
+
+const TYPES = ['byte', 'short', 'int32', 'uint32', 'int64', 'uint64', 'float', 'double', 'bool', 'ptr', 'vec3', 'vec4'];
+
+function parseArguments(argv) {
+  const options = { filter: null, scanMegabytes: 512, output: null };
+
+  for (let i = 0; i < argv.length; i += 1) {
+    if (argv[i] === '--filter') {
+      i += 1;
+      options.filter = new RegExp(argv[i]);
+    } else if (argv[i] === '--scan-mb') {
+      i += 1;
+      options.scanMegabytes = Number(argv[i]);
+    } else if (argv[i] === '--output') {
+      i += 1;
+      options.output = argv[i];
+    } else {
+      throw new Error(`unknown argument ${argv[i]}`);
+    }
+  }
+
+  return options;
+}
+
+// Starts the fixture and resolves with it and the layout it prints
+function startFixture(scanMegabytes) {
+  return new Promise((resolve, reject) => {
+    if (!fs.existsSync(FIXTURE)) {
+      reject(new Error(`${FIXTURE} not found, build it with: node-gyp rebuild -- -Dmemoryjs_bench=1`));
+      return;
+    }
+
+    const child = spawn(FIXTURE, [String(scanMegabytes)], { stdio: ['pipe', 'pipe', 'inherit'] });
+    let output = '';
+
+    child.on('error', reject);
+    child.stdout.on('data', (data) => {
+      output += data;
+      const end = output.indexOf('\n');
+      if (end !== -1) resolve({ child, layout: JSON.parse(output.slice(0, end)) });
+    });
+  });
+}
+
+function percentile(sorted, fraction) {
+  return sorted[Math.min(sorted.length - 1, Math.floor(sorted.length * fraction))];
+}
+
+// Times `run` until it has run `iterations` times or for `seconds`, whichever comes first, after a few runs to warm
+// up. `bytes` is how much memory one run reads or scans.
+function measure(name, run, { iterations = 10000, seconds = 1, bytes = 0 } = {}) {
+  for (let i = 0; i < Math.min(10, iterations); i += 1) run();
+
+  const samples = [];
+  const deadline = Date.now() + seconds * 1000;
+
+  while (samples.length < iterations && (samples.length < 3 || Date.now() < deadline)) {
+    const start = process.hrtime.bigint();
+    run();
+    samples.push(Number(process.hrtime.bigint() - start));
+  }
+
+  samples.sort((a, b) => a - b);
+  const mean = samples.reduce((sum, sample) => sum + sample, 0) / samples.length;
+
+  const result = {
+    name,
+    iterations: samples.length,
+    meanNs: Math.round(mean),
+    minNs: samples[0],
+    p50Ns: percentile(samples, 0.5),
+    p90Ns: percentile(samples, 0.9),
+    p99Ns: percentile(samples, 0.99),
+  };
+
+  if (bytes) {
+    result.bytes = bytes;
+    result.mbPerSecond = (bytes / MEGABYTE) / (result.p50Ns / 1e9);
+  }
+
+  return result;
+}
+
+function benchmarks(handle, layout) {
+  const list = [];
+  const add = (name, run, options) => list.push({ name, run: () => measure(name, run, options) });
+
+  TYPES.forEach((type) => {
+    add(`readMemory/${type}`, () => memoryjs.readMemory(handle, layout[type], type));
+  });
+
+  add('readMemory/string', () => memoryjs.readMemory(handle, layout.shortString, 'string'));
+  add('readMemory/string-4k', () => memoryjs.readMemory(handle, layout.longString, 'string'));
+  add('readMemory/wstring', () => memoryjs.readMemory(handle, layout.wideString, 'wstring'));
+
+  // The same thousand values, read one call at a time and in one batch
+  const addresses = new Float64Array(1000);
+  for (let i = 0; i < addresses.length; i += 1) addresses[i] = layout.scan + i * 4096;
+
+  add('readMemory/int32-x1000', () => {
+    for (let i = 0; i < addresses.length; i += 1) memoryjs.readMemory(handle, addresses[i], 'int32');
+  }, { iterations: 200 });
+  add('readMemoryBatch/int32-x1000', () => memoryjs.readMemoryBatch(handle, addresses, 'int32'), { iterations: 200 });
+
+  [64, 4096, 65536, MEGABYTE, 16 * MEGABYTE].filter(size => size <= layout.scanSize).forEach((size) => {
+    add(`readBuffer/${size}`, () => memoryjs.readBuffer(handle, layout.scan, size), {
+      iterations: size >= MEGABYTE ? 50 : 10000,
+      bytes: size,
+    });
+  });
+
+  const scan = { start: layout.scan, end: layout.scan + layout.scanSize };
+
+  Object.keys(PATTERNS).forEach((shape) => {
+    add(`findAll/${shape}`, () => memoryjs.findAll(handle, PATTERNS[shape], scan), {
+      iterations: 20,
+      bytes: layout.scanSize,
+    });
+  });
+
+  // How scans scale with the thread pool, from one thread up to one per hardware thread
+  const threads = [];
+  for (let count = 1; count < os.cpus().length; count *= 2) threads.push(count);
+  threads.push(os.cpus().length);
+
+  threads.forEach((count) => {
+    const name = `findAll/rare-anchor/threads-${count}`;
+    const run = () => memoryjs.findAll(handle, PATTERNS['rare-anchor'], scan);
+
+    list.push({
+      name,
+      run: () => {
+        memoryjs.setThreadCount(count);
+        const result = measure(name, run, { iterations: 20, bytes: layout.scanSize });
+        memoryjs.setThreadCount(0);
+        return result;
+      },
+    });
+  });
+
+  // The fixture's own image is small, so this is mostly the cost of a call rather than of the scan
+  const moduleName = path.basename(FIXTURE);
+  add('findPattern/module', () => memoryjs.findPattern(handle, moduleName, PATTERNS['rare-anchor'], 0, 0, 0), {
+    iterations: 1000,
+  });
+
+  add('getProcesses', () => memoryjs.getProcesses(), { iterations: 200 });
+  add('getModules', () => memoryjs.getModules(layout.pid), { iterations: 1000 });
+  add('findModule', () => memoryjs.findModule(moduleName, layout.pid), { iterations: 1000 });
+  add('openProcess', () => memoryjs.closeProcess(memoryjs.openProcess(layout.pid).handle), { iterations: 1000 });
+
+  return list;
+}
+
+async function main() {
+  const options = parseArguments(process.argv.slice(2));
+  const { child, layout } = await startFixture(options.scanMegabytes);
+
+  try {
+    const { handle } = memoryjs.openProcess(layout.pid);
+    memoryjs.resetStats();
+
+    const results = benchmarks(handle, layout)
+      .filter(benchmark => !options.filter || options.filter.test(benchmark.name))
+      .map((benchmark) => {
+        const result = benchmark.run();
+        console.error(`${result.name}: ${result.p50Ns} ns`);
+        return result;
+      });
+
+    const report = {
+      memoryjs: version,
+      node: process.version,
+      platform: process.platform,
+      arch: process.arch,
+      cpu: os.cpus()[0].model,
+      cpus: os.cpus().length,
+      date: new Date().toISOString(),
+      results,
+      stats: memoryjs.getStats(),
+    };
+
+    memoryjs.closeProcess(handle);
+
+    const json = JSON.stringify(report, null, 2);
+    if (options.output) {
+      fs.writeFileSync(options.output, `${json}\n`);
+    } else {
+      console.log(json);
+    }
+  } finally {
+    child.stdin.end();
+  }
+}
+
+main().catch((error) => {
+  console.error(error.message);
+  process.exitCode = 1;
+});
@@ -1,17 +1,101 @@
 {
+  "variables": {
+    "memoryjs_stats%": 1,
+    "memoryjs_bench%": 0,
+    "memoryjs_tests%": 0,
+  },
   "targets": [
     {
       "target_name": "memoryjs",
       "sources": [ 
         "lib/memoryjs.cc",
-        "lib/memory.cc",
-        "lib/process.cc",
-        "lib/module.cc",
+        "lib/addressmap.cc",
+        "lib/async.cc",
+        "lib/batch.cc",
+        "lib/bufferpool.cc",
+        "lib/datatype.cc",
+        "lib/instance.cc",
+        "lib/layout.cc",
+        "lib/mapfile.cc",
+        "lib/mirror.cc",
         "lib/pattern.cc",
+        "lib/pointer.cc",
+        "lib/pointerscan.cc",
+        "lib/process_common.cc",
+        "lib/region.cc",
+        "lib/scanner.cc",
+        "lib/session.cc",
+        "lib/share.cc",
+        "lib/sigcache.cc",
+        "lib/snapshot.cc",
+        "lib/stats.cc",
+        "lib/symbols.cc",
+        "lib/text.cc",
+        "lib/textscan.cc",
+        "lib/threadpool.cc",
+        "lib/watch.cc",
+      ],
+      "conditions": [
+        ["memoryjs_stats==0", {
+          "defines": ["MEMORYJS_NO_STATS"],
+        }],
+        ["OS=='win'", {
+          "sources": [
+            "lib/memory.cc",
+            "lib/process.cc",
+            "lib/module.cc",
+          ],
+        }],
+        ["OS=='linux'", {
+          "sources": [
+            "lib/memory_linux.cc",
+            "lib/process_linux.cc",
+            "lib/module_linux.cc",
+            "lib/procfs.cc",
+          ],
+        }],
       ],
       "include_dirs": ["<!@(node -p \"require('node-addon-api').include\")"],
       "dependencies": ["<!(node -p \"require('node-addon-api').gyp\")"],
-      "defines": ["NAPI_DISABLE_CPP_EXCEPTIONS"],
+      "defines": ["NAPI_DISABLE_CPP_EXCEPTIONS", "NAPI_VERSION=6"],
     }
-  ]
+  ],
+  "conditions": [
+    ["memoryjs_bench==1 or memoryjs_tests==1", {
+      "targets": [
+        {
+          "target_name": "fixture",
+          "type": "executable",
+          "sources": ["bench/fixture.cc"],
+        }
+      ],
+    }],
+    ["memoryjs_tests==1", {
+      "targets": [
+        {
+          "target_name": "kernels",
+          "type": "executable",
+          "sources": [
+            "test/kernels.cc",
+            "lib/mapfile.cc",
+            "lib/pattern.cc",
+            "lib/region.cc",
+            "lib/sigcache.cc",
+            "lib/snapshot.cc",
+            "lib/stats.cc",
+            "lib/threadpool.cc",
+          ],
+          "conditions": [
+            ["OS=='win'", {
+              "sources": ["lib/memory.cc", "lib/module.cc"],
+              "libraries": ["psapi.lib"],
+            }],
+            ["OS=='linux'", {
+              "sources": ["lib/memory_linux.cc", "lib/module_linux.cc", "lib/procfs.cc"],
+            }],
+          ],
+        }
+      ],
+    }],
+  ],
 }
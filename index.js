@@ -1,4 +1,214 @@
 const memoryjs = require('./build/Release/memoryjs');
+const { getSharedSequence, readSharedRegions } = require('./shared');
+
+function normalizeType(options) {
+  const normalized = { ...options };
+
+  if (typeof normalized.type === 'string') {
+    normalized.type = normalized.type.toLowerCase();
+  }
+
+  return normalized;
+}
+
+function resolvePointers(resolve, args, options, callback) {
+  const normalized = normalizeType(options);
+
+  if (callback) {
+    return resolve(...args, normalized, callback);
+  }
+
+  return resolve(...args, normalized);
+}
+
+function normalizeRequests(requests) {
+  return requests.map(request => ({ ...request, type: request.type.toLowerCase() }));
+}
+
+// The arguments of readMemoryBatch before its callback or token, with every type in lower case.
+function batchArguments(handle, requests, dataType) {
+  const args = [handle, requests];
+
+  if (dataType !== undefined) {
+    args.push(Array.isArray(dataType)
+      ? dataType.map(type => type.toLowerCase())
+      : dataType.toLowerCase());
+  }
+
+  if (Array.isArray(requests)) {
+    args[1] = requests.map(({ address, type }) => ({ address, type: type.toLowerCase() }));
+  }
+
+  return args;
+}
+
+function normalizeStringOptions(options) {
+  const normalized = { ...options };
+
+  if (typeof normalized.encoding === 'string') {
+    normalized.encoding = normalized.encoding.toLowerCase().replace('-', '');
+  }
+
+  return normalized;
+}
+
+// Runs an Async binding with a cancel token that is set once `signal` aborts.
+function withSignal(signal, run) {
+  if (!signal) {
+    return run(undefined);
+  }
+
+  if (signal.aborted) {
+    const error = new Error('the operation was aborted');
+    error.name = 'AbortError';
+    return Promise.reject(error);
+  }
+
+  const token = memoryjs.createCancelToken();
+  const abort = () => memoryjs.cancel(token);
+  signal.addEventListener('abort', abort);
+
+  return run(token).finally(() => signal.removeEventListener('abort', abort));
+}
+
+// Promise versions of the slow operations. Each one takes an optional trailing { signal } to abort it with.
+const promises = {
+  openProcess(processIdentifier, { signal } = {}) {
+    return withSignal(signal, token => memoryjs.openProcessAsync(processIdentifier, token));
+  },
+
+  getProcesses({ signal } = {}) {
+    return withSignal(signal, token => memoryjs.getProcessesAsync(token));
+  },
+
+  getModules(processId, { signal } = {}) {
+    return withSignal(signal, token => memoryjs.getModulesAsync(processId, token));
+  },
+
+  readMemory(handle, address, dataType, { signal } = {}) {
+    return withSignal(signal, token => memoryjs.readMemoryAsync(handle, address, dataType.toLowerCase(), token));
+  },
+
+  readBuffer(handle, address, size, { signal } = {}) {
+    return withSignal(signal, token => memoryjs.readBufferAsync(handle, address, size, token));
+  },
+
+  // The data type may be left out, like for the synchronous form
+  readMemoryBatch(handle, requests, ...rest) {
+    const typed = typeof rest[0] === 'string' || Array.isArray(rest[0]);
+    const { signal } = (typed ? rest[1] : rest[0]) || {};
+    const args = batchArguments(handle, requests, typed ? rest[0] : undefined);
+    return withSignal(signal, token => memoryjs.readMemoryBatchAsync(...args, token));
+  },
+
+  // Offset and length are optional, like for the synchronous form
+  readBufferInto(handle, address, buffer, ...rest) {
+    const { signal } = typeof rest[rest.length - 1] === 'object' ? rest.pop() || {} : {};
+    return withSignal(signal, token => memoryjs.readBufferIntoAsync(handle, address, buffer, ...rest, token));
+  },
+
+  readString(handle, address, options = {}) {
+    const { signal, ...rest } = options;
+    const normalized = normalizeStringOptions(rest);
+    return withSignal(signal, token => memoryjs.readStringAsync(handle, address, normalized, token));
+  },
+
+  // `target` is filled in like the target argument of the synchronous forms
+  readStruct(handle, address, layout, { target, signal } = {}) {
+    const args = [handle, address, layout];
+    if (target !== undefined) args.push(target);
+    return withSignal(signal, token => memoryjs.readStructAsync(...args, token));
+  },
+
+  readStructArray(handle, address, layout, count, { target, signal } = {}) {
+    const args = [handle, address, layout, count];
+    if (target !== undefined) args.push(target);
+    return withSignal(signal, token => memoryjs.readStructArrayAsync(...args, token));
+  },
+
+  resolvePointerChain(handle, base, offsets, options = {}) {
+    const { signal, ...rest } = options;
+    const normalized = normalizeType(rest);
+    return withSignal(signal, token => memoryjs.resolvePointerChainAsync(handle, base, offsets, normalized, token));
+  },
+
+  resolvePointerChains(handle, chains, options = {}) {
+    const { signal, ...rest } = options;
+    const normalized = normalizeType(rest);
+    return withSignal(signal, token => memoryjs.resolvePointerChainsAsync(handle, chains, normalized, token));
+  },
+
+  // eslint-disable-next-line
+  findPattern(handle, moduleName, signature, signatureType, patternOffset, addressOffset, { signal } = {}) {
+    return withSignal(signal, token => memoryjs.findPatternAsync(
+      handle,
+      moduleName,
+      signature,
+      signatureType,
+      patternOffset,
+      addressOffset,
+      token,
+    ));
+  },
+
+  findPatterns(handle, moduleName, signatures, { signal } = {}) {
+    return withSignal(signal, token => memoryjs.findPatternsAsync(handle, moduleName, signatures, token));
+  },
+
+  findAll(handle, signature, options = {}) {
+    const { signal, ...filter } = options;
+    return withSignal(signal, token => memoryjs.findAllAsync(handle, signature, filter, token));
+  },
+
+  firstScan(scanner, condition, { signal } = {}) {
+    return withSignal(signal, token => memoryjs.firstScanAsync(scanner, condition, token));
+  },
+
+  nextScan(scanner, condition, { signal } = {}) {
+    return withSignal(signal, token => memoryjs.nextScanAsync(scanner, condition, token));
+  },
+
+  dumpRegions(handle, path, options = {}) {
+    const { signal, ...filter } = options;
+    return withSignal(signal, token => memoryjs.dumpRegionsAsync(handle, path, filter, token));
+  },
+
+  findStrings(handle, options = {}) {
+    const { signal, ...search } = options;
+    return withSignal(signal, token => memoryjs.findStringsAsync(handle, search, token));
+  },
+
+  createPointerMap(handle, options = {}) {
+    const { signal, ...filter } = options;
+    return withSignal(signal, token => memoryjs.createPointerMapAsync(handle, filter, token));
+  },
+
+  findPointerPaths(map, address, options = {}) {
+    const { signal, ...search } = options;
+    return withSignal(signal, token => memoryjs.findPointerPathsAsync(map, address, search, token));
+  },
+
+  rescanPointerPaths(handle, paths, address, { signal } = {}) {
+    return withSignal(signal, token => memoryjs.rescanPointerPathsAsync(handle, paths, address, token));
+  },
+
+  openSession(filter, { signal } = {}) {
+    return withSignal(signal, token => memoryjs.openSessionAsync(filter, token));
+  },
+
+  refreshSession(session, { signal } = {}) {
+    return withSignal(signal, token => memoryjs.refreshSessionAsync(session, token));
+  },
+
+  sessionReadBatch(session, requests, { signal } = {}) {
+    return withSignal(signal, token => memoryjs.sessionReadBatchAsync(session, normalizeRequests(requests), token));
+  },
+
+  sessionFindAll(session, signature, options = {}) {
+    const { signal, ...filter } = options;
+    return withSignal(signal, token => memoryjs.sessionFindAllAsync(session, signature, filter, token));
+  },
+};
 
 module.exports = {
   // data type constants
@@ -95,6 +305,18 @@ module.exports = {
     memoryjs.getModules(processId, callback);
   },
 
+  findModuleForAddress: memoryjs.findModuleForAddress,
+  findRegion: memoryjs.findRegion,
+
+  refreshAddressMap(handle, regions) {
+    return memoryjs.refreshAddressMap(handle, !!regions);
+  },
+
+  invalidateAddressMap: memoryjs.invalidateAddressMap,
+  findSymbol: memoryjs.findSymbol,
+  addressToSymbol: memoryjs.addressToSymbol,
+  getModuleSymbols: memoryjs.getModuleSymbols,
+
   readMemory(handle, address, dataType, callback) {
     if (arguments.length === 3) {
       return memoryjs.readMemory(handle, address, dataType.toLowerCase());
@@ -103,6 +325,38 @@ module.exports = {
     memoryjs.readMemory(handle, address, dataType.toLowerCase(), callback);
   },
 
+  readMemoryBatch(handle, requests, dataType, callback) {
+    if (typeof dataType === 'function') {
+      callback = dataType;
+      dataType = undefined;
+    }
+
+    const args = batchArguments(handle, requests, dataType);
+
+    if (callback) {
+      args.push(callback);
+    }
+
+    return memoryjs.readMemoryBatch(...args);
+  },
+
+  readBufferInto: memoryjs.readBufferInto,
+
+  readString(handle, address, options, callback) {
+    if (typeof options === 'function') {
+      callback = options;
+      options = {};
+    }
+
+    const normalized = normalizeStringOptions(options);
+
+    if (!callback) {
+      return memoryjs.readString(handle, address, normalized);
+    }
+
+    memoryjs.readString(handle, address, normalized, callback);
+  },
+
   readBuffer(handle, address, size, callback) {
     if (arguments.length === 3) {
       return memoryjs.readBuffer(handle, address, size);
@@ -135,5 +389,275 @@ module.exports = {
     );
   },
 
+  findPatterns(handle, moduleName, signatures, callback) {
+    if (arguments.length === 3) {
+      return memoryjs.findPatterns(handle, moduleName, signatures);
+    }
+
+    memoryjs.findPatterns(handle, moduleName, signatures, callback);
+  },
+
+  findAll(handle, signature, options, callback) {
+    if (typeof options === 'function') {
+      callback = options;
+      options = {};
+    }
+
+    if (!callback) {
+      return memoryjs.findAll(handle, signature, options || {});
+    }
+
+    memoryjs.findAll(handle, signature, options || {}, callback);
+  },
+
+  dumpRegions(handle, path, options, callback) {
+    if (typeof options === 'function') {
+      callback = options;
+      options = {};
+    }
+
+    if (!callback) {
+      return memoryjs.dumpRegions(handle, path, options || {});
+    }
+
+    memoryjs.dumpRegions(handle, path, options || {}, callback);
+  },
+
+  findStrings(handle, options, callback) {
+    if (typeof options === 'function') {
+      callback = options;
+      options = {};
+    }
+
+    if (!callback) {
+      return memoryjs.findStrings(handle, options || {});
+    }
+
+    memoryjs.findStrings(handle, options || {}, callback);
+  },
+
+  getStringResults(strings, offset, limit) {
+    if (limit === undefined) {
+      return memoryjs.getStringResults(strings, offset || 0);
+    }
+
+    return memoryjs.getStringResults(strings, offset || 0, limit);
+  },
+
+  openSnapshot: memoryjs.openSnapshot,
+  openSession(filter, callback) {
+    if (!callback) {
+      return memoryjs.openSession(filter);
+    }
+
+    memoryjs.openSession(filter, callback);
+  },
+
+  refreshSession(session, callback) {
+    if (!callback) {
+      return memoryjs.refreshSession(session);
+    }
+
+    memoryjs.refreshSession(session, callback);
+  },
+
+  getSessionTargets: memoryjs.getSessionTargets,
+  closeSession: memoryjs.closeSession,
+  sessionReadBatch(session, requests, callback) {
+    if (!callback) {
+      return memoryjs.sessionReadBatch(session, normalizeRequests(requests));
+    }
+
+    memoryjs.sessionReadBatch(session, normalizeRequests(requests), callback);
+  },
+
+  sessionFindAll(session, signature, options, callback) {
+    if (typeof options === 'function') {
+      callback = options;
+      options = {};
+    }
+
+    if (!callback) {
+      return memoryjs.sessionFindAll(session, signature, options || {});
+    }
+
+    memoryjs.sessionFindAll(session, signature, options || {}, callback);
+  },
+
+  // Watches the live targets of a session, each with its own subscription. `locations` is an array of
+  // { address, type }, or a function returning one for a target.
+  watchSession(session, locations, options, callback) {
+    if (typeof options === 'function') {
+      callback = options;
+      options = {};
+    }
+
+    return memoryjs.getSessionTargets(session)
+      .filter(target => target.alive)
+      .map((target) => {
+        const targetLocations = typeof locations === 'function' ? locations(target) : locations;
+        return memoryjs.watchMemory(
+          target.handle,
+          normalizeRequests(targetLocations),
+          options || {},
+          (changes, dropped) => callback(target, changes, dropped),
+        );
+      });
+  },
+
+  shareRegions(handle, regions, options) {
+    return memoryjs.shareRegions(handle, regions, options || {});
+  },
+
+  configureSharedRegions(shared, { regions, intervalMs = 100 }) {
+    memoryjs.configureSharedRegions(shared.publisher, regions, intervalMs);
+  },
+
+  stopSharedRegions(shared) {
+    memoryjs.stopSharedRegions(shared.publisher);
+  },
+
+  getSharedSequence,
+  readSharedRegions,
+  createMirror: memoryjs.createMirror,
+  updateMirror: memoryjs.updateMirror,
+  applyMirror: memoryjs.applyMirror,
+  getMirrorBuffer: memoryjs.getMirrorBuffer,
+  getMirrorStats: memoryjs.getMirrorStats,
+
+  createScanner(handle, dataType, options) {
+    return memoryjs.createScanner(handle, dataType, options || {});
+  },
+
+  firstScan(scanner, condition, callback) {
+    if (!callback) {
+      return memoryjs.firstScan(scanner, condition);
+    }
+
+    memoryjs.firstScan(scanner, condition, callback);
+  },
+
+  nextScan(scanner, condition, callback) {
+    if (!callback) {
+      return memoryjs.nextScan(scanner, condition);
+    }
+
+    memoryjs.nextScan(scanner, condition, callback);
+  },
+
+  watch(handle, address, dataType, options, callback) {
+    if (typeof options === 'function') {
+      callback = options;
+      options = {};
+    }
+
+    const locations = [{ address, type: dataType.toLowerCase() }];
+    return memoryjs.watchMemory(
+      handle,
+      locations,
+      options || {},
+      (changes, dropped) => callback(changes[0].value, dropped),
+    );
+  },
+
+  watchGroup(handle, locations, options, callback) {
+    if (typeof options === 'function') {
+      callback = options;
+      options = {};
+    }
+
+    const normalized = locations.map(({ address, type }) => ({ address, type: type.toLowerCase() }));
+    return memoryjs.watchMemory(handle, normalized, options || {}, callback);
+  },
+
+  unwatch: memoryjs.unwatchMemory,
+
+  getScanResults(scanner, offset, limit) {
+    if (limit === undefined) {
+      return memoryjs.getScanResults(scanner, offset || 0);
+    }
+
+    return memoryjs.getScanResults(scanner, offset || 0, limit);
+  },
+
+  defineStruct(fields, options) {
+    const normalized = fields.map(field => ({
+      ...field,
+      type: typeof field.type === 'string' ? field.type.toLowerCase() : field.type,
+    }));
+
+    return memoryjs.defineStruct(normalized, options || {});
+  },
+
+  readStruct: memoryjs.readStruct,
+  readStructArray: memoryjs.readStructArray,
+  resolvePointerChain(handle, base, offsets, options, callback) {
+    if (typeof options === 'function') {
+      callback = options;
+      options = {};
+    }
+
+    return resolvePointers(memoryjs.resolvePointerChain, [handle, base, offsets], options, callback);
+  },
+
+  resolvePointerChains(handle, chains, options, callback) {
+    if (typeof options === 'function') {
+      callback = options;
+      options = {};
+    }
+
+    return resolvePointers(memoryjs.resolvePointerChains, [handle, chains], options, callback);
+  },
+
+  createPointerCache: memoryjs.createPointerCache,
+  clearPointerCache: memoryjs.clearPointerCache,
+  createPointerMap(handle, options, callback) {
+    if (typeof options === 'function') {
+      callback = options;
+      options = {};
+    }
+
+    if (!callback) {
+      return memoryjs.createPointerMap(handle, options || {});
+    }
+
+    memoryjs.createPointerMap(handle, options || {}, callback);
+  },
+
+  savePointerMap: memoryjs.savePointerMap,
+  loadPointerMap: memoryjs.loadPointerMap,
+  findPointerPaths(map, address, options, callback) {
+    if (typeof options === 'function') {
+      callback = options;
+      options = {};
+    }
+
+    if (!callback) {
+      return memoryjs.findPointerPaths(map, address, options || {});
+    }
+
+    memoryjs.findPointerPaths(map, address, options || {}, callback);
+  },
+
+  rescanPointerPaths(handle, paths, address, callback) {
+    if (!callback) {
+      return memoryjs.rescanPointerPaths(handle, paths, address);
+    }
+
+    memoryjs.rescanPointerPaths(handle, paths, address, callback);
+  },
+
+  compilePattern: memoryjs.compilePattern,
+  setSignatureCache: memoryjs.setSignatureCache,
+  flushSignatureCache: memoryjs.flushSignatureCache,
+  clearSignatureCache: memoryjs.clearSignatureCache,
+  getSignatureCacheStats: memoryjs.getSignatureCacheStats,
+  setThreadCount: memoryjs.setThreadCount,
+  getThreadCount: memoryjs.getThreadCount,
+  setAsyncConcurrency: memoryjs.setAsyncConcurrency,
+  getAsyncConcurrency: memoryjs.getAsyncConcurrency,
+  getStats: memoryjs.getStats,
+  resetStats: memoryjs.resetStats,
   closeProcess: memoryjs.closeProcess,
+  promises,
 };
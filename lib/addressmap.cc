@@ -0,0 +1,202 @@
+#include "addressmap.h"
+
+#include <string.h>
+#include <algorithm>
+#include <mutex>
+#include <numeric>
+#include "memory.h"
+#include "module.h"
+#include "snapshot.h"
+
+namespace {
+struct Entry {
+  std::mutex refreshing;  // one refresh at a time per handle, lookups only read `snapshot`
+  std::shared_ptr<const addressmap::Snapshot> snapshot;
+};
+
+std::mutex lock;
+std::unordered_map<HANDLE, std::shared_ptr<Entry>> entries;
+
+std::shared_ptr<Entry> entryOf(HANDLE hProcess) {
+  std::lock_guard<std::mutex> guard(lock);
+  std::shared_ptr<Entry>& entry = entries[hProcess];
+  if (!entry) entry = std::make_shared<Entry>();
+  return entry;
+}
+
+DWORD64 baseOf(const MODULEENTRY32& module) {
+  return (DWORD64)module.modBaseAddr;
+}
+
+DWORD64 baseOf(const MEMORY_BASIC_INFORMATION& region) {
+  return (DWORD64)region.BaseAddress;
+}
+
+bool sameModules(const std::vector<MODULEENTRY32>& a, const std::vector<MODULEENTRY32>& b) {
+  if (a.size() != b.size()) return false;
+
+  for (size_t i = 0; i < a.size(); i++) {
+    if (a[i].modBaseAddr != b[i].modBaseAddr || a[i].modBaseSize != b[i].modBaseSize ||
+        strcmp(a[i].szExePath, b[i].szExePath)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool sameRegions(const std::vector<MEMORY_BASIC_INFORMATION>& a, const std::vector<MEMORY_BASIC_INFORMATION>& b) {
+  if (a.size() != b.size()) return false;
+
+  for (size_t i = 0; i < a.size(); i++) {
+    if (a[i].BaseAddress != b[i].BaseAddress || a[i].RegionSize != b[i].RegionSize || a[i].State != b[i].State ||
+        a[i].Protect != b[i].Protect || a[i].Type != b[i].Type) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// Sorts the modules by base address and indexes them by name. When two modules share a name the one listed first
+// wins, like the linear search this replaces.
+void setModules(addressmap::Snapshot& snapshot, const std::vector<MODULEENTRY32>& modules) {
+  std::vector<size_t> order(modules.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&](size_t a, size_t b) { return baseOf(modules[a]) < baseOf(modules[b]); });
+
+  std::vector<size_t> position(modules.size());
+  snapshot.modules.clear();
+  snapshot.names.clear();
+
+  for (size_t i = 0; i < order.size(); i++) {
+    position[order[i]] = i;
+    snapshot.modules.push_back(modules[order[i]]);
+  }
+
+  for (size_t i = 0; i < modules.size(); i++) snapshot.names.emplace(modules[i].szModule, position[i]);
+}
+
+// Binary search for the entry whose [base, base + size) contains `address`.
+template <class T, class Size>
+const T* findContaining(const std::vector<T>& entries, DWORD64 address, Size size) {
+  auto next = std::upper_bound(entries.begin(), entries.end(), address,
+                               [](DWORD64 address, const T& entry) { return address < baseOf(entry); });
+  if (next == entries.begin()) return nullptr;
+
+  const T& entry = *(next - 1);
+  return address - baseOf(entry) < (DWORD64)size(entry) ? &entry : nullptr;
+}
+}  // namespace
+
+const MODULEENTRY32* addressmap::Snapshot::findModule(const std::string& name) const {
+  auto index = names.find(name);
+  return index == names.end() ? nullptr : &modules[index->second];
+}
+
+const MODULEENTRY32* addressmap::Snapshot::findModuleForAddress(DWORD64 address) const {
+  return findContaining(modules, address, [](const MODULEENTRY32& module) { return module.modBaseSize; });
+}
+
+const MEMORY_BASIC_INFORMATION* addressmap::Snapshot::findRegion(DWORD64 address) const {
+  return findContaining(regions, address, [](const MEMORY_BASIC_INFORMATION& region) { return region.RegionSize; });
+}
+
+std::shared_ptr<const addressmap::Snapshot> addressmap::get(HANDLE hProcess, bool regions, char** errorMessage) {
+  std::shared_ptr<Entry> entry = entryOf(hProcess);
+  std::lock_guard<std::mutex> guard(entry->refreshing);
+
+  std::shared_ptr<const Snapshot> current = entry->snapshot;
+  // The modules of a dump never change
+  bool dumped = snapshot::owns(hProcess);
+  uint64_t fingerprint = dumped ? 1 : module::getFingerprint(hProcess);
+
+  // A fingerprint of 0 could not be computed, so the modules are always re-read rather than trusted
+  bool readModules = !current || !fingerprint || fingerprint != current->fingerprint;
+  if (!readModules && !regions) return current;
+
+  std::shared_ptr<Snapshot> next = current ? std::make_shared<Snapshot>(*current) : std::make_shared<Snapshot>();
+  bool changed = !current;
+
+  if (readModules) {
+    std::vector<MODULEENTRY32> modules =
+        dumped ? snapshot::getModules(hProcess) : module::getModules(GetProcessId(hProcess), errorMessage);
+    if (strcmp(*errorMessage, "")) return nullptr;
+
+    next->fingerprint = fingerprint;
+    setModules(*next, modules);
+
+    if (current && !sameModules(current->modules, next->modules)) {
+      changed = true;
+
+      // Regions read before the modules changed are not worth keeping
+      next->regions.clear();
+      next->hasRegions = false;
+    }
+  }
+
+  if (regions) {
+    std::vector<MEMORY_BASIC_INFORMATION> read = memory::getRegions(hProcess);
+    std::sort(read.begin(), read.end(), [](const MEMORY_BASIC_INFORMATION& a, const MEMORY_BASIC_INFORMATION& b) {
+      return baseOf(a) < baseOf(b);
+    });
+
+    if (!next->hasRegions || !sameRegions(next->regions, read)) changed = true;
+
+    next->regions.swap(read);
+    next->hasRegions = true;
+  }
+
+  next->generation = current ? current->generation + (changed ? 1 : 0) : 1;
+  entry->snapshot = next;
+  return next;
+}
+
+bool addressmap::findModule(HANDLE hProcess, const std::string& name, MODULEENTRY32* module, char** errorMessage) {
+  std::shared_ptr<const Snapshot> snapshot = get(hProcess, false, errorMessage);
+  if (!snapshot) return false;
+
+  const MODULEENTRY32* found = snapshot->findModule(name);
+  if (!found) {
+    *errorMessage = "unable to find module";
+    return false;
+  }
+
+  *module = *found;
+  return true;
+}
+
+bool addressmap::findRegion(HANDLE hProcess, DWORD64 address, MEMORY_BASIC_INFORMATION* region) {
+  char* errorMessage = "";
+  std::shared_ptr<const Snapshot> snapshot = get(hProcess, false, &errorMessage);
+  const MEMORY_BASIC_INFORMATION* found = snapshot && snapshot->hasRegions ? snapshot->findRegion(address) : nullptr;
+
+  // A miss may be memory allocated since the regions were read
+  if (!found) {
+    errorMessage = "";
+    snapshot = get(hProcess, true, &errorMessage);
+    found = snapshot ? snapshot->findRegion(address) : nullptr;
+  }
+
+  if (!found) return false;
+
+  *region = *found;
+  return true;
+}
+
+bool addressmap::findModuleForAddress(HANDLE hProcess, DWORD64 address, MODULEENTRY32* module) {
+  char* errorMessage = "";
+  std::shared_ptr<const Snapshot> snapshot = get(hProcess, false, &errorMessage);
+  const MODULEENTRY32* found = snapshot ? snapshot->findModuleForAddress(address) : nullptr;
+
+  if (!found) return false;
+
+  *module = *found;
+  return true;
+}
+
+void addressmap::invalidate(HANDLE hProcess) {
+  std::lock_guard<std::mutex> guard(lock);
+  entries.erase(hProcess);
+}
@@ -0,0 +1,52 @@
+#pragma once
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+
+#include <windows.h>
+#include <TlHelp32.h>
+#else
+#include "compat.h"
+#endif
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// A per-handle cache of a process' modules and regions, so that looking up a module by name or finding what an
+// address belongs to does not take a module snapshot or walk the address space every time.
+//
+// Modules are checked against module::getFingerprint on every lookup and only re-read when it changes. Regions change
+// all the time (every allocation) and are only re-read when asked for, or when a lookup misses.
+namespace addressmap {
+// An immutable view of the cache. Holding one keeps it valid however the cache is refreshed afterwards.
+struct Snapshot {
+  uint64_t generation;  // increases whenever the modules or regions change
+  uint64_t fingerprint;
+  bool hasRegions;
+
+  std::vector<MODULEENTRY32> modules;             // sorted by base address
+  std::vector<MEMORY_BASIC_INFORMATION> regions;  // sorted by base address
+  std::unordered_map<std::string, size_t> names;  // module name to index into `modules`
+
+  const MODULEENTRY32* findModule(const std::string& name) const;
+  const MODULEENTRY32* findModuleForAddress(DWORD64 address) const;
+  const MEMORY_BASIC_INFORMATION* findRegion(DWORD64 address) const;
+};
+
+// Returns the cached modules of a process, re-reading them first if they changed. With `regions` set the regions are
+// re-read too. `errorMessage` is set, and null returned, if the modules could not be read.
+std::shared_ptr<const Snapshot> get(HANDLE hProcess, bool regions, char** errorMessage);
+
+// Finds a module by name. Sets `errorMessage` if the module could not be found.
+bool findModule(HANDLE hProcess, const std::string& name, MODULEENTRY32* module, char** errorMessage);
+
+// Finds the region containing `address`, refreshing the regions once if it is not in the cached ones.
+bool findRegion(HANDLE hProcess, DWORD64 address, MEMORY_BASIC_INFORMATION* region);
+
+// Finds the module containing `address`.
+bool findModuleForAddress(HANDLE hProcess, DWORD64 address, MODULEENTRY32* module);
+
+// Drops the cache of a handle, such as when it is closed. The next lookup starts from scratch.
+void invalidate(HANDLE hProcess);
+}  // namespace addressmap
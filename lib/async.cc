@@ -0,0 +1,138 @@
+#include "async.h"
+
+#include <string.h>
+#include <memory>
+#include "instance.h"
+#include "stats.h"
+
+const char* async::abortedMessage = "the operation was aborted";
+
+namespace {
+void finished(Napi::Env env);
+
+class Operation : public Napi::AsyncWorker {
+ public:
+  Operation(Napi::Function callback, bool nullError, async::Token token, const async::Execute& execute,
+            const async::Complete& complete)
+      : Napi::AsyncWorker(callback),
+        nullError(nullError),
+        token(token),
+        execute(execute),
+        complete(complete),
+        errorMessage("") {}
+
+  // Settles `deferred` rather than calling the callback.
+  void settle(const Napi::Promise::Deferred& promise) {
+    deferred.reset(new Napi::Promise::Deferred(promise));
+  }
+
+  void Execute() override {
+    static const std::atomic<bool> never(false);
+
+    if (token && *token) {
+      errorMessage = (char*)async::abortedMessage;
+      return;
+    }
+
+    // Operations that ran to the end keep their results even if the token was set in the meantime, so that what
+    // they acquired (a handle, a session) is not lost. Scans that stopped early fail through `failIfCancelled`.
+    execute(&errorMessage, token ? *token : never);
+  }
+
+  void OnOK() override {
+    Napi::Env env = Env();
+    MEMORYJS_STATS(pending.finish());
+    bool failed = strcmp(errorMessage, "") != 0;
+
+    if (deferred) {
+      if (failed) {
+        Napi::Error error = Napi::Error::New(env, errorMessage);
+        if (errorMessage == async::abortedMessage) error.Set("name", Napi::String::New(env, "AbortError"));
+        deferred->Reject(error.Value());
+      } else {
+        deferred->Resolve(complete(env));
+      }
+    } else {
+      Napi::Value error = !failed && nullError ? env.Null() : Napi::String::New(env, errorMessage);
+      Callback().Call({error, complete(env)});
+    }
+
+    finished(env);
+  }
+
+ private:
+  bool nullError;
+  async::Token token;
+  async::Execute execute;
+  async::Complete complete;
+  char* errorMessage;
+  std::unique_ptr<Napi::Promise::Deferred> deferred;
+
+  // Taken from the binding that queued the operation, which counts as running until its result is ready
+  MEMORYJS_STATS(stats::Pending pending;)
+};
+
+// Operations are only queued and completed on their environment's thread, so limiters need no locking.
+void start(Napi::Env env, Operation* operation) {
+  async::Limiter& limiter = instance::get(env).limiter;
+
+  if (limiter.concurrency && limiter.running >= limiter.concurrency) {
+    limiter.waiting.push_back(operation);
+    return;
+  }
+
+  limiter.running++;
+  operation->Queue();
+}
+
+// Starts waiting operations while the limit allows.
+void drain(async::Limiter& limiter) {
+  while (!limiter.waiting.empty() && (!limiter.concurrency || limiter.running < limiter.concurrency)) {
+    Napi::AsyncWorker* next = limiter.waiting.front();
+    limiter.waiting.pop_front();
+
+    limiter.running++;
+    next->Queue();
+  }
+}
+
+void finished(Napi::Env env) {
+  async::Limiter& limiter = instance::get(env).limiter;
+  limiter.running--;
+  drain(limiter);
+}
+}  // namespace
+
+void async::queue(Napi::Function callback, bool nullError, const Execute& execute, const Complete& complete) {
+  start(callback.Env(), new Operation(callback, nullError, nullptr, execute, complete));
+}
+
+Napi::Promise async::queue(Napi::Env env, Token token, const Execute& execute, const Complete& complete) {
+  // The worker needs a callback even though the promise is settled instead
+  Napi::Function unused = Napi::Function::New(env, [](const Napi::CallbackInfo&) {});
+  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+
+  Operation* operation = new Operation(unused, false, token, execute, complete);
+  operation->settle(deferred);
+  start(env, operation);
+
+  return deferred.Promise();
+}
+
+void async::failIfCancelled(char** errorMessage, const std::atomic<bool>& cancelled) {
+  if (cancelled && !strcmp(*errorMessage, "")) *errorMessage = (char*)abortedMessage;
+}
+
+async::Limiter::~Limiter() {
+  for (Napi::AsyncWorker* operation : waiting) delete operation;
+}
+
+void async::setConcurrency(Napi::Env env, size_t limit) {
+  Limiter& limiter = instance::get(env).limiter;
+  limiter.concurrency = limit;
+  drain(limiter);
+}
+
+size_t async::getConcurrency(Napi::Env env) {
+  return instance::get(env).limiter.concurrency;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <napi.h>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+
+// Running operations on the libuv thread pool, so that slow reads and scans do not block the event loop.
+namespace async {
+// Shared between JS and the operations it was passed to. Once set, operations that have not started yet fail with
+// `abortedMessage` and scans stop at their next window of memory.
+typedef std::shared_ptr<std::atomic<bool>> Token;
+
+extern const char* abortedMessage;
+
+// The part of an operation that runs on a worker thread. It must not use N-API and reports failure through
+// `errorMessage`, like the rest of the library.
+typedef std::function<void(char** errorMessage, const std::atomic<bool>& cancelled)> Execute;
+
+// Fails an operation whose results are incomplete because `cancelled` stopped it part of the way through, unless it
+// has already failed. Called at the end of `Execute`s that stop early.
+void failIfCancelled(char** errorMessage, const std::atomic<bool>& cancelled);
+
+// The part that runs back on the main thread and turns the results into a JS value.
+typedef std::function<Napi::Value(Napi::Env env)> Complete;
+
+// Queues an operation and calls `callback(error, result)` once it is done, the way the synchronous callback forms
+// always have. `error` is "" on success, or null when `nullError` is set.
+void queue(Napi::Function callback, bool nullError, const Execute& execute, const Complete& complete);
+
+// Queues an operation and returns a promise that resolves with its result, or rejects with its error message.
+// `token` may be null.
+Napi::Promise queue(Napi::Env env, Token token, const Execute& execute, const Complete& complete);
+
+// Limits how many operations of an environment run at once. Every environment (the main thread and each worker) has
+// its own, and only touches it from its own thread.
+struct Limiter {
+  size_t concurrency = 0;
+  size_t running = 0;
+  std::deque<Napi::AsyncWorker*> waiting;  // not queued yet, in order
+
+  // Operations that never got to run are dropped with the environment
+  ~Limiter();
+};
+
+// At most `limit` operations of the environment run at once, the others wait for their turn in order. 0 removes the
+// limit.
+void setConcurrency(Napi::Env env, size_t limit);
+size_t getConcurrency(Napi::Env env);
+}  // namespace async
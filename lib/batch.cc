@@ -0,0 +1,92 @@
+#include "batch.h"
+
+#include <string.h>
+#include <algorithm>
+#include <numeric>
+#include <vector>
+#include "memory.h"
+
+namespace {
+const DWORD64 pageSize = 0x1000;
+
+// Longest span that reads are merged into. Merging saves an iovec, not a system call, so it is only worth it while the
+// bytes read in between stay few.
+const SIZE_T maxSpan = 0x10000;
+
+DWORD64 pageOf(DWORD64 address) {
+  return address & ~(pageSize - 1);
+}
+}  // namespace
+
+void batch::read(HANDLE hProcess, std::vector<Read>& reads) {
+  std::vector<size_t> order(reads.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return reads[a].address < reads[b].address; });
+
+  // Each span covers reads[order[first]] to reads[order[last - 1]].
+  struct Span {
+    DWORD64 address;
+    SIZE_T size;
+    size_t first;
+    size_t last;
+    size_t offset;  // into the staging buffer
+  };
+
+  std::vector<Span> spans;
+  size_t staged = 0;
+
+  for (size_t i = 0; i < order.size(); i++) {
+    const Read& next = reads[order[i]];
+    if (!next.size) continue;
+
+    if (!spans.empty()) {
+      Span& span = spans.back();
+      DWORD64 end = span.address + span.size;
+
+      // Only reads that overlap or follow the span directly, or start on the last page it touches, are merged, so that
+      // the bytes read in between are at most a page per read. Sparse reads become iovecs of their own.
+      bool near = next.address <= end || pageOf(next.address) == pageOf(end - 1);
+      if (near && std::max(end, next.address + next.size) - span.address <= maxSpan) {
+        DWORD64 extended = std::max(end, next.address + next.size);
+        staged += (SIZE_T)(extended - end);
+        span.size = (SIZE_T)(extended - span.address);
+        span.last = i + 1;
+        continue;
+      }
+    }
+
+    spans.push_back({next.address, next.size, i, i + 1, staged});
+    staged += next.size;
+  }
+
+  std::vector<unsigned char> staging(staged);
+  std::vector<memory::Segment> segments(spans.size());
+
+  for (size_t i = 0; i < spans.size(); i++) {
+    segments[i] = {spans[i].address, staging.data() + spans[i].offset, spans[i].size, 0};
+  }
+
+  memory::readScatter(hProcess, segments.data(), segments.size());
+
+  for (size_t i = 0; i < spans.size(); i++) {
+    const Span& span = spans[i];
+    DWORD64 readEnd = span.address + segments[i].bytesRead;
+
+    for (size_t j = span.first; j < span.last; j++) {
+      Read& read = reads[order[j]];
+      if (!read.size) continue;
+
+      if (read.address + read.size <= readEnd) {
+        memcpy(read.buffer, staging.data() + span.offset + (read.address - span.address), read.size);
+        read.ok = true;
+      } else {
+        // Past the first unreadable byte of the span, the read may still sit on a readable page of its own.
+        read.ok = memory::read(hProcess, read.address, read.buffer, read.size) == read.size;
+      }
+    }
+  }
+
+  for (auto& read : reads) {
+    if (!read.size) read.ok = true;
+  }
+}
@@ -0,0 +1,24 @@
+#pragma once
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+
+#include <windows.h>
+#else
+#include "compat.h"
+#endif
+#include <vector>
+
+// Reading many small values at scattered addresses with as few system calls as possible.
+namespace batch {
+struct Read {
+  DWORD64 address;
+  SIZE_T size;
+  void* buffer;  // receives `size` bytes
+  bool ok;       // set if the value could be read
+};
+
+// Reads are sorted by address and merged with their neighbours when they touch or fall in the same page, up to a
+// span of 64KB, then the spans are read with as few vectored reads as the platform allows. Reads in a span that was
+// only partly readable are retried on their own.
+void read(HANDLE hProcess, std::vector<Read>& reads);
+}  // namespace batch
@@ -0,0 +1,99 @@
+#include "bufferpool.h"
+
+#include <stdint.h>
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+namespace {
+// Every buffer is preceded by a header holding its size class, kept at 16 bytes so the data stays aligned.
+const size_t headerSize = 16;
+const uint32_t unpooled = 0xFFFFFFFF;
+
+// The free buffers of a size class are capped at this many bytes (but at least 4 buffers).
+const size_t retainedBytes = 0x400000;
+
+size_t classCount() {
+  size_t count = 0;
+  for (size_t size = bufferpool::minPooled; size <= bufferpool::maxPooled; size <<= 1) count++;
+  return count;
+}
+
+size_t classSize(uint32_t index) {
+  return bufferpool::minPooled << index;
+}
+
+class Pool {
+ public:
+  Pool() : free(classCount()), bytes(0) {}
+
+  char* acquire(uint32_t index) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (free[index].empty()) return nullptr;
+
+    char* block = free[index].back();
+    free[index].pop_back();
+    bytes -= classSize(index);
+    return block;
+  }
+
+  bool release(uint32_t index, char* block) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    size_t cap = std::max<size_t>(4, retainedBytes / classSize(index));
+    if (free[index].size() >= cap) return false;
+
+    free[index].push_back(block);
+    bytes += classSize(index);
+    return true;
+  }
+
+  size_t pooledBytes() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return bytes;
+  }
+
+ private:
+  std::mutex mutex;
+  std::vector<std::vector<char*>> free;
+  size_t bytes;
+};
+
+// Like the thread pool, never destroyed: buffers may still be finalized while static objects are torn down.
+Pool& pool() {
+  static Pool* instance = new Pool();
+  return *instance;
+}
+}  // namespace
+
+char* bufferpool::acquire(size_t size) {
+  uint32_t index = 0;
+  while (index < classCount() && classSize(index) < size) index++;
+
+  if (index == classCount()) {
+    char* block = new char[headerSize + size];
+    *(uint32_t*)block = unpooled;
+    return block + headerSize;
+  }
+
+  char* block = pool().acquire(index);
+  if (!block) {
+    block = new char[headerSize + classSize(index)];
+    *(uint32_t*)block = index;
+  }
+
+  return block + headerSize;
+}
+
+void bufferpool::release(char* data) {
+  if (!data) return;
+
+  char* block = data - headerSize;
+  uint32_t index = *(uint32_t*)block;
+
+  if (index == unpooled || !pool().release(index, block)) delete[] block;
+}
+
+size_t bufferpool::pooledBytes() {
+  return pool().pooledBytes();
+}
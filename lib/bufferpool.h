@@ -0,0 +1,19 @@
+#pragma once
+#include <stddef.h>
+
+// A pool of native buffers in power-of-two size classes, so that buffers handed to JS and freed by the garbage
+// collector are reused instead of going back to the heap.
+namespace bufferpool {
+// Smallest and largest pooled size class. Larger buffers are allocated and freed as usual.
+const size_t minPooled = 0x40;
+const size_t maxPooled = 0x100000;
+
+// Returns a buffer of at least `size` bytes. Its contents are undefined.
+char* acquire(size_t size);
+
+// Returns a buffer from acquire to the pool, or frees it if its size class already holds enough free buffers.
+void release(char* data);
+
+// Number of bytes held by free buffers in the pool.
+size_t pooledBytes();
+}  // namespace bufferpool
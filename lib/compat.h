@@ -0,0 +1,88 @@
+#pragma once
+
+// Win32 type shims for non-Windows builds. The rest of the addon is written against the Windows types
+// (HANDLE, MEMORY_BASIC_INFORMATION, MODULEENTRY32, PROCESSENTRY32), so the Linux backend fills in the
+// same structures and keeps the field names the JS layer already exposes.
+
+#include <limits.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+typedef void* HANDLE;
+typedef void* HMODULE;
+typedef void* PVOID;
+typedef void* LPVOID;
+typedef const void* LPCVOID;
+typedef int BOOL;
+typedef uint8_t BYTE;
+typedef uint16_t WORD;
+typedef uint32_t DWORD;
+typedef uint64_t DWORD64;
+typedef int32_t LONG;
+typedef uintptr_t ULONG_PTR;
+typedef size_t SIZE_T;
+
+#define MAX_PATH PATH_MAX
+#define MAX_MODULE_NAME32 255
+
+// Memory protection constants.
+#define PAGE_NOACCESS 0x01
+#define PAGE_READONLY 0x02
+#define PAGE_READWRITE 0x04
+#define PAGE_WRITECOPY 0x08
+#define PAGE_EXECUTE 0x10
+#define PAGE_EXECUTE_READ 0x20
+#define PAGE_EXECUTE_READWRITE 0x40
+#define PAGE_EXECUTE_WRITECOPY 0x80
+#define PAGE_GUARD 0x100
+
+// Memory state and type constants.
+// On Linux every mapping listed in /proc/<pid>/maps is committed. File-backed mappings of a module that has
+// executable code are MEM_IMAGE, other file-backed mappings are MEM_MAPPED and anonymous memory is MEM_PRIVATE.
+#define MEM_COMMIT 0x1000
+#define MEM_RESERVE 0x2000
+#define MEM_FREE 0x10000
+#define MEM_PRIVATE 0x20000
+#define MEM_MAPPED 0x40000
+#define MEM_IMAGE 0x1000000
+
+typedef struct _MEMORY_BASIC_INFORMATION {
+  PVOID BaseAddress;
+  PVOID AllocationBase;
+  DWORD AllocationProtect;
+  SIZE_T RegionSize;
+  DWORD State;
+  DWORD Protect;
+  DWORD Type;
+} MEMORY_BASIC_INFORMATION;
+
+typedef struct tagPROCESSENTRY32 {
+  DWORD dwSize;
+  DWORD cntUsage;
+  DWORD th32ProcessID;
+  ULONG_PTR th32DefaultHeapID;
+  DWORD th32ModuleID;
+  DWORD cntThreads;
+  DWORD th32ParentProcessID;
+  LONG pcPriClassBase;
+  DWORD dwFlags;
+  char szExeFile[MAX_PATH];
+} PROCESSENTRY32;
+
+typedef struct tagMODULEENTRY32 {
+  DWORD dwSize;
+  DWORD th32ModuleID;
+  DWORD th32ProcessID;
+  DWORD GlblcntUsage;
+  DWORD ProccntUsage;
+  BYTE* modBaseAddr;
+  DWORD modBaseSize;
+  HMODULE hModule;
+  char szModule[MAX_MODULE_NAME32 + 1];
+  char szExePath[MAX_PATH];
+} MODULEENTRY32;
+
+// A process "handle" on Linux is the process id itself.
+inline DWORD GetProcessId(HANDLE hProcess) {
+  return (DWORD)(uintptr_t)hProcess;
+}
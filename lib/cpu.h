@@ -0,0 +1,91 @@
+#pragma once
+
+#include <stdint.h>
+
+// Runtime CPU feature detection for the SIMD kernels. Kernels are compiled with per-function target
+// attributes so the addon itself does not require anything beyond the baseline instruction set.
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define MEMORYJS_X86 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#include <immintrin.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define MEMORYJS_TARGET(x) __attribute__((target(x)))
+#else
+#define MEMORYJS_TARGET(x)
+#endif
+
+namespace cpu {
+inline bool hasSSE2() {
+#if defined(_M_X64) || defined(__x86_64__)
+  return true;
+#elif defined(MEMORYJS_X86) && defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 1);
+  return (info[3] & (1 << 26)) != 0;
+#elif defined(MEMORYJS_X86)
+  return __builtin_cpu_supports("sse2");
+#else
+  return false;
+#endif
+}
+
+inline bool hasAVX2() {
+#if defined(MEMORYJS_X86) && defined(_MSC_VER)
+  static const bool supported = [] {
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+
+    // The OS has to save the YMM registers as well (OSXSAVE + XCR0 bits 1 and 2).
+    __cpuid(info, 1);
+    if (!(info[2] & (1 << 27)) || (_xgetbv(0) & 6) != 6) return false;
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+  }();
+  return supported;
+#elif defined(MEMORYJS_X86)
+  return __builtin_cpu_supports("avx2");
+#else
+  return false;
+#endif
+}
+
+// Index of the lowest set bit. `mask` must not be zero.
+inline unsigned ctz(uint32_t mask) {
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return index;
+#else
+  return __builtin_ctz(mask);
+#endif
+}
+
+// Index of the lowest set bit of a 64-bit mask. `mask` must not be zero.
+inline unsigned ctz64(uint64_t mask) {
+#ifdef _MSC_VER
+  uint32_t low = (uint32_t)mask;
+  return low ? ctz(low) : 32 + ctz((uint32_t)(mask >> 32));
+#else
+  return __builtin_ctzll(mask);
+#endif
+}
+
+// Number of set bits.
+inline unsigned popcount(uint32_t mask) {
+#ifdef _MSC_VER
+  // __popcnt needs the POPCNT instruction, which is not part of the baseline
+  mask = mask - ((mask >> 1) & 0x55555555);
+  mask = (mask & 0x33333333) + ((mask >> 2) & 0x33333333);
+  return (((mask + (mask >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
+#else
+  return __builtin_popcount(mask);
+#endif
+}
+}  // namespace cpu
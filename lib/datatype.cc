@@ -0,0 +1,107 @@
+#include "datatype.h"
+
+#include <stdint.h>
+#include <string.h>
+
+namespace {
+struct Name {
+  const char* name;
+  datatype::Type type;
+};
+
+const Name names[] = {
+    {"byte", datatype::T_BYTE},       {"int", datatype::T_INT},         {"int32", datatype::T_INT32},
+    {"uint32", datatype::T_UINT32},   {"int64", datatype::T_INT64},     {"uint64", datatype::T_UINT64},
+    {"dword", datatype::T_DWORD},     {"short", datatype::T_SHORT},     {"long", datatype::T_LONG},
+    {"float", datatype::T_FLOAT},     {"double", datatype::T_DOUBLE},   {"ptr", datatype::T_POINTER},
+    {"pointer", datatype::T_POINTER}, {"bool", datatype::T_BOOL},       {"boolean", datatype::T_BOOL},
+    {"vector3", datatype::T_VECTOR3}, {"vec3", datatype::T_VECTOR3},   {"vector4", datatype::T_VECTOR4},
+    {"vec4", datatype::T_VECTOR4},
+};
+
+template <class T>
+T load(const void* data) {
+  T value;
+  memcpy(&value, data, sizeof(T));
+  return value;
+}
+}  // namespace
+
+bool datatype::parse(const std::string& name, Type* type) {
+  for (auto& entry : names) {
+    if (name == entry.name) {
+      *type = entry.type;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+size_t datatype::size(Type type) {
+  switch (type) {
+    case T_BYTE:
+    case T_BOOL:
+      return 1;
+    case T_SHORT:
+      return sizeof(short);
+    case T_INT:
+    case T_INT32:
+    case T_UINT32:
+    case T_DWORD:
+    case T_FLOAT:
+      return 4;
+    case T_LONG:
+      return sizeof(long);
+    case T_INT64:
+    case T_UINT64:
+    case T_DOUBLE:
+      return 8;
+    case T_POINTER:
+      return sizeof(intptr_t);
+    case T_VECTOR3:
+      return 3 * sizeof(float);
+    case T_VECTOR4:
+      return 4 * sizeof(float);
+  }
+
+  return 0;
+}
+
+bool datatype::isNumber(Type type) {
+  return type != T_BOOL && type != T_VECTOR3 && type != T_VECTOR4;
+}
+
+double datatype::toNumber(Type type, const void* data) {
+  switch (type) {
+    case T_BYTE:
+      return load<unsigned char>(data);
+    case T_INT:
+    case T_INT32:
+      return load<int32_t>(data);
+    case T_UINT32:
+    case T_DWORD:
+      return load<uint32_t>(data);
+    case T_INT64:
+      return (double)load<int64_t>(data);
+    case T_UINT64:
+      return (double)load<uint64_t>(data);
+    case T_SHORT:
+      return load<short>(data);
+    case T_LONG:
+      return load<long>(data);
+    case T_FLOAT:
+      return load<float>(data);
+    case T_DOUBLE:
+      return load<double>(data);
+    case T_POINTER:
+      return (double)load<intptr_t>(data);
+    case T_BOOL:
+      return load<bool>(data);
+    case T_VECTOR3:
+    case T_VECTOR4:
+      return load<float>(data);
+  }
+
+  return 0;
+}
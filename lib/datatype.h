@@ -0,0 +1,35 @@
+#pragma once
+#include <stddef.h>
+#include <string>
+
+// The data types readMemory understands, parsed once so that batched reads do not compare type strings per value.
+namespace datatype {
+enum Type {
+  T_BYTE,
+  T_INT,
+  T_INT32,
+  T_UINT32,
+  T_INT64,
+  T_UINT64,
+  T_DWORD,
+  T_SHORT,
+  T_LONG,
+  T_FLOAT,
+  T_DOUBLE,
+  T_POINTER,
+  T_BOOL,
+  T_VECTOR3,
+  T_VECTOR4
+};
+
+// Accepts the same names as readMemory (apart from strings). Returns false for an unknown name.
+bool parse(const std::string& name, Type* type);
+
+size_t size(Type type);
+
+// True if a value of the type is a single number.
+bool isNumber(Type type);
+
+// Converts a value of a number type (or a bool) to a double.
+double toNumber(Type type, const void* data);
+}  // namespace datatype
@@ -0,0 +1,89 @@
+#include "instance.h"
+
+#include <stdint.h>
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include "addressmap.h"
+#include "process.h"
+#include "sigcache.h"
+#include "snapshot.h"
+
+namespace {
+// Every handle opened through the addon, with how many times each environment that holds it opened it
+std::mutex handlesLock;
+std::map<HANDLE, std::map<const instance::Data*, size_t>> owners;
+
+// Closes one open of a handle, with the lock held. `last` is set once no environment holds it any more.
+void closeHandle(HANDLE handle, bool last) {
+  // Handles are reused, so the cache of this one must not outlive it
+  if (last) addressmap::invalidate(handle);
+
+  if (snapshot::owns(handle)) {
+    snapshot::close(handle);
+  } else {
+    process::closeProcess(handle);
+  }
+}
+
+// Closes `count` of the opens `data` holds on the handle, with the lock held
+void release(std::map<HANDLE, std::map<const instance::Data*, size_t>>::iterator handle, const instance::Data* data,
+             size_t count) {
+  auto owner = handle->second.find(data);
+  if (owner == handle->second.end()) return;
+
+  count = std::min(count, owner->second);
+  owner->second -= count;
+  if (!owner->second) handle->second.erase(owner);
+
+  bool last = handle->second.empty();
+  for (size_t i = 0; i < count; i++) closeHandle(handle->first, last && i + 1 == count);
+  if (last) owners.erase(handle);
+}
+}  // namespace
+
+instance::Data::~Data() {
+  {
+    std::lock_guard<std::mutex> guard(publishersLock);
+
+    for (auto& publisher : publishers) {
+      std::shared_ptr<share::Publisher> running = publisher.lock();
+      if (running) running->stop();
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> guard(handlesLock);
+
+    for (auto handle = owners.begin(); handle != owners.end();) {
+      auto next = std::next(handle);
+      release(handle, this, SIZE_MAX);
+      handle = next;
+    }
+  }
+
+  // Matches found since the last flush would be lost with the process
+  sigcache::flush();
+}
+
+void instance::init(Napi::Env env) {
+  napi_set_instance_data(env, new Data(), [](napi_env, void* data, void*) { delete (Data*)data; }, nullptr);
+}
+
+instance::Data& instance::get(Napi::Env env) {
+  void* data = nullptr;
+  napi_get_instance_data(env, &data);
+  return *(Data*)data;
+}
+
+void instance::open(Napi::Env env, HANDLE handle) {
+  std::lock_guard<std::mutex> guard(handlesLock);
+  owners[handle][&get(env)]++;
+}
+
+void instance::close(Napi::Env env, HANDLE handle) {
+  std::lock_guard<std::mutex> guard(handlesLock);
+
+  auto entry = owners.find(handle);
+  if (entry != owners.end()) release(entry, &get(env), 1);
+}
@@ -0,0 +1,47 @@
+#pragma once
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+
+#include <windows.h>
+#else
+#include "compat.h"
+#endif
+#include <napi.h>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "async.h"
+#include "share.h"
+
+// State the addon keeps per environment, so that it can be loaded in any number of worker threads at once.
+//
+// Each environment (the main thread and every worker) gets its own, stored as the environment's instance data and
+// only used from that environment's thread. What is shared between environments is process-wide and locked: the
+// address maps, snapshots, signature cache, native thread pool and the registry of open handles.
+namespace instance {
+struct Data {
+  async::Limiter limiter;
+
+  // Publishers writing into this environment's SharedArrayBuffers. Locked, as their owners may be finalized from
+  // elsewhere in teardown.
+  std::mutex publishersLock;
+  std::vector<std::weak_ptr<share::Publisher>> publishers;
+
+  // Runs when the environment is torn down: stops the publishers, closes the handles that were left open and flushes
+  // the signature cache
+  ~Data();
+};
+
+// Sets up the environment's data, once per environment the addon is loaded in.
+void init(Napi::Env env);
+
+Data& get(Napi::Env env);
+
+// Records that the environment opened `handle`, a process or a snapshot, once more.
+void open(Napi::Env env, HANDLE handle);
+
+// Closes one open of `handle` by the environment. Handles are shared by the whole process (on Linux a process handle
+// is its pid, so environments that open the same process get the same handle), so what is kept for a handle is only
+// dropped once no environment holds it, and closing a handle the environment does not hold does nothing.
+void close(Napi::Env env, HANDLE handle);
+}  // namespace instance
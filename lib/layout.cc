@@ -0,0 +1,65 @@
+#include "layout.h"
+
+#include <string.h>
+#include <algorithm>
+
+namespace {
+// Number of values a single element of the field flattens to.
+size_t numbersOf(const layout::Field& field) {
+  if (field.nested) return field.nested->numbers;
+  if (field.type == datatype::T_VECTOR3) return 3;
+  if (field.type == datatype::T_VECTOR4) return 4;
+  return 1;
+}
+
+size_t flattenElement(const layout::Field& field, const unsigned char* data, double* out) {
+  if (field.nested) return layout::flatten(*field.nested, data, out);
+
+  if (field.type == datatype::T_VECTOR3 || field.type == datatype::T_VECTOR4) {
+    size_t components = field.type == datatype::T_VECTOR3 ? 3 : 4;
+    float values[4];
+    memcpy(values, data, components * sizeof(float));
+    for (size_t i = 0; i < components; i++) out[i] = values[i];
+    return components;
+  }
+
+  out[0] = datatype::toNumber(field.type, data);
+  return 1;
+}
+}  // namespace
+
+size_t layout::Field::elementSize() const {
+  return nested ? nested->size : datatype::size(type);
+}
+
+size_t layout::Field::size() const {
+  return elementSize() * (count ? count : 1);
+}
+
+bool layout::finish(Layout& layout) {
+  size_t end = 0;
+  layout.numbers = 0;
+
+  for (auto& field : layout.fields) {
+    end = std::max(end, field.offset + field.size());
+    layout.numbers += numbersOf(field) * (field.count ? field.count : 1);
+  }
+
+  if (!layout.size) layout.size = end;
+  return layout.size >= end;
+}
+
+size_t layout::flatten(const Layout& layout, const unsigned char* data, double* out) {
+  size_t written = 0;
+
+  for (auto& field : layout.fields) {
+    const unsigned char* element = data + field.offset;
+
+    for (size_t i = 0; i < (field.count ? field.count : 1); i++) {
+      written += flattenElement(field, element, out + written);
+      element += field.elementSize();
+    }
+  }
+
+  return written;
+}
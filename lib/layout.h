@@ -0,0 +1,43 @@
+#pragma once
+#include <stddef.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "datatype.h"
+
+// Struct layouts compiled once from their JS description, so reading a struct is one read of `size` bytes followed
+// by a walk over a fixed list of fields.
+namespace layout {
+struct Layout;
+
+// The largest struct, or array of structs read at once. Offsets and sizes within it cannot overflow.
+const size_t maxSize = (size_t)1 << 30;
+
+struct Field {
+  std::string name;
+  size_t offset;                         // from the start of the struct
+  datatype::Type type;                   // type of a scalar field
+  std::shared_ptr<const Layout> nested;  // layout of a nested struct field, null for scalars
+  size_t count;                          // number of elements of a fixed array, 0 for a single value
+
+  // Size of a single element.
+  size_t elementSize() const;
+
+  // Size of the whole field, every element included.
+  size_t size() const;
+};
+
+struct Layout {
+  std::vector<Field> fields;
+  size_t size;     // bytes read per struct and the distance between the elements of a struct array
+  size_t numbers;  // number of values when the struct is flattened into numbers
+};
+
+// Fills in `size` (unless one was given) and `numbers` once the fields are set.
+// Returns false if a given size is too small to hold every field.
+bool finish(Layout& layout);
+
+// Writes every value of the struct at `data` to `out` as numbers, in field order. Vectors contribute one number
+// per component, arrays one per element and nested structs all of their own. Returns the number of values written.
+size_t flatten(const Layout& layout, const unsigned char* data, double* out);
+}  // namespace layout
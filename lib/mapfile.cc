@@ -0,0 +1,69 @@
+#include "mapfile.h"
+
+#include <stdio.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+mapfile::Mapping mapfile::none() {
+#ifdef _WIN32
+  return {nullptr, 0, INVALID_HANDLE_VALUE, NULL};
+#else
+  return {nullptr, 0, -1};
+#endif
+}
+
+bool mapfile::map(const std::string& path, Mapping& mapping) {
+  mapping = none();
+
+#ifdef _WIN32
+  mapping.file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING,
+                             FILE_ATTRIBUTE_NORMAL, NULL);
+  if (mapping.file == INVALID_HANDLE_VALUE) return false;
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(mapping.file, &size) || !size.QuadPart) return true;
+  mapping.size = (size_t)size.QuadPart;
+
+  mapping.view = CreateFileMappingA(mapping.file, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (mapping.view) mapping.data = (const unsigned char*)MapViewOfFile(mapping.view, FILE_MAP_READ, 0, 0, 0);
+#else
+  mapping.fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (mapping.fd < 0) return false;
+
+  struct stat status;
+  if (fstat(mapping.fd, &status) || !status.st_size) return true;
+  mapping.size = (size_t)status.st_size;
+
+  void* data = mmap(nullptr, mapping.size, PROT_READ, MAP_SHARED, mapping.fd, 0);
+  if (data != MAP_FAILED) mapping.data = (const unsigned char*)data;
+#endif
+
+  if (!mapping.data) mapping.size = 0;
+  return true;
+}
+
+void mapfile::unmap(Mapping& mapping) {
+#ifdef _WIN32
+  if (mapping.data) UnmapViewOfFile(mapping.data);
+  if (mapping.view) CloseHandle(mapping.view);
+  if (mapping.file != INVALID_HANDLE_VALUE) CloseHandle(mapping.file);
+#else
+  if (mapping.data) munmap((void*)mapping.data, mapping.size);
+  if (mapping.fd >= 0) close(mapping.fd);
+#endif
+
+  mapping = none();
+}
+
+bool mapfile::replace(const std::string& from, const std::string& to) {
+#ifdef _WIN32
+  return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+  return rename(from.c_str(), to.c_str()) == 0;
+#endif
+}
@@ -0,0 +1,32 @@
+#pragma once
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+
+#include <windows.h>
+#endif
+#include <stddef.h>
+#include <string>
+
+// Read-only memory mappings of whole files, for the file formats that are read in place.
+namespace mapfile {
+struct Mapping {
+  const unsigned char* data;  // null if the file is empty or could not be mapped
+  size_t size;
+#ifdef _WIN32
+  HANDLE file;
+  HANDLE view;
+#else
+  int fd;
+#endif
+};
+
+// A mapping of nothing, which unmap accepts.
+Mapping none();
+
+// Returns false if the file could not be opened.
+bool map(const std::string& path, Mapping& mapping);
+void unmap(Mapping& mapping);
+
+// Moves `from` over `to`, replacing it.
+bool replace(const std::string& from, const std::string& to);
+}  // namespace mapfile
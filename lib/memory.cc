@@ -2,8 +2,12 @@
 
 #include <windows.h>
 #include <vector>
+#include "snapshot.h"
+#include "stats.h"
 
 std::vector<MEMORY_BASIC_INFORMATION> memory::getRegions(HANDLE hProcess) {
+  if (snapshot::owns(hProcess)) return snapshot::getRegions(hProcess);
+
   std::vector<MEMORY_BASIC_INFORMATION> regions;
 
   MEMORY_BASIC_INFORMATION region;
@@ -14,11 +18,59 @@ std::vector<MEMORY_BASIC_INFORMATION> memory::getRegions(HANDLE hProcess) {
     regions.push_back(region);
   }
 
+  MEMORYJS_STATS(stats::syscalls(regions.size() + 1));
+
   return regions;
 }
 
-char* memory::readBuffer(HANDLE hProcess, DWORD64 address, SIZE_T size) {
-  char* buffer = new char[size];
-  ReadProcessMemory(hProcess, (LPVOID)address, buffer, size, NULL);
-  return buffer;
+std::vector<MEMORY_BASIC_INFORMATION> memory::getRegions(HANDLE hProcess, DWORD64 start, DWORD64 end) {
+  std::vector<MEMORY_BASIC_INFORMATION> regions;
+
+  if (snapshot::owns(hProcess)) {
+    for (auto& region : snapshot::getRegions(hProcess)) {
+      DWORD64 base = (DWORD64)region.BaseAddress;
+      if (base < end && base + region.RegionSize > start) regions.push_back(region);
+    }
+
+    return regions;
+  }
+
+  MEMORY_BASIC_INFORMATION region;
+  DWORD64 address;
+
+  for (address = start;
+       address < end && VirtualQueryEx(hProcess, (LPVOID)address, &region, sizeof(region)) == sizeof(region);
+       address = (DWORD64)region.BaseAddress + region.RegionSize) {
+    regions.push_back(region);
+  }
+
+  MEMORYJS_STATS(stats::syscalls(regions.size() + 1));
+
+  return regions;
+}
+
+SIZE_T memory::read(HANDLE hProcess, DWORD64 address, void* buffer, SIZE_T size) {
+  SIZE_T bytesRead = 0;
+
+  if (snapshot::owns(hProcess)) {
+    bytesRead = snapshot::read(hProcess, address, buffer, size);
+  } else {
+    ReadProcessMemory(hProcess, (LPCVOID)address, buffer, size, &bytesRead);
+    MEMORYJS_STATS(stats::syscalls(1));
+  }
+
+  MEMORYJS_STATS(stats::read(size, bytesRead));
+  return bytesRead;
+}
+
+SIZE_T memory::readScatter(HANDLE hProcess, Segment* segments, size_t count) {
+  // Windows has no vectored equivalent of ReadProcessMemory.
+  SIZE_T total = 0;
+
+  for (size_t i = 0; i < count; i++) {
+    segments[i].bytesRead = read(hProcess, segments[i].address, segments[i].buffer, segments[i].size);
+    total += segments[i].bytesRead;
+  }
+
+  return total;
 }
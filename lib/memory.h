@@ -1,17 +1,40 @@
 #pragma once
+#ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
 
 #include <windows.h>
+#else
+#include "compat.h"
+#endif
 #include <vector>
 
 namespace memory {
+// One piece of a scatter/gather read: `size` bytes at `address` in the target are copied to `buffer`.
+// `bytesRead` is filled in by readScatter.
+struct Segment {
+  DWORD64 address;
+  void* buffer;
+  SIZE_T size;
+  SIZE_T bytesRead;
+};
+
 std::vector<MEMORY_BASIC_INFORMATION> getRegions(HANDLE hProcess);
-char* readBuffer(HANDLE hProcess, DWORD64 address, SIZE_T size);
+
+// Returns only the regions that overlap [start, end).
+std::vector<MEMORY_BASIC_INFORMATION> getRegions(HANDLE hProcess, DWORD64 start, DWORD64 end);
+
+// Reads `size` bytes at `address` into `buffer`, returning the number of bytes that were read.
+SIZE_T read(HANDLE hProcess, DWORD64 address, void* buffer, SIZE_T size);
+
+// Reads every segment, batching them into as few system calls as the platform allows.
+// A segment that cannot be read does not stop the remaining segments from being read.
+// Returns the total number of bytes read.
+SIZE_T readScatter(HANDLE hProcess, Segment* segments, size_t count);
 
 template <class T>
 T readMemory(HANDLE hProcess, DWORD64 address) {
   T cRead;
-  ReadProcessMemory(hProcess, (LPVOID)address, &cRead, sizeof(T), NULL);
+  read(hProcess, address, &cRead, sizeof(T));
   return cRead;
 }
 }  // namespace memory
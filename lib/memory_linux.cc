@@ -0,0 +1,170 @@
+#include "memory.h"
+
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <set>
+#include <string>
+#include <vector>
+#include "procfs.h"
+#include "snapshot.h"
+#include "stats.h"
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+namespace {
+DWORD toProtection(const procfs::Mapping& mapping) {
+  if (!mapping.read && !mapping.write && !mapping.execute) return PAGE_NOACCESS;
+
+  if (mapping.execute) {
+    if (mapping.write) return PAGE_EXECUTE_READWRITE;
+    return mapping.read ? PAGE_EXECUTE_READ : PAGE_EXECUTE;
+  }
+
+  return mapping.write ? PAGE_READWRITE : PAGE_READONLY;
+}
+
+// Reads whatever process_vm_readv could not through /proc/<pid>/mem. This covers kernels or sandboxes where
+// process_vm_readv is unavailable, as well as pages the kernel will only hand out through the mem file.
+SIZE_T readProcMem(pid_t pid, int* fd, DWORD64 address, char* buffer, SIZE_T size) {
+  if (*fd == -2) {
+    *fd = open(("/proc/" + std::to_string(pid) + "/mem").c_str(), O_RDONLY | O_CLOEXEC);
+  }
+
+  if (*fd < 0) return 0;
+
+  SIZE_T total = 0;
+  while (total < size) {
+    ssize_t count = pread(*fd, buffer + total, size - total, (off_t)(address + total));
+    MEMORYJS_STATS(stats::syscalls(1));
+    if (count <= 0) break;
+    total += count;
+  }
+
+  return total;
+}
+}  // namespace
+
+std::vector<MEMORY_BASIC_INFORMATION> memory::getRegions(HANDLE hProcess) {
+  if (snapshot::owns(hProcess)) return snapshot::getRegions(hProcess);
+
+  std::vector<MEMORY_BASIC_INFORMATION> regions;
+  std::vector<procfs::Mapping> mappings;
+
+  if (!procfs::readMaps(GetProcessId(hProcess), mappings)) return regions;
+
+  // A file is treated as an image (module) if any of its mappings is executable.
+  std::set<std::string> images;
+  for (auto& mapping : mappings) {
+    if (mapping.execute && procfs::isFileBacked(mapping)) images.insert(mapping.path);
+  }
+
+  for (std::vector<procfs::Mapping>::size_type i = 0; i != mappings.size(); i++) {
+    const procfs::Mapping& mapping = mappings[i];
+    MEMORY_BASIC_INFORMATION region;
+
+    region.BaseAddress = (PVOID)mapping.start;
+    region.AllocationBase = (PVOID)mapping.start;
+    region.RegionSize = mapping.end - mapping.start;
+    region.State = MEM_COMMIT;
+    region.Protect = toProtection(mapping);
+    region.AllocationProtect = region.Protect;
+    region.Type = MEM_PRIVATE;
+
+    if (procfs::isFileBacked(mapping)) {
+      region.Type = images.count(mapping.path) ? MEM_IMAGE : MEM_MAPPED;
+
+      // Point the allocation base at the first mapping of the same file, like an image base on Windows.
+      for (auto j = i; j > 0 && mappings[j - 1].path == mapping.path; j--) {
+        region.AllocationBase = (PVOID)mappings[j - 1].start;
+      }
+    }
+
+    regions.push_back(region);
+  }
+
+  return regions;
+}
+
+std::vector<MEMORY_BASIC_INFORMATION> memory::getRegions(HANDLE hProcess, DWORD64 start, DWORD64 end) {
+  std::vector<MEMORY_BASIC_INFORMATION> regions;
+
+  for (auto& region : getRegions(hProcess)) {
+    DWORD64 base = (DWORD64)region.BaseAddress;
+    if (base < end && base + region.RegionSize > start) regions.push_back(region);
+  }
+
+  return regions;
+}
+
+SIZE_T memory::read(HANDLE hProcess, DWORD64 address, void* buffer, SIZE_T size) {
+  Segment segment = {address, buffer, size, 0};
+  return readScatter(hProcess, &segment, 1);
+}
+
+SIZE_T memory::readScatter(HANDLE hProcess, Segment* segments, size_t count) {
+  if (snapshot::owns(hProcess)) {
+    SIZE_T total = 0;
+
+    for (size_t i = 0; i < count; i++) {
+      segments[i].bytesRead = snapshot::read(hProcess, segments[i].address, segments[i].buffer, segments[i].size);
+      total += segments[i].bytesRead;
+      MEMORYJS_STATS(stats::read(segments[i].size, segments[i].bytesRead));
+    }
+
+    return total;
+  }
+
+  pid_t pid = GetProcessId(hProcess);
+  int memFd = -2;
+  SIZE_T total = 0;
+
+  struct iovec local[IOV_MAX];
+  struct iovec remote[IOV_MAX];
+
+  size_t i = 0;
+  while (i < count) {
+    size_t batch = count - i < IOV_MAX ? count - i : IOV_MAX;
+
+    for (size_t j = 0; j < batch; j++) {
+      local[j].iov_base = segments[i + j].buffer;
+      local[j].iov_len = segments[i + j].size;
+      remote[j].iov_base = (void*)(uintptr_t)segments[i + j].address;
+      remote[j].iov_len = segments[i + j].size;
+    }
+
+    ssize_t result = process_vm_readv(pid, local, batch, remote, batch, 0);
+    MEMORYJS_STATS(stats::syscalls(1));
+    SIZE_T transferred = result > 0 ? (SIZE_T)result : 0;
+
+    // The kernel copies segments in order and stops at the first one it cannot read completely.
+    size_t j = i;
+    while (j < i + batch && transferred >= segments[j].size) {
+      segments[j].bytesRead = segments[j].size;
+      transferred -= segments[j].size;
+      total += segments[j].size;
+      j++;
+    }
+
+    if (j == i + batch) {
+      i = j;
+      continue;
+    }
+
+    // Finish the segment that stopped the batch, then resume with the one after it.
+    Segment& failed = segments[j];
+    failed.bytesRead = transferred;
+    failed.bytesRead += readProcMem(pid, &memFd, failed.address + transferred, (char*)failed.buffer + transferred,
+                                    failed.size - transferred);
+    total += failed.bytesRead;
+    i = j + 1;
+  }
+
+  if (memFd >= 0) close(memFd);
+
+  MEMORYJS_STATS(for (size_t i = 0; i < count; i++) stats::read(segments[i].size, segments[i].bytesRead));
+  return total;
+}
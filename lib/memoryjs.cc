@@ -1,17 +1,50 @@
+#ifdef _WIN32
 #include <windows.h>
 #include <TlHelp32.h>
+#include <psapi.h>
+#endif
+#include <math.h>
+#include <algorithm>
+#include <atomic>
+#include <initializer_list>
 #include <iostream>
+#include <memory>
 #include <napi.h>
-#include <psapi.h>
+#include <string.h>
 #include <string>
 #include <thread>
 #include <vector>
+#include "addressmap.h"
+#include "async.h"
+#include "batch.h"
+#include "bufferpool.h"
+#include "datatype.h"
+#include "instance.h"
+#include "layout.h"
 #include "memory.h"
+#include "mirror.h"
 #include "module.h"
+#include "opaque.h"
 #include "pattern.h"
+#include "pointer.h"
+#include "pointerscan.h"
 #include "process.h"
-
+#include "region.h"
+#include "scanner.h"
+#include "session.h"
+#include "share.h"
+#include "sigcache.h"
+#include "snapshot.h"
+#include "stats.h"
+#include "symbols.h"
+#include "text.h"
+#include "textscan.h"
+#include "threadpool.h"
+#include "watch.h"
+
+#ifdef _WIN32
 #pragma comment(lib, "psapi.lib")
+#endif
 
 struct Vector3 {
   float x, y, z;
@@ -25,9 +58,303 @@ namespace memoryjs {
 static void throwError(Napi::Env env, char* error) {
   Napi::TypeError::New(env, Napi::String::New(env, error)).ThrowAsJavaScriptException();
 }
+
+// Handles are pointer-sized, read as 64-bit integers so that none is truncated
+static HANDLE getHandle(Napi::Value value) {
+  return (HANDLE)(intptr_t)value.As<Napi::Number>().Int64Value();
+}
+
+// Reads a size, offset or count: false unless the value is a non-negative safe integer no larger than `max`
+static bool getSize(Napi::Value value, size_t max, size_t* size) {
+  if (!value.IsNumber()) return false;
+
+  double number = value.As<Napi::Number>().DoubleValue();
+  if (!(number >= 0) || number != floor(number) || number > 9007199254740991.0 || number > (double)max) return false;
+
+  *size = (size_t)number;
+  return true;
+}
+
+// True if every one of `names` that `options` has is a number
+static bool hasNumbers(Napi::Object options, std::initializer_list<const char*> names) {
+  for (const char* name : names) {
+    if (options.Has(name) && !options.Get(name).IsNumber()) return false;
+  }
+
+  return true;
+}
+
+// Reads a region filter of the form { protection, type, start, end } where every property is optional, returns false
+// if one of them is not a number
+static bool getFilter(Napi::Object options, region::Filter* filter) {
+  *filter = region::all();
+  if (!hasNumbers(options, {"protection", "type", "start", "end"})) return false;
+
+  if (options.Has("protection")) filter->protect = options.Get("protection").As<Napi::Number>().Uint32Value();
+  if (options.Has("type")) filter->type = options.Get("type").As<Napi::Number>().Uint32Value();
+  if (options.Has("start")) filter->start = options.Get("start").As<Napi::Number>().Int64Value();
+  if (options.Has("end")) filter->end = options.Get("end").As<Napi::Number>().Int64Value();
+
+  return true;
+}
+
+// Reads a scan condition of the form { compare, value, max, tolerance }, returns false if `compare` is unknown or
+// not a string, or another property is not a number
+static bool getCondition(Napi::Object options, scanner::Condition* condition) {
+  static const char* names[] = {"exact",   "notEqual",  "greater",   "less",     "between",
+                                "changed", "unchanged", "increased", "decreased"};
+
+  if (options.Has("compare") && !options.Get("compare").IsString()) return false;
+  if (!hasNumbers(options, {"value", "max", "tolerance"})) return false;
+
+  std::string compare = options.Has("compare") ? options.Get("compare").As<Napi::String>().Utf8Value() : "exact";
+  size_t index = 0;
+  while (index < sizeof(names) / sizeof(names[0]) && compare != names[index]) index++;
+  if (index == sizeof(names) / sizeof(names[0])) return false;
+
+  condition->compare = (scanner::Compare)index;
+  condition->integer = condition->integerMax = 0;
+  condition->number = condition->numberMax = condition->tolerance = 0;
+
+  if (options.Has("value")) {
+    condition->integer = options.Get("value").As<Napi::Number>().Int64Value();
+    condition->number = options.Get("value").As<Napi::Number>().DoubleValue();
+  }
+
+  if (options.Has("max")) {
+    condition->integerMax = options.Get("max").As<Napi::Number>().Int64Value();
+    condition->numberMax = options.Get("max").As<Napi::Number>().DoubleValue();
+  }
+
+  if (options.Has("tolerance")) condition->tolerance = options.Get("tolerance").As<Napi::Number>().DoubleValue();
+
+  return true;
+}
+
+// Converts a value read from memory to its JS representation, as readMemory returns it
+static Napi::Value toValue(Napi::Env env, datatype::Type type, const unsigned char* data) {
+  if (type == datatype::T_BOOL) return Napi::Boolean::New(env, data[0] != 0);
+
+  if (type == datatype::T_VECTOR3 || type == datatype::T_VECTOR4) {
+    float components[4];
+    memcpy(components, data, datatype::size(type));
+
+    Napi::Object vector = Napi::Object::New(env);
+    if (type == datatype::T_VECTOR3) {
+      vector.Set("x", Napi::Number::New(env, components[0]));
+      vector.Set("y", Napi::Number::New(env, components[1]));
+      vector.Set("z", Napi::Number::New(env, components[2]));
+    } else {
+      vector.Set("w", Napi::Number::New(env, components[0]));
+      vector.Set("x", Napi::Number::New(env, components[1]));
+      vector.Set("y", Napi::Number::New(env, components[2]));
+      vector.Set("z", Napi::Number::New(env, components[3]));
+    }
+    return vector;
+  }
+
+  return Napi::Number::New(env, datatype::toNumber(type, data));
+}
+
+// Reads a struct definition: an array of { name, type, offset, count } fields where `type` is a data type or another
+// struct layout, `offset` defaults to the end of the previous field and `count` makes the field a fixed array
+static bool getLayout(Napi::Array fields, layout::Layout* layout, char** errorMessage) {
+  size_t next = 0;
+
+  for (uint32_t i = 0; i < fields.Length(); i++) {
+    Napi::Value value = fields[i];
+    if (!value.IsObject()) {
+      *errorMessage = "every field must be an object of the form { name, type, offset, count }";
+      return false;
+    }
+
+    Napi::Object definition = value.As<Napi::Object>();
+    Napi::Value name = definition.Get("name");
+    Napi::Value type = definition.Get("type");
+    layout::Field field;
+
+    if (!name.IsString()) {
+      *errorMessage = "every field must have a name";
+      return false;
+    }
+
+    field.name = name.As<Napi::String>().Utf8Value();
+
+    if (opaque::get<layout::Layout>(type)) {
+      field.type = datatype::T_BYTE;
+      field.nested = std::make_shared<const layout::Layout>(*opaque::get<layout::Layout>(type));
+    } else if (!type.IsString() || !datatype::parse(type.As<Napi::String>().Utf8Value(), &field.type)) {
+      *errorMessage = "unexpected data type";
+      return false;
+    }
+
+    field.offset = next;
+    field.count = 0;
+
+    if ((definition.Has("offset") && !getSize(definition.Get("offset"), layout::maxSize, &field.offset)) ||
+        (definition.Has("count") && !getSize(definition.Get("count"), UINT32_MAX, &field.count))) {
+      *errorMessage = "offset and count must be non-negative integers";
+      return false;
+    }
+
+    // Kept within the largest struct, so that the end of no field overflows
+    if ((field.elementSize() && field.count > layout::maxSize / field.elementSize()) ||
+        field.size() > layout::maxSize - field.offset) {
+      *errorMessage = "struct size is larger than the largest struct";
+      return false;
+    }
+
+    next = field.offset + field.size();
+
+    layout->fields.push_back(field);
+  }
+
+  if (!layout::finish(*layout)) {
+    *errorMessage = "struct size is smaller than its fields";
+    return false;
+  }
+
+  return true;
+}
+
+static Napi::Value decodeElement(Napi::Env env, const layout::Field& field, const unsigned char* data);
+
+// Sets a property on `target` for every field of the struct at `data`
+static void decodeStruct(Napi::Env env, const layout::Layout& layout, const unsigned char* data,
+                         Napi::Object target) {
+  for (auto& field : layout.fields) {
+    const unsigned char* element = data + field.offset;
+
+    if (!field.count) {
+      target.Set(field.name, decodeElement(env, field, element));
+      continue;
+    }
+
+    Napi::Array values = Napi::Array::New(env, field.count);
+    for (uint32_t i = 0; i < field.count; i++, element += field.elementSize()) {
+      values[i] = decodeElement(env, field, element);
+    }
+
+    target.Set(field.name, values);
+  }
+}
+
+static Napi::Value decodeElement(Napi::Env env, const layout::Field& field, const unsigned char* data) {
+  if (!field.nested) return toValue(env, field.type, data);
+
+  Napi::Object object = Napi::Object::New(env);
+  decodeStruct(env, *field.nested, data, object);
+  return object;
+}
+
+// Reads the offsets of a pointer chain, returns false if any of them is not a number
+static bool getOffsets(Napi::Value value, std::vector<DWORD64>* offsets) {
+  if (!value.IsArray()) return false;
+
+  Napi::Array array = value.As<Napi::Array>();
+  for (uint32_t i = 0; i < array.Length(); i++) {
+    Napi::Value offset = array[i];
+    if (!offset.IsNumber()) return false;
+    offsets->push_back((DWORD64)offset.As<Napi::Number>().Int64Value());
+  }
+
+  return true;
+}
+// Creates a JS string straight from the code units read by text::read
+static Napi::String toString(Napi::Env env, text::Encoding encoding, const std::string& units) {
+  if (encoding == text::UTF16) return Napi::String::New(env, (const char16_t*)units.data(), units.size() / 2);
+  return Napi::String::New(env, units.data(), units.size());
+}
+static Napi::Object toModule(Napi::Env env, const MODULEENTRY32& entry) {
+  Napi::Object module = Napi::Object::New(env);
+
+  module.Set("modBaseAddr", Napi::Number::New(env, (uintptr_t)entry.modBaseAddr));
+  module.Set("modBaseSize", Napi::Number::New(env, (int)entry.modBaseSize));
+  module.Set("szExePath", Napi::String::New(env, entry.szExePath));
+  module.Set("szModule", Napi::String::New(env, entry.szModule));
+  module.Set("th32ModuleID", Napi::Number::New(env, (int)entry.th32ProcessID));
+
+  return module;
+}
+
+static Napi::Object toSymbol(Napi::Env env, const symbols::Symbol& entry) {
+  Napi::Object symbol = Napi::Object::New(env);
+
+  symbol.Set("module", Napi::String::New(env, entry.module));
+  symbol.Set("name", Napi::String::New(env, entry.name));
+  symbol.Set("address", Napi::Number::New(env, (double)entry.address));
+  symbol.Set("size", Napi::Number::New(env, (double)entry.size));
+
+  return symbol;
+}
+
+static Napi::Object toRegion(Napi::Env env, const MEMORY_BASIC_INFORMATION& entry) {
+  Napi::Object region = Napi::Object::New(env);
+
+  region.Set("BaseAddress", Napi::Number::New(env, (double)(uintptr_t)entry.BaseAddress));
+  region.Set("AllocationBase", Napi::Number::New(env, (double)(uintptr_t)entry.AllocationBase));
+  region.Set("AllocationProtect", Napi::Number::New(env, (double)entry.AllocationProtect));
+  region.Set("RegionSize", Napi::Number::New(env, (double)entry.RegionSize));
+  region.Set("State", Napi::Number::New(env, (double)entry.State));
+  region.Set("Protect", Napi::Number::New(env, (double)entry.Protect));
+  region.Set("Type", Napi::Number::New(env, (double)entry.Type));
+
+  return region;
+}
+
+// How a binding was called: synchronously, with a callback as its last argument, or through its Async export with a
+// cancel token (or undefined) as its last argument
+enum Mode { SYNC, CALLBACK, PROMISE };
+
+// Runs an operation right away for synchronous calls and on the thread pool otherwise. Synchronous calls throw the
+// error message, callbacks are passed it and promises are rejected with it.
+static Napi::Value run(const Napi::CallbackInfo& args, Mode mode, const async::Execute& execute,
+                       const async::Complete& complete, bool nullError = false) {
+  Napi::Env env = args.Env();
+  Napi::Value last = args[args.Length() - 1];
+
+  if (mode == CALLBACK) {
+    async::queue(last.As<Napi::Function>(), nullError, execute, complete);
+    return env.Null();
+  }
+
+  if (mode == PROMISE) {
+    // The token slot is always there, so that an options object left in it is not silently taken for no token
+    async::Token* token = opaque::get<async::Token>(last);
+    if (!args.Length() || (!token && !last.IsUndefined())) {
+      throwError(env, "last argument must be a cancel token or undefined");
+      return env.Null();
+    }
+
+    return async::queue(env, token ? *token : nullptr, execute, complete);
+  }
+
+  char* errorMessage = "";
+  std::atomic<bool> cancelled(false);
+  execute(&errorMessage, cancelled);
+
+  if (strcmp(errorMessage, "")) {
+    throwError(env, errorMessage);
+    return env.Null();
+  }
+
+  return complete(env);
+}
+
+// SYNC or CALLBACK, for bindings whose optional arguments leave the callback without a fixed position
+static Mode callbackMode(const Napi::CallbackInfo& args) {
+  return args.Length() && args[args.Length() - 1].IsFunction() ? CALLBACK : SYNC;
+}
+
+// Keeps a JS value, such as a compiled pattern, alive for as long as an operation that uses it
+typedef std::shared_ptr<Napi::Reference<Napi::Value>> Hold;
+
+static Hold hold(Napi::Value value) {
+  return std::make_shared<Napi::Reference<Napi::Value>>(Napi::Persistent(value));
+}
 }  // namespace memoryjs
 
-Napi::Value openProcess(const Napi::CallbackInfo& args) {
+static Napi::Value openProcessImpl(const Napi::CallbackInfo& args, memoryjs::Mode mode) {
   auto env = args.Env();
 
   if (args.Length() != 1 && args.Length() != 2) {
@@ -40,71 +367,70 @@ Napi::Value openProcess(const Napi::CallbackInfo& args) {
     return env.Null();
   }
 
-  if (args.Length() == 2 && !args[1].IsFunction()) {
+  if (mode == memoryjs::CALLBACK && !args[1].IsFunction()) {
     memoryjs::throwError(env, "second argument must be a function");
     return env.Null();
   }
 
-  // Define error message that may be set by the function that opens the process
-  char* errorMessage = "";
+  bool byName = args[0].IsString();
+  std::string processName = byName ? args[0].As<Napi::String>().Utf8Value() : "";
+  uint32_t processId = byName ? 0 : args[0].As<Napi::Number>().Uint32Value();
 
-  process::Pair pair;
+  auto pair = std::make_shared<process::Pair>();
+  auto base = std::make_shared<DWORD64>(0);
 
-  if (args[0].IsString()) {
-    std::string processName(args[0].As<Napi::String>().Utf8Value());
-    pair = process::openProcess(processName.c_str(), &errorMessage);
+  auto execute = [=](char** errorMessage, const std::atomic<bool>&) {
+    // The error message, if any, is thrown for synchronous calls and passed to the callback otherwise
+    *pair = byName ? process::openProcess(processName.c_str(), errorMessage)
+                   : process::openProcess(processId, errorMessage);
 
-    // In case it failed to open, let's keep retrying
-    // while(!strcmp(process.szExeFile, "")) {
-    //   process = process::openProcess((char*) *(processName), &errorMessage);
-    // };
-  }
+    // Looking the base address up also fills the handle's address map, which later pattern scans use
+    if (!strcmp(*errorMessage, "")) {
+      char* moduleError = "";
+      MODULEENTRY32 module;
 
-  if (args[0].IsNumber()) {
-    uint32_t processId = args[0].As<Napi::Number>().Uint32Value();
-    pair = process::openProcess(processId, &errorMessage);
+      if (addressmap::findModule(pair->handle, pair->process.szExeFile, &module, &moduleError)) {
+        *base = (DWORD64)module.modBaseAddr;
+      }
+    }
+  };
 
-    // In case it failed to open, let's keep retrying
-    // while(!strcmp(process.szExeFile, "")) {
-    //   process = process::openProcess(args[0]->Uint32Value(), &errorMessage);
-    // };
-  }
+  auto complete = [=](Napi::Env env) -> Napi::Value {
+    // Create a v8 Object (JSON) to store the process information
+    Napi::Object processInfo = Napi::Object::New(env);
 
-  // If an error message was returned from the function that opens the process, throw the error.
-  // Only throw an error if there is no callback (if there's a callback, the error is passed there).
-  if (strcmp(errorMessage, "") && args.Length() != 2) {
-    memoryjs::throwError(env, errorMessage);
-    return env.Null();
-  }
+    processInfo.Set("dwSize", Napi::Number::New(env, (int)pair->process.dwSize));
+    processInfo.Set("th32ProcessID", Napi::Number::New(env, (int)pair->process.th32ProcessID));
+    processInfo.Set("cntThreads", Napi::Number::New(env, (int)pair->process.cntThreads));
+    processInfo.Set("th32ParentProcessID", Napi::Number::New(env, (int)pair->process.th32ParentProcessID));
+    processInfo.Set("pcPriClassBase", Napi::Number::New(env, (int)pair->process.pcPriClassBase));
+    processInfo.Set("szExeFile", Napi::String::New(env, pair->process.szExeFile));
+    processInfo.Set("handle", Napi::Number::New(env, (intptr_t)pair->handle));
 
-  // Create a v8 Object (JSON) to store the process information
-  Napi::Object processInfo = Napi::Object::New(env);
+    // Handles left open are closed with the environment
+    if (pair->handle) instance::open(env, pair->handle);
+    processInfo.Set("modBaseAddr", Napi::Number::New(env, (uintptr_t)*base));
 
-  processInfo.Set("dwSize", Napi::Number::New(env, (int)pair.process.dwSize));
-  processInfo.Set("th32ProcessID", Napi::Number::New(env, (int)pair.process.th32ProcessID));
-  processInfo.Set("cntThreads", Napi::Number::New(env, (int)pair.process.cntThreads));
-  processInfo.Set("th32ParentProcessID", Napi::Number::New(env, (int)pair.process.th32ParentProcessID));
-  processInfo.Set("pcPriClassBase", Napi::Number::New(env, (int)pair.process.pcPriClassBase));
-  processInfo.Set("szExeFile", Napi::String::New(env, pair.process.szExeFile));
-  processInfo.Set("handle", Napi::Number::New(env, (int)pair.handle));
+    return processInfo;
+  };
 
-  DWORD64 base = module::getBaseAddress(pair.process.szExeFile, pair.process.th32ProcessID);
-  processInfo.Set("modBaseAddr", Napi::Number::New(env, (uintptr_t)base));
+  return memoryjs::run(args, mode, execute, complete);
+}
 
+Napi::Value openProcess(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("openProcess");
   // openProcess can either take one argument or can take
   // two arguments for asychronous use (second argument is the callback)
-  if (args.Length() == 2) {
-    // Callback to let the user handle with the information
-    Napi::Function callback = args[1].As<Napi::Function>();
-    callback.Call({Napi::String::New(env, errorMessage), processInfo});
-    return env.Null();
-  }
+  return openProcessImpl(args, args.Length() == 2 ? memoryjs::CALLBACK : memoryjs::SYNC);
+}
 
-  // return JSON
-  return processInfo;
+Napi::Value openProcessAsync(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("openProcessAsync");
+  return openProcessImpl(args, memoryjs::PROMISE);
 }
 
 void closeProcess(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("closeProcess");
   Napi::Env env = args.Env();
 
   if (args.Length() != 1) {
@@ -117,11 +443,10 @@ void closeProcess(const Napi::CallbackInfo& args) {
     return;
   }
 
-  int32_t hProcess = args[0].As<Napi::Number>().Int32Value();
-  process::closeProcess((HANDLE)hProcess);
+  instance::close(env, memoryjs::getHandle(args[0]));
 }
 
-Napi::Value getProcesses(const Napi::CallbackInfo& args) {
+static Napi::Value getProcessesImpl(const Napi::CallbackInfo& args, memoryjs::Mode mode) {
   Napi::Env env = args.Env();
 
   if (args.Length() > 1) {
@@ -129,55 +454,58 @@ Napi::Value getProcesses(const Napi::CallbackInfo& args) {
     return env.Null();
   }
 
-  if (args.Length() == 1 && !args[0].IsFunction()) {
+  if (mode == memoryjs::CALLBACK && !args[0].IsFunction()) {
     memoryjs::throwError(env, "first argument must be a function");
     return env.Null();
   }
 
-  // Define error message that may be set by the function that gets the processes
-  char* errorMessage = "";
+  auto processEntries = std::make_shared<std::vector<PROCESSENTRY32>>();
 
-  std::vector<PROCESSENTRY32> processEntries = process::getProcesses(&errorMessage);
+  auto execute = [=](char** errorMessage, const std::atomic<bool>&) {
+    *processEntries = process::getProcesses(errorMessage);
+  };
 
-  // If an error message was returned from the function that gets the processes, throw the error.
-  // Only throw an error if there is no callback (if there's a callback, the error is passed there).
-  if (strcmp(errorMessage, "") && args.Length() != 1) {
-    memoryjs::throwError(env, errorMessage);
-    return env.Null();
-  }
+  auto complete = [=](Napi::Env env) -> Napi::Value {
+    // Creates v8 array with the size being that of the processEntries vector processes is an array of JavaScript
+    // objects
+    Napi::Array processes = Napi::Array::New(env, processEntries->size());
 
-  // Creates v8 array with the size being that of the processEntries vector processes is an array of JavaScript objects
-  Napi::Array processes = Napi::Array::New(env, processEntries.size());
+    // Loop over all processes found
+    for (std::vector<PROCESSENTRY32>::size_type i = 0; i != processEntries->size(); i++) {
+      const PROCESSENTRY32& entry = (*processEntries)[i];
 
-  // Loop over all processes found
-  for (std::vector<PROCESSENTRY32>::size_type i = 0; i != processEntries.size(); i++) {
-    // Create a v8 object to store the current process' information
-    Napi::Object process = Napi::Object::New(env);
+      // Create a v8 object to store the current process' information
+      Napi::Object process = Napi::Object::New(env);
 
-    process.Set("cntThreads", Napi::Number::New(env, (int)processEntries[i].cntThreads));
-    process.Set("szExeFile", Napi::String::New(env, processEntries[i].szExeFile));
-    process.Set("th32ProcessID", Napi::Number::New(env, (int)processEntries[i].th32ProcessID));
-    process.Set("th32ParentProcessID", Napi::Number::New(env, (int)processEntries[i].th32ParentProcessID));
-    process.Set("pcPriClassBase", Napi::Number::New(env, (int)processEntries[i].pcPriClassBase));
+      process.Set("cntThreads", Napi::Number::New(env, (int)entry.cntThreads));
+      process.Set("szExeFile", Napi::String::New(env, entry.szExeFile));
+      process.Set("th32ProcessID", Napi::Number::New(env, (int)entry.th32ProcessID));
+      process.Set("th32ParentProcessID", Napi::Number::New(env, (int)entry.th32ParentProcessID));
+      process.Set("pcPriClassBase", Napi::Number::New(env, (int)entry.pcPriClassBase));
 
-    // Push the object to the array
-    processes.Set(i, process);
-  }
+      // Push the object to the array
+      processes.Set(i, process);
+    }
+
+    return processes;
+  };
+
+  return memoryjs::run(args, mode, execute, complete);
+}
 
+Napi::Value getProcesses(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("getProcesses");
   /* getProcesses can either take no arguments or one argument
      one argument is for asychronous use (the callback) */
-  if (args.Length() == 1) {
-    // Callback to let the user handle with the information
-    Napi::Function callback = args[0].As<Napi::Function>();
-    callback.Call({Napi::String::New(env, errorMessage), processes});
-    return env.Null();
-  }
+  return getProcessesImpl(args, args.Length() == 1 ? memoryjs::CALLBACK : memoryjs::SYNC);
+}
 
-  // return JSON
-  return processes;
+Napi::Value getProcessesAsync(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("getProcessesAsync");
+  return getProcessesImpl(args, memoryjs::PROMISE);
 }
 
-Napi::Value getModules(const Napi::CallbackInfo& args) {
+static Napi::Value getModulesImpl(const Napi::CallbackInfo& args, memoryjs::Mode mode) {
   Napi::Env env = args.Env();
 
   if (args.Length() != 1 && args.Length() != 2) {
@@ -190,57 +518,48 @@ Napi::Value getModules(const Napi::CallbackInfo& args) {
     return env.Null();
   }
 
-  if (args.Length() == 2 && !args[1].IsFunction()) {
+  if (mode == memoryjs::CALLBACK && !args[1].IsFunction()) {
     memoryjs::throwError(env, "first argument must be a number, second argument must be a function");
     return env.Null();
   }
 
-  // Define error message that may be set by the function that gets the modules
-  char* errorMessage = "";
-
   int32_t processId = args[0].As<Napi::Number>().Int32Value();
-  std::vector<MODULEENTRY32> moduleEntries = module::getModules(processId, &errorMessage);
+  auto moduleEntries = std::make_shared<std::vector<MODULEENTRY32>>();
 
-  // If an error message was returned from the function getting the modules, throw the error.
-  // Only throw an error if there is no callback (if there's a callback, the error is passed there).
-  if (strcmp(errorMessage, "") && args.Length() != 2) {
-    memoryjs::throwError(env, errorMessage);
-    return env.Null();
-  }
+  auto execute = [=](char** errorMessage, const std::atomic<bool>&) {
+    *moduleEntries = module::getModules(processId, errorMessage);
+  };
 
-  // Creates v8 array with the size being that of the moduleEntries vector
-  // modules is an array of JavaScript objects
-  Napi::Array modules = Napi::Array::New(env, moduleEntries.size());
+  auto complete = [=](Napi::Env env) -> Napi::Value {
+    // Creates v8 array with the size being that of the moduleEntries vector
+    // modules is an array of JavaScript objects
+    Napi::Array modules = Napi::Array::New(env, moduleEntries->size());
 
-  // Loop over all modules found
-  for (std::vector<MODULEENTRY32>::size_type i = 0; i != moduleEntries.size(); i++) {
-    //  Create a v8 object to store the current module's information
-    Napi::Object module = Napi::Object::New(env);
+    // Loop over all modules found
+    for (std::vector<MODULEENTRY32>::size_type i = 0; i != moduleEntries->size(); i++) {
+      // Push an object with the current module's information to the array
+      modules.Set(i, memoryjs::toModule(env, (*moduleEntries)[i]));
+    }
 
-    module.Set("modBaseAddr", Napi::Number::New(env, (uintptr_t)moduleEntries[i].modBaseAddr));
-    module.Set("modBaseSize", Napi::Number::New(env, (int)moduleEntries[i].modBaseSize));
-    module.Set("szExePath", Napi::String::New(env, moduleEntries[i].szExePath));
-    module.Set("szModule", Napi::String::New(env, moduleEntries[i].szModule));
-    module.Set("th32ModuleID", Napi::Number::New(env, (int)moduleEntries[i].th32ProcessID));
+    return modules;
+  };
 
-    // Push the object to the array
-    modules.Set(i, module);
-  }
+  return memoryjs::run(args, mode, execute, complete);
+}
 
+Napi::Value getModules(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("getModules");
   // getModules can either take one argument or two arguments
   // one/two arguments is for asychronous use (the callback)
-  if (args.Length() == 2) {
-    // Callback to let the user handle with the information
-    Napi::Function callback = args[1].As<Napi::Function>();
-    callback.Call({Napi::String::New(env, errorMessage), modules});
-    return env.Null();
-  }
+  return getModulesImpl(args, args.Length() == 2 ? memoryjs::CALLBACK : memoryjs::SYNC);
+}
 
-  // return JSON
-  return modules;
+Napi::Value getModulesAsync(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("getModulesAsync");
+  return getModulesImpl(args, memoryjs::PROMISE);
 }
 
-Napi::Value readMemory(const Napi::CallbackInfo& args) {
+static Napi::Value readMemoryImpl(const Napi::CallbackInfo& args, memoryjs::Mode mode) {
   Napi::Env env = args.Env();
 
   if (args.Length() != 3 && args.Length() != 4) {
@@ -253,309 +572,2900 @@ Napi::Value readMemory(const Napi::CallbackInfo& args) {
     return env.Null();
   }
 
-  if (args.Length() == 4 && !args[3].IsFunction()) {
+  if (mode == memoryjs::CALLBACK && !args[3].IsFunction()) {
     memoryjs::throwError(env, "fourth argument must be a function");
     return env.Null();
   }
 
   std::string dataType(args[2].As<Napi::String>().Utf8Value());
 
-  // Set callback variables in the case the a callback parameter has been passed
-  Napi::Function callback = args[3].As<Napi::Function>();
-  Napi::Value cbError = env.Null();  // Define the error message that will be set if no data type is recognised
-  Napi::Value cbResult;
-
-  HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int32Value();
+  HANDLE handle = memoryjs::getHandle(args[0]);
   DWORD64 address = args[1].As<Napi::Number>().Int64Value();
 
-  if (dataType == "byte") {
-    unsigned char result = memory::readMemory<unsigned char>(handle, address);
-    if (args.Length() == 4)
-      cbResult = Napi::Number::New(env, result);
-    else
-      return Napi::Number::New(env, result);
-
-  } else if (dataType == "int") {
-    int result = memory::readMemory<int>(handle, address);
-    if (args.Length() == 4)
-      cbResult = Napi::Number::New(env, result);
-    else
-      return Napi::Number::New(env, result);
-
-  } else if (dataType == "int32") {
-    int32_t result = memory::readMemory<int32_t>(handle, address);
-    if (args.Length() == 4)
-      cbResult = Napi::Number::New(env, result);
-    else
-      return Napi::Number::New(env, result);
-
-  } else if (dataType == "uint32") {
-    uint32_t result = memory::readMemory<uint32_t>(handle, address);
-    if (args.Length() == 4)
-      cbResult = Napi::Number::New(env, result);
-    else
-      return Napi::Number::New(env, result);
-
-  } else if (dataType == "int64") {
-    int64_t result = memory::readMemory<int64_t>(handle, address);
-    if (args.Length() == 4)
-      cbResult = Napi::Number::New(env, result);
-    else
-      return Napi::Number::New(env, result);
-
-  } else if (dataType == "uint64") {
-    uint64_t result = memory::readMemory<uint64_t>(handle, address);
-    if (args.Length() == 4)
-      cbResult = Napi::Number::New(env, result);
-    else
-      return Napi::Number::New(env, result);
-
-  } else if (dataType == "dword") {
-    DWORD result = memory::readMemory<DWORD>(handle, address);
-    if (args.Length() == 4)
-      cbResult = Napi::Number::New(env, result);
-    else
-      return Napi::Number::New(env, result);
-
-  } else if (dataType == "short") {
-    short result = memory::readMemory<short>(handle, address);
-    if (args.Length() == 4)
-      cbResult = Napi::Number::New(env, result);
-    else
-      return Napi::Number::New(env, result);
-
-  } else if (dataType == "long") {
-    long result = memory::readMemory<long>(handle, address);
-    if (args.Length() == 4)
-      cbResult = Napi::Number::New(env, result);
-    else
-      return Napi::Number::New(env, result);
+  // Strings have no fixed size and are read up to their terminator, everything else is one read of the type's size
+  bool isString = dataType == "string" || dataType == "str" || dataType == "wstring" || dataType == "wstr";
+  text::Encoding encoding = dataType[0] == 'w' ? text::UTF16 : text::UTF8;
 
-  } else if (dataType == "float") {
-    float result = memory::readMemory<float>(handle, address);
-    if (args.Length() == 4)
-      cbResult = Napi::Number::New(env, result);
-    else
-      return Napi::Number::New(env, result);
+  datatype::Type type = datatype::T_BYTE;
+  bool known = isString || datatype::parse(dataType, &type);
 
-  } else if (dataType == "double") {
-    double result = memory::readMemory<double>(handle, address);
-    if (args.Length() == 4)
-      cbResult = Napi::Number::New(env, result);
-    else
-      return Napi::Number::New(env, result);
-
-  } else if (dataType == "ptr" || dataType == "pointer") {
-    intptr_t result = memory::readMemory<intptr_t>(handle, address);
-    if (args.Length() == 4)
-      cbResult = Napi::Number::New(env, result);
-    else
-      return Napi::Number::New(env, result);
-
-  } else if (dataType == "bool" || dataType == "boolean") {
-    bool result = memory::readMemory<bool>(handle, address);
-    if (args.Length() == 4)
-      cbResult = Napi::Boolean::New(env, result);
-    else
-      return Napi::Boolean::New(env, result);
-
-  } else if (dataType == "string" || dataType == "str") {
-    std::vector<char> chars;
-    int offset = 0x0;
-    while (true) {
-      char c = memory::readMemory<char>(handle, address + offset);
-      chars.push_back(c);
-
-      // break at 1 million chars
-      if (offset == (sizeof(char) * 1000000)) {
-        chars.clear();
-        break;
-      }
+  auto data = std::make_shared<std::string>();
+  auto ok = std::make_shared<bool>(false);
 
-      // break at terminator (end of string)
-      if (c == '\0') {
-        break;
-      }
+  auto execute = [=](char** errorMessage, const std::atomic<bool>&) {
+    if (!known) {
+      *errorMessage = "unexpected data type";
+      return;
+    }
 
-      // go to next char
-      offset += sizeof(char);
+    if (!isString) {
+      data->resize(datatype::size(type));
+      memory::read(handle, address, &(*data)[0], data->size());
+      *ok = true;
+      return;
     }
 
-    if (chars.size() == 0) {
-      if (args.Length() == 4)
-        cbError = Napi::String::New(env, "unable to read string (no null-terminator found after 1 million chars)");
-      else {
-        memoryjs::throwError(env, "unable to read string (no null-terminator found after 1 million chars)");
-        return env.Null();
-      }
+    text::Status status = text::read(handle, address, encoding, text::defaultMaxLength, *data);
 
+    if (status == text::UNREADABLE) {
+      *errorMessage = "unable to read string";
+    } else if (status == text::NO_TERMINATOR) {
+      *errorMessage = "unable to read string (no null-terminator found after 1 million chars)";
     } else {
-      // vector -> string
-      std::string str(chars.begin(), chars.end());
-
-      if (args.Length() == 4)
-        cbResult = Napi::String::New(env, str);
-      else
-        return Napi::String::New(env, str);
-    }
-
-  } else if (dataType == "vector3" || dataType == "vec3") {
-    Vector3 result = memory::readMemory<Vector3>(handle, address);
-    Napi::Object moduleInfo = Napi::Object::New(env);
-    moduleInfo.Set("x", Napi::Number::New(env, result.x));
-    moduleInfo.Set("y", Napi::Number::New(env, result.y));
-    moduleInfo.Set("z", Napi::Number::New(env, result.z));
-
-    if (args.Length() == 4)
-      cbResult = moduleInfo;
-    else
-      return moduleInfo;
-
-  } else if (dataType == "vector4" || dataType == "vec4") {
-    Vector4 result = memory::readMemory<Vector4>(handle, address);
-    Napi::Object moduleInfo = Napi::Object::New(env);
-    moduleInfo.Set("w", Napi::Number::New(env, result.w));
-    moduleInfo.Set("x", Napi::Number::New(env, result.x));
-    moduleInfo.Set("y", Napi::Number::New(env, result.y));
-    moduleInfo.Set("z", Napi::Number::New(env, result.z));
-
-    if (args.Length() == 4)
-      cbResult = moduleInfo;
-    else
-      return moduleInfo;
-
-  } else {
-    if (args.Length() == 4)
-      cbError = Napi::String::New(env, "unexpected data type");
-    else {
-      memoryjs::throwError(env, "unexpected data type");
-      return env.Null();
+      *ok = true;
     }
-  }
+  };
 
-  if (args.Length() == 4) callback.Call({cbError, cbResult});
+  auto complete = [=](Napi::Env env) -> Napi::Value {
+    if (!*ok) return env.Undefined();
+    if (isString) return memoryjs::toString(env, encoding, *data);
+    return memoryjs::toValue(env, type, (const unsigned char*)data->data());
+  };
 
-  return env.Null();  // ???
+  return memoryjs::run(args, mode, execute, complete, true);
 }
 
-Napi::Value readBuffer(const Napi::CallbackInfo& args) {
+Napi::Value findModuleForAddress(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("findModuleForAddress");
   Napi::Env env = args.Env();
 
-  if (args.Length() != 3 && args.Length() != 4) {
-    memoryjs::throwError(env, "requires 3 arguments, or 4 arguments if a callback is being used");
+  if (args.Length() != 2 || !args[0].IsNumber() || !args[1].IsNumber()) {
+    memoryjs::throwError(env, "requires 2 arguments, a handle and an address");
     return env.Null();
   }
 
-  if (!args[0].IsNumber() && !args[1].IsNumber() && !args[2].IsNumber()) {
-    memoryjs::throwError(env, "first, second and third arguments must be a number");
+  HANDLE handle = memoryjs::getHandle(args[0]);
+  DWORD64 address = args[1].As<Napi::Number>().Int64Value();
+
+  MODULEENTRY32 module;
+  if (!addressmap::findModuleForAddress(handle, address, &module)) return env.Null();
+
+  return memoryjs::toModule(env, module);
+}
+
+Napi::Value findRegion(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("findRegion");
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 2 || !args[0].IsNumber() || !args[1].IsNumber()) {
+    memoryjs::throwError(env, "requires 2 arguments, a handle and an address");
     return env.Null();
   }
 
-  if (args.Length() == 4 && !args[3].IsFunction()) {
-    memoryjs::throwError(env, "fourth argument must be a function");
+  HANDLE handle = memoryjs::getHandle(args[0]);
+  DWORD64 address = args[1].As<Napi::Number>().Int64Value();
+
+  MEMORY_BASIC_INFORMATION region;
+  if (!addressmap::findRegion(handle, address, &region)) return env.Null();
+
+  return memoryjs::toRegion(env, region);
+}
+
+Napi::Value refreshAddressMap(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("refreshAddressMap");
+  Napi::Env env = args.Env();
+
+  if (args.Length() < 1 || args.Length() > 2 || !args[0].IsNumber()) {
+    memoryjs::throwError(env, "requires 1 or 2 arguments, a handle and optionally whether to read the regions");
     return env.Null();
   }
 
-  // Set callback variables in the case the a callback parameter has been passed
-  Napi::Function callback = args[3].As<Napi::Function>();
-  Napi::Value cbError = env.Null();  // Define the error message that will be set if no data type is recognised
-  Napi::Value cbResult;
-
-  HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int32Value();
-  DWORD64 address = args[1].As<Napi::Number>().Int64Value();
-  SIZE_T size = args[2].As<Napi::Number>().Uint32Value();
-  char* data = memory::readBuffer(handle, address, size);
+  HANDLE handle = memoryjs::getHandle(args[0]);
+  bool regions = args.Length() == 2 && args[1].IsBoolean() && args[1].As<Napi::Boolean>().Value();
 
-  Napi::Buffer<char> buffer = Napi::Buffer<char>::Copy(env, data, size);  // TODO copy or new?
+  // Modules are only re-read if they changed, so comparing generations is a cheap way to find out whether they did
+  char* errorMessage = "";
+  std::shared_ptr<const addressmap::Snapshot> snapshot = addressmap::get(handle, regions, &errorMessage);
 
-  if (args.Length() == 4) {
-    cbResult = buffer;
-    callback.Call({cbError, cbResult});
+  if (strcmp(errorMessage, "")) {
+    memoryjs::throwError(env, errorMessage);
     return env.Null();
   }
 
-  return buffer;
+  return Napi::Number::New(env, (double)snapshot->generation);
 }
 
-Napi::Value findPattern(const Napi::CallbackInfo& args) {
+void invalidateAddressMap(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("invalidateAddressMap");
   Napi::Env env = args.Env();
 
-  // if (args.Length() != 5 && args.Length() != 6) {
-  //   memoryjs::throwError("requires 5 arguments, or 6 arguments if a callback is being used", isolate);
-  //   return;
-  // }
+  if (args.Length() != 1 || !args[0].IsNumber()) {
+    memoryjs::throwError(env, "first argument must be a number");
+    return;
+  }
 
-  // if (!args[0]->IsNumber() && !args[1]->IsString() && !args[2]->IsNumber() && !args[3]->IsNumber() &&
-  // !args[4]->IsNumber()) {
-  //   memoryjs::throwError("first argument must be a number, the remaining arguments must be numbers apart from the
-  //   callback", isolate); return;
-  // }
+  addressmap::invalidate(memoryjs::getHandle(args[0]));
+}
 
-  // if (args.Length() == 6 && !args[5]->IsFunction()) {
-  //   memoryjs::throwError("sixth argument must be a function", isolate);
-  //   return;
-  // }
+Napi::Value findSymbol(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("findSymbol");
+  Napi::Env env = args.Env();
 
-  // Address of findPattern result
-  uintptr_t address = -1;
+  if (args.Length() != 3 || !args[0].IsNumber() || !args[1].IsString() || !args[2].IsString()) {
+    memoryjs::throwError(env, "requires 3 arguments, a handle, a module name and a symbol name");
+    return env.Null();
+  }
+
+  HANDLE handle = memoryjs::getHandle(args[0]);
+  std::string moduleName(args[1].As<Napi::String>().Utf8Value());
+  std::string name(args[2].As<Napi::String>().Utf8Value());
 
-  // Define error message that may be set by the function that gets the modules
   char* errorMessage = "";
+  symbols::Symbol symbol;
+  bool found = symbols::find(handle, moduleName, name, &symbol, &errorMessage);
 
-  HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int32Value();
+  if (strcmp(errorMessage, "")) {
+    memoryjs::throwError(env, errorMessage);
+    return env.Null();
+  }
+
+  if (!found) return env.Null();
+  return memoryjs::toSymbol(env, symbol);
+}
 
-  std::vector<MODULEENTRY32> moduleEntries = module::getModules(GetProcessId(handle), &errorMessage);
+Napi::Value addressToSymbol(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("addressToSymbol");
+  Napi::Env env = args.Env();
 
-  // If an error message was returned from the function getting the modules, throw the error.
-  // Only throw an error if there is no callback (if there's a callback, the error is passed there).
-  if (strcmp(errorMessage, "") && args.Length() != 7) {
-    memoryjs::throwError(env, errorMessage);
+  if (args.Length() != 2 || !args[0].IsNumber() || !args[1].IsNumber()) {
+    memoryjs::throwError(env, "requires 2 arguments, a handle and an address");
     return env.Null();
   }
 
-  std::string moduleName(args[1].As<Napi::String>().Utf8Value());
-  std::string signature(args[2].As<Napi::String>().Utf8Value());
+  HANDLE handle = memoryjs::getHandle(args[0]);
+  DWORD64 address = args[1].As<Napi::Number>().Int64Value();
 
-  for (std::vector<MODULEENTRY32>::size_type i = 0; i != moduleEntries.size(); i++) {
-    if (!strcmp(moduleEntries[i].szModule, moduleName.c_str())) {
-      // const char* pattern = std::string(*signature).c_str();
-      short sigType = args[3].As<Napi::Number>().Uint32Value();
-      uint32_t patternOffset = args[4].As<Napi::Number>().Uint32Value();
-      uint32_t addressOffset = args[5].As<Napi::Number>().Uint32Value();
+  symbols::Symbol symbol;
+  DWORD64 displacement;
+  if (!symbols::findForAddress(handle, address, &symbol, &displacement)) return env.Null();
 
-      address =
-          pattern::findPattern(handle, moduleEntries[i], signature.c_str(), sigType, patternOffset, addressOffset);
-      break;
-    }
+  Napi::Object result = memoryjs::toSymbol(env, symbol);
+  result.Set("displacement", Napi::Number::New(env, (double)displacement));
+  return result;
+}
+
+Napi::Value getModuleSymbols(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("getModuleSymbols");
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 2 || !args[0].IsNumber() || !args[1].IsString()) {
+    memoryjs::throwError(env, "requires 2 arguments, a handle and a module name");
+    return env.Null();
   }
 
-  // If no error was set by getModules and the address is still the value we set it as, it probably means we couldn't
-  // find the module
-  if (strcmp(errorMessage, "") && address == -1) errorMessage = "unable to find module";
+  HANDLE handle = memoryjs::getHandle(args[0]);
+  std::string moduleName(args[1].As<Napi::String>().Utf8Value());
 
-  // If no error was set by getModules and the address is -2 this means there was no match to the pattern
-  if (strcmp(errorMessage, "") && address == -2) errorMessage = "no match found";
+  char* errorMessage = "";
+  std::vector<symbols::Symbol> found = symbols::getSymbols(handle, moduleName, &errorMessage);
 
-  // findPattern can be asynchronous
-  if (args.Length() == 7) {
-    // Callback to let the user handle with the information
-    Napi::Function callback = args[6].As<Napi::Function>();
-    callback.Call({Napi::String::New(env, errorMessage), Napi::Number::New(env, address)});
+  if (strcmp(errorMessage, "")) {
+    memoryjs::throwError(env, errorMessage);
     return env.Null();
   }
 
-  // return JSON
-  return Napi::Number::New(env, address);
+  Napi::Array result = Napi::Array::New(env, found.size());
+  for (size_t i = 0; i < found.size(); i++) result.Set(i, memoryjs::toSymbol(env, found[i]));
+  return result;
 }
 
-Napi::Object Init(Napi::Env env, Napi::Object exports) {
+Napi::Value readMemory(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("readMemory");
+  return readMemoryImpl(args, args.Length() == 4 ? memoryjs::CALLBACK : memoryjs::SYNC);
+}
+
+Napi::Value readMemoryAsync(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("readMemoryAsync");
+  return readMemoryImpl(args, memoryjs::PROMISE);
+}
+
+static Napi::Value readMemoryBatchImpl(const Napi::CallbackInfo& args, memoryjs::Mode mode) {
+  Napi::Env env = args.Env();
+  bool hasTail = mode != memoryjs::SYNC;
+
+  if (args.Length() < 2 + (size_t)hasTail || args.Length() > 3 + (size_t)hasTail) {
+    memoryjs::throwError(env, "requires 2 or 3 arguments, or 4 arguments if a callback is being used");
+    return env.Null();
+  }
+
+  if (!args[0].IsNumber() || (!args[1].IsArray() && !args[1].IsTypedArray())) {
+    memoryjs::throwError(env, "first argument must be a number, second argument must be an array or a Float64Array");
+    return env.Null();
+  }
+
+  HANDLE handle = memoryjs::getHandle(args[0]);
+
+  // Either an array of { address, type } objects, or a Float64Array of addresses followed by one type for all of
+  // them or an array with a type per address
+  bool packed = args[1].IsTypedArray();
+  auto addresses = std::make_shared<std::vector<DWORD64>>();
+  auto types = std::make_shared<std::vector<datatype::Type>>();
+
+  if (packed) {
+    if (args[1].As<Napi::TypedArray>().TypedArrayType() != napi_float64_array ||
+        args.Length() < 3 + (size_t)hasTail) {
+      memoryjs::throwError(env, "a Float64Array of addresses must be followed by a data type");
+      return env.Null();
+    }
+
+    Napi::Float64Array input = args[1].As<Napi::Float64Array>();
+    addresses->resize(input.ElementLength());
+    for (size_t i = 0; i < addresses->size(); i++) (*addresses)[i] = (DWORD64)input[i];
+
+    datatype::Type type;
+    if (args[2].IsString()) {
+      if (!datatype::parse(args[2].As<Napi::String>().Utf8Value(), &type) || !datatype::isNumber(type)) {
+        memoryjs::throwError(env, "unexpected data type");
+        return env.Null();
+      }
+
+      types->assign(addresses->size(), type);
+    } else if (args[2].IsArray() && args[2].As<Napi::Array>().Length() == addresses->size()) {
+      Napi::Array names = args[2].As<Napi::Array>();
+
+      for (uint32_t i = 0; i < names.Length(); i++) {
+        Napi::Value name = names[i];
+        if (!name.IsString() || !datatype::parse(name.As<Napi::String>().Utf8Value(), &type) ||
+            !datatype::isNumber(type)) {
+          memoryjs::throwError(env, "unexpected data type");
+          return env.Null();
+        }
+
+        types->push_back(type);
+      }
+    } else {
+      memoryjs::throwError(env, "third argument must be a string or an array with a data type per address");
+      return env.Null();
+    }
+  } else {
+    Napi::Array requests = args[1].As<Napi::Array>();
+
+    for (uint32_t i = 0; i < requests.Length(); i++) {
+      Napi::Value value = requests[i];
+      if (!value.IsObject()) {
+        memoryjs::throwError(env, "every request must be an object of the form { address, type }");
+        return env.Null();
+      }
+
+      Napi::Object request = value.As<Napi::Object>();
+      datatype::Type type;
+
+      Napi::Value name = request.Get("type");
+
+      if (!name.IsString() || !datatype::parse(name.As<Napi::String>().Utf8Value(), &type)) {
+        memoryjs::throwError(env, "unexpected data type");
+        return env.Null();
+      }
+
+      if (!request.Get("address").IsNumber()) {
+        memoryjs::throwError(env, "every request must be an object of the form { address, type }");
+        return env.Null();
+      }
+
+      addresses->push_back(request.Get("address").As<Napi::Number>().Int64Value());
+      types->push_back(type);
+    }
+  }
+
+  // Every value gets its own slot in one buffer, so a single allocation serves the whole batch
+  auto offsets = std::make_shared<std::vector<size_t>>(types->size());
+  size_t total = 0;
+  for (size_t i = 0; i < types->size(); i++) {
+    (*offsets)[i] = total;
+    total += datatype::size((*types)[i]);
+  }
+
+  auto data = std::make_shared<std::vector<unsigned char>>(total);
+  auto ok = std::make_shared<std::vector<char>>(types->size(), 0);
+
+  auto execute = [=](char**, const std::atomic<bool>&) {
+    std::vector<batch::Read> reads(types->size());
+    for (size_t i = 0; i < types->size(); i++) {
+      reads[i] = {(*addresses)[i], datatype::size((*types)[i]), data->data() + (*offsets)[i], false};
+    }
+
+    batch::read(handle, reads);
+    for (size_t i = 0; i < reads.size(); i++) (*ok)[i] = reads[i].ok;
+  };
+
+  // Values that could not be read are NaN in a Float64Array and null in an array
+  auto complete = [=](Napi::Env env) -> Napi::Value {
+    if (packed) {
+      Napi::Float64Array values = Napi::Float64Array::New(env, types->size());
+      for (size_t i = 0; i < types->size(); i++) {
+        values[i] = (*ok)[i] ? datatype::toNumber((*types)[i], data->data() + (*offsets)[i]) : NAN;
+      }
+      return values;
+    }
+
+    Napi::Array values = Napi::Array::New(env, types->size());
+    for (uint32_t i = 0; i < types->size(); i++) {
+      values[i] = (*ok)[i] ? memoryjs::toValue(env, (*types)[i], data->data() + (*offsets)[i]) : env.Null();
+    }
+    return values;
+  };
+
+  return memoryjs::run(args, mode, execute, complete);
+}
+
+Napi::Value readMemoryBatch(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("readMemoryBatch");
+  return readMemoryBatchImpl(args, memoryjs::callbackMode(args));
+}
+
+Napi::Value readMemoryBatchAsync(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("readMemoryBatchAsync");
+  return readMemoryBatchImpl(args, memoryjs::PROMISE);
+}
+
+Napi::Value defineStruct(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("defineStruct");
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 1 && args.Length() != 2) {
+    memoryjs::throwError(env, "requires 1 or 2 arguments");
+    return env.Null();
+  }
+
+  if (!args[0].IsArray() || (args.Length() == 2 && !args[1].IsObject())) {
+    memoryjs::throwError(env, "first argument must be an array, second argument must be an object");
+    return env.Null();
+  }
+
+  layout::Layout compiled;
+  compiled.size = 0;
+
+  // Options: { size }, defaults to the end of the last field
+  if (args.Length() == 2 && args[1].As<Napi::Object>().Has("size") &&
+      !memoryjs::getSize(args[1].As<Napi::Object>().Get("size"), layout::maxSize, &compiled.size)) {
+    memoryjs::throwError(env, "size must be a non-negative integer no larger than the largest struct");
+    return env.Null();
+  }
+
+  char* errorMessage = "";
+  if (!memoryjs::getLayout(args[0].As<Napi::Array>(), &compiled, &errorMessage)) {
+    memoryjs::throwError(env, errorMessage);
+    return env.Null();
+  }
+
+  // Like compiled patterns, the layout is opaque to JS and freed once it is garbage collected
+  return opaque::wrap<layout::Layout>(env, std::move(compiled));
+}
+
+// readStruct and readStructArray differ only in the number of structs they decode
+static Napi::Value readStructsImpl(const Napi::CallbackInfo& args, bool array, memoryjs::Mode mode) {
+  Napi::Env env = args.Env();
+  size_t required = array ? 4 : 3;
+  bool hasTail = mode != memoryjs::SYNC;
+
+  if (args.Length() < required + hasTail || args.Length() > required + 1 + hasTail) {
+    memoryjs::throwError(env, "requires the handle, address, layout (and count for arrays), then optionally a target "
+                              "and a callback");
+    return env.Null();
+  }
+
+  if (!args[0].IsNumber() || !args[1].IsNumber() || !opaque::get<layout::Layout>(args[2]) ||
+      (array && !args[3].IsNumber())) {
+    memoryjs::throwError(env, "handle, address and count must be numbers and the layout must come from defineStruct");
+    return env.Null();
+  }
+
+  bool hasTarget = args.Length() > required + hasTail;
+
+  if (hasTarget && !args[required].IsObject()) {
+    memoryjs::throwError(env, "the target must be an object or a Float64Array");
+    return env.Null();
+  }
+
+  HANDLE handle = memoryjs::getHandle(args[0]);
+  DWORD64 address = args[1].As<Napi::Number>().Int64Value();
+  const layout::Layout* layout = opaque::get<layout::Layout>(args[2]);
+  size_t count = 1;
+
+  // Every struct is read at once, so the structs together are bounded like a single one
+  if (array && (!memoryjs::getSize(args[3], UINT32_MAX, &count) ||
+                (layout->size && count > layout::maxSize / layout->size))) {
+    memoryjs::throwError(env, "count must be a non-negative integer, and the structs no larger than the largest one");
+    return env.Null();
+  }
+
+  // The layout and the target are kept until the structs are decoded into it
+  memoryjs::Hold layoutHold = memoryjs::hold(args[2]);
+  memoryjs::Hold targetHold = hasTarget ? memoryjs::hold(args[required]) : nullptr;
+
+  // Typed array targets receive every struct flattened into numbers
+  bool flat = hasTarget && args[required].IsTypedArray();
+
+  if (flat) {
+    Napi::TypedArray target = args[required].As<Napi::TypedArray>();
+    if (target.TypedArrayType() != napi_float64_array || target.ElementLength() < layout->numbers * count) {
+      memoryjs::throwError(env, "the target must be a Float64Array large enough to hold every value");
+      return env.Null();
+    }
+  }
+
+  // Every struct is decoded from a single read
+  auto data = std::make_shared<std::vector<unsigned char>>(layout->size * count);
+  auto ok = std::make_shared<bool>(false);
+
+  auto execute = [=](char** errorMessage, const std::atomic<bool>&) {
+    if (memory::read(handle, address, data->data(), data->size()) != data->size()) {
+      *errorMessage = "unable to read memory";
+    } else {
+      *ok = true;
+    }
+  };
+
+  auto complete = [=](Napi::Env env) -> Napi::Value {
+    (void)layoutHold;
+    if (!*ok) return env.Null();
+
+    Napi::Value target = targetHold ? targetHold->Value() : env.Null();
+
+    if (flat) {
+      // A target whose buffer was detached while the read ran is left alone
+      Napi::Float64Array values = target.As<Napi::Float64Array>();
+      if (values.ElementLength() < layout->numbers * count) return env.Null();
+
+      for (size_t i = 0; i < count; i++) {
+        layout::flatten(*layout, &(*data)[i * layout->size], values.Data() + i * layout->numbers);
+      }
+      return values;
+    }
+
+    if (array) {
+      Napi::Array structs = target.IsArray() ? target.As<Napi::Array>() : Napi::Array::New(env, count);
+
+      for (uint32_t i = 0; i < count; i++) {
+        // Fill the objects already in a target array rather than replacing them
+        Napi::Value existing = structs.Get(i);
+        Napi::Object element = existing.IsObject() ? existing.As<Napi::Object>() : Napi::Object::New(env);
+
+        memoryjs::decodeStruct(env, *layout, &(*data)[i * layout->size], element);
+        structs[i] = element;
+      }
+
+      return structs;
+    }
+
+    Napi::Object object = hasTarget ? target.As<Napi::Object>() : Napi::Object::New(env);
+    memoryjs::decodeStruct(env, *layout, data->data(), object);
+    return object;
+  };
+
+  return memoryjs::run(args, mode, execute, complete);
+}
+
+Napi::Value readStruct(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("readStruct");
+  return readStructsImpl(args, false, memoryjs::callbackMode(args));
+}
+
+Napi::Value readStructAsync(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("readStructAsync");
+  return readStructsImpl(args, false, memoryjs::PROMISE);
+}
+
+Napi::Value readStructArray(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("readStructArray");
+  return readStructsImpl(args, true, memoryjs::callbackMode(args));
+}
+
+Napi::Value readStructArrayAsync(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("readStructArrayAsync");
+  return readStructsImpl(args, true, memoryjs::PROMISE);
+}
+
+Napi::Value createPointerCache(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("createPointerCache");
+  return opaque::wrap<pointer::Cache>(args.Env());
+}
+
+void clearPointerCache(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("clearPointerCache");
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 1 || !opaque::get<pointer::Cache>(args[0])) {
+    memoryjs::throwError(env, "requires 1 argument, a pointer cache");
+    return;
+  }
+
+  opaque::get<pointer::Cache>(args[0])->clear();
+}
+
+// resolvePointerChain and resolvePointerChains read their chains differently, then share the rest
+static Napi::Value resolvePointersImpl(const Napi::CallbackInfo& args, bool many, memoryjs::Mode mode) {
+  Napi::Env env = args.Env();
+  size_t required = many ? 2 : 3;
+  bool hasTail = mode != memoryjs::SYNC;
+
+  if (args.Length() < required + hasTail || args.Length() > required + 1 + hasTail) {
+    memoryjs::throwError(env, "requires the handle and the chain(s), then optionally options and a callback");
+    return env.Null();
+  }
+
+  if (!args[0].IsNumber() || (many ? !args[1].IsArray() : !args[1].IsNumber() || !args[2].IsArray())) {
+    memoryjs::throwError(env, "the handle and base must be numbers and offsets and chains must be arrays");
+    return env.Null();
+  }
+
+  bool hasOptions = args.Length() > required + hasTail;
+
+  if (hasOptions && !args[required].IsObject()) {
+    memoryjs::throwError(env, "options must be an object");
+    return env.Null();
+  }
+
+  HANDLE handle = memoryjs::getHandle(args[0]);
+  auto chains = std::make_shared<std::vector<pointer::Chain>>();
+
+  if (many) {
+    Napi::Array array = args[1].As<Napi::Array>();
+
+    for (uint32_t i = 0; i < array.Length(); i++) {
+      Napi::Value value = array[i];
+      pointer::Chain chain;
+
+      if (!value.IsObject() || !value.As<Napi::Object>().Get("base").IsNumber() ||
+          !memoryjs::getOffsets(value.As<Napi::Object>().Get("offsets"), &chain.offsets)) {
+        memoryjs::throwError(env, "every chain must be an object of the form { base, offsets }");
+        return env.Null();
+      }
+
+      chain.base = value.As<Napi::Object>().Get("base").As<Napi::Number>().Int64Value();
+      chains->push_back(chain);
+    }
+  } else {
+    pointer::Chain chain;
+    chain.base = args[1].As<Napi::Number>().Int64Value();
+
+    if (!memoryjs::getOffsets(args[2], &chain.offsets)) {
+      memoryjs::throwError(env, "offsets must be numbers");
+      return env.Null();
+    }
+
+    chains->push_back(chain);
+  }
+
+  // Options: { type, cache }, the value at every final address is read as well when a type is given
+  pointer::Cache* cache = nullptr;
+  memoryjs::Hold cacheHold;
+  bool hasType = false;
+  datatype::Type type;
+
+  if (hasOptions) {
+    Napi::Object options = args[required].As<Napi::Object>();
+
+    if (options.Has("cache")) {
+      cache = opaque::get<pointer::Cache>(options.Get("cache"));
+
+      if (!cache) {
+        memoryjs::throwError(env, "cache must come from createPointerCache");
+        return env.Null();
+      }
+
+      cacheHold = memoryjs::hold(options.Get("cache"));
+    }
+
+    if (options.Has("type")) {
+      hasType = true;
+
+      if (!options.Get("type").IsString() ||
+          !datatype::parse(options.Get("type").As<Napi::String>().Utf8Value(), &type) ||
+          (many && !datatype::isNumber(type))) {
+        memoryjs::throwError(env, "unexpected data type");
+        return env.Null();
+      }
+    }
+  }
+
+  auto addresses = std::make_shared<std::vector<DWORD64>>();
+  auto resolved = std::make_shared<std::vector<bool>>();
+  size_t size = hasType ? datatype::size(type) : 0;
+  auto data = std::make_shared<std::vector<unsigned char>>(size * chains->size());
+  auto ok = std::make_shared<std::vector<char>>(chains->size(), 0);
+
+  auto execute = [=](char**, const std::atomic<bool>&) {
+    pointer::resolve(handle, *chains, cache, *addresses, *resolved);
+    if (!hasType) return;
+
+    // The values at the final addresses are fetched with one more batched read
+    std::vector<batch::Read> reads;
+    for (size_t i = 0; i < chains->size(); i++) {
+      reads.push_back({(*addresses)[i], (*resolved)[i] ? size : 0, data->data() + i * size, false});
+    }
+
+    batch::read(handle, reads);
+    for (size_t i = 0; i < reads.size(); i++) (*ok)[i] = (*resolved)[i] && reads[i].ok;
+  };
+
+  // A chain that could not be followed to the end resolves to null (NaN in the batched form), as does a value that
+  // could not be read
+  auto complete = [=](Napi::Env env) -> Napi::Value {
+    (void)cacheHold;
+
+    if (many) {
+      Napi::Float64Array resultAddresses = Napi::Float64Array::New(env, chains->size());
+      Napi::Float64Array values = Napi::Float64Array::New(env, hasType ? chains->size() : 0);
+
+      for (size_t i = 0; i < chains->size(); i++) {
+        resultAddresses[i] = (*resolved)[i] ? (double)(*addresses)[i] : NAN;
+        if (hasType) values[i] = (*ok)[i] ? datatype::toNumber(type, &(*data)[i * size]) : NAN;
+      }
+
+      if (!hasType) return resultAddresses;
+
+      Napi::Object object = Napi::Object::New(env);
+      object.Set(Napi::String::New(env, "addresses"), resultAddresses);
+      object.Set(Napi::String::New(env, "values"), values);
+      return object;
+    }
+
+    Napi::Value address = (*resolved)[0] ? Napi::Number::New(env, (double)(*addresses)[0]) : env.Null();
+    if (!hasType) return address;
+
+    Napi::Object object = Napi::Object::New(env);
+    object.Set(Napi::String::New(env, "address"), address);
+    object.Set(Napi::String::New(env, "value"), (*ok)[0] ? memoryjs::toValue(env, type, data->data()) : env.Null());
+    return object;
+  };
+
+  return memoryjs::run(args, mode, execute, complete);
+}
+
+Napi::Value resolvePointerChain(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("resolvePointerChain");
+  return resolvePointersImpl(args, false, memoryjs::callbackMode(args));
+}
+
+Napi::Value resolvePointerChainAsync(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("resolvePointerChainAsync");
+  return resolvePointersImpl(args, false, memoryjs::PROMISE);
+}
+
+Napi::Value resolvePointerChains(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("resolvePointerChains");
+  return resolvePointersImpl(args, true, memoryjs::callbackMode(args));
+}
+
+Napi::Value resolvePointerChainsAsync(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("resolvePointerChainsAsync");
+  return resolvePointersImpl(args, true, memoryjs::PROMISE);
+}
+
+typedef std::shared_ptr<const pointerscan::Map> PointerMap;
+
+static Napi::Value toPointerMap(Napi::Env env, PointerMap map) {
+  return opaque::wrap<PointerMap>(env, map);
+}
+
+// Reads a path of the form { module, offsets }, returns false if it is malformed
+static bool getPointerPath(Napi::Value value, pointerscan::Path* path) {
+  if (!value.IsObject()) return false;
+
+  Napi::Object object = value.As<Napi::Object>();
+  if (!object.Get("module").IsString()) return false;
+
+  path->module = object.Get("module").As<Napi::String>().Utf8Value();
+  return memoryjs::getOffsets(object.Get("offsets"), &path->offsets);
+}
+
+static Napi::Value createPointerMapImpl(const Napi::CallbackInfo& args, memoryjs::Mode mode) {
+  Napi::Env env = args.Env();
+
+  size_t optionsIndex = 1;
+  bool hasTail = mode != memoryjs::SYNC;
+
+  if (args.Length() < optionsIndex + hasTail || args.Length() > optionsIndex + 1 + hasTail || !args[0].IsNumber()) {
+    memoryjs::throwError(env, "first argument must be a number");
+    return env.Null();
+  }
+
+  if (args.Length() > optionsIndex + hasTail && !args[optionsIndex].IsObject()) {
+    memoryjs::throwError(env, "second argument must be an object");
+    return env.Null();
+  }
+
+  HANDLE handle = memoryjs::getHandle(args[0]);
+
+  // Options: { protection, type, start, end } of the memory pointers are looked for in
+  region::Filter filter = region::all();
+  if (args.Length() > optionsIndex + hasTail && !memoryjs::getFilter(args[optionsIndex].As<Napi::Object>(), &filter)) {
+    memoryjs::throwError(env, "protection, type, start and end must be numbers");
+    return env.Null();
+  }
+
+  auto map = std::make_shared<pointerscan::Map>();
+
+  auto execute = [=](char** errorMessage, const std::atomic<bool>& cancelled) {
+    pointerscan::build(handle, filter, map.get(), errorMessage, &cancelled);
+    async::failIfCancelled(errorMessage, cancelled);
+  };
+
+  auto complete = [=](Napi::Env env) -> Napi::Value { return toPointerMap(env, map); };
+
+  return memoryjs::run(args, mode, execute, complete);
+}
+
+Napi::Value createPointerMap(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("createPointerMap");
+  return createPointerMapImpl(args, args[args.Length() - 1].IsFunction() ? memoryjs::CALLBACK : memoryjs::SYNC);
+}
+
+Napi::Value createPointerMapAsync(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("createPointerMapAsync");
+  return createPointerMapImpl(args, memoryjs::PROMISE);
+}
+
+void savePointerMap(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("savePointerMap");
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 2 || !opaque::get<PointerMap>(args[0]) || !args[1].IsString()) {
+    memoryjs::throwError(env, "requires a pointer map and a path");
+    return;
+  }
+
+  char* errorMessage = "";
+  PointerMap map = *opaque::get<PointerMap>(args[0]);
+
+  if (!pointerscan::save(*map, args[1].As<Napi::String>().Utf8Value(), &errorMessage)) {
+    memoryjs::throwError(env, errorMessage);
+  }
+}
+
+Napi::Value loadPointerMap(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("loadPointerMap");
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 1 || !args[0].IsString()) {
+    memoryjs::throwError(env, "first argument must be a string");
+    return env.Null();
+  }
+
+  char* errorMessage = "";
+  auto map = std::make_shared<pointerscan::Map>();
+
+  if (!pointerscan::load(args[0].As<Napi::String>().Utf8Value(), map.get(), &errorMessage)) {
+    memoryjs::throwError(env, errorMessage);
+    return env.Null();
+  }
+
+  return toPointerMap(env, map);
+}
+
+static Napi::Value findPointerPathsImpl(const Napi::CallbackInfo& args, memoryjs::Mode mode) {
+  Napi::Env env = args.Env();
+
+  size_t optionsIndex = 2;
+  bool hasTail = mode != memoryjs::SYNC;
+
+  if (args.Length() < optionsIndex + hasTail || args.Length() > optionsIndex + 1 + hasTail ||
+      !opaque::get<PointerMap>(args[0]) || !args[1].IsNumber()) {
+    memoryjs::throwError(env, "first argument must be a pointer map, second argument must be a number");
+    return env.Null();
+  }
+
+  if (args.Length() > optionsIndex + hasTail && !args[optionsIndex].IsObject()) {
+    memoryjs::throwError(env, "third argument must be an object");
+    return env.Null();
+  }
+
+  PointerMap map = *opaque::get<PointerMap>(args[0]);
+  DWORD64 address = args[1].As<Napi::Number>().Int64Value();
+
+  // Options: { depth, maxOffset, limit, maxNodes }
+  pointerscan::Options options = pointerscan::defaults();
+
+  if (args.Length() > optionsIndex + hasTail) {
+    Napi::Object given = args[optionsIndex].As<Napi::Object>();
+
+    size_t maxOffset = options.maxOffset;
+
+    if ((given.Has("depth") && !memoryjs::getSize(given.Get("depth"), UINT32_MAX, &options.depth)) ||
+        (given.Has("maxOffset") && !memoryjs::getSize(given.Get("maxOffset"), SIZE_MAX, &maxOffset)) ||
+        (given.Has("limit") && !memoryjs::getSize(given.Get("limit"), SIZE_MAX, &options.limit)) ||
+        (given.Has("maxNodes") && !memoryjs::getSize(given.Get("maxNodes"), SIZE_MAX, &options.maxNodes))) {
+      memoryjs::throwError(env, "depth, maxOffset, limit and maxNodes must be non-negative integers");
+      return env.Null();
+    }
+
+    options.maxOffset = maxOffset;
+  }
+
+  auto paths = std::make_shared<std::vector<pointerscan::Path>>();
+
+  auto execute = [=](char** errorMessage, const std::atomic<bool>& cancelled) {
+    *paths = pointerscan::find(*map, address, options, &cancelled);
+    async::failIfCancelled(errorMessage, cancelled);
+  };
+
+  auto complete = [=](Napi::Env env) -> Napi::Value {
+    Napi::Array results = Napi::Array::New(env, paths->size());
+
+    for (uint32_t i = 0; i < paths->size(); i++) {
+      const pointerscan::Path& path = (*paths)[i];
+      Napi::Array offsets = Napi::Array::New(env, path.offsets.size());
+      for (uint32_t j = 0; j < path.offsets.size(); j++) offsets[j] = Napi::Number::New(env, (double)path.offsets[j]);
+
+      Napi::Object result = Napi::Object::New(env);
+      result.Set("module", Napi::String::New(env, path.module));
+      result.Set("offsets", offsets);
+      results[i] = result;
+    }
+
+    return results;
+  };
+
+  return memoryjs::run(args, mode, execute, complete);
+}
+
+Napi::Value findPointerPaths(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("findPointerPaths");
+  return findPointerPathsImpl(args, args[args.Length() - 1].IsFunction() ? memoryjs::CALLBACK : memoryjs::SYNC);
+}
+
+Napi::Value findPointerPathsAsync(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("findPointerPathsAsync");
+  return findPointerPathsImpl(args, memoryjs::PROMISE);
+}
+
+// Returns the paths, the same objects, that still lead to the address in the given process
+static Napi::Value rescanPointerPathsImpl(const Napi::CallbackInfo& args, memoryjs::Mode mode) {
+  Napi::Env env = args.Env();
+  bool hasTail = mode != memoryjs::SYNC;
+
+  if (args.Length() != 3 + (size_t)hasTail || !args[0].IsNumber() || !args[1].IsArray() || !args[2].IsNumber()) {
+    memoryjs::throwError(env, "requires a handle, an array of paths and an address");
+    return env.Null();
+  }
+
+  HANDLE handle = memoryjs::getHandle(args[0]);
+  DWORD64 address = args[2].As<Napi::Number>().Int64Value();
+  Napi::Array input = args[1].As<Napi::Array>();
+  auto paths = std::make_shared<std::vector<pointerscan::Path>>(input.Length());
+
+  for (uint32_t i = 0; i < input.Length(); i++) {
+    if (!getPointerPath(input[i], &(*paths)[i])) {
+      memoryjs::throwError(env, "every path must be an object of the form { module, offsets }");
+      return env.Null();
+    }
+  }
+
+  memoryjs::Hold pathsHold = memoryjs::hold(args[1]);
+  auto matches = std::make_shared<std::vector<size_t>>();
+
+  auto execute = [=](char**, const std::atomic<bool>&) { *matches = pointerscan::rescan(handle, *paths, address); };
+
+  auto complete = [=](Napi::Env env) -> Napi::Value {
+    Napi::Array given = pathsHold->Value().As<Napi::Array>();
+    Napi::Array results = Napi::Array::New(env, matches->size());
+    for (uint32_t i = 0; i < matches->size(); i++) results[i] = given.Get((uint32_t)(*matches)[i]);
+    return results;
+  };
+
+  return memoryjs::run(args, mode, execute, complete);
+}
+
+Napi::Value rescanPointerPaths(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("rescanPointerPaths");
+  return rescanPointerPathsImpl(args, args[args.Length() - 1].IsFunction() ? memoryjs::CALLBACK : memoryjs::SYNC);
+}
+
+Napi::Value rescanPointerPathsAsync(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("rescanPointerPathsAsync");
+  return rescanPointerPathsImpl(args, memoryjs::PROMISE);
+}
+
+static Napi::Value readStringImpl(const Napi::CallbackInfo& args, memoryjs::Mode mode) {
+  Napi::Env env = args.Env();
+  bool hasTail = mode != memoryjs::SYNC;
+
+  if (args.Length() < 2 + (size_t)hasTail || args.Length() > 3 + (size_t)hasTail) {
+    memoryjs::throwError(env, "requires 2 or 3 arguments, or 4 arguments if a callback is being used");
+    return env.Null();
+  }
+
+  if (!args[0].IsNumber() || !args[1].IsNumber()) {
+    memoryjs::throwError(env, "first and second argument must be a number");
+    return env.Null();
+  }
+
+  bool hasOptions = args.Length() > 2 + (size_t)hasTail;
+
+  if (hasOptions && !args[2].IsObject()) {
+    memoryjs::throwError(env, "third argument must be an object");
+    return env.Null();
+  }
+
+  HANDLE handle = memoryjs::getHandle(args[0]);
+  DWORD64 address = args[1].As<Napi::Number>().Int64Value();
+
+  // Options: { encoding, maxLength, length }, `length` reads a fixed number of characters
+  text::Encoding encoding = text::UTF8;
+  size_t maxLength = text::defaultMaxLength;
+  size_t length = 0;
+
+  if (hasOptions) {
+    Napi::Object options = args[2].As<Napi::Object>();
+
+    if ((options.Has("encoding") && !options.Get("encoding").IsString()) ||
+        (options.Has("maxLength") && !memoryjs::getSize(options.Get("maxLength"), text::longest, &maxLength)) ||
+        (options.Has("length") && !memoryjs::getSize(options.Get("length"), text::longest, &length))) {
+      memoryjs::throwError(env, "encoding must be a string, maxLength and length integers within the longest string");
+      return env.Null();
+    }
+
+    if (options.Has("encoding")) {
+      std::string name = options.Get("encoding").As<Napi::String>().Utf8Value();
+
+      if (name == "utf16" || name == "utf16le" || name == "ucs2") {
+        encoding = text::UTF16;
+      } else if (name != "utf8" && name != "ascii") {
+        memoryjs::throwError(env, "unexpected encoding");
+        return env.Null();
+      }
+    }
+  }
+
+  auto units = std::make_shared<std::string>();
+  auto ok = std::make_shared<bool>(false);
+
+  auto execute = [=](char** errorMessage, const std::atomic<bool>&) {
+    text::Status status = length ? text::readFixed(handle, address, encoding, length, *units)
+                                 : text::read(handle, address, encoding, maxLength, *units);
+
+    if (status == text::UNREADABLE) *errorMessage = "unable to read string";
+    if (status == text::NO_TERMINATOR) *errorMessage = "unable to read string (no null-terminator found)";
+    *ok = status == text::OK;
+  };
+
+  auto complete = [=](Napi::Env env) -> Napi::Value {
+    return *ok ? (Napi::Value)memoryjs::toString(env, encoding, *units) : env.Null();
+  };
+
+  return memoryjs::run(args, mode, execute, complete);
+}
+
+Napi::Value readString(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("readString");
+  return readStringImpl(args, memoryjs::callbackMode(args));
+}
+
+Napi::Value readStringAsync(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("readStringAsync");
+  return readStringImpl(args, memoryjs::PROMISE);
+}
+
+static Napi::Value readBufferImpl(const Napi::CallbackInfo& args, memoryjs::Mode mode) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 3 && args.Length() != 4) {
+    memoryjs::throwError(env, "requires 3 arguments, or 4 arguments if a callback is being used");
+    return env.Null();
+  }
+
+  if (!args[0].IsNumber() && !args[1].IsNumber() && !args[2].IsNumber()) {
+    memoryjs::throwError(env, "first, second and third arguments must be a number");
+    return env.Null();
+  }
+
+  if (mode == memoryjs::CALLBACK && !args[3].IsFunction()) {
+    memoryjs::throwError(env, "fourth argument must be a function");
+    return env.Null();
+  }
+
+  HANDLE handle = memoryjs::getHandle(args[0]);
+  DWORD64 address = args[1].As<Napi::Number>().Int64Value();
+  SIZE_T size = args[2].As<Napi::Number>().Uint32Value();
+
+  auto data = std::make_shared<std::shared_ptr<char>>();
+
+  auto execute = [=](char**, const std::atomic<bool>&) {
+    // Memory is read straight into a pooled buffer that JS takes over, and that goes back to the pool once collected
+    data->reset(bufferpool::acquire(size), bufferpool::release);
+    SIZE_T bytesRead = memory::read(handle, address, data->get(), size);
+    memset(data->get() + bytesRead, 0, size - bytesRead);
+  };
+
+  auto complete = [=](Napi::Env env) -> Napi::Value {
+    // The Buffer shares the pooled buffer with the operation, which releases it if the Buffer is never made
+    auto owner = new std::shared_ptr<char>(*data);
+    Napi::Buffer<char> buffer = Napi::Buffer<char>::New(
+        env, owner->get(), size, [](Napi::Env, char*, std::shared_ptr<char>* owner) { delete owner; }, owner);
+
+    if (buffer.IsEmpty()) delete owner;
+    return buffer;
+  };
+
+  return memoryjs::run(args, mode, execute, complete, true);
+}
+
+Napi::Value readBuffer(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("readBuffer");
+  return readBufferImpl(args, args.Length() == 4 ? memoryjs::CALLBACK : memoryjs::SYNC);
+}
+
+Napi::Value readBufferAsync(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("readBufferAsync");
+  return readBufferImpl(args, memoryjs::PROMISE);
+}
+
+static Napi::Value readBufferIntoImpl(const Napi::CallbackInfo& args, memoryjs::Mode mode) {
+  Napi::Env env = args.Env();
+  bool hasTail = mode != memoryjs::SYNC;
+
+  if (args.Length() < 3 + (size_t)hasTail || args.Length() > 5 + (size_t)hasTail) {
+    memoryjs::throwError(env, "requires 3 to 5 arguments, or 6 arguments if a callback is being used");
+    return env.Null();
+  }
+
+  if (!args[0].IsNumber() || !args[1].IsNumber() || (!args[2].IsTypedArray() && !args[2].IsArrayBuffer())) {
+    memoryjs::throwError(env, "first and second argument must be a number, third argument must be a Buffer, "
+                              "TypedArray or ArrayBuffer");
+    return env.Null();
+  }
+
+  size_t given = args.Length() - hasTail;
+
+  if ((given > 3 && !args[3].IsNumber()) || (given > 4 && !args[4].IsNumber())) {
+    memoryjs::throwError(env, "offset and length must be numbers");
+    return env.Null();
+  }
+
+  HANDLE handle = memoryjs::getHandle(args[0]);
+  DWORD64 address = args[1].As<Napi::Number>().Int64Value();
+
+  // The bytes the target views, whatever its type
+  auto view = [](Napi::Value value, size_t* capacity) -> char* {
+    if (value.IsArrayBuffer()) {
+      Napi::ArrayBuffer arrayBuffer = value.As<Napi::ArrayBuffer>();
+      *capacity = arrayBuffer.ByteLength();
+      return (char*)arrayBuffer.Data();
+    }
+
+    Napi::TypedArray typedArray = value.As<Napi::TypedArray>();
+    *capacity = typedArray.ByteLength();
+    return (char*)typedArray.ArrayBuffer().Data() + typedArray.ByteOffset();
+  };
+
+  size_t capacity;
+  char* target = view(args[2], &capacity);
+
+  size_t offset = given > 3 ? args[3].As<Napi::Number>().Int64Value() : 0;
+  size_t length = given > 4 ? args[4].As<Napi::Number>().Int64Value() : capacity - std::min(offset, capacity);
+
+  if (offset > capacity || length > capacity - offset) {
+    memoryjs::throwError(env, "offset and length must be within the target");
+    return env.Null();
+  }
+
+  auto bytesRead = std::make_shared<size_t>(0);
+
+  // Synchronous calls read straight into the target. The others read into a pooled buffer that is copied into the
+  // target back on the main thread, so that the target is never written to while JS can use it.
+  if (mode == memoryjs::SYNC) {
+    auto execute = [=](char**, const std::atomic<bool>&) {
+      *bytesRead = memory::read(handle, address, target + offset, length);
+    };
+
+    auto complete = [=](Napi::Env env) -> Napi::Value { return Napi::Number::New(env, (double)*bytesRead); };
+    return memoryjs::run(args, mode, execute, complete);
+  }
+
+  memoryjs::Hold targetHold = memoryjs::hold(args[2]);
+  auto staging = std::make_shared<std::shared_ptr<char>>();
+
+  auto execute = [=](char**, const std::atomic<bool>&) {
+    staging->reset(bufferpool::acquire(length), bufferpool::release);
+    *bytesRead = memory::read(handle, address, staging->get(), length);
+  };
+
+  auto complete = [=](Napi::Env env) -> Napi::Value {
+    // A target whose buffer was detached while the read ran is left alone
+    size_t capacity;
+    char* target = view(targetHold->Value(), &capacity);
+    if (!*staging || offset + length > capacity) return Napi::Number::New(env, 0);
+
+    memcpy(target + offset, staging->get(), *bytesRead);
+    staging->reset();
+    return Napi::Number::New(env, (double)*bytesRead);
+  };
+
+  return memoryjs::run(args, mode, execute, complete);
+}
+
+Napi::Value readBufferInto(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("readBufferInto");
+  return readBufferIntoImpl(args, memoryjs::callbackMode(args));
+}
+
+Napi::Value readBufferIntoAsync(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("readBufferIntoAsync");
+  return readBufferIntoImpl(args, memoryjs::PROMISE);
+}
+
+static Napi::Value findPatternImpl(const Napi::CallbackInfo& args, memoryjs::Mode mode) {
+  // if (args.Length() != 5 && args.Length() != 6) {
+  //   memoryjs::throwError("requires 5 arguments, or 6 arguments if a callback is being used", isolate);
+  //   return;
+  // }
+
+  // if (!args[0]->IsNumber() && !args[1]->IsString() && !args[2]->IsNumber() && !args[3]->IsNumber() &&
+  // !args[4]->IsNumber()) {
+  //   memoryjs::throwError("first argument must be a number, the remaining arguments must be numbers apart from the
+  //   callback", isolate); return;
+  // }
+
+  // if (args.Length() == 6 && !args[5]->IsFunction()) {
+  //   memoryjs::throwError("sixth argument must be a function", isolate);
+  //   return;
+  // }
+
+  HANDLE handle = memoryjs::getHandle(args[0]);
+  std::string moduleName(args[1].As<Napi::String>().Utf8Value());
+  short sigType = args[3].As<Napi::Number>().Uint32Value();
+  uint32_t patternOffset = args[4].As<Napi::Number>().Uint32Value();
+  uint32_t addressOffset = args[5].As<Napi::Number>().Uint32Value();
+
+  // The signature is either a string or a pattern compiled ahead of time with compilePattern, which is kept alive
+  // until the scan is done
+  auto compiled = std::make_shared<pattern::Signature>();
+  const pattern::Signature* signature = compiled.get();
+  memoryjs::Hold signatureHold;
+
+  if (args[2].IsExternal()) {
+    signature = opaque::get<pattern::Signature>(args[2]);
+    signatureHold = memoryjs::hold(args[2]);
+
+    if (!signature) {
+      memoryjs::throwError(args.Env(), "third argument must be a string or a compiled pattern");
+      return args.Env().Null();
+    }
+  } else {
+    *compiled = pattern::compile(args[2].As<Napi::String>().Utf8Value().c_str());
+  }
+
+  // Address of findPattern result
+  auto address = std::make_shared<uintptr_t>(-1);
+
+  auto execute = [=](char** errorMessage, const std::atomic<bool>& cancelled) {
+    // Modules come from the handle's cached address map, which is only re-read when they change
+    std::shared_ptr<const addressmap::Snapshot> modules = addressmap::get(handle, false, errorMessage);
+
+    // If an error message was returned from the function getting the modules, it is thrown for synchronous calls
+    // and passed to the callback otherwise
+    if (strcmp(*errorMessage, "")) return;
+
+    const MODULEENTRY32* module = modules->findModule(moduleName);
+    if (module) {
+      *address = pattern::findPattern(handle, *module, *signature, sigType, patternOffset, addressOffset, &cancelled);
+    }
+
+    async::failIfCancelled(errorMessage, cancelled);
+    if (strcmp(*errorMessage, "")) return;
+
+    // Synchronous calls return -1 when the module could not be found and -2 when there was no match, callbacks and
+    // promises are told why
+    if (mode == memoryjs::SYNC) return;
+    if (*address == (uintptr_t)-1) *errorMessage = "unable to find module";
+    if (*address == (uintptr_t)-2) *errorMessage = "no match found";
+  };
+
+  auto complete = [=](Napi::Env env) -> Napi::Value {
+    (void)signatureHold;
+    return Napi::Number::New(env, *address);
+  };
+
+  return memoryjs::run(args, mode, execute, complete);
+}
+
+Napi::Value findPattern(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("findPattern");
+  // findPattern can be asynchronous
+  return findPatternImpl(args, args.Length() == 7 ? memoryjs::CALLBACK : memoryjs::SYNC);
+}
+
+Napi::Value findPatternAsync(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("findPatternAsync");
+  return findPatternImpl(args, memoryjs::PROMISE);
+}
+
+static Napi::Value findPatternsImpl(const Napi::CallbackInfo& args, memoryjs::Mode mode) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 3 && args.Length() != 4) {
+    memoryjs::throwError(env, "requires 3 arguments, or 4 arguments if a callback is being used");
+    return env.Null();
+  }
+
+  if (!args[0].IsNumber() || !args[1].IsString() || !args[2].IsArray()) {
+    memoryjs::throwError(env, "first argument must be a number, second a string and third an array");
+    return env.Null();
+  }
+
+  if (mode == memoryjs::CALLBACK && !args[3].IsFunction()) {
+    memoryjs::throwError(env, "fourth argument must be a function");
+    return env.Null();
+  }
+
+  HANDLE handle = memoryjs::getHandle(args[0]);
+  std::string moduleName(args[1].As<Napi::String>().Utf8Value());
+  Napi::Array signatures = args[2].As<Napi::Array>();
+
+  // Each entry is either a signature (a string or a compiled pattern), or an object of the form
+  // { signature, signatureType, patternOffset, addressOffset }
+  auto requests = std::make_shared<std::vector<pattern::Request>>(signatures.Length());
+  auto compiled = std::make_shared<std::vector<pattern::Signature>>(signatures.Length());
+  std::vector<memoryjs::Hold> holds;
+
+  for (uint32_t i = 0; i < signatures.Length(); i++) {
+    Napi::Value entry = signatures.Get(i);
+    Napi::Value signature = entry;
+    pattern::Request& request = (*requests)[i];
+
+    request.sigType = pattern::ST_NORMAL;
+    request.patternOffset = 0;
+    request.addressOffset = 0;
+
+    if (entry.IsObject() && !entry.IsExternal()) {
+      Napi::Object options = entry.As<Napi::Object>();
+      signature = options.Get("signature");
+
+      if (!memoryjs::hasNumbers(options, {"signatureType", "patternOffset", "addressOffset"})) {
+        memoryjs::throwError(env, "signatureType, patternOffset and addressOffset must be numbers");
+        return env.Null();
+      }
+
+      if (options.Has("signatureType")) request.sigType = options.Get("signatureType").As<Napi::Number>().Uint32Value();
+      if (options.Has("patternOffset")) {
+        request.patternOffset = options.Get("patternOffset").As<Napi::Number>().Uint32Value();
+      }
+      if (options.Has("addressOffset")) {
+        request.addressOffset = options.Get("addressOffset").As<Napi::Number>().Uint32Value();
+      }
+    }
+
+    if (opaque::get<pattern::Signature>(signature)) {
+      request.signature = opaque::get<pattern::Signature>(signature);
+      holds.push_back(memoryjs::hold(signature));
+    } else if (signature.IsString()) {
+      (*compiled)[i] = pattern::compile(signature.As<Napi::String>().Utf8Value().c_str());
+      request.signature = &(*compiled)[i];
+    } else {
+      memoryjs::throwError(env, "every signature must be a string, a compiled pattern or an object with a signature");
+      return env.Null();
+    }
+  }
+
+  auto addresses = std::make_shared<std::vector<uintptr_t>>();
+
+  auto execute = [=](char** errorMessage, const std::atomic<bool>& cancelled) {
+    MODULEENTRY32 module;
+
+    if (addressmap::findModule(handle, moduleName, &module, errorMessage)) {
+      *addresses = pattern::findPatterns(handle, module, *requests, &cancelled);
+    }
+
+    async::failIfCancelled(errorMessage, cancelled);
+  };
+
+  auto complete = [=](Napi::Env env) -> Napi::Value {
+    (void)compiled;
+    (void)holds;
+
+    // One address per signature, null for the signatures that did not match
+    Napi::Array results = Napi::Array::New(env, addresses->size());
+    for (std::vector<uintptr_t>::size_type i = 0; i != addresses->size(); i++) {
+      if ((*addresses)[i] == (uintptr_t)-2) {
+        results.Set(i, env.Null());
+      } else {
+        results.Set(i, Napi::Number::New(env, (*addresses)[i]));
+      }
+    }
+
+    return results;
+  };
+
+  return memoryjs::run(args, mode, execute, complete);
+}
+
+Napi::Value findPatterns(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("findPatterns");
+  return findPatternsImpl(args, args.Length() == 4 ? memoryjs::CALLBACK : memoryjs::SYNC);
+}
+
+Napi::Value findPatternsAsync(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("findPatternsAsync");
+  return findPatternsImpl(args, memoryjs::PROMISE);
+}
+
+static Napi::Value findAllImpl(const Napi::CallbackInfo& args, memoryjs::Mode mode) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() < 2 || args.Length() > 4) {
+    memoryjs::throwError(env, "requires 2 or 3 arguments, or 4 arguments if a callback is being used");
+    return env.Null();
+  }
+
+  if (!args[0].IsNumber() || (!args[1].IsString() && !opaque::get<pattern::Signature>(args[1]))) {
+    memoryjs::throwError(env, "first argument must be a number, second argument must be a signature");
+    return env.Null();
+  }
+
+  // The last argument is the callback, or the cancel token of an Async call
+  size_t optionsIndex = 2;
+  bool hasTail = mode != memoryjs::SYNC;
+
+  if (args.Length() > optionsIndex + hasTail && !args[optionsIndex].IsObject()) {
+    memoryjs::throwError(env, "third argument must be an object");
+    return env.Null();
+  }
+
+  HANDLE handle = memoryjs::getHandle(args[0]);
+
+  auto compiled = std::make_shared<pattern::Signature>();
+  const pattern::Signature* signature = compiled.get();
+  memoryjs::Hold signatureHold;
+
+  if (args[1].IsExternal()) {
+    signature = opaque::get<pattern::Signature>(args[1]);
+    signatureHold = memoryjs::hold(args[1]);
+  } else {
+    *compiled = pattern::compile(args[1].As<Napi::String>().Utf8Value().c_str());
+  }
+
+  // Options: { protection, type, start, end, limit }
+  region::Filter filter = region::all();
+  size_t limit = pattern::npos;
+
+  if (args.Length() > optionsIndex + hasTail) {
+    Napi::Object options = args[optionsIndex].As<Napi::Object>();
+
+    if (!memoryjs::getFilter(options, &filter) ||
+        (options.Has("limit") && !memoryjs::getSize(options.Get("limit"), SIZE_MAX, &limit))) {
+      memoryjs::throwError(env, "protection, type, start and end must be numbers, limit a non-negative integer");
+      return env.Null();
+    }
+  }
+
+  auto addresses = std::make_shared<std::vector<uintptr_t>>();
+
+  auto execute = [=](char** errorMessage, const std::atomic<bool>& cancelled) {
+    *addresses = pattern::findAll(handle, *signature, filter, limit, &cancelled);
+    async::failIfCancelled(errorMessage, cancelled);
+  };
+
+  auto complete = [=](Napi::Env env) -> Napi::Value {
+    (void)signatureHold;
+
+    Napi::Float64Array results = Napi::Float64Array::New(env, addresses->size());
+    for (std::vector<uintptr_t>::size_type i = 0; i != addresses->size(); i++) results[i] = (double)(*addresses)[i];
+    return results;
+  };
+
+  return memoryjs::run(args, mode, execute, complete);
+}
+
+Napi::Value findAll(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("findAll");
+  return findAllImpl(args, args[args.Length() - 1].IsFunction() ? memoryjs::CALLBACK : memoryjs::SYNC);
+}
+
+Napi::Value findAllAsync(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("findAllAsync");
+  return findAllImpl(args, memoryjs::PROMISE);
+}
+
+Napi::Value compilePattern(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("compilePattern");
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 1) {
+    memoryjs::throwError(env, "requires 1 argument");
+    return env.Null();
+  }
+
+  if (!args[0].IsString()) {
+    memoryjs::throwError(env, "first argument must be a string");
+    return env.Null();
+  }
+
+  std::string signature(args[0].As<Napi::String>().Utf8Value());
+
+  // The compiled pattern is opaque to JS and is freed once it is garbage collected
+  return opaque::wrap<pattern::Signature>(env, pattern::compile(signature.c_str()));
+}
+
+void setSignatureCache(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("setSignatureCache");
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 1 || (!args[0].IsString() && !args[0].IsNull())) {
+    memoryjs::throwError(env, "first argument must be a string, or null to turn the cache off");
+    return;
+  }
+
+  std::string path = args[0].IsString() ? args[0].As<Napi::String>().Utf8Value() : "";
+  char* errorMessage = "";
+
+  if (!sigcache::open(path, &errorMessage)) memoryjs::throwError(env, errorMessage);
+}
+
+Napi::Value flushSignatureCache(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("flushSignatureCache");
+  return Napi::Boolean::New(args.Env(), sigcache::flush());
+}
+
+void clearSignatureCache(const Napi::CallbackInfo&) {
+  MEMORYJS_STATS_CALL("clearSignatureCache");
+  sigcache::clear();
+}
+
+Napi::Value getSignatureCacheStats(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("getSignatureCacheStats");
+  Napi::Env env = args.Env();
+  sigcache::Stats stats = sigcache::stats();
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("enabled", Napi::Boolean::New(env, sigcache::enabled()));
+  result.Set("hits", Napi::Number::New(env, (double)stats.hits));
+  result.Set("misses", Napi::Number::New(env, (double)stats.misses));
+  result.Set("entries", Napi::Number::New(env, (double)stats.entries));
+  return result;
+}
+
+void setThreadCount(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("setThreadCount");
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 1) {
+    memoryjs::throwError(env, "requires 1 argument");
+    return;
+  }
+
+  if (!args[0].IsNumber()) {
+    memoryjs::throwError(env, "first argument must be a number");
+    return;
+  }
+
+  // 0 sizes the pool to the number of hardware threads
+  threadpool::setThreads(args[0].As<Napi::Number>().Uint32Value());
+}
+
+Napi::Value getThreadCount(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("getThreadCount");
+  return Napi::Number::New(args.Env(), (double)threadpool::getThreads());
+}
+
+// A scanner session and whether a scan of it is in progress, which must not be used until it completes. Scans share
+// it, so that it outlives them in whatever order they, the JS handle and the environment go away.
+struct Scanner {
+  Scanner(HANDLE handle, scanner::ValueType type, size_t alignment, const region::Filter& filter)
+      : session(handle, type, alignment, filter), busy(false) {}
+
+  scanner::Session session;
+  bool busy;
+};
+
+typedef std::shared_ptr<Scanner> SharedScanner;
+
+Napi::Value createScanner(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("createScanner");
+  Napi::Env env = args.Env();
+
+  if (args.Length() < 2 || args.Length() > 3) {
+    memoryjs::throwError(env, "requires 2 or 3 arguments");
+    return env.Null();
+  }
+
+  if (!args[0].IsNumber() || !args[1].IsString()) {
+    memoryjs::throwError(env, "first argument must be a number, second argument must be a string");
+    return env.Null();
+  }
+
+  if (args.Length() == 3 && !args[2].IsObject()) {
+    memoryjs::throwError(env, "third argument must be an object");
+    return env.Null();
+  }
+
+  HANDLE handle = memoryjs::getHandle(args[0]);
+  std::string dataType(args[1].As<Napi::String>().Utf8Value());
+  scanner::ValueType type;
+
+  if (dataType == "byte") {
+    type = scanner::T_BYTE;
+  } else if (dataType == "int" || dataType == "int32") {
+    type = scanner::T_INT32;
+  } else if (dataType == "int64") {
+    type = scanner::T_INT64;
+  } else if (dataType == "float") {
+    type = scanner::T_FLOAT;
+  } else if (dataType == "double") {
+    type = scanner::T_DOUBLE;
+  } else {
+    memoryjs::throwError(env, "unexpected data type");
+    return env.Null();
+  }
+
+  // Options: { alignment, protection, type, start, end }, scans writable memory by default
+  region::Filter filter = region::all();
+  filter.protect = PAGE_READWRITE | PAGE_WRITECOPY | PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY;
+  size_t alignment = 0;
+
+  if (args.Length() == 3) {
+    Napi::Object options = args[2].As<Napi::Object>();
+    region::Filter given;
+
+    if (!memoryjs::getFilter(options, &given) || !memoryjs::hasNumbers(options, {"alignment"})) {
+      memoryjs::throwError(env, "protection, type, start, end and alignment must be numbers");
+      return env.Null();
+    }
+
+    if (options.Has("protection")) filter.protect = given.protect;
+    filter.type = given.type;
+    filter.start = given.start;
+    filter.end = given.end;
+
+    if (options.Has("alignment")) alignment = options.Get("alignment").As<Napi::Number>().Uint32Value();
+  }
+
+  return opaque::wrap<SharedScanner>(env, std::make_shared<Scanner>(handle, type, alignment, filter));
+}
+
+// firstScan and nextScan share everything but the session method they call
+static Napi::Value scan(const Napi::CallbackInfo& args, bool first, memoryjs::Mode mode) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() < 2 || args.Length() > 3) {
+    memoryjs::throwError(env, "requires 2 arguments, or 3 arguments if a callback is being used");
+    return env.Null();
+  }
+
+  if (!opaque::get<SharedScanner>(args[0]) || !args[1].IsObject()) {
+    memoryjs::throwError(env, "first argument must be a scanner, second argument must be an object");
+    return env.Null();
+  }
+
+  if (mode == memoryjs::CALLBACK && !args[2].IsFunction()) {
+    memoryjs::throwError(env, "third argument must be a function");
+    return env.Null();
+  }
+
+  SharedScanner shared = *opaque::get<SharedScanner>(args[0]);
+  scanner::Session* session = &shared->session;
+  scanner::Condition condition;
+
+  if (shared->busy) {
+    memoryjs::throwError(env, "the scanner is busy with another scan");
+    return env.Null();
+  }
+
+  if (!memoryjs::getCondition(args[1].As<Napi::Object>(), &condition)) {
+    memoryjs::throwError(env, "unexpected comparison, or value, max or tolerance is not a number");
+    return env.Null();
+  }
+
+  if (first && scanner::isRelative(condition.compare)) {
+    memoryjs::throwError(env, "the first scan cannot compare against previous values");
+    return env.Null();
+  }
+
+  if (!first && !session->scanned()) {
+    memoryjs::throwError(env, "firstScan has to be called before nextScan");
+    return env.Null();
+  }
+
+  // The session stays busy, and alive, until the scan has completed and the operation is destroyed
+  shared->busy = true;
+  std::shared_ptr<void> busy(nullptr, [shared](void*) { shared->busy = false; });
+
+  auto count = std::make_shared<size_t>(0);
+
+  // An aborted scan leaves the candidates of the previous one
+  auto execute = [=](char** errorMessage, const std::atomic<bool>& cancelled) {
+    *count = first ? session->firstScan(condition, &cancelled) : session->nextScan(condition, &cancelled);
+    if (*count == scanner::aborted) *errorMessage = (char*)async::abortedMessage;
+  };
+
+  auto complete = [=](Napi::Env env) -> Napi::Value {
+    (void)busy;
+    return Napi::Number::New(env, (double)*count);
+  };
+
+  return memoryjs::run(args, mode, execute, complete);
+}
+
+Napi::Value firstScan(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("firstScan");
+  return scan(args, true, args.Length() == 3 ? memoryjs::CALLBACK : memoryjs::SYNC);
+}
+
+Napi::Value firstScanAsync(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("firstScanAsync");
+  return scan(args, true, memoryjs::PROMISE);
+}
+
+Napi::Value nextScan(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("nextScan");
+  return scan(args, false, args.Length() == 3 ? memoryjs::CALLBACK : memoryjs::SYNC);
+}
+
+Napi::Value nextScanAsync(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("nextScanAsync");
+  return scan(args, false, memoryjs::PROMISE);
+}
+
+Napi::Value getScanResults(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("getScanResults");
+  Napi::Env env = args.Env();
+
+  if (args.Length() < 1 || args.Length() > 3) {
+    memoryjs::throwError(env, "requires 1 to 3 arguments");
+    return env.Null();
+  }
+
+  if (!opaque::get<SharedScanner>(args[0])) {
+    memoryjs::throwError(env, "first argument must be a scanner");
+    return env.Null();
+  }
+
+  const Scanner& shared = **opaque::get<SharedScanner>(args[0]);
+  const scanner::Session* session = &shared.session;
+
+  if (shared.busy) {
+    memoryjs::throwError(env, "the scanner is busy with another scan");
+    return env.Null();
+  }
+
+  size_t offset = args.Length() > 1 ? args[1].As<Napi::Number>().Int64Value() : 0;
+  size_t limit = args.Length() > 2 ? args[2].As<Napi::Number>().Int64Value() : session->count();
+
+  std::vector<scanner::Result> results = session->results(offset, limit);
+
+  Napi::Float64Array addresses = Napi::Float64Array::New(env, results.size());
+  Napi::Float64Array values = Napi::Float64Array::New(env, results.size());
+
+  for (std::vector<scanner::Result>::size_type i = 0; i != results.size(); i++) {
+    addresses[i] = (double)results[i].address;
+    values[i] = results[i].value;
+  }
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set(Napi::String::New(env, "addresses"), addresses);
+  result.Set(Napi::String::New(env, "values"), values);
+  result.Set(Napi::String::New(env, "count"), Napi::Number::New(env, (double)session->count()));
+  return result;
+}
+
+typedef std::shared_ptr<const std::vector<textscan::Match>> StringList;
+
+// Reads string scan options of the form { minLength, maxLength, encoding, filter, limit } on top of a region filter,
+// returns false if a length is not an integer up to textscan::longestRun, the limit not a non-negative integer,
+// `encoding` is unknown or `filter` is not a string or an array of strings
+static bool getStringOptions(Napi::Object options, textscan::Options* scan) {
+  const size_t longest = textscan::longestRun;
+
+  if ((options.Has("minLength") && !memoryjs::getSize(options.Get("minLength"), longest, &scan->minLength)) ||
+      (options.Has("maxLength") && !memoryjs::getSize(options.Get("maxLength"), longest, &scan->maxLength)) ||
+      (options.Has("limit") && !memoryjs::getSize(options.Get("limit"), SIZE_MAX, &scan->limit))) {
+    return false;
+  }
+
+  if (options.Has("encoding")) {
+    if (!options.Get("encoding").IsString()) return false;
+
+    std::string encoding = options.Get("encoding").As<Napi::String>().Utf8Value();
+
+    if (encoding == "ascii") {
+      scan->encodings = textscan::ASCII;
+    } else if (encoding == "utf16") {
+      scan->encodings = textscan::UTF16;
+    } else if (encoding == "both") {
+      scan->encodings = textscan::ASCII | textscan::UTF16;
+    } else {
+      return false;
+    }
+  }
+
+  if (options.Has("filter")) {
+    Napi::Value filter = options.Get("filter");
+
+    if (filter.IsString()) {
+      scan->filters.push_back(filter.As<Napi::String>().Utf8Value());
+    } else if (filter.IsArray()) {
+      Napi::Array filters = filter.As<Napi::Array>();
+      for (uint32_t i = 0; i < filters.Length(); i++) {
+        Napi::Value value = filters[i];
+        if (!value.IsString()) return false;
+        scan->filters.push_back(value.As<Napi::String>().Utf8Value());
+      }
+    } else {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static Napi::Value findStringsImpl(const Napi::CallbackInfo& args, memoryjs::Mode mode) {
+  Napi::Env env = args.Env();
+
+  size_t optionsIndex = 1;
+  bool hasTail = mode != memoryjs::SYNC;
+
+  if (args.Length() < optionsIndex + hasTail || args.Length() > optionsIndex + 1 + hasTail || !args[0].IsNumber()) {
+    memoryjs::throwError(env, "first argument must be a number");
+    return env.Null();
+  }
+
+  if (args.Length() > optionsIndex + hasTail && !args[optionsIndex].IsObject()) {
+    memoryjs::throwError(env, "second argument must be an object");
+    return env.Null();
+  }
+
+  HANDLE handle = memoryjs::getHandle(args[0]);
+
+  // Options: { protection, type, start, end, minLength, maxLength, encoding, filter, limit }
+  region::Filter filter = region::all();
+  textscan::Options options = textscan::defaults();
+
+  if (args.Length() > optionsIndex + hasTail) {
+    Napi::Object object = args[optionsIndex].As<Napi::Object>();
+
+    if (!memoryjs::getFilter(object, &filter)) {
+      memoryjs::throwError(env, "protection, type, start and end must be numbers");
+      return env.Null();
+    }
+
+    if (!getStringOptions(object, &options)) {
+      memoryjs::throwError(env, "minLength and maxLength must be integers up to 1048576, limit a non-negative integer, "
+                                "encoding 'ascii', 'utf16' or 'both' and filter a string or strings");
+      return env.Null();
+    }
+  }
+
+  auto matches = std::make_shared<std::vector<textscan::Match>>();
+
+  auto execute = [=](char** errorMessage, const std::atomic<bool>& cancelled) {
+    *matches = textscan::find(handle, filter, options, &cancelled);
+    async::failIfCancelled(errorMessage, cancelled);
+  };
+
+  // The strings stay native until they are asked for, a batch at a time
+  auto complete = [=](Napi::Env env) -> Napi::Value {
+    return opaque::wrap<StringList>(env, matches);
+  };
+
+  return memoryjs::run(args, mode, execute, complete);
+}
+
+Napi::Value findStrings(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("findStrings");
+  return findStringsImpl(args, args[args.Length() - 1].IsFunction() ? memoryjs::CALLBACK : memoryjs::SYNC);
+}
+
+Napi::Value findStringsAsync(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("findStringsAsync");
+  return findStringsImpl(args, memoryjs::PROMISE);
+}
+
+Napi::Value getStringResults(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("getStringResults");
+  Napi::Env env = args.Env();
+
+  if (args.Length() < 1 || args.Length() > 3 || !opaque::get<StringList>(args[0])) {
+    memoryjs::throwError(env, "first argument must be the result of findStrings");
+    return env.Null();
+  }
+
+  const std::vector<textscan::Match>& matches = **opaque::get<StringList>(args[0]);
+
+  size_t offset = args.Length() > 1 ? args[1].As<Napi::Number>().Int64Value() : 0;
+  size_t limit = args.Length() > 2 ? args[2].As<Napi::Number>().Int64Value() : matches.size();
+
+  offset = std::min(offset, matches.size());
+  size_t count = std::min(limit, matches.size() - offset);
+
+  Napi::Float64Array addresses = Napi::Float64Array::New(env, count);
+  Napi::Uint8Array encodings = Napi::Uint8Array::New(env, count);
+  Napi::Array texts = Napi::Array::New(env, count);
+
+  for (size_t i = 0; i < count; i++) {
+    const textscan::Match& match = matches[offset + i];
+    addresses[i] = (double)match.address;
+    encodings[i] = match.encoding == textscan::UTF16;
+    texts.Set(i, Napi::String::New(env, match.text));
+  }
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("addresses", addresses);
+  result.Set("encodings", encodings);
+  result.Set("texts", texts);
+  result.Set("count", Napi::Number::New(env, (double)matches.size()));
+  return result;
+}
+
+static Napi::Value dumpRegionsImpl(const Napi::CallbackInfo& args, memoryjs::Mode mode) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() < 2 || args.Length() > 4) {
+    memoryjs::throwError(env, "requires 2 or 3 arguments, or 4 arguments if a callback is being used");
+    return env.Null();
+  }
+
+  if (!args[0].IsNumber() || !args[1].IsString()) {
+    memoryjs::throwError(env, "first argument must be a number, second argument must be a string");
+    return env.Null();
+  }
+
+  // The last argument is the callback, or the cancel token of an Async call
+  size_t optionsIndex = 2;
+  bool hasTail = mode != memoryjs::SYNC;
+
+  if (args.Length() > optionsIndex + hasTail && !args[optionsIndex].IsObject()) {
+    memoryjs::throwError(env, "third argument must be an object");
+    return env.Null();
+  }
+
+  HANDLE handle = memoryjs::getHandle(args[0]);
+  std::string path = args[1].As<Napi::String>().Utf8Value();
+
+  // Options: { protection, type, start, end, compress }
+  region::Filter filter = region::all();
+  bool compress = false;
+
+  if (args.Length() > optionsIndex + hasTail) {
+    Napi::Object options = args[optionsIndex].As<Napi::Object>();
+
+    if (!memoryjs::getFilter(options, &filter)) {
+      memoryjs::throwError(env, "protection, type, start and end must be numbers");
+      return env.Null();
+    }
+
+    if (options.Has("compress")) {
+      Napi::Value value = options.Get("compress");
+      compress = value.IsBoolean() && value.As<Napi::Boolean>().Value();
+    }
+  }
+
+  auto summary = std::make_shared<snapshot::Summary>();
+
+  auto execute = [=](char** errorMessage, const std::atomic<bool>& cancelled) {
+    // A cancelled dump leaves no file behind and rejects like any other aborted operation
+    if (!snapshot::dump(handle, path, filter, compress, summary.get(), errorMessage, &cancelled) && cancelled) {
+      *errorMessage = (char*)async::abortedMessage;
+    }
+  };
+
+  auto complete = [=](Napi::Env env) -> Napi::Value {
+    Napi::Object result = Napi::Object::New(env);
+    result.Set(Napi::String::New(env, "regions"), Napi::Number::New(env, (double)summary->regions));
+    result.Set(Napi::String::New(env, "bytes"), Napi::Number::New(env, (double)summary->bytes));
+    return result;
+  };
+
+  return memoryjs::run(args, mode, execute, complete);
+}
+
+Napi::Value dumpRegions(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("dumpRegions");
+  return dumpRegionsImpl(args, args[args.Length() - 1].IsFunction() ? memoryjs::CALLBACK : memoryjs::SYNC);
+}
+
+Napi::Value dumpRegionsAsync(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("dumpRegionsAsync");
+  return dumpRegionsImpl(args, memoryjs::PROMISE);
+}
+
+Napi::Value openSnapshot(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("openSnapshot");
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 1 || !args[0].IsString()) {
+    memoryjs::throwError(env, "first argument must be a string");
+    return env.Null();
+  }
+
+  char* errorMessage = "";
+  HANDLE handle = snapshot::open(args[0].As<Napi::String>().Utf8Value(), &errorMessage);
+
+  if (!handle) {
+    memoryjs::throwError(env, errorMessage);
+    return env.Null();
+  }
+
+  instance::open(env, handle);
+  return Napi::Number::New(env, (intptr_t)handle);
+}
+
+typedef std::shared_ptr<mirror::Mirror> Mirror;
+
+Napi::Value createMirror(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("createMirror");
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 3 && args.Length() != 4) {
+    memoryjs::throwError(env, "requires 3 or 4 arguments");
+    return env.Null();
+  }
+
+  if (!args[0].IsNumber() || !args[1].IsNumber() || !args[2].IsNumber()) {
+    memoryjs::throwError(env, "first, second and third argument must be numbers");
+    return env.Null();
+  }
+
+  if (args.Length() == 4 && !args[3].IsObject()) {
+    memoryjs::throwError(env, "fourth argument must be an object");
+    return env.Null();
+  }
+
+  HANDLE handle = memoryjs::getHandle(args[0]);
+  DWORD64 address = args[1].As<Napi::Number>().Int64Value();
+  int64_t size = args[2].As<Napi::Number>().Int64Value();
+  int64_t granularity = 64;
+
+  if (args.Length() == 4 && !memoryjs::hasNumbers(args[3].As<Napi::Object>(), {"granularity"})) {
+    memoryjs::throwError(env, "granularity must be a number");
+    return env.Null();
+  }
+
+  if (args.Length() == 4 && args[3].As<Napi::Object>().Has("granularity")) {
+    granularity = args[3].As<Napi::Object>().Get("granularity").As<Napi::Number>().Int64Value();
+  }
+
+  if (size <= 0 || granularity <= 0) {
+    memoryjs::throwError(env, "size and granularity must be positive");
+    return env.Null();
+  }
+
+  return opaque::wrap<Mirror>(env,
+                              std::make_shared<mirror::Mirror>(handle, address, (size_t)size, (size_t)granularity));
+}
+
+static mirror::Mirror* getMirror(const Napi::CallbackInfo& args) {
+  if (args.Length() != 1 || !opaque::get<Mirror>(args[0])) {
+    memoryjs::throwError(args.Env(), "first argument must be a mirror");
+    return nullptr;
+  }
+
+  return opaque::get<Mirror>(args[0])->get();
+}
+
+// Updates the mirror and returns the spans that changed, each with a copy of its bytes
+Napi::Value updateMirror(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("updateMirror");
+  Napi::Env env = args.Env();
+  mirror::Mirror* mirrored = getMirror(args);
+  if (!mirrored) return env.Null();
+
+  const std::vector<mirror::Span>& spans = mirrored->update();
+  Napi::Array results = Napi::Array::New(env, spans.size());
+
+  for (size_t i = 0; i < spans.size(); i++) {
+    Napi::Object span = Napi::Object::New(env);
+    span.Set("offset", Napi::Number::New(env, (double)spans[i].offset));
+    span.Set("length", Napi::Number::New(env, (double)spans[i].length));
+    span.Set("bytes", Napi::Buffer<char>::Copy(env, (const char*)mirrored->data() + spans[i].offset, spans[i].length));
+    results.Set(i, span);
+  }
+
+  return results;
+}
+
+// Updates the mirror in place, where getMirrorBuffer's buffer sees it, and returns the changed spans as offset and
+// length pairs
+Napi::Value applyMirror(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("applyMirror");
+  Napi::Env env = args.Env();
+  mirror::Mirror* mirrored = getMirror(args);
+  if (!mirrored) return env.Null();
+
+  const std::vector<mirror::Span>& spans = mirrored->update();
+  Napi::Float64Array results = Napi::Float64Array::New(env, spans.size() * 2);
+
+  for (size_t i = 0; i < spans.size(); i++) {
+    results[i * 2] = (double)spans[i].offset;
+    results[i * 2 + 1] = (double)spans[i].length;
+  }
+
+  return results;
+}
+
+Napi::Value getMirrorBuffer(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("getMirrorBuffer");
+  Napi::Env env = args.Env();
+  mirror::Mirror* mirrored = getMirror(args);
+  if (!mirrored) return env.Null();
+
+  // The buffer views the mirror's copy and keeps the mirror alive for as long as it is reachable
+  Mirror* owner = new Mirror(*opaque::get<Mirror>(args[0]));
+  return Napi::Buffer<char>::New(env, (char*)mirrored->data(), mirrored->size(),
+                                 [](Napi::Env, char*, Mirror* owner) { delete owner; }, owner);
+}
+
+Napi::Value getMirrorStats(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("getMirrorStats");
+  Napi::Env env = args.Env();
+  mirror::Mirror* mirrored = getMirror(args);
+  if (!mirrored) return env.Null();
+
+  const mirror::Stats& stats = mirrored->stats();
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("updates", Napi::Number::New(env, (double)stats.updates));
+  result.Set("bytesRead", Napi::Number::New(env, (double)stats.bytesRead));
+  result.Set("bytesChanged", Napi::Number::New(env, (double)stats.bytesChanged));
+  result.Set("bytesTransferred", Napi::Number::New(env, (double)stats.bytesTransferred));
+  return result;
+}
+
+// Reads [{ address, size }] or [{ address, layout }], where the layout is one returned by defineStruct
+static bool getSharedRegions(Napi::Value value, std::vector<share::Region>* regions) {
+  if (!value.IsArray()) return false;
+
+  Napi::Array array = value.As<Napi::Array>();
+  regions->clear();
+
+  for (uint32_t i = 0; i < array.Length(); i++) {
+    if (!array.Get(i).IsObject()) return false;
+
+    Napi::Object entry = array.Get(i).As<Napi::Object>();
+    if (!entry.Get("address").IsNumber()) return false;
+
+    share::Region region;
+    region.address = entry.Get("address").As<Napi::Number>().Int64Value();
+
+    if (opaque::get<layout::Layout>(entry.Get("layout"))) {
+      region.size = opaque::get<layout::Layout>(entry.Get("layout"))->size;
+    } else if (entry.Get("size").IsNumber() && entry.Get("size").As<Napi::Number>().Int64Value() >= 0) {
+      region.size = (size_t)entry.Get("size").As<Napi::Number>().Int64Value();
+    } else {
+      return false;
+    }
+
+    regions->push_back(region);
+  }
+
+  return true;
+}
+
+// The publisher is declared last so that it stops writing before the buffer is let go of
+struct SharedRegions {
+  Napi::Reference<Napi::Value> buffer;
+  std::shared_ptr<share::Publisher> publisher;
+};
+
+Napi::Value shareRegions(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("shareRegions");
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 2 && args.Length() != 3) {
+    memoryjs::throwError(env, "requires 2 or 3 arguments");
+    return env.Null();
+  }
+
+  std::vector<share::Region> regions;
+
+  if (!args[0].IsNumber() || !getSharedRegions(args[1], &regions)) {
+    memoryjs::throwError(env, "first argument must be a number, second argument must be an array of "
+                              "{ address, size } or { address, layout }");
+    return env.Null();
+  }
+
+  if (args.Length() == 3 && !args[2].IsObject()) {
+    memoryjs::throwError(env, "third argument must be an object");
+    return env.Null();
+  }
+
+  // Options: { intervalMs, buffers, capacity }
+  uint32_t interval = 100;
+  size_t slots = 2;
+  size_t slotSize = share::slotSize(regions);
+
+  if (args.Length() == 3) {
+    Napi::Object options = args[2].As<Napi::Object>();
+
+    if (!memoryjs::hasNumbers(options, {"intervalMs", "buffers", "capacity"})) {
+      memoryjs::throwError(env, "intervalMs, buffers and capacity must be numbers");
+      return env.Null();
+    }
+
+    if (options.Has("intervalMs")) interval = std::max(options.Get("intervalMs").As<Napi::Number>().Uint32Value(), 1u);
+    if (options.Has("buffers")) slots = options.Get("buffers").As<Napi::Number>().Uint32Value();
+    if (options.Has("capacity")) {
+      slotSize = std::max(slotSize, (size_t)options.Get("capacity").As<Napi::Number>().Int64Value());
+    }
+  }
+
+  if (slots != 2 && slots != share::maxSlots) {
+    memoryjs::throwError(env, "buffers must be 2 or 3");
+    return env.Null();
+  }
+
+  if (!env.Global().Get("SharedArrayBuffer").IsFunction()) {
+    memoryjs::throwError(env, "SharedArrayBuffer is not available");
+    return env.Null();
+  }
+
+  // N-API cannot create a SharedArrayBuffer itself, but can get at its memory through a view
+  size_t size = share::memorySize(slots, slotSize);
+  Napi::Function constructor = env.Global().Get("SharedArrayBuffer").As<Napi::Function>();
+  Napi::Object buffer = constructor.New({Napi::Number::New(env, (double)size)});
+  Napi::Object view = env.Global().Get("Uint8Array").As<Napi::Function>().New({buffer});
+
+  Napi::Value publisher = opaque::wrap<SharedRegions>(env);
+  SharedRegions* shared = opaque::get<SharedRegions>(publisher);
+  shared->buffer = Napi::Persistent(Napi::Value(buffer));
+  shared->publisher = std::make_shared<share::Publisher>(memoryjs::getHandle(args[0]),
+                                                        view.As<Napi::Uint8Array>().Data(), slots, slotSize);
+  shared->publisher->configure(regions, interval);
+  shared->publisher->start();
+
+  // Stopped with the environment even if the finalizer of `shared` has not run by then
+  instance::Data& data = instance::get(env);
+  {
+    std::lock_guard<std::mutex> guard(data.publishersLock);
+    data.publishers.erase(std::remove_if(data.publishers.begin(), data.publishers.end(),
+                                         [](const std::weak_ptr<share::Publisher>& p) { return p.expired(); }),
+                          data.publishers.end());
+    data.publishers.push_back(shared->publisher);
+  }
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("buffer", buffer);
+  result.Set("publisher", publisher);
+  return result;
+}
+
+void configureSharedRegions(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("configureSharedRegions");
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 3 || !opaque::get<SharedRegions>(args[0]) || !args[2].IsNumber()) {
+    memoryjs::throwError(env, "requires a publisher, the regions and the interval");
+    return;
+  }
+
+  std::vector<share::Region> regions;
+
+  if (!getSharedRegions(args[1], &regions)) {
+    memoryjs::throwError(env, "second argument must be an array of { address, size } or { address, layout }");
+    return;
+  }
+
+  SharedRegions* shared = opaque::get<SharedRegions>(args[0]);
+  uint32_t interval = std::max(args[2].As<Napi::Number>().Uint32Value(), 1u);
+
+  if (!shared->publisher->configure(regions, interval)) {
+    memoryjs::throwError(env, "the regions do not fit in the shared buffer, create it with a larger capacity");
+  }
+}
+
+void stopSharedRegions(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("stopSharedRegions");
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 1 || !opaque::get<SharedRegions>(args[0])) {
+    memoryjs::throwError(env, "first argument must be a publisher");
+    return;
+  }
+
+  opaque::get<SharedRegions>(args[0])->publisher->stop();
+}
+
+typedef std::shared_ptr<session::Session> ProcessSession;
+
+// Reads a session filter of the form { names, pids }, returns false if either is not an array of the right type
+static bool getSessionFilter(Napi::Value value, session::Filter* filter) {
+  if (!value.IsObject()) return false;
+
+  Napi::Object options = value.As<Napi::Object>();
+
+  if (options.Has("names")) {
+    if (!options.Get("names").IsArray()) return false;
+
+    Napi::Array names = options.Get("names").As<Napi::Array>();
+    for (uint32_t i = 0; i < names.Length(); i++) {
+      Napi::Value name = names[i];
+      if (!name.IsString()) return false;
+      filter->names.insert(name.As<Napi::String>().Utf8Value());
+    }
+  }
+
+  if (options.Has("pids")) {
+    if (!options.Get("pids").IsArray()) return false;
+
+    Napi::Array ids = options.Get("pids").As<Napi::Array>();
+    for (uint32_t i = 0; i < ids.Length(); i++) {
+      Napi::Value id = ids[i];
+      if (!id.IsNumber()) return false;
+      filter->ids.insert(id.As<Napi::Number>().Uint32Value());
+    }
+  }
+
+  return true;
+}
+
+// Returns the session passed as the first argument, or null (with an exception pending) if it is not one or was closed
+static ProcessSession getSession(const Napi::CallbackInfo& args) {
+  if (args.Length() < 1 || !opaque::get<ProcessSession>(args[0])) {
+    memoryjs::throwError(args.Env(), "first argument must be a session");
+    return nullptr;
+  }
+
+  ProcessSession processSession = *opaque::get<ProcessSession>(args[0]);
+  if (!processSession) memoryjs::throwError(args.Env(), "the session is closed");
+
+  return processSession;
+}
+
+static Napi::Object toTarget(Napi::Env env, const session::Target& target) {
+  Napi::Object result = Napi::Object::New(env);
+
+  result.Set("th32ProcessID", Napi::Number::New(env, (int)target.process.th32ProcessID));
+  result.Set("szExeFile", Napi::String::New(env, target.process.szExeFile));
+  result.Set("handle", Napi::Number::New(env, (intptr_t)target.handle));
+  result.Set("alive", Napi::Boolean::New(env, target.alive));
+
+  return result;
+}
+
+// The result of a target in a session operation: the target, and its error or null
+static Napi::Object toOutcome(Napi::Env env, const session::Target& target, const char* error) {
+  Napi::Object result = toTarget(env, target);
+  result.Set("error", strcmp(error, "") ? Napi::String::New(env, error) : env.Null());
+  return result;
+}
+
+static Napi::Value openSessionImpl(const Napi::CallbackInfo& args, memoryjs::Mode mode) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 1 && args.Length() != 2) {
+    memoryjs::throwError(env, "requires 1 argument, or 2 arguments if a callback is being used");
+    return env.Null();
+  }
+
+  session::Filter filter;
+
+  if (!getSessionFilter(args[0], &filter)) {
+    memoryjs::throwError(env, "first argument must be an object of the form { names, pids }");
+    return env.Null();
+  }
+
+  if (mode == memoryjs::CALLBACK && !args[1].IsFunction()) {
+    memoryjs::throwError(env, "second argument must be a function");
+    return env.Null();
+  }
+
+  auto processSession = std::make_shared<session::Session>(filter);
+
+  auto execute = [=](char** errorMessage, const std::atomic<bool>&) { processSession->refresh(errorMessage); };
+
+  auto complete = [=](Napi::Env env) -> Napi::Value {
+    return opaque::wrap<ProcessSession>(env, processSession);
+  };
+
+  return memoryjs::run(args, mode, execute, complete);
+}
+
+Napi::Value openSession(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("openSession");
+  return openSessionImpl(args, args.Length() == 2 ? memoryjs::CALLBACK : memoryjs::SYNC);
+}
+
+Napi::Value openSessionAsync(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("openSessionAsync");
+  return openSessionImpl(args, memoryjs::PROMISE);
+}
+
+// Opens the processes that started matching since, drops the ones that exited and returns how many were added
+static Napi::Value refreshSessionImpl(const Napi::CallbackInfo& args, memoryjs::Mode mode) {
+  Napi::Env env = args.Env();
+  ProcessSession processSession = getSession(args);
+  if (!processSession) return env.Null();
+
+  if (mode == memoryjs::CALLBACK && !args[1].IsFunction()) {
+    memoryjs::throwError(env, "second argument must be a function");
+    return env.Null();
+  }
+
+  auto added = std::make_shared<size_t>(0);
+
+  auto execute = [=](char** errorMessage, const std::atomic<bool>&) {
+    *added = processSession->refresh(errorMessage);
+  };
+
+  auto complete = [=](Napi::Env env) -> Napi::Value { return Napi::Number::New(env, (double)*added); };
+
+  return memoryjs::run(args, mode, execute, complete);
+}
+
+Napi::Value refreshSession(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("refreshSession");
+  return refreshSessionImpl(args, args.Length() == 2 ? memoryjs::CALLBACK : memoryjs::SYNC);
+}
+
+Napi::Value refreshSessionAsync(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("refreshSessionAsync");
+  return refreshSessionImpl(args, memoryjs::PROMISE);
+}
+
+Napi::Value getSessionTargets(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("getSessionTargets");
+  Napi::Env env = args.Env();
+  ProcessSession processSession = getSession(args);
+  if (!processSession) return env.Null();
+
+  session::Targets targets = processSession->targets();
+  Napi::Array results = Napi::Array::New(env, targets.size());
+  for (uint32_t i = 0; i < targets.size(); i++) results[i] = toTarget(env, *targets[i]);
+
+  return results;
+}
+
+// Lets go of the targets. Their handles are closed as soon as no operation on the session is running.
+void closeSession(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("closeSession");
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 1 || !opaque::get<ProcessSession>(args[0])) {
+    memoryjs::throwError(env, "first argument must be a session");
+    return;
+  }
+
+  ProcessSession& processSession = *opaque::get<ProcessSession>(args[0]);
+  if (processSession) processSession->close();
+  processSession.reset();
+}
+
+// Reads the same values from every target, as readMemoryBatch does for one. A request may name a `module`, making
+// its address an offset from where that module is loaded in each target.
+static Napi::Value sessionReadBatchImpl(const Napi::CallbackInfo& args, memoryjs::Mode mode) {
+  Napi::Env env = args.Env();
+  ProcessSession processSession = getSession(args);
+  if (!processSession) return env.Null();
+
+  bool hasTail = mode != memoryjs::SYNC;
+
+  if (args.Length() != 2 + (size_t)hasTail || !args[1].IsArray()) {
+    memoryjs::throwError(env, "second argument must be an array of { address, type, module }");
+    return env.Null();
+  }
+
+  struct Request {
+    DWORD64 address;
+    datatype::Type type;
+    size_t module;  // index into `modules`, or npos for absolute addresses
+    size_t offset;  // of the value within a target's data
+  };
+
+  auto requests = std::make_shared<std::vector<Request>>();
+  auto modules = std::make_shared<std::vector<std::string>>();
+  const size_t npos = (size_t)-1;
+  size_t total = 0;
+
+  Napi::Array input = args[1].As<Napi::Array>();
+  for (uint32_t i = 0; i < input.Length(); i++) {
+    Napi::Value value = input[i];
+    if (!value.IsObject()) {
+      memoryjs::throwError(env, "every request must be an object of the form { address, type, module }");
+      return env.Null();
+    }
+
+    Napi::Object object = value.As<Napi::Object>();
+    Napi::Value name = object.Get("type");
+
+    if (!object.Get("address").IsNumber() || (object.Has("module") && !object.Get("module").IsString())) {
+      memoryjs::throwError(env, "every request must be an object of the form { address, type, module }");
+      return env.Null();
+    }
+
+    Request request = {(DWORD64)object.Get("address").As<Napi::Number>().Int64Value(), datatype::T_BYTE, npos, total};
+
+    if (!name.IsString() || !datatype::parse(name.As<Napi::String>().Utf8Value(), &request.type)) {
+      memoryjs::throwError(env, "unexpected data type");
+      return env.Null();
+    }
+
+    if (object.Has("module")) {
+      std::string module = object.Get("module").As<Napi::String>().Utf8Value();
+      request.module = std::find(modules->begin(), modules->end(), module) - modules->begin();
+      if (request.module == modules->size()) modules->push_back(module);
+    }
+
+    requests->push_back(request);
+    total += datatype::size(request.type);
+  }
+
+  // Large batches are split into several tasks per target, so that other targets get their turn in between
+  const size_t chunk = 4096;
+  size_t tasks = std::max<size_t>(1, (requests->size() + chunk - 1) / chunk);
+
+  auto targets = std::make_shared<session::Targets>(processSession->targets());
+  auto data = std::make_shared<std::vector<std::vector<unsigned char>>>(targets->size());
+  auto ok = std::make_shared<std::vector<std::vector<char>>>(targets->size());
+  auto errors = std::make_shared<std::vector<const char*>>();
+
+  auto execute = [=](char** errorMessage, const std::atomic<bool>& cancelled) {
+    for (size_t i = 0; i < targets->size(); i++) {
+      (*data)[i].resize(total);
+      (*ok)[i].assign(requests->size(), 0);
+    }
+
+    *errors = session::run(*targets, tasks, [&](size_t target, size_t task, char**) {
+      HANDLE handle = (*targets)[target]->handle;
+
+      // Modules a target has not loaded leave the values relative to them unread
+      std::vector<DWORD64> bases(modules->size(), 0);
+      for (size_t i = 0; i < modules->size(); i++) {
+        char* moduleError = "";
+        MODULEENTRY32 module;
+        if (addressmap::findModule(handle, (*modules)[i], &module, &moduleError)) {
+          bases[i] = (DWORD64)module.modBaseAddr;
+        }
+      }
+
+      size_t end = std::min(requests->size(), (task + 1) * chunk);
+      std::vector<size_t> indices;
+      std::vector<batch::Read> reads;
+
+      for (size_t i = task * chunk; i < end; i++) {
+        const Request& request = (*requests)[i];
+        if (request.module != npos && !bases[request.module]) continue;
+
+        DWORD64 base = request.module != npos ? bases[request.module] : 0;
+        unsigned char* buffer = (*data)[target].data() + request.offset;
+        reads.push_back({base + request.address, datatype::size(request.type), buffer, false});
+        indices.push_back(i);
+      }
+
+      batch::read(handle, reads);
+      for (size_t i = 0; i < reads.size(); i++) (*ok)[target][indices[i]] = reads[i].ok;
+    }, cancelled);
+    async::failIfCancelled(errorMessage, cancelled);
+  };
+
+  auto complete = [=](Napi::Env env) -> Napi::Value {
+    Napi::Array results = Napi::Array::New(env, targets->size());
+
+    for (uint32_t i = 0; i < targets->size(); i++) {
+      Napi::Object result = toOutcome(env, *(*targets)[i], (*errors)[i]);
+      Napi::Array values = Napi::Array::New(env, requests->size());
+
+      for (uint32_t j = 0; j < requests->size(); j++) {
+        const Request& request = (*requests)[j];
+        const unsigned char* value = (*data)[i].data() + request.offset;
+        values[j] = (*ok)[i][j] ? memoryjs::toValue(env, request.type, value) : env.Null();
+      }
+
+      result.Set("values", values);
+      results[i] = result;
+    }
+
+    return results;
+  };
+
+  return memoryjs::run(args, mode, execute, complete);
+}
+
+Napi::Value sessionReadBatch(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("sessionReadBatch");
+  return sessionReadBatchImpl(args, args[args.Length() - 1].IsFunction() ? memoryjs::CALLBACK : memoryjs::SYNC);
+}
+
+Napi::Value sessionReadBatchAsync(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("sessionReadBatchAsync");
+  return sessionReadBatchImpl(args, memoryjs::PROMISE);
+}
+
+// Runs findAll on every target
+static Napi::Value sessionFindAllImpl(const Napi::CallbackInfo& args, memoryjs::Mode mode) {
+  Napi::Env env = args.Env();
+  ProcessSession processSession = getSession(args);
+  if (!processSession) return env.Null();
+
+  size_t optionsIndex = 2;
+  bool hasTail = mode != memoryjs::SYNC;
+
+  if (args.Length() < optionsIndex + hasTail || args.Length() > optionsIndex + 1 + hasTail ||
+      (!args[1].IsString() && !opaque::get<pattern::Signature>(args[1]))) {
+    memoryjs::throwError(env, "second argument must be a signature");
+    return env.Null();
+  }
+
+  if (args.Length() > optionsIndex + hasTail && !args[optionsIndex].IsObject()) {
+    memoryjs::throwError(env, "third argument must be an object");
+    return env.Null();
+  }
+
+  auto compiled = std::make_shared<pattern::Signature>();
+  const pattern::Signature* signature = compiled.get();
+  memoryjs::Hold signatureHold;
+
+  if (args[1].IsExternal()) {
+    signature = opaque::get<pattern::Signature>(args[1]);
+    signatureHold = memoryjs::hold(args[1]);
+  } else {
+    *compiled = pattern::compile(args[1].As<Napi::String>().Utf8Value().c_str());
+  }
+
+  // Options: { protection, type, start, end, limit }, the limit applying to each target
+  region::Filter filter = region::all();
+  size_t limit = pattern::npos;
+
+  if (args.Length() > optionsIndex + hasTail) {
+    Napi::Object options = args[optionsIndex].As<Napi::Object>();
+
+    if (!memoryjs::getFilter(options, &filter) ||
+        (options.Has("limit") && !memoryjs::getSize(options.Get("limit"), SIZE_MAX, &limit))) {
+      memoryjs::throwError(env, "protection, type, start and end must be numbers, limit a non-negative integer");
+      return env.Null();
+    }
+  }
+
+  auto targets = std::make_shared<session::Targets>(processSession->targets());
+  auto addresses = std::make_shared<std::vector<std::vector<uintptr_t>>>(targets->size());
+  auto errors = std::make_shared<std::vector<const char*>>();
+
+  auto execute = [=](char** errorMessage, const std::atomic<bool>& cancelled) {
+    *errors = session::run(*targets, 1, [&](size_t target, size_t, char**) {
+      (*addresses)[target] = pattern::findAll((*targets)[target]->handle, *signature, filter, limit, &cancelled);
+    }, cancelled);
+    async::failIfCancelled(errorMessage, cancelled);
+  };
+
+  auto complete = [=](Napi::Env env) -> Napi::Value {
+    (void)compiled;
+    (void)signatureHold;
+
+    Napi::Array results = Napi::Array::New(env, targets->size());
+
+    for (uint32_t i = 0; i < targets->size(); i++) {
+      const std::vector<uintptr_t>& found = (*addresses)[i];
+      Napi::Float64Array matches = Napi::Float64Array::New(env, found.size());
+      for (size_t j = 0; j < found.size(); j++) matches[j] = (double)found[j];
+
+      Napi::Object result = toOutcome(env, *(*targets)[i], (*errors)[i]);
+      result.Set("addresses", matches);
+      results[i] = result;
+    }
+
+    return results;
+  };
+
+  return memoryjs::run(args, mode, execute, complete);
+}
+
+Napi::Value sessionFindAll(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("sessionFindAll");
+  return sessionFindAllImpl(args, args[args.Length() - 1].IsFunction() ? memoryjs::CALLBACK : memoryjs::SYNC);
+}
+
+Napi::Value sessionFindAllAsync(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("sessionFindAllAsync");
+  return sessionFindAllImpl(args, memoryjs::PROMISE);
+}
+
+// What JS holds of a subscription. One that is collected without being unwatched is stopped then, so that its thread
+// and its thread-safe function (which keeps the event loop alive) do not outlive every reference to it.
+struct Subscription {
+  explicit Subscription(std::shared_ptr<watch::Subscription> subscription) : subscription(subscription) {}
+  ~Subscription() { subscription->stop(); }
+
+  std::shared_ptr<watch::Subscription> subscription;
+};
+
+Napi::Value watchMemory(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("watchMemory");
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 4) {
+    memoryjs::throwError(env, "requires 4 arguments");
+    return env.Null();
+  }
+
+  if (!args[0].IsNumber() || !args[1].IsArray() || !args[2].IsObject() || !args[3].IsFunction()) {
+    memoryjs::throwError(env, "arguments must be a number, an array, an object and a function");
+    return env.Null();
+  }
+
+  HANDLE handle = memoryjs::getHandle(args[0]);
+  Napi::Array entries = args[1].As<Napi::Array>();
+  Napi::Object options = args[2].As<Napi::Object>();
+
+  // Each entry is { address, type }
+  std::vector<watch::Location> locations(entries.Length());
+
+  for (uint32_t i = 0; i < entries.Length(); i++) {
+    Napi::Value entry = entries.Get(i);
+
+    if (!entry.IsObject()) {
+      memoryjs::throwError(env, "every location must be an object with an address and a type");
+      return env.Null();
+    }
+
+    Napi::Object location = entry.As<Napi::Object>();
+    Napi::Value address = location.Get("address");
+    Napi::Value type = location.Get("type");
+
+    if (!address.IsNumber() || !type.IsString()) {
+      memoryjs::throwError(env, "every location must be an object with an address and a type");
+      return env.Null();
+    }
+
+    if (!datatype::parse(type.As<Napi::String>().Utf8Value(), &locations[i].type)) {
+      memoryjs::throwError(env, "unexpected data type");
+      return env.Null();
+    }
+
+    locations[i].address = address.As<Napi::Number>().Int64Value();
+  }
+
+  if (locations.empty()) {
+    memoryjs::throwError(env, "at least one location has to be watched");
+    return env.Null();
+  }
+
+  uint32_t interval = 100;
+  if (options.Has("intervalMs")) {
+    if (!options.Get("intervalMs").IsNumber()) {
+      memoryjs::throwError(env, "intervalMs must be a number");
+      return env.Null();
+    }
+
+    interval = std::max(1u, options.Get("intervalMs").As<Napi::Number>().Uint32Value());
+  }
+
+  // Called with ([{ index, address, value }], dropped), value is null if the location could not be read
+  auto deliver = [locations](Napi::Env env, Napi::Function callback, const std::vector<watch::Change>& changes,
+                             uint64_t dropped) {
+    Napi::Array results = Napi::Array::New(env, changes.size());
+
+    for (size_t i = 0; i < changes.size(); i++) {
+      const watch::Location& location = locations[changes[i].index];
+      Napi::Object change = Napi::Object::New(env);
+
+      change.Set("index", Napi::Number::New(env, (double)changes[i].index));
+      change.Set("address", Napi::Number::New(env, (double)location.address));
+
+      if (changes[i].readable) {
+        change.Set("value", memoryjs::toValue(env, location.type, (const unsigned char*)changes[i].value));
+      } else {
+        change.Set("value", env.Null());
+      }
+
+      results.Set(i, change);
+    }
+
+    callback.Call({results, Napi::Number::New(env, (double)dropped)});
+  };
+
+  return opaque::wrap<Subscription>(
+      env, watch::Subscription::start(env, args[3].As<Napi::Function>(), handle, locations, interval, deliver));
+}
+
+void unwatchMemory(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("unwatchMemory");
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 1 || !opaque::get<Subscription>(args[0])) {
+    memoryjs::throwError(env, "first argument must be a subscription");
+    return;
+  }
+
+  opaque::get<Subscription>(args[0])->subscription->stop();
+}
+
+Napi::Value createCancelToken(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("createCancelToken");
+  // Operations keep their own reference to the flag, so the token can be collected while they are still queued
+  return opaque::wrap<async::Token>(args.Env(), std::make_shared<std::atomic<bool>>(false));
+}
+
+void cancel(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("cancel");
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 1 || !opaque::get<async::Token>(args[0])) {
+    memoryjs::throwError(env, "first argument must be a cancel token");
+    return;
+  }
+
+  **opaque::get<async::Token>(args[0]) = true;
+}
+
+void setAsyncConcurrency(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("setAsyncConcurrency");
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 1 || !args[0].IsNumber()) {
+    memoryjs::throwError(env, "first argument must be a number");
+    return;
+  }
+
+  // 0 lets every operation run as soon as the thread pool has room for it
+  async::setConcurrency(env, args[0].As<Napi::Number>().Uint32Value());
+}
+
+Napi::Value getAsyncConcurrency(const Napi::CallbackInfo& args) {
+  MEMORYJS_STATS_CALL("getAsyncConcurrency");
+  return Napi::Number::New(args.Env(), (double)async::getConcurrency(args.Env()));
+}
+
+// The time under which `fraction` of the calls finished, in microseconds, as the upper bound of its histogram bucket
+static double percentile(const stats::Api& api, double fraction) {
+  uint64_t seen = 0;
+
+  for (size_t bucket = 0; bucket < stats::buckets; bucket++) {
+    seen += api.histogram[bucket];
+    if (seen >= fraction * api.calls) return (double)((uint64_t)1 << bucket) / 1000;
+  }
+
+  return (double)((uint64_t)1 << (stats::buckets - 1)) / 1000;
+}
+
+Napi::Value getStats(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+  stats::Totals totals = stats::get();
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("enabled", Napi::Boolean::New(env, stats::enabled()));
+  result.Set("syscalls", Napi::Number::New(env, (double)totals.syscalls));
+  result.Set("reads", Napi::Number::New(env, (double)totals.reads));
+  result.Set("bytesRead", Napi::Number::New(env, (double)totals.bytesRead));
+  result.Set("failedReads", Napi::Number::New(env, (double)totals.failedReads));
+  result.Set("partialReads", Napi::Number::New(env, (double)totals.partialReads));
+  result.Set("scanBytes", Napi::Number::New(env, (double)totals.scanBytes));
+
+  double scanSeconds = totals.scanNanoseconds / 1e9;
+  result.Set("scanSeconds", Napi::Number::New(env, scanSeconds));
+  result.Set("scanBytesPerSecond", Napi::Number::New(env, scanSeconds ? totals.scanBytes / scanSeconds : 0));
+  result.Set("pooledBytes", Napi::Number::New(env, (double)bufferpool::pooledBytes()));
+
+  Napi::Object apis = Napi::Object::New(env);
+  for (const stats::Api& api : totals.apis) {
+    Napi::Array histogram = Napi::Array::New(env, stats::buckets);
+    for (size_t bucket = 0; bucket < stats::buckets; bucket++) {
+      histogram.Set(bucket, Napi::Number::New(env, (double)api.histogram[bucket]));
+    }
+
+    Napi::Object entry = Napi::Object::New(env);
+    entry.Set("calls", Napi::Number::New(env, (double)api.calls));
+    entry.Set("totalMs", Napi::Number::New(env, api.nanoseconds / 1e6));
+    entry.Set("meanUs", Napi::Number::New(env, api.nanoseconds / 1e3 / api.calls));
+    entry.Set("p50Us", Napi::Number::New(env, percentile(api, 0.5)));
+    entry.Set("p90Us", Napi::Number::New(env, percentile(api, 0.9)));
+    entry.Set("p99Us", Napi::Number::New(env, percentile(api, 0.99)));
+    entry.Set("histogram", histogram);
+    apis.Set(api.name, entry);
+  }
+
+  result.Set("apis", apis);
+  return result;
+}
+
+void resetStats(const Napi::CallbackInfo&) {
+  stats::reset();
+}
+
+// Runs once for every environment the addon is loaded in, the main thread and each worker thread
+Napi::Object Init(Napi::Env env, Napi::Object exports) {
+  instance::init(env);
+
   exports.Set("openProcess", Napi::Function::New(env, openProcess));
   exports.Set("closeProcess", Napi::Function::New(env, closeProcess));
   exports.Set("getProcesses", Napi::Function::New(env, getProcesses));
   exports.Set("getModules", Napi::Function::New(env, getModules));
+  exports.Set("findModuleForAddress", Napi::Function::New(env, findModuleForAddress));
+  exports.Set("findRegion", Napi::Function::New(env, findRegion));
+  exports.Set("refreshAddressMap", Napi::Function::New(env, refreshAddressMap));
+  exports.Set("invalidateAddressMap", Napi::Function::New(env, invalidateAddressMap));
+  exports.Set("findSymbol", Napi::Function::New(env, findSymbol));
+  exports.Set("addressToSymbol", Napi::Function::New(env, addressToSymbol));
+  exports.Set("getModuleSymbols", Napi::Function::New(env, getModuleSymbols));
   exports.Set("readMemory", Napi::Function::New(env, readMemory));
+  exports.Set("readMemoryBatch", Napi::Function::New(env, readMemoryBatch));
+  exports.Set("readMemoryBatchAsync", Napi::Function::New(env, readMemoryBatchAsync));
+  exports.Set("readString", Napi::Function::New(env, readString));
+  exports.Set("readStringAsync", Napi::Function::New(env, readStringAsync));
   exports.Set("readBuffer", Napi::Function::New(env, readBuffer));
+  exports.Set("readBufferInto", Napi::Function::New(env, readBufferInto));
+  exports.Set("readBufferIntoAsync", Napi::Function::New(env, readBufferIntoAsync));
+  exports.Set("defineStruct", Napi::Function::New(env, defineStruct));
+  exports.Set("readStruct", Napi::Function::New(env, readStruct));
+  exports.Set("readStructAsync", Napi::Function::New(env, readStructAsync));
+  exports.Set("readStructArray", Napi::Function::New(env, readStructArray));
+  exports.Set("readStructArrayAsync", Napi::Function::New(env, readStructArrayAsync));
+  exports.Set("resolvePointerChain", Napi::Function::New(env, resolvePointerChain));
+  exports.Set("resolvePointerChainAsync", Napi::Function::New(env, resolvePointerChainAsync));
+  exports.Set("resolvePointerChains", Napi::Function::New(env, resolvePointerChains));
+  exports.Set("resolvePointerChainsAsync", Napi::Function::New(env, resolvePointerChainsAsync));
+  exports.Set("createPointerCache", Napi::Function::New(env, createPointerCache));
+  exports.Set("clearPointerCache", Napi::Function::New(env, clearPointerCache));
+  exports.Set("createPointerMap", Napi::Function::New(env, createPointerMap));
+  exports.Set("savePointerMap", Napi::Function::New(env, savePointerMap));
+  exports.Set("loadPointerMap", Napi::Function::New(env, loadPointerMap));
+  exports.Set("findPointerPaths", Napi::Function::New(env, findPointerPaths));
+  exports.Set("rescanPointerPaths", Napi::Function::New(env, rescanPointerPaths));
   exports.Set("findPattern", Napi::Function::New(env, findPattern));
+  exports.Set("findPatterns", Napi::Function::New(env, findPatterns));
+  exports.Set("findAll", Napi::Function::New(env, findAll));
+  exports.Set("compilePattern", Napi::Function::New(env, compilePattern));
+  exports.Set("setSignatureCache", Napi::Function::New(env, setSignatureCache));
+  exports.Set("flushSignatureCache", Napi::Function::New(env, flushSignatureCache));
+  exports.Set("clearSignatureCache", Napi::Function::New(env, clearSignatureCache));
+  exports.Set("getSignatureCacheStats", Napi::Function::New(env, getSignatureCacheStats));
+  exports.Set("setThreadCount", Napi::Function::New(env, setThreadCount));
+  exports.Set("getThreadCount", Napi::Function::New(env, getThreadCount));
+  exports.Set("createScanner", Napi::Function::New(env, createScanner));
+  exports.Set("firstScan", Napi::Function::New(env, firstScan));
+  exports.Set("nextScan", Napi::Function::New(env, nextScan));
+  exports.Set("getScanResults", Napi::Function::New(env, getScanResults));
+  exports.Set("findStrings", Napi::Function::New(env, findStrings));
+  exports.Set("getStringResults", Napi::Function::New(env, getStringResults));
+  exports.Set("dumpRegions", Napi::Function::New(env, dumpRegions));
+  exports.Set("openSnapshot", Napi::Function::New(env, openSnapshot));
+  exports.Set("createMirror", Napi::Function::New(env, createMirror));
+  exports.Set("updateMirror", Napi::Function::New(env, updateMirror));
+  exports.Set("applyMirror", Napi::Function::New(env, applyMirror));
+  exports.Set("getMirrorBuffer", Napi::Function::New(env, getMirrorBuffer));
+  exports.Set("getMirrorStats", Napi::Function::New(env, getMirrorStats));
+  exports.Set("shareRegions", Napi::Function::New(env, shareRegions));
+  exports.Set("configureSharedRegions", Napi::Function::New(env, configureSharedRegions));
+  exports.Set("stopSharedRegions", Napi::Function::New(env, stopSharedRegions));
+  exports.Set("openSession", Napi::Function::New(env, openSession));
+  exports.Set("refreshSession", Napi::Function::New(env, refreshSession));
+  exports.Set("getSessionTargets", Napi::Function::New(env, getSessionTargets));
+  exports.Set("closeSession", Napi::Function::New(env, closeSession));
+  exports.Set("sessionReadBatch", Napi::Function::New(env, sessionReadBatch));
+  exports.Set("sessionFindAll", Napi::Function::New(env, sessionFindAll));
+  exports.Set("watchMemory", Napi::Function::New(env, watchMemory));
+  exports.Set("unwatchMemory", Napi::Function::New(env, unwatchMemory));
+  exports.Set("openProcessAsync", Napi::Function::New(env, openProcessAsync));
+  exports.Set("getProcessesAsync", Napi::Function::New(env, getProcessesAsync));
+  exports.Set("getModulesAsync", Napi::Function::New(env, getModulesAsync));
+  exports.Set("readMemoryAsync", Napi::Function::New(env, readMemoryAsync));
+  exports.Set("readBufferAsync", Napi::Function::New(env, readBufferAsync));
+  exports.Set("findPatternAsync", Napi::Function::New(env, findPatternAsync));
+  exports.Set("findPatternsAsync", Napi::Function::New(env, findPatternsAsync));
+  exports.Set("findAllAsync", Napi::Function::New(env, findAllAsync));
+  exports.Set("firstScanAsync", Napi::Function::New(env, firstScanAsync));
+  exports.Set("nextScanAsync", Napi::Function::New(env, nextScanAsync));
+  exports.Set("dumpRegionsAsync", Napi::Function::New(env, dumpRegionsAsync));
+  exports.Set("findStringsAsync", Napi::Function::New(env, findStringsAsync));
+  exports.Set("createPointerMapAsync", Napi::Function::New(env, createPointerMapAsync));
+  exports.Set("findPointerPathsAsync", Napi::Function::New(env, findPointerPathsAsync));
+  exports.Set("rescanPointerPathsAsync", Napi::Function::New(env, rescanPointerPathsAsync));
+  exports.Set("openSessionAsync", Napi::Function::New(env, openSessionAsync));
+  exports.Set("refreshSessionAsync", Napi::Function::New(env, refreshSessionAsync));
+  exports.Set("sessionReadBatchAsync", Napi::Function::New(env, sessionReadBatchAsync));
+  exports.Set("sessionFindAllAsync", Napi::Function::New(env, sessionFindAllAsync));
+  exports.Set("createCancelToken", Napi::Function::New(env, createCancelToken));
+  exports.Set("cancel", Napi::Function::New(env, cancel));
+  exports.Set("setAsyncConcurrency", Napi::Function::New(env, setAsyncConcurrency));
+  exports.Set("getAsyncConcurrency", Napi::Function::New(env, getAsyncConcurrency));
+  exports.Set("getStats", Napi::Function::New(env, getStats));
+  exports.Set("resetStats", Napi::Function::New(env, resetStats));
   return exports;
 }
 
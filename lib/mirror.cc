@@ -0,0 +1,204 @@
+#include "mirror.h"
+
+#include <string.h>
+#include <algorithm>
+#include "cpu.h"
+#include "memory.h"
+
+namespace {
+const size_t pageSize = 0x1000;
+
+// Index of the first byte where `a` and `b` differ, or `size` if they do not.
+typedef size_t (*Mismatch)(const unsigned char* a, const unsigned char* b, size_t size);
+
+// Number of bytes where `a` and `b` differ.
+typedef size_t (*Count)(const unsigned char* a, const unsigned char* b, size_t size);
+
+size_t mismatchScalar(const unsigned char* a, const unsigned char* b, size_t size) {
+  size_t offset = 0;
+
+  for (; offset + 8 <= size; offset += 8) {
+    uint64_t x, y;
+    memcpy(&x, a + offset, 8);
+    memcpy(&y, b + offset, 8);
+    if (x != y) break;
+  }
+
+  for (; offset < size && a[offset] == b[offset]; offset++) {
+  }
+
+  return offset;
+}
+
+size_t countScalar(const unsigned char* a, const unsigned char* b, size_t size) {
+  size_t count = 0;
+  for (size_t i = 0; i < size; i++) count += a[i] != b[i];
+  return count;
+}
+
+#ifdef MEMORYJS_X86
+MEMORYJS_TARGET("sse2")
+size_t mismatchSSE2(const unsigned char* a, const unsigned char* b, size_t size) {
+  size_t offset = 0;
+
+  for (; offset + 16 <= size; offset += 16) {
+    __m128i equal = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(a + offset)),
+                                   _mm_loadu_si128((const __m128i*)(b + offset)));
+    uint32_t different = ~(uint32_t)_mm_movemask_epi8(equal) & 0xFFFF;
+    if (different) return offset + cpu::ctz(different);
+  }
+
+  return offset + mismatchScalar(a + offset, b + offset, size - offset);
+}
+
+MEMORYJS_TARGET("sse2")
+size_t countSSE2(const unsigned char* a, const unsigned char* b, size_t size) {
+  size_t count = 0;
+  size_t offset = 0;
+
+  for (; offset + 16 <= size; offset += 16) {
+    __m128i equal = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(a + offset)),
+                                   _mm_loadu_si128((const __m128i*)(b + offset)));
+    count += 16 - cpu::popcount((uint32_t)_mm_movemask_epi8(equal));
+  }
+
+  return count + countScalar(a + offset, b + offset, size - offset);
+}
+
+MEMORYJS_TARGET("avx2")
+size_t mismatchAVX2(const unsigned char* a, const unsigned char* b, size_t size) {
+  size_t offset = 0;
+
+  // Two vectors per iteration, most of a mirrored region is usually unchanged
+  for (; offset + 64 <= size; offset += 64) {
+    __m256i low = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(a + offset)),
+                                    _mm256_loadu_si256((const __m256i*)(b + offset)));
+    __m256i high = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(a + offset + 32)),
+                                     _mm256_loadu_si256((const __m256i*)(b + offset + 32)));
+    if ((uint32_t)_mm256_movemask_epi8(_mm256_and_si256(low, high)) == 0xFFFFFFFF) continue;
+
+    uint32_t different = ~(uint32_t)_mm256_movemask_epi8(low);
+    if (different) return offset + cpu::ctz(different);
+    return offset + 32 + cpu::ctz(~(uint32_t)_mm256_movemask_epi8(high));
+  }
+
+  for (; offset + 32 <= size; offset += 32) {
+    __m256i equal = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(a + offset)),
+                                      _mm256_loadu_si256((const __m256i*)(b + offset)));
+    uint32_t different = ~(uint32_t)_mm256_movemask_epi8(equal);
+    if (different) return offset + cpu::ctz(different);
+  }
+
+  return offset + mismatchScalar(a + offset, b + offset, size - offset);
+}
+
+MEMORYJS_TARGET("avx2")
+size_t countAVX2(const unsigned char* a, const unsigned char* b, size_t size) {
+  size_t count = 0;
+  size_t offset = 0;
+
+  for (; offset + 32 <= size; offset += 32) {
+    __m256i equal = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(a + offset)),
+                                      _mm256_loadu_si256((const __m256i*)(b + offset)));
+    count += 32 - cpu::popcount((uint32_t)_mm256_movemask_epi8(equal));
+  }
+
+  return count + countScalar(a + offset, b + offset, size - offset);
+}
+#endif
+
+struct Kernels {
+  Mismatch mismatch;
+  Count count;
+};
+
+const Kernels& kernels() {
+#ifdef MEMORYJS_X86
+  static const Kernels best = cpu::hasAVX2()   ? Kernels{mismatchAVX2, countAVX2}
+                              : cpu::hasSSE2() ? Kernels{mismatchSSE2, countSSE2}
+                                               : Kernels{mismatchScalar, countScalar};
+#else
+  static const Kernels best = {mismatchScalar, countScalar};
+#endif
+  return best;
+}
+}  // namespace
+
+size_t mirror::diff(const unsigned char* a, const unsigned char* b, size_t size, size_t granularity,
+                    std::vector<Span>& spans) {
+  const Kernels& kernel = kernels();
+  size_t changed = 0;
+  size_t offset = 0;
+
+  while (offset < size) {
+    offset += kernel.mismatch(a + offset, b + offset, size - offset);
+    if (offset == size) break;
+
+    // Widen the difference to its granule, then take in the granules after it until one is unchanged
+    size_t start = offset - offset % granularity;
+    size_t end = std::min(start + granularity, size);
+
+    while (end < size) {
+      size_t length = std::min(granularity, size - end);
+      if (kernel.mismatch(a + end, b + end, length) == length) break;
+      end += length;
+    }
+
+    changed += kernel.count(a + start, b + start, end - start);
+    spans.push_back({start, end - start});
+    offset = end;
+  }
+
+  return changed;
+}
+
+mirror::Mirror::Mirror(HANDLE handle, DWORD64 address, size_t size, size_t granularity)
+    : handle(handle),
+      address(address),
+      granularity(std::max<size_t>(granularity, 1)),
+      primed(false),
+      copy(size),
+      scratch(size),
+      counters() {}
+
+const std::vector<mirror::Span>& mirror::Mirror::update() {
+  size_t size = copy.size();
+  spans.clear();
+  counters.updates++;
+
+  SIZE_T bytesRead = memory::read(handle, address, scratch.data(), size);
+
+  // Read what can be read a page at a time, and keep the old bytes of the pages that cannot
+  if (bytesRead < size) {
+    bytesRead = 0;
+
+    for (size_t offset = 0; offset < size;) {
+      DWORD64 cursor = address + offset;
+      size_t chunk = std::min<size_t>(pageSize - (size_t)(cursor & (pageSize - 1)), size - offset);
+      SIZE_T got = memory::read(handle, cursor, &scratch[offset], chunk);
+
+      if (got < chunk) memcpy(&scratch[offset + got], &copy[offset + got], chunk - got);
+      bytesRead += got;
+      offset += chunk;
+    }
+  }
+
+  counters.bytesRead += bytesRead;
+
+  if (!primed) {
+    primed = true;
+    memcpy(copy.data(), scratch.data(), size);
+    counters.bytesTransferred += size;
+    if (size) spans.push_back({0, size});
+    return spans;
+  }
+
+  counters.bytesChanged += diff(copy.data(), scratch.data(), size, granularity, spans);
+
+  for (const Span& span : spans) {
+    memcpy(&copy[span.offset], &scratch[span.offset], span.length);
+    counters.bytesTransferred += span.length;
+  }
+
+  return spans;
+}
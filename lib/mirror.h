@@ -0,0 +1,65 @@
+#pragma once
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+
+#include <windows.h>
+#else
+#include "compat.h"
+#endif
+#include <stdint.h>
+#include <vector>
+
+// Keeping a local copy of a region of another process up to date, and telling which parts of it changed.
+//
+// Every update reads the whole region into a scratch buffer and compares it with the copy a granule at a time, so that
+// only the granules that changed are copied over and reported.
+namespace mirror {
+// A changed range of the mirrored region, in whole granules.
+struct Span {
+  size_t offset;
+  size_t length;
+};
+
+struct Stats {
+  uint64_t updates;
+  uint64_t bytesRead;         // from the target process
+  uint64_t bytesChanged;      // that differed from the copy
+  uint64_t bytesTransferred;  // copied into the copy, a granule at a time (everything on the first update)
+};
+
+// Appends the ranges where `a` and `b` differ to `spans`, widened to whole granules. Changed granules that follow each
+// other make one span. Returns the number of bytes that differ.
+size_t diff(const unsigned char* a, const unsigned char* b, size_t size, size_t granularity, std::vector<Span>& spans);
+
+class Mirror {
+ public:
+  Mirror(HANDLE handle, DWORD64 address, size_t size, size_t granularity);
+
+  // Reads the region again and brings the copy up to date. The first update reports the whole region as changed.
+  // Bytes that cannot be read keep their previous value.
+  const std::vector<Span>& update();
+
+  const unsigned char* data() const {
+    return copy.data();
+  }
+
+  size_t size() const {
+    return copy.size();
+  }
+
+  const Stats& stats() const {
+    return counters;
+  }
+
+ private:
+  HANDLE handle;
+  DWORD64 address;
+  size_t granularity;
+  bool primed;
+
+  std::vector<unsigned char> copy;  // never reallocated, JS may be viewing it
+  std::vector<unsigned char> scratch;
+  std::vector<Span> spans;
+  Stats counters;
+};
+}  // namespace mirror
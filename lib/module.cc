@@ -2,7 +2,11 @@
 
 #include <windows.h>
 #include <TlHelp32.h>
+#include <psapi.h>
+#include <string.h>
+#include <string>
 #include <vector>
+#include "memory.h"
 
 std::vector<MODULEENTRY32> module::getModules(DWORD processId, char** errorMessage) {
   // Take a snapshot of all modules inside a given process.
@@ -64,3 +68,90 @@ DWORD64 module::getBaseAddress(const char* processName, DWORD processId) {
   MODULEENTRY32 baseModule = module::findModule(processName, processId, &errorMessage);
   return (DWORD64)baseModule.modBaseAddr;
 }
+
+uint64_t module::getFingerprint(HANDLE hProcess) {
+  std::vector<HMODULE> modules(256);
+  DWORD needed = 0;
+
+  // Only lists module handles, without the snapshot getModules takes
+  while (true) {
+    DWORD size = (DWORD)(modules.size() * sizeof(HMODULE));
+    if (!EnumProcessModulesEx(hProcess, modules.data(), size, &needed, LIST_MODULES_ALL)) return 0;
+    if (needed <= size) break;
+    modules.resize(needed / sizeof(HMODULE));
+  }
+
+  // FNV-1a over the module handles, which are their base addresses
+  uint64_t hash = 14695981039346656037ULL;
+  const unsigned char* bytes = (const unsigned char*)modules.data();
+
+  for (DWORD i = 0; i < needed; i++) {
+    hash ^= bytes[i];
+    hash *= 1099511628211ULL;
+  }
+
+  return hash ? hash : 1;
+}
+
+bool module::getSymbols(HANDLE hProcess, const MODULEENTRY32& module, std::vector<Symbol>& symbols) {
+  DWORD64 base = (DWORD64)module.modBaseAddr;
+  IMAGE_DOS_HEADER dos;
+
+  if (memory::read(hProcess, base, &dos, sizeof(dos)) != sizeof(dos) || dos.e_magic != IMAGE_DOS_SIGNATURE) {
+    return false;
+  }
+
+  // The optional header of a 32-bit image (in a WOW64 process) is laid out differently, the data directories included
+  IMAGE_NT_HEADERS64 headers64;
+  IMAGE_NT_HEADERS32 headers32;
+  IMAGE_DATA_DIRECTORY directory;
+
+  if (memory::read(hProcess, base + dos.e_lfanew, &headers64, sizeof(headers64)) != sizeof(headers64) ||
+      headers64.Signature != IMAGE_NT_SIGNATURE) {
+    return false;
+  }
+
+  if (headers64.OptionalHeader.Magic == IMAGE_NT_OPTIONAL_HDR64_MAGIC) {
+    if (headers64.OptionalHeader.NumberOfRvaAndSizes <= IMAGE_DIRECTORY_ENTRY_EXPORT) return true;
+    directory = headers64.OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_EXPORT];
+  } else {
+    memcpy(&headers32, &headers64, sizeof(headers32));
+    if (headers32.OptionalHeader.NumberOfRvaAndSizes <= IMAGE_DIRECTORY_ENTRY_EXPORT) return true;
+    directory = headers32.OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_EXPORT];
+  }
+
+  if (!directory.VirtualAddress || directory.Size < sizeof(IMAGE_EXPORT_DIRECTORY)) return true;
+
+  // The linker places the address, name and ordinal tables and the names themselves inside the export directory, so
+  // one read gets all of them
+  std::vector<unsigned char> data(directory.Size);
+  if (memory::read(hProcess, base + directory.VirtualAddress, data.data(), data.size()) != data.size()) return false;
+
+  auto at = [&](DWORD rva, size_t size) -> const unsigned char* {
+    DWORD offset = rva - directory.VirtualAddress;
+    return rva >= directory.VirtualAddress && offset <= data.size() && data.size() - offset >= size ? &data[offset]
+                                                                                                    : nullptr;
+  };
+
+  const IMAGE_EXPORT_DIRECTORY* exports = (const IMAGE_EXPORT_DIRECTORY*)data.data();
+  const DWORD* functions = (const DWORD*)at(exports->AddressOfFunctions, exports->NumberOfFunctions * sizeof(DWORD));
+  const DWORD* names = (const DWORD*)at(exports->AddressOfNames, exports->NumberOfNames * sizeof(DWORD));
+  const WORD* ordinals = (const WORD*)at(exports->AddressOfNameOrdinals, exports->NumberOfNames * sizeof(WORD));
+  if (!functions || !names || !ordinals) return false;
+
+  for (DWORD i = 0; i < exports->NumberOfNames; i++) {
+    if (ordinals[i] >= exports->NumberOfFunctions) continue;
+
+    // Forwarded exports point at the name of the function they forward to, inside the directory, rather than code
+    DWORD rva = functions[ordinals[i]];
+    if (at(rva, 0)) continue;
+
+    const char* name = (const char*)at(names[i], 1);
+    if (!name) continue;
+
+    size_t length = strnlen(name, data.size() - (names[i] - directory.VirtualAddress));
+    symbols.push_back({std::string(name, length), rva, 0});
+  }
+
+  return true;
+}
@@ -1,12 +1,33 @@
 #pragma once
+#ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
 
 #include <windows.h>
 #include <TlHelp32.h>
+#else
+#include "compat.h"
+#endif
+#include <stdint.h>
+#include <string>
 #include <vector>
 
 namespace module {
+struct Symbol {
+  std::string name;
+  uint64_t offset;  // from the module's base address
+  uint64_t size;    // 0 if not known
+};
+
 std::vector<MODULEENTRY32> getModules(DWORD processId, char** errorMessage);
 MODULEENTRY32 findModule(const char* moduleName, DWORD processId, char** errorMessage);
 DWORD64 getBaseAddress(const char* processName, DWORD processId);
+
+// A hash of the process' loaded modules that changes whenever one is loaded or unloaded, and is much cheaper to get
+// than the modules themselves. 0 if it could not be computed.
+uint64_t getFingerprint(HANDLE hProcess);
+
+// Reads the functions and globals a module exports: the names in its export directory on Windows, the defined
+// functions and objects of its dynamic and static symbol tables on Linux. Returns false if the module's image could
+// not be parsed.
+bool getSymbols(HANDLE hProcess, const MODULEENTRY32& module, std::vector<Symbol>& symbols);
 }  // namespace module
@@ -0,0 +1,440 @@
+#include "module.h"
+
+#include <elf.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+#include "mapfile.h"
+#include "memory.h"
+#include "procfs.h"
+
+namespace {
+// The lowest address a module's segments are linked at. Symbol values minus this are offsets from the module's base.
+template <class Phdr>
+bool lowestLoad(const Phdr* headers, size_t count, uint64_t* lowest) {
+  *lowest = UINT64_MAX;
+
+  for (size_t i = 0; i < count; i++) {
+    if (headers[i].p_type == PT_LOAD) *lowest = std::min<uint64_t>(*lowest, headers[i].p_vaddr & ~(uint64_t)0xFFF);
+  }
+
+  return *lowest != UINT64_MAX;
+}
+
+// The GNU build id among the notes of a note segment, empty if there is none.
+std::string findBuildId(const unsigned char* notes, size_t size, size_t align) {
+  align = align == 8 ? 8 : 4;
+  auto aligned = [align](size_t value) { return (value + align - 1) & ~(align - 1); };
+
+  for (size_t at = 0; size - at >= sizeof(Elf64_Nhdr);) {
+    const Elf64_Nhdr* note = (const Elf64_Nhdr*)(notes + at);
+    size_t name = at + sizeof(Elf64_Nhdr);
+    if (note->n_namesz > size - name) break;
+
+    size_t desc = name + aligned(note->n_namesz);
+    if (desc > size || note->n_descsz > size - desc) break;
+
+    if (note->n_type == NT_GNU_BUILD_ID && note->n_namesz == 4 && !memcmp(notes + name, "GNU", 4)) {
+      return std::string((const char*)notes + desc, note->n_descsz);
+    }
+
+    at = desc + aligned(note->n_descsz);
+  }
+
+  return std::string();
+}
+
+// The build id of the module's file.
+template <class Phdr>
+std::string fileBuildId(const unsigned char* data, size_t size, const Phdr* headers, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    const Phdr& segment = headers[i];
+    if (segment.p_type != PT_NOTE || segment.p_offset > size || size - segment.p_offset < segment.p_filesz) continue;
+
+    std::string id = findBuildId(data + segment.p_offset, segment.p_filesz, segment.p_align);
+    if (!id.empty()) return id;
+  }
+
+  return std::string();
+}
+
+// The build id of the loaded image, empty if it has none or its headers cannot be read.
+template <class Ehdr, class Phdr>
+std::string imageBuildId(HANDLE hProcess, const MODULEENTRY32& module) {
+  uint64_t base = (uint64_t)module.modBaseAddr;
+  unsigned char page[0x1000];
+  size_t size = memory::read(hProcess, base, page, sizeof(page));
+
+  const Ehdr* header = (const Ehdr*)page;
+  if (size < sizeof(Ehdr) || header->e_phentsize != sizeof(Phdr) || header->e_phoff > size ||
+      (size - header->e_phoff) / sizeof(Phdr) < header->e_phnum) {
+    return std::string();
+  }
+
+  const Phdr* headers = (const Phdr*)(page + header->e_phoff);
+  uint64_t lowest;
+  if (!lowestLoad(headers, header->e_phnum, &lowest)) return std::string();
+
+  for (size_t i = 0; i < header->e_phnum; i++) {
+    const Phdr& segment = headers[i];
+    if (segment.p_type != PT_NOTE || segment.p_memsz > module.modBaseSize) continue;
+
+    std::vector<unsigned char> notes(segment.p_memsz);
+    notes.resize(memory::read(hProcess, base - lowest + segment.p_vaddr, notes.data(), notes.size()));
+
+    std::string id = findBuildId(notes.data(), notes.size(), segment.p_align);
+    if (!id.empty()) return id;
+  }
+
+  return std::string();
+}
+
+// Adds a symbol if it is a defined function or object. TLS symbols are offsets into a thread's block, not addresses.
+template <class Sym>
+void addSymbol(const Sym& symbol, const char* strings, size_t stringsSize, uint64_t lowest,
+               std::vector<module::Symbol>& symbols) {
+  unsigned type = symbol.st_info & 0xF;
+  if (type != STT_FUNC && type != STT_OBJECT && type != STT_GNU_IFUNC) return;
+  if (symbol.st_shndx == SHN_UNDEF || symbol.st_name == 0 || symbol.st_name >= stringsSize) return;
+  if (symbol.st_value < lowest) return;
+
+  const char* name = strings + symbol.st_name;
+  symbols.push_back({std::string(name, strnlen(name, stringsSize - symbol.st_name)), symbol.st_value - lowest,
+                     (uint64_t)symbol.st_size});
+}
+
+// Reads the symbol tables of the module's file, which has the static symbols too unless it was stripped. A file whose
+// build id is not the image's (`buildId`, empty if the image has none) is some other build, and left alone.
+template <class Ehdr, class Phdr, class Shdr, class Sym>
+bool fromFile(const unsigned char* data, size_t size, const std::string& buildId,
+              std::vector<module::Symbol>& symbols) {
+  const Ehdr* header = (const Ehdr*)data;
+  if (size < sizeof(Ehdr) || header->e_phentsize != sizeof(Phdr) || header->e_shentsize != sizeof(Shdr)) return false;
+  if (header->e_phoff > size || (size - header->e_phoff) / sizeof(Phdr) < header->e_phnum) return false;
+  if (!header->e_shoff || header->e_shoff > size || (size - header->e_shoff) / sizeof(Shdr) < header->e_shnum) {
+    return false;
+  }
+
+  const Phdr* headers = (const Phdr*)(data + header->e_phoff);
+  if (!buildId.empty() && fileBuildId(data, size, headers, header->e_phnum) != buildId) return false;
+
+  uint64_t lowest;
+  if (!lowestLoad(headers, header->e_phnum, &lowest)) return false;
+
+  const Shdr* sections = (const Shdr*)(data + header->e_shoff);
+  bool found = false;
+
+  for (size_t i = 0; i < header->e_shnum; i++) {
+    const Shdr& table = sections[i];
+    if ((table.sh_type != SHT_SYMTAB && table.sh_type != SHT_DYNSYM) || table.sh_link >= header->e_shnum) continue;
+
+    const Shdr& strings = sections[table.sh_link];
+    if (table.sh_offset > size || size - table.sh_offset < table.sh_size) continue;
+    if (strings.sh_offset > size || size - strings.sh_offset < strings.sh_size) continue;
+
+    const Sym* entries = (const Sym*)(data + table.sh_offset);
+    for (size_t j = 0; j < table.sh_size / sizeof(Sym); j++) {
+      addSymbol(entries[j], (const char*)data + strings.sh_offset, strings.sh_size, lowest, symbols);
+    }
+
+    found = true;
+  }
+
+  return found;
+}
+
+// Number of entries in the dynamic symbol table, which the GNU hash table only tells by walking the chain of its last
+// bucket to the end. The counts come from the target, so a table larger than the module (`limit`) is not believed.
+template <class Addr>
+size_t gnuHashCount(HANDLE hProcess, uint64_t table, size_t limit) {
+  uint32_t header[4];  // buckets, first hashed symbol, bloom filter words, bloom shift
+  if (memory::read(hProcess, table, header, sizeof(header)) != sizeof(header)) return 0;
+  if (header[0] > limit / sizeof(uint32_t)) return 0;
+
+  uint64_t bucketsAddress = table + sizeof(header) + (uint64_t)header[2] * sizeof(Addr);
+  std::vector<uint32_t> buckets(header[0]);
+  size_t bytes = buckets.size() * sizeof(uint32_t);
+  if (memory::read(hProcess, bucketsAddress, buckets.data(), bytes) != bytes) return 0;
+
+  uint32_t last = 0;
+  for (uint32_t bucket : buckets) last = std::max(last, bucket);
+  if (last < header[1]) return header[1];
+
+  uint64_t chain = bucketsAddress + bytes;
+  uint32_t values[256];
+
+  for (uint32_t index = last; index - last < 0x1000000;) {
+    size_t read = memory::read(hProcess, chain + (uint64_t)(index - header[1]) * 4, values, sizeof(values)) / 4;
+    if (!read) return 0;
+
+    for (size_t i = 0; i < read; i++, index++) {
+      if (values[i] & 1) return index + 1;
+    }
+  }
+
+  return 0;
+}
+
+// Reads the dynamic symbol table of the loaded image, for modules whose file cannot be read.
+template <class Ehdr, class Phdr, class Dyn, class Sym, class Addr>
+bool fromImage(HANDLE hProcess, const MODULEENTRY32& module, std::vector<module::Symbol>& symbols) {
+  uint64_t base = (uint64_t)module.modBaseAddr;
+  unsigned char page[0x1000];
+  size_t size = memory::read(hProcess, base, page, sizeof(page));
+
+  const Ehdr* header = (const Ehdr*)page;
+  if (size < sizeof(Ehdr) || header->e_phentsize != sizeof(Phdr) || header->e_phoff > size ||
+      (size - header->e_phoff) / sizeof(Phdr) < header->e_phnum) {
+    return false;
+  }
+
+  const Phdr* headers = (const Phdr*)(page + header->e_phoff);
+  uint64_t lowest;
+  if (!lowestLoad(headers, header->e_phnum, &lowest)) return false;
+
+  std::vector<Dyn> dynamic;
+  for (size_t i = 0; i < header->e_phnum; i++) {
+    if (headers[i].p_type != PT_DYNAMIC) continue;
+
+    dynamic.resize(std::min<uint64_t>(headers[i].p_memsz, module.modBaseSize) / sizeof(Dyn));
+    size_t bytes = dynamic.size() * sizeof(Dyn);
+    dynamic.resize(memory::read(hProcess, base - lowest + headers[i].p_vaddr, dynamic.data(), bytes) / sizeof(Dyn));
+  }
+
+  // The loader may have relocated the table's addresses in place, or not
+  auto locate = [&](uint64_t address) {
+    return address - base < module.modBaseSize ? address : base - lowest + address;
+  };
+
+  uint64_t symbolTable = 0, stringTable = 0, stringsSize = 0, hashTable = 0, gnuHashTable = 0;
+  for (const Dyn& entry : dynamic) {
+    if (entry.d_tag == DT_NULL) break;
+    if (entry.d_tag == DT_SYMTAB) symbolTable = locate(entry.d_un.d_ptr);
+    if (entry.d_tag == DT_STRTAB) stringTable = locate(entry.d_un.d_ptr);
+    if (entry.d_tag == DT_STRSZ) stringsSize = entry.d_un.d_val;
+    if (entry.d_tag == DT_HASH) hashTable = locate(entry.d_un.d_ptr);
+    if (entry.d_tag == DT_GNU_HASH) gnuHashTable = locate(entry.d_un.d_ptr);
+  }
+
+  if (!symbolTable || !stringTable || !stringsSize) return false;
+
+  // Only the hash tables tell how many symbols there are. The classic one has a chain entry per symbol.
+  size_t count = 0;
+  uint32_t counts[2];
+  if (gnuHashTable) {
+    count = gnuHashCount<Addr>(hProcess, gnuHashTable, module.modBaseSize);
+  } else if (hashTable && memory::read(hProcess, hashTable, counts, sizeof(counts)) == sizeof(counts)) {
+    count = counts[1];
+  }
+
+  // Neither table can be larger than the module they are in
+  if (count > module.modBaseSize / sizeof(Sym) || stringsSize > module.modBaseSize) return false;
+
+  std::vector<Sym> entries(count);
+  std::vector<char> strings(stringsSize);
+  if (memory::read(hProcess, symbolTable, entries.data(), count * sizeof(Sym)) != count * sizeof(Sym) ||
+      memory::read(hProcess, stringTable, strings.data(), strings.size()) != strings.size()) {
+    return false;
+  }
+
+  for (const Sym& entry : entries) addSymbol(entry, strings.data(), strings.size(), lowest, symbols);
+  return true;
+}
+
+// Where the module's file can be read as the process sees it, the most trusted first: the file mapped at the module's
+// base, which is the very file even if it was replaced or deleted since, then the path within the process' root, for
+// processes in another mount namespace or chroot.
+std::vector<std::string> filePaths(DWORD processId, const MODULEENTRY32& module) {
+  std::string directory = "/proc/" + std::to_string(processId);
+  std::vector<std::string> paths;
+  std::vector<procfs::Mapping> mappings;
+
+  if (procfs::readMaps(processId, mappings)) {
+    for (const procfs::Mapping& mapping : mappings) {
+      if (mapping.start != (uintptr_t)module.modBaseAddr) continue;
+
+      char range[64];
+      snprintf(range, sizeof(range), "%lx-%lx", (unsigned long)mapping.start, (unsigned long)mapping.end);
+      paths.push_back(directory + "/map_files/" + range);
+      break;
+    }
+  }
+
+  paths.push_back(directory + "/root" + module.szExePath);
+  return paths;
+}
+}  // namespace
+
+std::vector<MODULEENTRY32> module::getModules(DWORD processId, char** errorMessage) {
+  std::vector<MODULEENTRY32> modules;
+  std::vector<procfs::Mapping> mappings;
+
+  if (!procfs::readMaps(processId, mappings)) {
+    *errorMessage = "method failed to read the memory map of the process";
+    return modules;
+  }
+
+  // Modules are the files that have at least one executable mapping. A module spans from its lowest to its
+  // highest mapping, which covers every segment of the image including the gaps between them, and the anonymous
+  // mapping of its .bss.
+  std::map<std::string, size_t> indices;
+
+  for (auto& mapping : mappings) {
+    if (!mapping.execute || !procfs::isFileBacked(mapping) || indices.count(mapping.path)) continue;
+
+    indices[mapping.path] = modules.size();
+
+    MODULEENTRY32 mEntry;
+    memset(&mEntry, 0, sizeof(mEntry));
+    mEntry.dwSize = sizeof(mEntry);
+    mEntry.th32ProcessID = processId;
+    mEntry.GlblcntUsage = 1;
+    mEntry.ProccntUsage = 1;
+    strncpy(mEntry.szExePath, mapping.path.c_str(), sizeof(mEntry.szExePath) - 1);
+    strncpy(mEntry.szModule, procfs::basename(mapping.path).c_str(), sizeof(mEntry.szModule) - 1);
+
+    modules.push_back(mEntry);
+  }
+
+  std::vector<uintptr_t> starts(modules.size(), UINTPTR_MAX);
+  std::vector<uintptr_t> ends(modules.size(), 0);
+
+  const procfs::Mapping* previous = NULL;
+
+  for (auto& mapping : mappings) {
+    const procfs::Mapping* before = previous;
+    previous = &mapping;
+
+    auto index = indices.find(mapping.path);
+    if (index == indices.end()) {
+      // The .bss that does not fit the last page of the file is anonymous memory right after the module's last,
+      // writable mapping. Its statics are the module's as much as those in .data.
+      if (!before || !mapping.path.empty() || !mapping.write || mapping.shared || mapping.start != before->end ||
+          !before->write) {
+        continue;
+      }
+
+      auto owner = indices.find(before->path);
+      if (owner != indices.end() && ends[owner->second] == before->end) ends[owner->second] = mapping.end;
+      continue;
+    }
+
+    if (mapping.start < starts[index->second]) starts[index->second] = mapping.start;
+    if (mapping.end > ends[index->second]) ends[index->second] = mapping.end;
+  }
+
+  for (std::vector<MODULEENTRY32>::size_type i = 0; i != modules.size(); i++) {
+    modules[i].modBaseAddr = (BYTE*)starts[i];
+    modules[i].modBaseSize = (DWORD)(ends[i] - starts[i]);
+    modules[i].hModule = (HMODULE)starts[i];
+  }
+
+  if (modules.empty()) {
+    *errorMessage = "method failed to retrieve the first module";
+  }
+
+  return modules;
+}
+
+MODULEENTRY32 module::findModule(const char* moduleName, DWORD processId, char** errorMessage) {
+  MODULEENTRY32 module;
+  bool found = false;
+
+  std::vector<MODULEENTRY32> moduleEntries = getModules(processId, errorMessage);
+
+  // Loop over every module
+  for (std::vector<MODULEENTRY32>::size_type i = 0; i != moduleEntries.size(); i++) {
+    // Check to see if this is the module we want.
+    if (!strcmp(moduleEntries[i].szModule, moduleName)) {
+      module = moduleEntries[i];
+      found = true;
+      break;
+    }
+  }
+
+  if (!found) {
+    memset(&module, 0, sizeof(module));
+    *errorMessage = "unable to find module";
+  }
+
+  return module;
+}
+
+DWORD64 module::getBaseAddress(const char* processName, DWORD processId) {
+  char* errorMessage = "";
+  MODULEENTRY32 baseModule = module::findModule(processName, processId, &errorMessage);
+  return (DWORD64)baseModule.modBaseAddr;
+}
+
+uint64_t module::getFingerprint(HANDLE hProcess) {
+  std::string contents;
+  if (!procfs::readFile("/proc/" + std::to_string(GetProcessId(hProcess)) + "/maps", contents)) return 0;
+
+  // FNV-1a over the executable file mappings only, which are what getModules reports, so that the heap growing or
+  // memory being mapped does not change the fingerprint
+  uint64_t hash = 14695981039346656037ULL;
+  size_t lineStart = 0;
+
+  while (lineStart < contents.size()) {
+    size_t lineEnd = contents.find('\n', lineStart);
+    if (lineEnd == std::string::npos) lineEnd = contents.size();
+
+    size_t perms = contents.find(' ', lineStart);
+    bool executable = perms != std::string::npos && perms + 3 < lineEnd && contents[perms + 3] == 'x';
+    bool fileBacked = contents.find('/', lineStart) < lineEnd;
+
+    if (executable && fileBacked) {
+      for (size_t i = lineStart; i < lineEnd; i++) {
+        hash ^= (unsigned char)contents[i];
+        hash *= 1099511628211ULL;
+      }
+    }
+
+    lineStart = lineEnd + 1;
+  }
+
+  return hash ? hash : 1;
+}
+
+bool module::getSymbols(HANDLE hProcess, const MODULEENTRY32& module, std::vector<Symbol>& symbols) {
+  unsigned char ident[EI_NIDENT];
+  bool readable = memory::read(hProcess, (DWORD64)module.modBaseAddr, ident, sizeof(ident)) == sizeof(ident) &&
+                  !memcmp(ident, ELFMAG, SELFMAG);
+
+  std::string buildId;
+  if (readable && ident[EI_CLASS] == ELFCLASS64) {
+    buildId = imageBuildId<Elf64_Ehdr, Elf64_Phdr>(hProcess, module);
+  } else if (readable && ident[EI_CLASS] == ELFCLASS32) {
+    buildId = imageBuildId<Elf32_Ehdr, Elf32_Phdr>(hProcess, module);
+  }
+
+  for (const std::string& path : filePaths(GetProcessId(hProcess), module)) {
+    mapfile::Mapping mapping = mapfile::none();
+    bool parsed = false;
+
+    if (mapfile::map(path, mapping) && mapping.size > EI_CLASS && !memcmp(mapping.data, ELFMAG, SELFMAG)) {
+      if (mapping.data[EI_CLASS] == ELFCLASS64) {
+        parsed = fromFile<Elf64_Ehdr, Elf64_Phdr, Elf64_Shdr, Elf64_Sym>(mapping.data, mapping.size, buildId, symbols);
+      } else if (mapping.data[EI_CLASS] == ELFCLASS32) {
+        parsed = fromFile<Elf32_Ehdr, Elf32_Phdr, Elf32_Shdr, Elf32_Sym>(mapping.data, mapping.size, buildId, symbols);
+      }
+    }
+
+    mapfile::unmap(mapping);
+    if (parsed) return true;
+    symbols.clear();
+  }
+
+  if (!readable) return false;
+
+  if (ident[EI_CLASS] == ELFCLASS64) {
+    return fromImage<Elf64_Ehdr, Elf64_Phdr, Elf64_Dyn, Elf64_Sym, Elf64_Addr>(hProcess, module, symbols);
+  } else if (ident[EI_CLASS] == ELFCLASS32) {
+    return fromImage<Elf32_Ehdr, Elf32_Phdr, Elf32_Dyn, Elf32_Sym, Elf32_Addr>(hProcess, module, symbols);
+  }
+
+  return false;
+}
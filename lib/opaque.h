@@ -0,0 +1,52 @@
+#pragma once
+#include <napi.h>
+#include <stdint.h>
+#include <utility>
+
+// Native objects handed to JS as Externals (compiled patterns, scanners, sessions, ...). Each one is tagged with its
+// type, so that passing one where another kind is expected, or an External of another addon, is an error rather than
+// a cast to the wrong type.
+namespace opaque {
+const uint64_t magic = 0x736a79726f6d656dull;  // "memoryjs"
+
+struct Header {
+  uint64_t magic;
+  const void* kind;
+};
+
+// A distinct address for every type
+template <typename T>
+const void* kind() {
+  static const char tag = 0;
+  return &tag;
+}
+
+template <typename T>
+struct Box : Header {
+  T value;
+
+  template <typename... Args>
+  explicit Box(Args&&... args) : Header{opaque::magic, opaque::kind<T>()}, value(std::forward<Args>(args)...) {}
+};
+
+// Constructs a T owned by the returned External, and destroyed once it is garbage collected
+template <typename T, typename... Args>
+Napi::Value wrap(Napi::Env env, Args&&... args) {
+  Box<T>* box = new Box<T>(std::forward<Args>(args)...);
+  return Napi::External<Header>::New(env, box, [](Napi::Env, Header* header) {
+    header->magic = 0;
+    delete static_cast<Box<T>*>(header);
+  });
+}
+
+// The T inside `value`, or null if `value` is not an External made by wrap<T>
+template <typename T>
+T* get(Napi::Value value) {
+  if (!value.IsExternal()) return nullptr;
+
+  Header* header = value.As<Napi::External<Header>>().Data();
+  if (!header || header->magic != magic || header->kind != kind<T>()) return nullptr;
+
+  return &static_cast<Box<T>*>(header)->value;
+}
+}  // namespace opaque
@@ -1,44 +1,516 @@
 #include "pattern.h"
 
-#include <windows.h>
-#include <TlHelp32.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
 #include <vector>
+#include "cpu.h"
+#include "memory.h"
+#include "region.h"
+#include "sigcache.h"
+#include "stats.h"
+#include "threadpool.h"
 
 #define INRANGE(x, a, b) (x >= a && x <= b)
 #define getBits(x) (INRANGE(x, '0', '9') ? (x - '0') : ((x & (~0x20)) - 'A' + 0xa))
 #define getByte(x) (getBits(x[0]) << 4 | getBits(x[1]))
 
+namespace {
+// Number of offsets scanned by one task of a parallel scan. Buffers no larger than this are scanned inline.
+const size_t chunkSize = 0x100000;
+
+// The most common bytes in x86/x64 images, most common first. Anything not listed is considered rare.
+const unsigned char commonBytes[] = {
+    0x00, 0xFF, 0x48, 0x8B, 0x89, 0xCC, 0x0F, 0x24, 0x44, 0x4C, 0x01, 0xE8, 0x85, 0x83, 0x74, 0x08, 0xC0, 0x10,
+    0x20, 0x40, 0x45, 0x41, 0x8D, 0x75, 0x04, 0x90, 0xC3, 0x02, 0x03, 0x4D, 0x49, 0xEB, 0x5C, 0x50, 0x30, 0x18,
+    0x28, 0x38, 0x0C, 0x84, 0xE9, 0x33, 0xC7, 0x80, 0x15, 0x05, 0x06, 0x07, 0xF8, 0x3B,
+};
+
+// Lower is rarer.
+int commonness(unsigned char byte) {
+  static const std::vector<int> table = [] {
+    std::vector<int> table(256, 0);
+    for (size_t i = 0; i < sizeof(commonBytes); i++) table[commonBytes[i]] = (int)(sizeof(commonBytes) - i);
+    return table;
+  }();
+
+  return table[byte];
+}
+
+inline bool verify(const unsigned char* candidate, const pattern::Signature& signature) {
+  for (auto& run : signature.runs) {
+    if (memcmp(candidate + run.first, &signature.bytes[run.first], run.second)) return false;
+  }
+
+  return true;
+}
+
+size_t scanScalar(const unsigned char* data, size_t count, const pattern::Signature& signature) {
+  const unsigned char* anchor = data + signature.anchor;
+  const unsigned char value = signature.bytes[signature.anchor];
+
+  for (size_t offset = 0; offset < count;) {
+    auto found = (const unsigned char*)memchr(anchor + offset, value, count - offset);
+    if (!found) break;
+
+    offset = found - anchor;
+    if (verify(data + offset, signature)) return offset;
+    offset++;
+  }
+
+  return pattern::npos;
+}
+
+#ifdef MEMORYJS_X86
+MEMORYJS_TARGET("sse2")
+size_t scanSSE2(const unsigned char* data, size_t count, const pattern::Signature& signature) {
+  const unsigned char* anchor = data + signature.anchor;
+  const unsigned char* guard = data + signature.guard;
+  const __m128i anchorValue = _mm_set1_epi8((char)signature.bytes[signature.anchor]);
+  const __m128i guardValue = _mm_set1_epi8((char)signature.bytes[signature.guard]);
+
+  size_t offset = 0;
+  for (; offset + 16 <= count; offset += 16) {
+    __m128i anchors = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(anchor + offset)), anchorValue);
+    __m128i guards = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(guard + offset)), guardValue);
+    uint32_t candidates = (uint32_t)_mm_movemask_epi8(_mm_and_si128(anchors, guards));
+
+    while (candidates) {
+      size_t candidate = offset + cpu::ctz(candidates);
+      if (verify(data + candidate, signature)) return candidate;
+      candidates &= candidates - 1;
+    }
+  }
+
+  for (; offset < count; offset++) {
+    if (anchor[offset] == signature.bytes[signature.anchor] && verify(data + offset, signature)) return offset;
+  }
+
+  return pattern::npos;
+}
+
+MEMORYJS_TARGET("avx2")
+size_t scanAVX2(const unsigned char* data, size_t count, const pattern::Signature& signature) {
+  const unsigned char* anchor = data + signature.anchor;
+  const unsigned char* guard = data + signature.guard;
+  const __m256i anchorValue = _mm256_set1_epi8((char)signature.bytes[signature.anchor]);
+  const __m256i guardValue = _mm256_set1_epi8((char)signature.bytes[signature.guard]);
+
+  size_t offset = 0;
+  for (; offset + 32 <= count; offset += 32) {
+    __m256i anchors = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(anchor + offset)), anchorValue);
+    __m256i guards = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(guard + offset)), guardValue);
+    uint32_t candidates = (uint32_t)_mm256_movemask_epi8(_mm256_and_si256(anchors, guards));
+
+    while (candidates) {
+      size_t candidate = offset + cpu::ctz(candidates);
+      if (verify(data + candidate, signature)) return candidate;
+      candidates &= candidates - 1;
+    }
+  }
+
+  for (; offset < count; offset++) {
+    if (anchor[offset] == signature.bytes[signature.anchor] && verify(data + offset, signature)) return offset;
+  }
+
+  return pattern::npos;
+}
+#endif
+}  // namespace
+
+pattern::Signature pattern::compile(const char* pattern) {
+  Signature signature;
+
+  // Mirrors the way compareBytes walks the pattern: spaces are skipped, every '?' is one wildcard byte
+  // and every other pair of characters is one byte.
+  for (const char* p = pattern; *p;) {
+    if (*p == ' ') {
+      p++;
+      continue;
+    }
+
+    if (*p == '?') {
+      signature.bytes.push_back(0);
+      signature.mask.push_back(0);
+      p++;
+      continue;
+    }
+
+    signature.bytes.push_back((unsigned char)getByte(p));
+    signature.mask.push_back(0xFF);
+
+    if (!p[1]) break;
+    p += 2;
+  }
+
+  size_t anchorScore = 0;
+  bool anchored = false;
+
+  for (size_t i = 0; i < signature.mask.size(); i++) {
+    if (!signature.mask[i]) continue;
+
+    if (signature.runs.empty() || signature.runs.back().first + signature.runs.back().second != i) {
+      signature.runs.push_back({i, 0});
+    }
+    signature.runs.back().second++;
+
+    size_t score = commonness(signature.bytes[i]);
+    if (!anchored || score < anchorScore) {
+      signature.anchor = i;
+      anchorScore = score;
+      anchored = true;
+    }
+  }
+
+  signature.anchor = anchored ? signature.anchor : 0;
+
+  // The guard is the rarest byte that is not the anchor, which keeps both loads independent.
+  signature.guard = signature.anchor;
+  size_t guardScore = 0;
+  bool guarded = false;
+
+  for (size_t i = 0; i < signature.mask.size(); i++) {
+    if (!signature.mask[i] || i == signature.anchor) continue;
+
+    size_t score = commonness(signature.bytes[i]);
+    if (!guarded || score < guardScore) {
+      signature.guard = i;
+      guardScore = score;
+      guarded = true;
+    }
+  }
+
+  return signature;
+}
+
+size_t pattern::scan(const unsigned char* data, size_t size, const Signature& signature, Kernel kernel) {
+  size_t length = signature.bytes.size();
+  if (size < length) return npos;
+
+  // Number of offsets a match could start at.
+  size_t count = size - length + 1;
+
+  // A signature made of wildcards only matches anywhere.
+  if (signature.runs.empty()) return 0;
+
+#ifdef MEMORYJS_X86
+  if (kernel == KERNEL_AUTO) {
+    static const Kernel best = cpu::hasAVX2() ? KERNEL_AVX2 : cpu::hasSSE2() ? KERNEL_SSE2 : KERNEL_SCALAR;
+    kernel = best;
+  }
+
+  if (kernel == KERNEL_AVX2) return scanAVX2(data, count, signature);
+  if (kernel == KERNEL_SSE2) return scanSSE2(data, count, signature);
+#endif
+
+  return scanScalar(data, count, signature);
+}
+
+namespace {
+std::vector<size_t> scanManyRange(const unsigned char* data, size_t size,
+                                  const std::vector<const pattern::Signature*>& signatures, size_t maxStart) {
+  using pattern::npos;
+  using pattern::Signature;
+
+  std::vector<size_t> offsets(signatures.size(), npos);
+  size_t remaining = 0;
+
+  // Bucket the signatures by the value of their anchor byte, so every byte of the buffer is looked at once
+  // and only the signatures anchored on that value are verified there.
+  std::vector<size_t> buckets[256];
+
+  for (size_t i = 0; i < signatures.size(); i++) {
+    const Signature& signature = *signatures[i];
+    if (signature.bytes.size() > size) continue;
+
+    if (signature.runs.empty()) {
+      if (maxStart > 0) offsets[i] = 0;
+      continue;
+    }
+
+    buckets[signature.bytes[signature.anchor]].push_back(i);
+    remaining++;
+  }
+
+  for (size_t position = 0; position < size && remaining; position++) {
+    const std::vector<size_t>& bucket = buckets[data[position]];
+    if (bucket.empty()) continue;
+
+    for (size_t i : bucket) {
+      const Signature& signature = *signatures[i];
+      if (offsets[i] != npos || position < signature.anchor) continue;
+
+      size_t start = position - signature.anchor;
+      if (start >= maxStart || start + signature.bytes.size() > size) continue;
+
+      if (verify(data + start, signature)) {
+        offsets[i] = start;
+        remaining--;
+      }
+    }
+  }
+
+  return offsets;
+}
+}  // namespace
+
+size_t pattern::scanParallel(const unsigned char* data, size_t size, const Signature& signature, size_t maxStart) {
+  size_t length = signature.bytes.size();
+  if (size < length) return npos;
+
+  size_t count = std::min(size - length + 1, maxStart);
+  if (count == 0) return npos;
+
+  if (count <= chunkSize || threadpool::getThreads() == 1) return scan(data, count + length - 1, signature);
+
+  // Chunks are handed out in address order and each one overlaps the next by the signature length, so a match
+  // is always found by the chunk it starts in. Once a match is known, chunks that start after it are skipped.
+  std::atomic<size_t> first(npos);
+  size_t chunks = (count + chunkSize - 1) / chunkSize;
+
+  threadpool::parallelFor(chunks, [&](size_t chunk) {
+    size_t start = chunk * chunkSize;
+    if (start >= first) return;
+
+    size_t end = std::min(start + chunkSize, count);
+    size_t offset = scan(data + start, end - start + length - 1, signature);
+    if (offset == npos) return;
+
+    size_t found = start + offset;
+    size_t current = first;
+    while (found < current && !first.compare_exchange_weak(current, found)) {
+    }
+  });
+
+  return first;
+}
+
+std::vector<size_t> pattern::scanMany(const unsigned char* data, size_t size,
+                                      const std::vector<const Signature*>& signatures, size_t maxStart) {
+  size_t longest = 0;
+  for (auto signature : signatures) longest = std::max(longest, signature->bytes.size());
+
+  size_t count = std::min(size, maxStart);
+  if (count <= chunkSize || threadpool::getThreads() == 1) return scanManyRange(data, size, signatures, maxStart);
+
+  std::vector<size_t> offsets(signatures.size(), npos);
+  std::mutex mutex;
+  size_t chunks = (count + chunkSize - 1) / chunkSize;
+
+  threadpool::parallelFor(chunks, [&](size_t chunk) {
+    size_t start = chunk * chunkSize;
+    size_t end = std::min(start + chunkSize, count);
+
+    {
+      // Skip the chunk if every signature already matched before it.
+      std::lock_guard<std::mutex> lock(mutex);
+      bool resolved = true;
+      for (size_t offset : offsets) resolved = resolved && offset < start;
+      if (resolved) return;
+    }
+
+    size_t length = std::min(size - start, end - start + longest - 1);
+    std::vector<size_t> found = scanManyRange(data + start, length, signatures, end - start);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t i = 0; i < found.size(); i++) {
+      if (found[i] != npos && start + found[i] < offsets[i]) offsets[i] = start + found[i];
+    }
+  });
+
+  return offsets;
+}
+
+std::vector<size_t> pattern::scanAll(const unsigned char* data, size_t size, const Signature& signature,
+                                     size_t limit) {
+  std::vector<size_t> offsets;
+  size_t length = signature.bytes.size();
+  if (size < length || limit == 0) return offsets;
+
+  size_t count = size - length + 1;
+
+  // Each chunk collects its own matches, and the chunks are joined in address order afterwards.
+  size_t chunks = (count + chunkSize - 1) / chunkSize;
+  std::vector<std::vector<size_t>> found(chunks);
+  std::atomic<size_t> total(0);
+
+  auto scanChunk = [&](size_t chunk) {
+    // Chunks are handed out in order, so once the earlier chunks hold enough matches the rest can be skipped.
+    if (total >= limit) return;
+
+    size_t start = chunk * chunkSize;
+    size_t end = std::min(start + chunkSize, count);
+
+    for (size_t position = start; position < end && found[chunk].size() < limit;) {
+      size_t offset = scan(data + position, end - position + length - 1, signature);
+      if (offset == npos) break;
+
+      found[chunk].push_back(position + offset);
+      position += offset + 1;
+    }
+
+    total += found[chunk].size();
+  };
+
+  if (chunks == 1 || threadpool::getThreads() == 1) {
+    for (size_t chunk = 0; chunk < chunks; chunk++) scanChunk(chunk);
+  } else {
+    threadpool::parallelFor(chunks, scanChunk);
+  }
+
+  for (auto& chunk : found) {
+    for (size_t offset : chunk) {
+      if (offsets.size() == limit) return offsets;
+      offsets.push_back(offset);
+    }
+  }
+
+  return offsets;
+}
+
+namespace {
+// Applies the signature type and offsets to a match.
+uintptr_t resolve(HANDLE handle, uintptr_t moduleBase, uintptr_t match, short sigType, uintptr_t patternOffset,
+                  uintptr_t addressOffset) {
+  auto address = match + patternOffset;
+
+  /* read memory at pattern if flag is raised*/
+  if (sigType & pattern::ST_READ) memory::read(handle, address, &address, sizeof(uintptr_t));
+
+  /* subtract image base if flag is raised */
+  if (sigType & pattern::ST_SUBTRACT) address -= moduleBase;
+
+  return address + addressOffset;
+}
+
+// The readable regions making up a module.
+std::vector<MEMORY_BASIC_INFORMATION> moduleRegions(HANDLE handle, const MODULEENTRY32& module) {
+  region::Filter filter = region::all();
+  filter.start = uintptr_t(module.hModule);
+  filter.end = filter.start + module.modBaseSize;
+  return region::select(handle, filter);
+}
+}  // namespace
+
 /* based off Y3t1y3t's implementation */
 uintptr_t pattern::findPattern(HANDLE handle, MODULEENTRY32 module, const char* pattern, short sigType,
                                uintptr_t patternOffset, uintptr_t addressOffset) {
-  auto moduleSize = uintptr_t(module.modBaseSize);
-  auto moduleBase = uintptr_t(module.hModule);
+  return findPattern(handle, module, compile(pattern), sigType, patternOffset, addressOffset);
+}
 
-  auto moduleBytes = std::vector<unsigned char>(moduleSize);
-  ReadProcessMemory(handle, LPCVOID(moduleBase), &moduleBytes[0], moduleSize, nullptr);
-
-  auto byteBase = const_cast<unsigned char*>(&moduleBytes.at(0));
-  auto maxOffset = moduleSize - 0x1000;
+uintptr_t pattern::findPattern(HANDLE handle, MODULEENTRY32 module, const Signature& signature, short sigType,
+                               uintptr_t patternOffset, uintptr_t addressOffset, const std::atomic<bool>* cancelled) {
+  auto moduleBase = uintptr_t(module.hModule);
+  auto overlap = signature.bytes.empty() ? 0 : signature.bytes.size() - 1;
 
-  for (auto offset = 0UL; offset < maxOffset; ++offset) {
-    if (compareBytes(byteBase + offset, pattern)) {
-      auto address = moduleBase + offset + patternOffset;
+  uintptr_t match = 0;
+  bool found = sigcache::find(handle, module, signature, &match);
 
-      /* read memory at pattern if flag is raised*/
-      if (sigType & ST_READ) ReadProcessMemory(handle, LPCVOID(address), &address, sizeof(uintptr_t), nullptr);
+  // The module is streamed a window at a time, skipping pages that cannot be read.
+  if (!found) {
+    region::stream(handle, moduleRegions(handle, module), overlap,
+                   [&](DWORD64 address, const unsigned char* data, SIZE_T size) {
+                     MEMORYJS_STATS(stats::Scan scan(size));
+                     auto offset = scanParallel(data, size, signature);
+                     if (offset == npos) return true;
 
-      /* subtract image base if flag is raised */
-      if (sigType & ST_SUBTRACT) address -= moduleBase;
+                     match = uintptr_t(address + offset);
+                     found = true;
+                     return false;
+                   },
+                   cancelled);
 
-      return address + addressOffset;
-    }
+    if (found) sigcache::store(handle, module, signature, match);
   }
 
+  if (found) return resolve(handle, moduleBase, match, sigType, patternOffset, addressOffset);
+
   // the method that calls this will check to see if the value is -2
   // and throw a 'no match' error
   return -2;
 };
 
+std::vector<uintptr_t> pattern::findPatterns(HANDLE handle, MODULEENTRY32 module,
+                                             const std::vector<Request>& requests,
+                                             const std::atomic<bool>* cancelled) {
+  auto moduleBase = uintptr_t(module.hModule);
+  std::vector<uintptr_t> addresses(requests.size(), (uintptr_t)-2);
+
+  size_t longest = 0;
+  for (auto& request : requests) longest = std::max(longest, request.signature->bytes.size());
+
+  // Signatures that have not matched yet, and the request each of them belongs to.
+  std::vector<const Signature*> signatures;
+  std::vector<size_t> pending;
+
+  for (size_t i = 0; i < requests.size(); i++) {
+    const Request& request = requests[i];
+    uintptr_t match;
+
+    if (sigcache::find(handle, module, *request.signature, &match)) {
+      addresses[i] = resolve(handle, moduleBase, match, request.sigType, request.patternOffset, request.addressOffset);
+      continue;
+    }
+
+    signatures.push_back(request.signature);
+    pending.push_back(i);
+  }
+
+  if (signatures.empty()) return addresses;
+
+  region::stream(handle, moduleRegions(handle, module), longest ? longest - 1 : 0,
+                 [&](DWORD64 address, const unsigned char* data, SIZE_T size) {
+                   MEMORYJS_STATS(stats::Scan scan(size));
+                   std::vector<size_t> offsets = scanMany(data, size, signatures);
+
+                   std::vector<const Signature*> unmatched;
+                   std::vector<size_t> stillPending;
+
+                   for (size_t i = 0; i < offsets.size(); i++) {
+                     const Request& request = requests[pending[i]];
+
+                     if (offsets[i] == npos) {
+                       unmatched.push_back(signatures[i]);
+                       stillPending.push_back(pending[i]);
+                       continue;
+                     }
+
+                     uintptr_t match = uintptr_t(address + offsets[i]);
+                     sigcache::store(handle, module, *signatures[i], match);
+                     addresses[pending[i]] = resolve(handle, moduleBase, match, request.sigType,
+                                                     request.patternOffset, request.addressOffset);
+                   }
+
+                   signatures.swap(unmatched);
+                   pending.swap(stillPending);
+                   return !signatures.empty();
+                 },
+                 cancelled);
+
+  sigcache::flush();
+  return addresses;
+}
+
+std::vector<uintptr_t> pattern::findAll(HANDLE handle, const Signature& signature, const region::Filter& filter,
+                                        size_t limit, const std::atomic<bool>* cancelled) {
+  std::vector<uintptr_t> addresses;
+  auto overlap = signature.bytes.empty() ? 0 : signature.bytes.size() - 1;
+
+  region::stream(handle, region::select(handle, filter), overlap,
+                 [&](DWORD64 address, const unsigned char* data, SIZE_T size) {
+                   MEMORYJS_STATS(stats::Scan scan(size));
+                   for (size_t offset : scanAll(data, size, signature, limit - addresses.size())) {
+                     addresses.push_back(uintptr_t(address + offset));
+                   }
+
+                   return addresses.size() < limit;
+                 },
+                 cancelled);
+
+  return addresses;
+}
+
 bool pattern::compareBytes(const unsigned char* bytes, const char* pattern) {
   for (; *pattern; *pattern != ' ' ? ++bytes : bytes, ++pattern) {
     if (*pattern == ' ' || *pattern == '?') continue;
@@ -49,4 +521,4 @@ bool pattern::compareBytes(const unsigned char* bytes, const char* pattern) {
   }
 
   return true;
-}
\ No newline at end of file
+}
@@ -1,8 +1,17 @@
 #pragma once
+#ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
 
 #include <windows.h>
 #include <TlHelp32.h>
+#else
+#include "compat.h"
+#endif
+#include <stddef.h>
+#include <atomic>
+#include <utility>
+#include <vector>
+#include "region.h"
 
 namespace pattern {
 // Signature/pattern types
@@ -15,7 +24,61 @@ enum {
   ST_SUBTRACT = 0x2
 };
 
+// Scan kernels. KERNEL_AUTO picks the widest one the CPU supports.
+enum Kernel { KERNEL_AUTO, KERNEL_SCALAR, KERNEL_SSE2, KERNEL_AVX2 };
+
+// Returned by scan when there is no match.
+const size_t npos = (size_t)-1;
+
+// A signature parsed once into the bytes it matches. Every "XX" hex pair is a byte that must match
+// and every '?' is a single wildcard byte, the same as compareBytes.
+struct Signature {
+  std::vector<unsigned char> bytes;  // expected value of every byte (0 for wildcards)
+  std::vector<unsigned char> mask;   // 0xFF for bytes that must match, 0x00 for wildcards
+
+  // Runs of consecutive bytes that must match, as (offset, length) pairs. Candidates are verified run by run.
+  std::vector<std::pair<size_t, size_t>> runs;
+
+  size_t anchor;  // the rarest byte that must match, candidates are found by searching for it
+  size_t guard;   // a second byte that must match, checked alongside the anchor to thin out candidates
+};
+
+// One signature of a batch scan, along with how its match should be turned into an address.
+struct Request {
+  const Signature* signature;
+  short sigType;
+  uintptr_t patternOffset;
+  uintptr_t addressOffset;
+};
+
+Signature compile(const char* pattern);
+
+// Returns the offset of the first match within `data`, or npos.
+size_t scan(const unsigned char* data, size_t size, const Signature& signature, Kernel kernel = KERNEL_AUTO);
+
+// Same as scan, but large buffers are split into overlapping chunks that are scanned on the thread pool.
+// Matches must start before `maxStart`. Returns the lowest matching offset, or npos.
+size_t scanParallel(const unsigned char* data, size_t size, const Signature& signature, size_t maxStart = npos);
+
+// Finds the first match of every signature in a single pass over `data`, split across the thread pool.
+// Matches must start before `maxStart`. Returns one offset per signature, npos for the ones that did not match.
+std::vector<size_t> scanMany(const unsigned char* data, size_t size, const std::vector<const Signature*>& signatures,
+                             size_t maxStart = npos);
+
+// Finds every match in `data`, in address order, stopping after `limit` matches.
+std::vector<size_t> scanAll(const unsigned char* data, size_t size, const Signature& signature, size_t limit = npos);
+
 uintptr_t findPattern(HANDLE handle, MODULEENTRY32 module, const char* pattern, short sigType, uintptr_t patternOffset,
                       uintptr_t addressOffset);
+// Scans stop early, as if nothing else matched, once `cancelled` (if given) is set.
+uintptr_t findPattern(HANDLE handle, MODULEENTRY32 module, const Signature& signature, short sigType,
+                      uintptr_t patternOffset, uintptr_t addressOffset, const std::atomic<bool>* cancelled = nullptr);
+// Reads the module once and scans it for every request. Returns one address per request, -2 if it did not match.
+std::vector<uintptr_t> findPatterns(HANDLE handle, MODULEENTRY32 module, const std::vector<Request>& requests,
+                                    const std::atomic<bool>* cancelled = nullptr);
+// Scans every region that passes the filter and returns the address of every match, up to `limit` of them.
+// Regions are streamed through a fixed-size buffer, so memory use does not depend on the size of the target.
+std::vector<uintptr_t> findAll(HANDLE handle, const Signature& signature, const region::Filter& filter,
+                               size_t limit = npos, const std::atomic<bool>* cancelled = nullptr);
 bool compareBytes(const unsigned char* bytes, const char* pattern);
 }  // namespace pattern
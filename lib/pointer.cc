@@ -0,0 +1,100 @@
+#include "pointer.h"
+
+#include <stdint.h>
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "batch.h"
+
+bool pointer::Cache::find(DWORD64 address, DWORD64* value) const {
+  std::lock_guard<std::mutex> guard(lock);
+  auto link = links.find(address);
+  if (link == links.end()) return false;
+
+  *value = link->second;
+  return true;
+}
+
+void pointer::Cache::insert(DWORD64 address, DWORD64 value) {
+  std::lock_guard<std::mutex> guard(lock);
+  links[address] = value;
+}
+
+void pointer::Cache::clear() {
+  std::lock_guard<std::mutex> guard(lock);
+  links.clear();
+}
+
+size_t pointer::Cache::size() const {
+  std::lock_guard<std::mutex> guard(lock);
+  return links.size();
+}
+
+void pointer::resolve(HANDLE hProcess, const std::vector<Chain>& chains, Cache* cache,
+                      std::vector<DWORD64>& addresses, std::vector<bool>& resolved) {
+  addresses.resize(chains.size());
+  resolved.assign(chains.size(), true);
+
+  size_t levels = 0;
+  for (size_t i = 0; i < chains.size(); i++) {
+    addresses[i] = chains[i].base;
+    levels = std::max(levels, chains[i].offsets.size());
+  }
+
+  // The link each chain dereferences at the current level, and the read that fetches it.
+  std::vector<DWORD64> links(chains.size());
+  std::vector<size_t> slots(chains.size());
+
+  for (size_t level = 0; level + 1 < levels; level++) {
+    std::unordered_map<DWORD64, size_t> pending;
+    std::vector<batch::Read> reads;
+    std::vector<uintptr_t> values;
+
+    for (size_t i = 0; i < chains.size(); i++) {
+      if (!resolved[i] || level + 1 >= chains[i].offsets.size()) continue;
+
+      DWORD64 link = addresses[i] + chains[i].offsets[level];
+      DWORD64 value;
+      links[i] = link;
+      slots[i] = (size_t)-1;
+
+      if (cache && cache->find(link, &value)) {
+        addresses[i] = value;
+        continue;
+      }
+
+      auto read = pending.find(link);
+      if (read == pending.end()) {
+        read = pending.insert({link, reads.size()}).first;
+        reads.push_back({link, sizeof(uintptr_t), nullptr, false});
+      }
+
+      slots[i] = read->second;
+    }
+
+    if (reads.empty()) continue;
+
+    values.resize(reads.size());
+    for (size_t j = 0; j < reads.size(); j++) reads[j].buffer = &values[j];
+
+    batch::read(hProcess, reads);
+
+    for (size_t i = 0; i < chains.size(); i++) {
+      if (!resolved[i] || level + 1 >= chains[i].offsets.size() || slots[i] == (size_t)-1) continue;
+
+      const batch::Read& read = reads[slots[i]];
+      if (!read.ok) {
+        resolved[i] = false;
+        continue;
+      }
+
+      addresses[i] = values[slots[i]];
+      if (cache) cache->insert(links[i], addresses[i]);
+    }
+  }
+
+  for (size_t i = 0; i < chains.size(); i++) {
+    if (!chains[i].offsets.empty()) addresses[i] += chains[i].offsets.back();
+  }
+}
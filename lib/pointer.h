@@ -0,0 +1,41 @@
+#pragma once
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+
+#include <windows.h>
+#else
+#include "compat.h"
+#endif
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Following multi-level pointer paths such as [[[base + 0x10] + 0x48] + 0x8].
+namespace pointer {
+// Every offset but the last is added to the current address, which is then dereferenced. The last offset is added
+// to the final pointer without dereferencing it, so { base, [0x10, 0x48, 0x8] } is [[base + 0x10] + 0x48] + 0x8.
+struct Chain {
+  DWORD64 base;
+  std::vector<DWORD64> offsets;
+};
+
+// Pointers read while resolving chains, kept until cleared. Meant to live for one tick of the caller, since
+// nothing tells it when the target changes a pointer. Callback and promise forms may use it from several threads.
+class Cache {
+ public:
+  bool find(DWORD64 address, DWORD64* value) const;
+  void insert(DWORD64 address, DWORD64 value);
+  void clear();
+  size_t size() const;
+
+ private:
+  mutable std::mutex lock;
+  std::unordered_map<DWORD64, DWORD64> links;
+};
+
+// Resolves the chains level by level. Every distinct link of a level is read once, with a single batched read,
+// however many chains go through it. `cache` may be null.
+// Fills `addresses` with the final address of every chain and `resolved` with whether every link could be read.
+void resolve(HANDLE hProcess, const std::vector<Chain>& chains, Cache* cache, std::vector<DWORD64>& addresses,
+             std::vector<bool>& resolved);
+}  // namespace pointer
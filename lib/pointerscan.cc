@@ -0,0 +1,361 @@
+#include "pointerscan.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+#include "addressmap.h"
+#include "mapfile.h"
+#include "memory.h"
+#include "pointer.h"
+#include "threadpool.h"
+
+namespace {
+const char magic[8] = {'M', 'J', 'S', 'P', 'T', 'R', 'S', 0};
+const uint32_t version = 1;
+const size_t width = sizeof(uintptr_t);
+const size_t npos = (size_t)-1;
+
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t pointerSize;
+  uint64_t moduleCount;
+  uint64_t entryCount;
+};
+
+struct StoredModule {
+  uint64_t base;
+  uint64_t size;
+  char name[256];
+};
+
+struct Range {
+  DWORD64 start;
+  DWORD64 end;
+};
+
+struct Window {
+  DWORD64 address;
+  SIZE_T size;
+};
+
+// An address the search goes through: `offset` past where its pointer points is the address at index `next` of the
+// level before
+struct Node {
+  DWORD64 address;
+  size_t next;
+  DWORD64 offset;
+};
+
+bool byValue(const pointerscan::Entry& a, const pointerscan::Entry& b) {
+  return a.value < b.value || (a.value == b.value && a.address < b.address);
+}
+
+// Appends every aligned value in `data` that points into one of the readable ranges
+void collect(DWORD64 address, const unsigned char* data, size_t size, const std::vector<Range>& readable,
+             std::vector<pointerscan::Entry>& entries) {
+  DWORD64 low = readable.front().start;
+  DWORD64 high = readable.back().end;
+  const Range* last = &readable.front();
+
+  for (size_t offset = (width - address % width) % width; offset + width <= size; offset += width) {
+    uintptr_t value;
+    memcpy(&value, data + offset, width);
+
+    // Most values are not pointers at all, and pointers mostly point near the one before
+    if (value < low || value >= high) continue;
+
+    if (value - last->start >= last->end - last->start) {
+      auto next = std::upper_bound(readable.begin(), readable.end(), (DWORD64)value,
+                                   [](DWORD64 value, const Range& range) { return value < range.start; });
+      if (next == readable.begin() || value >= (next - 1)->end) continue;
+      last = &*(next - 1);
+    }
+
+    entries.push_back({(uint64_t)value, address + offset});
+  }
+}
+
+// The module an address is in, or null
+const pointerscan::Module* findModule(const std::vector<pointerscan::Module>& modules, DWORD64 address) {
+  auto next = std::upper_bound(
+      modules.begin(), modules.end(), address,
+      [](DWORD64 address, const pointerscan::Module& module) { return address < module.base; });
+  if (next == modules.begin() || address - (next - 1)->base >= (next - 1)->size) return nullptr;
+  return &*(next - 1);
+}
+}  // namespace
+
+pointerscan::Options pointerscan::defaults() {
+  Options options = {5, 0x1000, 10000, 1000000};
+  return options;
+}
+
+bool pointerscan::build(HANDLE hProcess, const region::Filter& filter, Map* map, char** errorMessage,
+                        const std::atomic<bool>* cancelled) {
+  map->modules.clear();
+  map->entries.clear();
+
+  char* moduleError = "";
+  std::shared_ptr<const addressmap::Snapshot> snapshot = addressmap::get(hProcess, false, &moduleError);
+  if (snapshot) {
+    for (const MODULEENTRY32& module : snapshot->modules) {
+      map->modules.push_back({(uint64_t)module.modBaseAddr, (uint64_t)module.modBaseSize, module.szModule});
+    }
+  }
+
+  // Pointers may point into any readable memory, not just the memory they are looked for in
+  std::vector<Range> readable;
+  for (const MEMORY_BASIC_INFORMATION& region : region::select(hProcess, region::all())) {
+    DWORD64 start = (DWORD64)region.BaseAddress;
+    DWORD64 end = start + region.RegionSize;
+
+    if (!readable.empty() && readable.back().end == start) {
+      readable.back().end = end;
+    } else {
+      readable.push_back({start, end});
+    }
+  }
+
+  if (readable.empty()) {
+    *errorMessage = "unable to read the regions of the process";
+    return false;
+  }
+
+  std::vector<Window> windows;
+  for (const MEMORY_BASIC_INFORMATION& region : region::select(hProcess, filter)) {
+    for (SIZE_T offset = 0; offset < region.RegionSize; offset += region::bufferSize) {
+      SIZE_T size = std::min(region::bufferSize, region.RegionSize - offset);
+      windows.push_back({(DWORD64)region.BaseAddress + offset, size});
+    }
+  }
+
+  // Each thread reads windows through its own buffer, taking the next one as it finishes
+  std::vector<std::vector<Entry>> found(windows.size());
+  std::atomic<size_t> next(0);
+
+  threadpool::parallelFor(std::min(threadpool::getThreads(), windows.size()), [&](size_t) {
+    std::vector<unsigned char> buffer(region::bufferSize);
+    size_t index;
+
+    while (!(cancelled && *cancelled) && (index = next++) < windows.size()) {
+      const Window& window = windows[index];
+      region::readFilled(hProcess, window.address, buffer.data(), window.size);
+      collect(window.address, buffer.data(), window.size, readable, found[index]);
+      std::sort(found[index].begin(), found[index].end(), byValue);
+    }
+  });
+
+  if (cancelled && *cancelled) return false;
+
+  // Every window was sorted on the thread pool, and pairs of them are merged there until one is left
+  while (found.size() > 1) {
+    std::vector<std::vector<Entry>> merged((found.size() + 1) / 2);
+
+    threadpool::parallelFor(merged.size(), [&](size_t i) {
+      if (i * 2 + 1 == found.size()) {
+        merged[i].swap(found[i * 2]);
+        return;
+      }
+
+      std::vector<Entry>& a = found[i * 2];
+      std::vector<Entry>& b = found[i * 2 + 1];
+      merged[i].resize(a.size() + b.size());
+      std::merge(a.begin(), a.end(), b.begin(), b.end(), merged[i].begin(), byValue);
+      std::vector<Entry>().swap(a);
+      std::vector<Entry>().swap(b);
+    });
+
+    found.swap(merged);
+  }
+
+  if (!found.empty()) map->entries.swap(found[0]);
+
+  return true;
+}
+
+bool pointerscan::save(const Map& map, const std::string& path, char** errorMessage) {
+  FILE* output = fopen(path.c_str(), "wb");
+  if (!output) {
+    *errorMessage = "unable to create the pointer map file";
+    return false;
+  }
+
+  Header header = {};
+  memcpy(header.magic, magic, sizeof(magic));
+  header.version = version;
+  header.pointerSize = (uint32_t)width;
+  header.moduleCount = map.modules.size();
+  header.entryCount = map.entries.size();
+
+  std::vector<StoredModule> modules(map.modules.size());
+  for (size_t i = 0; i < modules.size(); i++) {
+    modules[i].base = map.modules[i].base;
+    modules[i].size = map.modules[i].size;
+    strncpy(modules[i].name, map.modules[i].name.c_str(), sizeof(modules[i].name) - 1);
+  }
+
+  bool written = fwrite(&header, sizeof(header), 1, output) == 1 &&
+                 fwrite(modules.data(), sizeof(StoredModule), modules.size(), output) == modules.size() &&
+                 fwrite(map.entries.data(), sizeof(Entry), map.entries.size(), output) == map.entries.size();
+  written = fclose(output) == 0 && written;
+
+  if (!written) {
+    remove(path.c_str());
+    *errorMessage = "unable to write the pointer map file";
+    return false;
+  }
+
+  return true;
+}
+
+bool pointerscan::load(const std::string& path, Map* map, char** errorMessage) {
+  mapfile::Mapping mapping = mapfile::none();
+
+  if (!mapfile::map(path, mapping)) {
+    *errorMessage = "unable to open the pointer map file";
+    return false;
+  }
+
+  const Header* header = (const Header*)mapping.data;
+  size_t size = mapping.size;
+
+  bool valid = mapping.data && size >= sizeof(Header) && !memcmp(header->magic, magic, sizeof(magic)) &&
+               header->version == version && header->pointerSize == width &&
+               (size - sizeof(Header)) / sizeof(StoredModule) >= header->moduleCount;
+
+  size_t remaining = valid ? size - sizeof(Header) - (size_t)header->moduleCount * sizeof(StoredModule) : 0;
+  valid = valid && remaining / sizeof(Entry) >= header->entryCount;
+
+  if (valid) {
+    const StoredModule* modules = (const StoredModule*)(mapping.data + sizeof(Header));
+    const Entry* stored = (const Entry*)(modules + header->moduleCount);
+
+    map->modules.clear();
+    for (size_t i = 0; i < header->moduleCount; i++) {
+      std::string name(modules[i].name, strnlen(modules[i].name, sizeof(modules[i].name)));
+      map->modules.push_back({modules[i].base, modules[i].size, name});
+    }
+
+    map->entries.assign(stored, stored + header->entryCount);
+  }
+
+  mapfile::unmap(mapping);
+
+  if (!valid) {
+    *errorMessage = "the file is not a pointer map";
+    return false;
+  }
+
+  return true;
+}
+
+std::vector<pointerscan::Path> pointerscan::find(const Map& map, DWORD64 address, const Options& options,
+                                                 const std::atomic<bool>* cancelled) {
+  const size_t chunk = 1024;
+
+  // levels[0] holds the address itself, every level after it the pointers to just before an address of the last
+  std::vector<std::vector<Node>> levels(1, std::vector<Node>(1, {address, npos, 0}));
+  std::vector<std::pair<size_t, Node>> statics;
+
+  for (size_t depth = 1; depth <= options.depth && statics.size() < options.limit; depth++) {
+    const std::vector<Node>& current = levels.back();
+    if (current.empty() || (cancelled && *cancelled)) break;
+
+    size_t chunks = (current.size() + chunk - 1) / chunk;
+    std::vector<std::vector<Node>> nodes(chunks);
+    std::vector<std::vector<Node>> found(chunks);
+
+    threadpool::parallelFor(chunks, [&](size_t index) {
+      if (cancelled && *cancelled) return;
+
+      for (size_t i = index * chunk; i < std::min(current.size(), (index + 1) * chunk); i++) {
+        DWORD64 target = current[i].address;
+        Entry low = {target - std::min(target, options.maxOffset), 0};
+        auto entry = std::lower_bound(map.entries.begin(), map.entries.end(), low, byValue);
+
+        for (; entry != map.entries.end() && entry->value <= target; ++entry) {
+          Node node = {entry->address, i, target - entry->value};
+
+          // A path ends at the first pointer stored in a module, going on would only make it longer
+          if (findModule(map.modules, entry->address)) {
+            found[index].push_back(node);
+          } else {
+            nodes[index].push_back(node);
+          }
+        }
+      }
+    });
+
+    for (const std::vector<Node>& chunkFound : found) {
+      for (const Node& node : chunkFound) statics.push_back({depth, node});
+    }
+
+    levels.emplace_back();
+    for (const std::vector<Node>& chunkNodes : nodes) {
+      size_t room = options.maxNodes - std::min(options.maxNodes, levels.back().size());
+      levels.back().insert(levels.back().end(), chunkNodes.begin(),
+                           chunkNodes.begin() + std::min(room, chunkNodes.size()));
+    }
+  }
+
+  if (statics.size() > options.limit) statics.resize(options.limit);
+
+  std::vector<Path> paths(statics.size());
+
+  for (size_t i = 0; i < statics.size(); i++) {
+    size_t depth = statics[i].first;
+    Node node = statics[i].second;
+    const Module* module = findModule(map.modules, node.address);
+
+    paths[i].module = module->name;
+    paths[i].offsets.push_back(node.address - module->base);
+
+    while (depth > 0) {
+      paths[i].offsets.push_back(node.offset);
+      depth--;
+      if (depth > 0) node = levels[depth][node.next];
+    }
+  }
+
+  return paths;
+}
+
+std::vector<size_t> pointerscan::rescan(HANDLE hProcess, const std::vector<Path>& paths, DWORD64 address) {
+  std::unordered_map<std::string, DWORD64> bases;
+  std::vector<pointer::Chain> chains;
+  std::vector<size_t> indices;
+
+  for (size_t i = 0; i < paths.size(); i++) {
+    if (paths[i].offsets.empty()) continue;
+
+    auto base = bases.find(paths[i].module);
+    if (base == bases.end()) {
+      char* moduleError = "";
+      MODULEENTRY32 module;
+      DWORD64 found = addressmap::findModule(hProcess, paths[i].module, &module, &moduleError)
+                          ? (DWORD64)module.modBaseAddr
+                          : 0;
+      base = bases.insert({paths[i].module, found}).first;
+    }
+
+    // Paths through a module the process has not loaded cannot lead anywhere
+    if (!base->second) continue;
+
+    chains.push_back({base->second, paths[i].offsets});
+    indices.push_back(i);
+  }
+
+  std::vector<DWORD64> addresses;
+  std::vector<bool> resolved;
+  pointer::resolve(hProcess, chains, nullptr, addresses, resolved);
+
+  std::vector<size_t> matches;
+  for (size_t i = 0; i < chains.size(); i++) {
+    if (resolved[i] && addresses[i] == address) matches.push_back(indices[i]);
+  }
+
+  return matches;
+}
@@ -0,0 +1,71 @@
+#pragma once
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+
+#include <windows.h>
+#include <TlHelp32.h>
+#else
+#include "compat.h"
+#endif
+#include <stdint.h>
+#include <atomic>
+#include <string>
+#include <vector>
+#include "region.h"
+
+// Finding pointer paths from a module to an address, which keep leading to what lives there after the target restarts
+// and its dynamic allocations move.
+//
+// A pointer map records every aligned pointer-sized value in the target's memory that points into readable memory,
+// sorted by where it points so that the pointers to just before an address are found with a binary search. Paths are
+// searched backwards from the address, level by level, until they reach a pointer stored in a module. Paths found in
+// one run of the target are narrowed down to the stable ones by rescanning them in the next.
+namespace pointerscan {
+struct Entry {
+  uint64_t value;    // where the pointer points
+  uint64_t address;  // where the pointer is stored
+};
+
+struct Module {
+  uint64_t base;
+  uint64_t size;
+  std::string name;
+};
+
+struct Map {
+  std::vector<Module> modules;  // sorted by base address
+  std::vector<Entry> entries;   // sorted by value, then address
+};
+
+struct Options {
+  size_t depth;        // most pointers a path follows
+  uint64_t maxOffset;  // largest offset added to a pointer
+  size_t limit;        // most paths returned
+  size_t maxNodes;     // most addresses searched at each level, the rest are left out
+};
+
+Options defaults();
+
+// Read like a pointer::Chain based at the module: offsets[0] is where the first pointer is stored in the module, and
+// every offset but the last is added and then dereferenced.
+struct Path {
+  std::string module;
+  std::vector<DWORD64> offsets;
+};
+
+// Reads the regions that pass the filter, split across the thread pool, and records the pointers found in them.
+// Stops early, returning false, once `cancelled` (if given) is set.
+bool build(HANDLE hProcess, const region::Filter& filter, Map* map, char** errorMessage,
+           const std::atomic<bool>* cancelled = nullptr);
+
+bool save(const Map& map, const std::string& path, char** errorMessage);
+bool load(const std::string& path, Map* map, char** errorMessage);
+
+// Returns the paths that lead to `address`, shortest first. Every level of the search is split across the thread pool.
+std::vector<Path> find(const Map& map, DWORD64 address, const Options& options,
+                       const std::atomic<bool>* cancelled = nullptr);
+
+// Follows the paths in a process, which may have restarted since they were found, and returns the index of every path
+// that still leads to `address`.
+std::vector<size_t> rescan(HANDLE hProcess, const std::vector<Path>& paths, DWORD64 address);
+}  // namespace pointerscan
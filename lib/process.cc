@@ -60,6 +60,15 @@ void process::closeProcess(HANDLE hProcess) {
   CloseHandle(hProcess);
 }
 
+HANDLE process::openProcess(const PROCESSENTRY32& process) {
+  return OpenProcess(PROCESS_ALL_ACCESS, FALSE, process.th32ProcessID);
+}
+
+bool process::isAlive(HANDLE hProcess) {
+  // A process handle is signaled once the process exits
+  return WaitForSingleObject(hProcess, 0) == WAIT_TIMEOUT;
+}
+
 std::vector<PROCESSENTRY32> process::getProcesses(char** errorMessage) {
   // Take a snapshot of all processes.
   HANDLE hProcessSnapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, NULL);
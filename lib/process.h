@@ -1,8 +1,14 @@
 #pragma once
+#ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
 
 #include <windows.h>
 #include <TlHelp32.h>
+#else
+#include "compat.h"
+#endif
+#include <set>
+#include <string>
 #include <vector>
 
 namespace process {
@@ -15,4 +21,15 @@ Pair openProcess(const char* processName, char** errorMessage);
 Pair openProcess(DWORD processId, char** errorMessage);
 void closeProcess(HANDLE hProcess);
 std::vector<PROCESSENTRY32> getProcesses(char** errorMessage);
+
+// Every process whose executable is named in `names` or whose id is in `ids`, from a single list of the processes.
+std::vector<PROCESSENTRY32> findProcesses(const std::set<std::string>& names, const std::set<DWORD>& ids,
+                                          char** errorMessage);
+
+// Opens a process that getProcesses or findProcesses returned, without listing the processes again. Returns NULL if
+// it cannot be opened.
+HANDLE openProcess(const PROCESSENTRY32& process);
+
+// False once the process has exited.
+bool isAlive(HANDLE hProcess);
 }  // namespace process
@@ -0,0 +1,19 @@
+#include "process.h"
+
+#include <set>
+#include <string>
+#include <vector>
+
+// The parts of the process backend that are the same on every platform, built on the platform's getProcesses.
+
+std::vector<PROCESSENTRY32> process::findProcesses(const std::set<std::string>& names, const std::set<DWORD>& ids,
+                                                   char** errorMessage) {
+  std::vector<PROCESSENTRY32> processes = getProcesses(errorMessage);
+  std::vector<PROCESSENTRY32> matches;
+
+  for (const PROCESSENTRY32& entry : processes) {
+    if (names.count(entry.szExeFile) || ids.count(entry.th32ProcessID)) matches.push_back(entry);
+  }
+
+  return matches;
+}
@@ -0,0 +1,205 @@
+#include "process.h"
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "procfs.h"
+
+namespace {
+// What the opens of a pid recorded about the process, and how many of them have not been closed yet
+struct Opened {
+  unsigned long long startTime;
+  size_t count;
+};
+
+// Never destroyed, as handles may still be closed while the statics are torn down
+std::mutex& openedLock = *new std::mutex();
+std::map<pid_t, Opened>& opened = *new std::map<pid_t, Opened>();
+
+// Reads the state and the start time (in clock ticks since boot) from /proc/<pid>/stat. The start time tells the
+// process apart from a later one given the same pid. Returns false if the process has gone away.
+bool readStatus(pid_t pid, char* state, unsigned long long* startTime) {
+  std::string stat;
+  if (!procfs::readFile("/proc/" + std::to_string(pid) + "/stat", stat)) return false;
+
+  size_t nameEnd = stat.rfind(')');
+  if (nameEnd == std::string::npos) return false;
+
+  const char* format = " %c %*d %*d %*d %*d %*d %*u %*lu %*lu %*lu %*lu %*lu %*lu %*ld %*ld %*ld %*ld %*ld %*ld %llu";
+  return sscanf(stat.c_str() + nameEnd + 1, format, state, startTime) == 2;
+}
+
+// Records another open of `pid`. Returns false if the process has gone away.
+bool track(pid_t pid) {
+  char state;
+  unsigned long long startTime;
+  if (!readStatus(pid, &state, &startTime)) return false;
+
+  std::lock_guard<std::mutex> guard(openedLock);
+  Opened& entry = opened[pid];
+
+  // A pid that was given to a new process while still open stands for the new process from now on
+  entry.startTime = startTime;
+  entry.count++;
+  return true;
+}
+
+// Fills in a process entry from /proc/<pid>. Returns false if the process has gone away.
+bool readProcess(pid_t pid, PROCESSENTRY32* pEntry) {
+  std::string directory = "/proc/" + std::to_string(pid);
+  std::string stat;
+
+  if (!procfs::readFile(directory + "/stat", stat)) return false;
+
+  // The process name is wrapped in parentheses and may itself contain spaces or parentheses,
+  // so the remaining fields are parsed from after the last closing parenthesis.
+  size_t nameEnd = stat.rfind(')');
+  if (nameEnd == std::string::npos) return false;
+
+  char state;
+  int ppid;
+  long priority, nice, threads;
+  const char* format = " %c %d %*d %*d %*d %*d %*u %*lu %*lu %*lu %*lu %*lu %*lu %*ld %*ld %ld %ld %ld";
+  if (sscanf(stat.c_str() + nameEnd + 1, format, &state, &ppid, &priority, &nice, &threads) != 5) {
+    return false;
+  }
+
+  memset(pEntry, 0, sizeof(*pEntry));
+  pEntry->dwSize = sizeof(*pEntry);
+  pEntry->th32ProcessID = pid;
+  pEntry->th32ParentProcessID = ppid;
+  pEntry->cntThreads = threads;
+  pEntry->pcPriClassBase = nice;
+
+  // Prefer the executable's file name, which is what module::getModules reports for the main image.
+  // The link is only readable for our own processes (or with ptrace rights), so fall back to the
+  // (possibly truncated) command name otherwise.
+  char exe[MAX_PATH];
+  ssize_t length = readlink((directory + "/exe").c_str(), exe, sizeof(exe) - 1);
+
+  std::string name;
+  if (length > 0) {
+    exe[length] = '\0';
+    name = procfs::basename(exe);
+
+    const std::string deleted = " (deleted)";
+    if (name.size() > deleted.size() && name.compare(name.size() - deleted.size(), deleted.size(), deleted) == 0) {
+      name.resize(name.size() - deleted.size());
+    }
+  } else {
+    size_t nameStart = stat.find('(');
+    name = stat.substr(nameStart + 1, nameEnd - nameStart - 1);
+  }
+
+  strncpy(pEntry->szExeFile, name.c_str(), sizeof(pEntry->szExeFile) - 1);
+  return true;
+}
+}  // namespace
+
+process::Pair process::openProcess(const char* processName, char** errorMessage) {
+  PROCESSENTRY32 process;
+  HANDLE handle = NULL;
+
+  // A list of processes (PROCESSENTRY32)
+  std::vector<PROCESSENTRY32> processes = getProcesses(errorMessage);
+
+  for (std::vector<PROCESSENTRY32>::size_type i = 0; i != processes.size(); i++) {
+    // Check to see if this is the process we want.
+    if (!strcmp(processes[i].szExeFile, processName) && track(processes[i].th32ProcessID)) {
+      handle = (HANDLE)(uintptr_t)processes[i].th32ProcessID;
+      process = processes[i];
+      break;
+    }
+  }
+
+  if (handle == NULL) {
+    memset(&process, 0, sizeof(process));
+    *errorMessage = "unable to find process";
+  }
+
+  return {
+      handle,
+      process,
+  };
+}
+
+process::Pair process::openProcess(DWORD processId, char** errorMessage) {
+  PROCESSENTRY32 process;
+  HANDLE handle = NULL;
+
+  // There is nothing to open on Linux, the process id is used as the handle.
+  if (processId != 0 && readProcess(processId, &process) && track(processId)) {
+    handle = (HANDLE)(uintptr_t)processId;
+  }
+
+  if (handle == NULL) {
+    memset(&process, 0, sizeof(process));
+    *errorMessage = "unable to find process";
+  }
+
+  return {
+      handle,
+      process,
+  };
+}
+
+void process::closeProcess(HANDLE hProcess) {
+  // Handles are process ids, so there is nothing to release but what the open recorded
+  std::lock_guard<std::mutex> guard(openedLock);
+
+  auto entry = opened.find((pid_t)(uintptr_t)hProcess);
+  if (entry != opened.end() && --entry->second.count == 0) opened.erase(entry);
+}
+
+HANDLE process::openProcess(const PROCESSENTRY32& process) {
+  if (!track(process.th32ProcessID)) return NULL;
+  return (HANDLE)(uintptr_t)process.th32ProcessID;
+}
+
+bool process::isAlive(HANDLE hProcess) {
+  pid_t pid = (pid_t)(uintptr_t)hProcess;
+
+  // An exited process that was not reaped yet still has an entry, in the zombie state
+  char state;
+  unsigned long long startTime;
+  if (!readStatus(pid, &state, &startTime) || state == 'Z') return false;
+
+  // Once reaped, the pid may be given to a new process, which started later than the one that was opened
+  std::lock_guard<std::mutex> guard(openedLock);
+  auto entry = opened.find(pid);
+  return entry == opened.end() || entry->second.startTime == startTime;
+}
+
+std::vector<PROCESSENTRY32> process::getProcesses(char** errorMessage) {
+  std::vector<PROCESSENTRY32> processes;
+
+  DIR* directory = opendir("/proc");
+  if (directory == NULL) {
+    *errorMessage = "method failed to open /proc";
+    return processes;
+  }
+
+  struct dirent* entry;
+  while ((entry = readdir(directory)) != NULL) {
+    char* end;
+    long pid = strtol(entry->d_name, &end, 10);
+    if (*end != '\0' || pid <= 0) continue;
+
+    PROCESSENTRY32 pEntry;
+    if (readProcess(pid, &pEntry)) processes.push_back(pEntry);
+  }
+
+  closedir(directory);
+
+  if (processes.empty()) {
+    *errorMessage = "method failed to retrieve the first process";
+  }
+
+  return processes;
+}
@@ -0,0 +1,88 @@
+#include "procfs.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+bool procfs::readFile(const std::string& path, std::string& contents) {
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return false;
+
+  // /proc files report a size of 0, so read until EOF.
+  char chunk[4096];
+  contents.clear();
+
+  while (true) {
+    ssize_t count = read(fd, chunk, sizeof(chunk));
+    if (count <= 0) break;
+    contents.append(chunk, count);
+  }
+
+  close(fd);
+  return true;
+}
+
+bool procfs::readMaps(pid_t pid, std::vector<Mapping>& mappings) {
+  std::string contents;
+  if (!readFile("/proc/" + std::to_string(pid) + "/maps", contents)) return false;
+
+  mappings.clear();
+
+  // Each line looks like:
+  // 55d0c9a00000-55d0c9a02000 r-xp 00002000 08:01 1048602                    /usr/bin/cat
+  size_t lineStart = 0;
+  while (lineStart < contents.size()) {
+    size_t lineEnd = contents.find('\n', lineStart);
+    if (lineEnd == std::string::npos) lineEnd = contents.size();
+
+    std::string line = contents.substr(lineStart, lineEnd - lineStart);
+    lineStart = lineEnd + 1;
+
+    unsigned long long start, end, offset, inode;
+    char perms[5];
+    int pathOffset = 0;
+
+    if (sscanf(line.c_str(), "%llx-%llx %4s %llx %*x:%*x %llu %n", &start, &end, perms, &offset, &inode,
+               &pathOffset) < 5) {
+      continue;
+    }
+
+    Mapping mapping;
+    mapping.start = start;
+    mapping.end = end;
+    mapping.read = perms[0] == 'r';
+    mapping.write = perms[1] == 'w';
+    mapping.execute = perms[2] == 'x';
+    mapping.shared = perms[3] == 's';
+    mapping.offset = offset;
+    mapping.inode = inode;
+
+    if (pathOffset > 0 && (size_t)pathOffset < line.size()) {
+      mapping.path = line.substr(pathOffset);
+
+      // Files that were replaced or removed after being mapped are suffixed by the kernel.
+      const std::string deleted = " (deleted)";
+      if (mapping.path.size() > deleted.size() &&
+          mapping.path.compare(mapping.path.size() - deleted.size(), deleted.size(), deleted) == 0) {
+        mapping.path.resize(mapping.path.size() - deleted.size());
+      }
+    }
+
+    mappings.push_back(mapping);
+  }
+
+  return true;
+}
+
+bool procfs::isFileBacked(const Mapping& mapping) {
+  return mapping.inode != 0 && !mapping.path.empty() && mapping.path[0] == '/' &&
+         strncmp(mapping.path.c_str(), "/dev/", 5) != 0;
+}
+
+std::string procfs::basename(const std::string& path) {
+  size_t slash = path.find_last_of('/');
+  return slash == std::string::npos ? path : path.substr(slash + 1);
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Helpers for reading the Linux /proc filesystem, shared by the memory, module and process backends.
+namespace procfs {
+struct Mapping {
+  uintptr_t start;
+  uintptr_t end;
+  bool read;
+  bool write;
+  bool execute;
+  bool shared;
+  uint64_t offset;
+  uint64_t inode;
+  std::string path;
+};
+
+// Parses /proc/<pid>/maps. Returns false if the file could not be opened.
+bool readMaps(pid_t pid, std::vector<Mapping>& mappings);
+
+// Reads a whole /proc file into a string. Returns false if the file could not be opened.
+bool readFile(const std::string& path, std::string& contents);
+
+// True if the mapping is backed by a regular file (as opposed to anonymous memory, [heap], [stack], etc).
+bool isFileBacked(const Mapping& mapping);
+
+// Returns the final component of a path.
+std::string basename(const std::string& path);
+}  // namespace procfs
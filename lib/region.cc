@@ -0,0 +1,135 @@
+#include "region.h"
+
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include "memory.h"
+#include "snapshot.h"
+
+namespace {
+const SIZE_T pageSize = 0x1000;
+
+const DWORD readableProtections = PAGE_READONLY | PAGE_READWRITE | PAGE_WRITECOPY | PAGE_EXECUTE_READ |
+                                  PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY;
+
+// Reads a page at a time, stopping at the first page that cannot be read. Returns the number of bytes read.
+SIZE_T readPages(HANDLE hProcess, DWORD64 address, unsigned char* buffer, SIZE_T size) {
+  SIZE_T total = 0;
+
+  while (total < size) {
+    DWORD64 cursor = address + total;
+    SIZE_T chunk = std::min<DWORD64>(pageSize - (cursor & (pageSize - 1)), size - total);
+    SIZE_T bytesRead = memory::read(hProcess, cursor, buffer + total, chunk);
+
+    total += bytesRead;
+    if (bytesRead < chunk) break;
+  }
+
+  return total;
+}
+}  // namespace
+
+region::Filter region::all() {
+  return {0, 0, 0, ~(DWORD64)0};
+}
+
+bool region::isReadable(const MEMORY_BASIC_INFORMATION& region) {
+  if (region.State != MEM_COMMIT) return false;
+  if (region.Protect & (PAGE_GUARD | PAGE_NOACCESS)) return false;
+  return (region.Protect & readableProtections) != 0;
+}
+
+void region::readFilled(HANDLE hProcess, DWORD64 address, unsigned char* buffer, SIZE_T size) {
+  if (memory::read(hProcess, address, buffer, size) == size) return;
+
+  for (SIZE_T offset = 0; offset < size; offset += pageSize) {
+    SIZE_T chunk = std::min(pageSize, size - offset);
+    SIZE_T bytesRead = memory::read(hProcess, address + offset, buffer + offset, chunk);
+    memset(buffer + offset + bytesRead, 0, chunk - bytesRead);
+  }
+}
+
+std::vector<MEMORY_BASIC_INFORMATION> region::select(HANDLE hProcess, const Filter& filter) {
+  std::vector<MEMORY_BASIC_INFORMATION> selected;
+  DWORD types = filter.type ? filter.type : MEM_IMAGE | MEM_PRIVATE | MEM_MAPPED;
+
+  for (auto region : memory::getRegions(hProcess, filter.start, filter.end)) {
+    if (!isReadable(region)) continue;
+    if (filter.protect && !(region.Protect & filter.protect)) continue;
+    if (!(region.Type & types)) continue;
+
+    DWORD64 start = std::max((DWORD64)region.BaseAddress, filter.start);
+    DWORD64 end = std::min((DWORD64)region.BaseAddress + region.RegionSize, filter.end);
+    if (start >= end) continue;
+
+    region.BaseAddress = (PVOID)start;
+    region.RegionSize = (SIZE_T)(end - start);
+    selected.push_back(region);
+  }
+
+  return selected;
+}
+
+bool region::stream(HANDLE hProcess, const std::vector<MEMORY_BASIC_INFORMATION>& regions, SIZE_T overlap,
+                    const Visitor& visit, const std::atomic<bool>* cancelled) {
+  SIZE_T capacity = std::max(bufferSize, (overlap + pageSize) * 2);
+  std::vector<unsigned char> buffer;
+
+  // Held so that a dump closed during the stream stays mapped under its views
+  std::shared_ptr<const void> dump = snapshot::owns(hProcess) ? snapshot::retain(hProcess) : nullptr;
+
+  size_t i = 0;
+  while (i < regions.size()) {
+    // Adjacent regions are streamed as one run, so matches that straddle a region boundary are still seen.
+    DWORD64 address = (DWORD64)regions[i].BaseAddress;
+    DWORD64 end = address + regions[i].RegionSize;
+    for (i++; i < regions.size() && (DWORD64)regions[i].BaseAddress == end; i++) end += regions[i].RegionSize;
+
+    // Dumped memory is passed straight from the mapping, in windows of the same size and overlap
+    const unsigned char* view = dump ? snapshot::view(hProcess, address, (SIZE_T)(end - address)) : nullptr;
+
+    if (view) {
+      for (DWORD64 offset = 0;; offset += capacity - overlap) {
+        if (cancelled && *cancelled) return false;
+
+        SIZE_T size = (SIZE_T)std::min<DWORD64>(capacity, end - address - offset);
+        if (!visit(address + offset, view + offset, size)) return false;
+        if (address + offset + size >= end) break;
+      }
+
+      continue;
+    }
+
+    if (buffer.empty()) buffer.resize(capacity);
+
+    // Bytes at the start of the buffer carried over from the previous window.
+    SIZE_T carried = 0;
+
+    while (address < end) {
+      if (cancelled && *cancelled) return false;
+
+      SIZE_T wanted = (SIZE_T)std::min<DWORD64>(capacity - carried, end - address);
+      SIZE_T bytesRead = memory::read(hProcess, address, buffer.data() + carried, wanted);
+
+      // Part of the window is unreadable, read it again page by page to salvage what comes before the bad page.
+      if (bytesRead < wanted) bytesRead = readPages(hProcess, address, buffer.data() + carried, wanted);
+
+      SIZE_T size = carried + bytesRead;
+      if (bytesRead && !visit(address - carried, buffer.data(), size)) return false;
+
+      address += bytesRead;
+
+      if (bytesRead < wanted) {
+        // Skip the page that failed and start a fresh window after it.
+        address = (address & ~(DWORD64)(pageSize - 1)) + pageSize;
+        carried = 0;
+        continue;
+      }
+
+      carried = std::min(overlap, size);
+      memmove(buffer.data(), buffer.data() + size - carried, carried);
+    }
+  }
+
+  return true;
+}
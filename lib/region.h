@@ -0,0 +1,46 @@
+#pragma once
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+
+#include <windows.h>
+#else
+#include "compat.h"
+#endif
+#include <atomic>
+#include <functional>
+#include <vector>
+
+// Selecting memory regions and streaming their contents through a fixed-size buffer, so that scanning
+// a whole process never needs more memory than the buffer.
+namespace region {
+// Size of the buffer regions are streamed through.
+const SIZE_T bufferSize = 0x400000;
+
+struct Filter {
+  DWORD protect;  // the region's protection must have one of these flags (0 for any readable protection)
+  DWORD type;     // the region's type must be one of these (0 for MEM_IMAGE, MEM_PRIVATE and MEM_MAPPED)
+  DWORD64 start;  // only memory in [start, end) is included
+  DWORD64 end;
+};
+
+// A filter matching all readable memory.
+Filter all();
+
+bool isReadable(const MEMORY_BASIC_INFORMATION& region);
+
+// Reads `size` bytes at `address`, leaving the pages that cannot be read as zeros.
+void readFilled(HANDLE hProcess, DWORD64 address, unsigned char* buffer, SIZE_T size);
+
+// Returns the committed, readable regions that pass the filter, clipped to [filter.start, filter.end).
+std::vector<MEMORY_BASIC_INFORMATION> select(HANDLE hProcess, const Filter& filter);
+
+// Called with successive windows of memory. Return false to stop streaming.
+typedef std::function<bool(DWORD64 address, const unsigned char* data, SIZE_T size)> Visitor;
+
+// Reads the regions in order and passes them to `visit` one window at a time. Windows over contiguous memory
+// overlap by `overlap` bytes, so anything up to `overlap + 1` bytes long is seen whole in at least one window.
+// Pages that cannot be read are skipped. Streaming also stops once `cancelled` (if given) is set.
+// Returns false if the visitor or `cancelled` stopped the stream.
+bool stream(HANDLE hProcess, const std::vector<MEMORY_BASIC_INFORMATION>& regions, SIZE_T overlap,
+            const Visitor& visit, const std::atomic<bool>* cancelled = nullptr);
+}  // namespace region
@@ -0,0 +1,641 @@
+#include "scanner.h"
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include "cpu.h"
+#include "memory.h"
+#include "threadpool.h"
+
+namespace {
+using scanner::Compare;
+using scanner::Condition;
+
+// Regions are split into blocks of at most this many bytes. Blocks are the unit of work for the thread pool
+// and keep sparse offsets within 32 bits.
+const size_t blockSize = 0x1000000;
+const size_t pageSize = 0x1000;
+
+size_t popcount(uint64_t word) {
+#ifdef _MSC_VER
+  size_t count = 0;
+  for (; word; word &= word - 1) count++;
+  return count;
+#else
+  return __builtin_popcountll(word);
+#endif
+}
+
+template <typename T>
+struct Params {
+  T value;
+  T max;
+  double tolerance;
+};
+
+template <typename T>
+inline T load(const unsigned char* data) {
+  T value;
+  memcpy(&value, data, sizeof(T));
+  return value;
+}
+
+template <typename T>
+inline bool equal(T a, T b, double) {
+  return a == b;
+}
+
+template <>
+inline bool equal<float>(float a, float b, double tolerance) {
+  return fabs((double)a - (double)b) <= tolerance;
+}
+
+template <>
+inline bool equal<double>(double a, double b, double tolerance) {
+  return fabs(a - b) <= tolerance;
+}
+
+// Compared to the previous value, floating point values are unchanged if they are bit for bit identical,
+// or within the tolerance when one is given.
+template <typename T>
+inline bool same(T a, T b, double tolerance) {
+  if (tolerance > 0) return equal(a, b, tolerance);
+  return !memcmp(&a, &b, sizeof(T));
+}
+
+template <typename T, Compare C>
+inline bool test(T current, T previous, const Params<T>& params) {
+  switch (C) {
+    case scanner::EXACT:
+      return equal(current, params.value, params.tolerance);
+    case scanner::NOT_EQUAL:
+      return !equal(current, params.value, params.tolerance);
+    case scanner::GREATER:
+      return current > params.value;
+    case scanner::LESS:
+      return current < params.value;
+    case scanner::BETWEEN:
+      return current >= params.value && current <= params.max;
+    case scanner::CHANGED:
+      return !same(current, previous, params.tolerance);
+    case scanner::UNCHANGED:
+      return same(current, previous, params.tolerance);
+    case scanner::INCREASED:
+      return current > previous;
+    case scanner::DECREASED:
+      return current < previous;
+  }
+
+  return false;
+}
+
+// Clears the bits of every slot in `bitmap` whose predicate fails. `previous` may be null for absolute comparisons.
+template <typename T, Compare C>
+void denseScalar(const unsigned char* current, const unsigned char* previous, size_t slots, size_t alignment,
+                 const Params<T>& params, uint64_t* bitmap) {
+  for (size_t word = 0; word * 64 < slots; word++) {
+    if (!bitmap[word]) continue;
+
+    uint64_t bits = 0;
+    size_t end = std::min<size_t>(64, slots - word * 64);
+
+    for (size_t bit = 0; bit < end; bit++) {
+      size_t offset = (word * 64 + bit) * alignment;
+      T value = load<T>(current + offset);
+      T before = previous ? load<T>(previous + offset) : T();
+      if (test<T, C>(value, before, params)) bits |= (uint64_t)1 << bit;
+    }
+
+    bitmap[word] &= bits;
+  }
+}
+
+// Collapses a byte mask where every element is `size` identical bits into one bit per element.
+inline uint32_t collapse(uint32_t mask, size_t size) {
+  if (size == 2) {
+    mask &= 0x55555555;
+    mask = (mask | (mask >> 1)) & 0x33333333;
+    mask = (mask | (mask >> 2)) & 0x0F0F0F0F;
+    mask = (mask | (mask >> 4)) & 0x00FF00FF;
+    mask = (mask | (mask >> 8)) & 0x0000FFFF;
+  }
+
+  return mask;
+}
+
+// The equality kernels set bit i of `out` when element i of `a` equals element i of `b`, or `value` (repeated to
+// fill a vector) when `b` is null. They handle whole vectors only and return the number of elements covered.
+#ifdef MEMORYJS_X86
+MEMORYJS_TARGET("sse2")
+size_t equalSSE2(const unsigned char* a, const unsigned char* b, const unsigned char* value, size_t size,
+                 size_t count, uint64_t* out) {
+  const size_t perStep = 16 / size;
+  const __m128i broadcast = _mm_loadu_si128((const __m128i*)value);
+  size_t element = 0;
+
+  for (; element + perStep <= count; element += perStep) {
+    __m128i left = _mm_loadu_si128((const __m128i*)(a + element * size));
+    __m128i right = b ? _mm_loadu_si128((const __m128i*)(b + element * size)) : broadcast;
+    uint32_t bits;
+
+    if (size == 4) {
+      bits = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(left, right)));
+    } else if (size == 8) {
+      __m128i halves = _mm_cmpeq_epi32(left, right);
+      __m128i both = _mm_and_si128(halves, _mm_shuffle_epi32(halves, _MM_SHUFFLE(2, 3, 0, 1)));
+      bits = _mm_movemask_pd(_mm_castsi128_pd(both));
+    } else {
+      bits = collapse((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(left, right)), size);
+    }
+
+    out[element / 64] |= (uint64_t)bits << (element % 64);
+  }
+
+  return element;
+}
+
+MEMORYJS_TARGET("avx2")
+size_t equalAVX2(const unsigned char* a, const unsigned char* b, const unsigned char* value, size_t size,
+                 size_t count, uint64_t* out) {
+  const size_t perStep = 32 / size;
+  const __m256i broadcast = _mm256_loadu_si256((const __m256i*)value);
+  size_t element = 0;
+
+  for (; element + perStep <= count; element += perStep) {
+    __m256i left = _mm256_loadu_si256((const __m256i*)(a + element * size));
+    __m256i right = b ? _mm256_loadu_si256((const __m256i*)(b + element * size)) : broadcast;
+    uint32_t bits;
+
+    if (size == 4) {
+      bits = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(left, right)));
+    } else if (size == 8) {
+      bits = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(left, right)));
+    } else {
+      bits = collapse((uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(left, right)), size);
+    }
+
+    out[element / 64] |= (uint64_t)bits << (element % 64);
+  }
+
+  return element;
+}
+#endif
+
+// Sets bit i of `out` (which must be zeroed) when element i of `a` equals element i of `b` or `value`.
+void equalBits(const unsigned char* a, const unsigned char* b, const unsigned char* value, size_t size, size_t count,
+               uint64_t* out) {
+  // The value repeated across a whole vector.
+  unsigned char broadcast[32];
+  for (size_t i = 0; i < sizeof(broadcast); i++) broadcast[i] = value[i % size];
+
+  size_t element = 0;
+
+#ifdef MEMORYJS_X86
+  if (cpu::hasAVX2()) {
+    element = equalAVX2(a, b, broadcast, size, count, out);
+  } else if (cpu::hasSSE2()) {
+    element = equalSSE2(a, b, broadcast, size, count, out);
+  }
+#endif
+
+  for (; element < count; element++) {
+    if (!memcmp(a + element * size, b ? b + element * size : value, size)) {
+      out[element / 64] |= (uint64_t)1 << (element % 64);
+    }
+  }
+}
+
+// Reads a block, page by page where the whole read fails. Unreadable pages are zeroed and recorded in `failed`.
+void readBlock(HANDLE handle, DWORD64 base, unsigned char* buffer, size_t size,
+               std::vector<std::pair<size_t, size_t>>& failed) {
+  if (memory::read(handle, base, buffer, size) == size) return;
+
+  for (size_t offset = 0; offset < size; offset += pageSize) {
+    size_t length = std::min(pageSize, size - offset);
+    if (memory::read(handle, base + offset, buffer + offset, length) == length) continue;
+
+    memset(buffer + offset, 0, length);
+    if (!failed.empty() && failed.back().second == offset) {
+      failed.back().second += length;
+    } else {
+      failed.push_back({offset, offset + length});
+    }
+  }
+}
+
+double toNumber(scanner::ValueType type, const unsigned char* data) {
+  switch (type) {
+    case scanner::T_BYTE:
+      return load<unsigned char>(data);
+    case scanner::T_INT32:
+      return load<int32_t>(data);
+    case scanner::T_INT64:
+      return (double)load<int64_t>(data);
+    case scanner::T_FLOAT:
+      return load<float>(data);
+    case scanner::T_DOUBLE:
+      return load<double>(data);
+  }
+
+  return 0;
+}
+}  // namespace
+
+size_t scanner::valueSize(ValueType type) {
+  switch (type) {
+    case T_BYTE:
+      return 1;
+    case T_INT32:
+    case T_FLOAT:
+      return 4;
+    case T_INT64:
+    case T_DOUBLE:
+      return 8;
+  }
+
+  return 1;
+}
+
+bool scanner::isRelative(Compare compare) {
+  return compare == CHANGED || compare == UNCHANGED || compare == INCREASED || compare == DECREASED;
+}
+
+scanner::Session::Session(HANDLE handle, ValueType type, size_t alignment, const region::Filter& filter)
+    : handle(handle),
+      type(type),
+      size(valueSize(type)),
+      alignment(alignment ? alignment : valueSize(type)),
+      filter(filter),
+      started(false) {}
+
+size_t scanner::Session::slots(const Block& block) const {
+  return block.size < size ? 0 : (block.size - size) / alignment + 1;
+}
+
+size_t scanner::Session::count() const {
+  size_t total = 0;
+  for (auto& block : blocks) total += block.count;
+  return total;
+}
+
+namespace {
+// Runs the predicate over a dense block for one value type.
+template <typename T>
+void evaluateDense(const Condition& condition, const unsigned char* current, const unsigned char* previous,
+                   size_t slots, size_t alignment, uint64_t* bitmap) {
+  Params<T> params;
+  bool floating = (T)0.5 != 0;
+  params.value = floating ? (T)condition.number : (T)condition.integer;
+  params.max = floating ? (T)condition.numberMax : (T)condition.integerMax;
+  params.tolerance = condition.tolerance;
+
+  // Bitwise equality covers exact integer matches and unchanged/changed values, and runs on the SIMD kernels.
+  bool bitwise = condition.compare == scanner::CHANGED || condition.compare == scanner::UNCHANGED ||
+                 (condition.compare == scanner::EXACT && !floating);
+
+  if (bitwise && alignment == sizeof(T) && condition.tolerance <= 0) {
+    size_t words = (slots + 63) / 64;
+    std::vector<uint64_t> equal(words, 0);
+    bool relative = condition.compare != scanner::EXACT;
+
+    equalBits(current, relative ? previous : nullptr, (const unsigned char*)&params.value, sizeof(T), slots,
+              equal.data());
+
+    for (size_t word = 0; word < words; word++) {
+      bitmap[word] &= condition.compare == scanner::CHANGED ? ~equal[word] : equal[word];
+    }
+
+    // Clear the bits past the last slot that inverting may have set.
+    if (slots % 64) bitmap[words - 1] &= ((uint64_t)1 << (slots % 64)) - 1;
+    return;
+  }
+
+  switch (condition.compare) {
+    case scanner::EXACT:
+      return denseScalar<T, scanner::EXACT>(current, previous, slots, alignment, params, bitmap);
+    case scanner::NOT_EQUAL:
+      return denseScalar<T, scanner::NOT_EQUAL>(current, previous, slots, alignment, params, bitmap);
+    case scanner::GREATER:
+      return denseScalar<T, scanner::GREATER>(current, previous, slots, alignment, params, bitmap);
+    case scanner::LESS:
+      return denseScalar<T, scanner::LESS>(current, previous, slots, alignment, params, bitmap);
+    case scanner::BETWEEN:
+      return denseScalar<T, scanner::BETWEEN>(current, previous, slots, alignment, params, bitmap);
+    case scanner::CHANGED:
+      return denseScalar<T, scanner::CHANGED>(current, previous, slots, alignment, params, bitmap);
+    case scanner::UNCHANGED:
+      return denseScalar<T, scanner::UNCHANGED>(current, previous, slots, alignment, params, bitmap);
+    case scanner::INCREASED:
+      return denseScalar<T, scanner::INCREASED>(current, previous, slots, alignment, params, bitmap);
+    case scanner::DECREASED:
+      return denseScalar<T, scanner::DECREASED>(current, previous, slots, alignment, params, bitmap);
+  }
+}
+
+// Filters the candidates of a sparse block in place. `current` holds the block's memory from `base` on, and
+// `readable` tells whether the candidate at an offset could be read.
+template <typename T, Compare C>
+size_t sparseFilter(std::vector<uint32_t>& offsets, std::vector<unsigned char>& values, const unsigned char* current,
+                    size_t base, const std::vector<bool>& readable, const Params<T>& params) {
+  size_t kept = 0;
+
+  for (size_t i = 0; i < offsets.size(); i++) {
+    if (!readable[i]) continue;
+
+    T value = load<T>(current + offsets[i] - base);
+    T before = load<T>(&values[i * sizeof(T)]);
+    if (!test<T, C>(value, before, params)) continue;
+
+    offsets[kept] = offsets[i];
+    memcpy(&values[kept * sizeof(T)], &value, sizeof(T));
+    kept++;
+  }
+
+  offsets.resize(kept);
+  values.resize(kept * sizeof(T));
+  return kept;
+}
+
+template <typename T>
+size_t evaluateSparse(const Condition& condition, std::vector<uint32_t>& offsets, std::vector<unsigned char>& values,
+                      const unsigned char* current, size_t base, const std::vector<bool>& readable) {
+  Params<T> params;
+  bool floating = (T)0.5 != 0;
+  params.value = floating ? (T)condition.number : (T)condition.integer;
+  params.max = floating ? (T)condition.numberMax : (T)condition.integerMax;
+  params.tolerance = condition.tolerance;
+
+  switch (condition.compare) {
+    case scanner::EXACT:
+      return sparseFilter<T, scanner::EXACT>(offsets, values, current, base, readable, params);
+    case scanner::NOT_EQUAL:
+      return sparseFilter<T, scanner::NOT_EQUAL>(offsets, values, current, base, readable, params);
+    case scanner::GREATER:
+      return sparseFilter<T, scanner::GREATER>(offsets, values, current, base, readable, params);
+    case scanner::LESS:
+      return sparseFilter<T, scanner::LESS>(offsets, values, current, base, readable, params);
+    case scanner::BETWEEN:
+      return sparseFilter<T, scanner::BETWEEN>(offsets, values, current, base, readable, params);
+    case scanner::CHANGED:
+      return sparseFilter<T, scanner::CHANGED>(offsets, values, current, base, readable, params);
+    case scanner::UNCHANGED:
+      return sparseFilter<T, scanner::UNCHANGED>(offsets, values, current, base, readable, params);
+    case scanner::INCREASED:
+      return sparseFilter<T, scanner::INCREASED>(offsets, values, current, base, readable, params);
+    case scanner::DECREASED:
+      return sparseFilter<T, scanner::DECREASED>(offsets, values, current, base, readable, params);
+  }
+
+  return 0;
+}
+}  // namespace
+
+void scanner::Session::scanBlock(Block& block, const Condition& condition, std::vector<unsigned char>& buffer) {
+  size_t count = slots(block);
+
+  if (!block.sparse) {
+    std::vector<std::pair<size_t, size_t>> failed;
+    buffer.resize(block.size);
+    readBlock(handle, block.base, buffer.data(), block.size, failed);
+
+    const unsigned char* previous = block.snapshot.empty() ? nullptr : block.snapshot.data();
+
+    switch (type) {
+      case T_BYTE:
+        evaluateDense<unsigned char>(condition, buffer.data(), previous, count, alignment, block.bitmap.data());
+        break;
+      case T_INT32:
+        evaluateDense<int32_t>(condition, buffer.data(), previous, count, alignment, block.bitmap.data());
+        break;
+      case T_INT64:
+        evaluateDense<int64_t>(condition, buffer.data(), previous, count, alignment, block.bitmap.data());
+        break;
+      case T_FLOAT:
+        evaluateDense<float>(condition, buffer.data(), previous, count, alignment, block.bitmap.data());
+        break;
+      case T_DOUBLE:
+        evaluateDense<double>(condition, buffer.data(), previous, count, alignment, block.bitmap.data());
+        break;
+    }
+
+    // Slots that overlap a page that could not be read are no longer candidates.
+    for (auto& range : failed) {
+      size_t first = range.first >= size ? (range.first - size) / alignment + 1 : 0;
+      for (size_t slot = first; slot < count && slot * alignment < range.second; slot++) {
+        block.bitmap[slot / 64] &= ~((uint64_t)1 << (slot % 64));
+      }
+    }
+
+    block.snapshot.swap(buffer);
+    block.count = 0;
+    for (uint64_t word : block.bitmap) block.count += popcount(word);
+    return;
+  }
+
+  if (block.offsets.empty()) return;
+
+  // Read only the pages that hold candidates, as one vectored read.
+  size_t first = block.offsets.front() & ~(pageSize - 1);
+  size_t last = block.offsets.back() + size;
+  buffer.resize(last - first);
+
+  std::vector<memory::Segment> segments;
+  for (uint32_t offset : block.offsets) {
+    size_t start = offset & ~(pageSize - 1);
+    size_t end = std::min(((offset + size + pageSize - 1) & ~(pageSize - 1)), last);
+
+    if (!segments.empty() && segments.back().address + segments.back().size >= block.base + start) {
+      DWORD64 segmentEnd = std::max<DWORD64>(segments.back().address + segments.back().size, block.base + end);
+      segments.back().size = (SIZE_T)(segmentEnd - segments.back().address);
+      continue;
+    }
+
+    segments.push_back({block.base + start, buffer.data() + start - first, end - start, 0});
+  }
+
+  memory::readScatter(handle, segments.data(), segments.size());
+
+  // A candidate is readable if the segment it falls in was read at least up to its end.
+  std::vector<bool> readable(block.offsets.size());
+  size_t segment = 0;
+
+  for (size_t i = 0; i < block.offsets.size(); i++) {
+    DWORD64 address = block.base + block.offsets[i];
+    while (segments[segment].address + segments[segment].size <= address) segment++;
+    readable[i] = address + size <= segments[segment].address + segments[segment].bytesRead;
+  }
+
+  switch (type) {
+    case T_BYTE:
+      block.count = evaluateSparse<unsigned char>(condition, block.offsets, block.values, buffer.data(), first,
+                                                  readable);
+      break;
+    case T_INT32:
+      block.count = evaluateSparse<int32_t>(condition, block.offsets, block.values, buffer.data(), first, readable);
+      break;
+    case T_INT64:
+      block.count = evaluateSparse<int64_t>(condition, block.offsets, block.values, buffer.data(), first, readable);
+      break;
+    case T_FLOAT:
+      block.count = evaluateSparse<float>(condition, block.offsets, block.values, buffer.data(), first, readable);
+      break;
+    case T_DOUBLE:
+      block.count = evaluateSparse<double>(condition, block.offsets, block.values, buffer.data(), first, readable);
+      break;
+  }
+}
+
+void scanner::Session::compact(Block& block) {
+  // A dense block costs its bitmap plus its snapshot, a sparse one an offset and a value per candidate.
+  size_t denseCost = block.bitmap.size() * sizeof(uint64_t) + block.snapshot.size();
+  size_t sparseCost = block.count * (sizeof(uint32_t) + size);
+  if (sparseCost >= denseCost) return;
+
+  block.offsets.reserve(block.count);
+  block.values.reserve(block.count * size);
+
+  for (size_t word = 0; word < block.bitmap.size(); word++) {
+    for (uint64_t bits = block.bitmap[word]; bits; bits &= bits - 1) {
+      size_t bit = (uint32_t)bits ? cpu::ctz((uint32_t)bits) : 32 + cpu::ctz((uint32_t)(bits >> 32));
+      size_t offset = (word * 64 + bit) * alignment;
+      block.offsets.push_back((uint32_t)offset);
+      block.values.insert(block.values.end(), &block.snapshot[offset], &block.snapshot[offset] + size);
+    }
+  }
+
+  block.sparse = true;
+  std::vector<uint64_t>().swap(block.bitmap);
+  std::vector<unsigned char>().swap(block.snapshot);
+}
+
+size_t scanner::Session::firstScan(const Condition& condition, const std::atomic<bool>* cancelled) {
+  // Candidates are only replaced once every block is scanned
+  std::vector<Block> scanned;
+
+  for (auto& region : region::select(handle, filter)) {
+    DWORD64 base = (DWORD64)region.BaseAddress;
+    DWORD64 end = base + region.RegionSize;
+
+    for (DWORD64 address = base; address < end; address += blockSize) {
+      Block block;
+      block.base = address;
+      block.size = (size_t)std::min<DWORD64>(blockSize, end - address);
+      block.count = 0;
+      block.sparse = false;
+      scanned.push_back(block);
+    }
+  }
+
+  threadpool::parallelFor(scanned.size(), [&](size_t index) {
+    if (cancelled && *cancelled) return;
+
+    Block& block = scanned[index];
+    size_t count = slots(block);
+
+    // Every slot starts out as a candidate.
+    block.bitmap.assign((count + 63) / 64, ~(uint64_t)0);
+    if (count % 64) block.bitmap.back() = ((uint64_t)1 << (count % 64)) - 1;
+
+    std::vector<unsigned char> buffer;
+    scanBlock(block, condition, buffer);
+    compact(block);
+  });
+
+  if (cancelled && *cancelled) return aborted;
+
+  scanned.erase(std::remove_if(scanned.begin(), scanned.end(), [](const Block& block) { return block.count == 0; }),
+                scanned.end());
+
+  blocks.swap(scanned);
+  started = true;
+  return count();
+}
+
+size_t scanner::Session::nextScan(const Condition& condition, const std::atomic<bool>* cancelled) {
+  // Blocks are filtered in place. An abort only needs their candidates back, so those are all that is set aside, and
+  // dense blocks are compacted once every block is done.
+  struct Candidates {
+    bool saved = false;
+    size_t count = 0;
+    std::vector<uint64_t> bitmap;
+    std::vector<uint32_t> offsets;
+    std::vector<unsigned char> values;
+  };
+  std::vector<Candidates> previous(cancelled ? blocks.size() : 0);
+
+  threadpool::parallelFor(blocks.size(), [&](size_t index) {
+    if (cancelled && *cancelled) return;
+
+    Block& block = blocks[index];
+    if (cancelled) {
+      Candidates& candidates = previous[index];
+      candidates.saved = true;
+      candidates.count = block.count;
+      if (block.sparse) {
+        candidates.offsets = block.offsets;
+        candidates.values = block.values;
+      } else {
+        candidates.bitmap = block.bitmap;
+      }
+    }
+
+    std::vector<unsigned char> buffer;
+    scanBlock(block, condition, buffer);
+  });
+
+  if (cancelled && *cancelled) {
+    for (size_t index = 0; index < blocks.size(); index++) {
+      Block& block = blocks[index];
+      Candidates& candidates = previous[index];
+      if (!candidates.saved) continue;
+
+      block.count = candidates.count;
+      block.bitmap.swap(candidates.bitmap);
+      block.offsets.swap(candidates.offsets);
+      block.values.swap(candidates.values);
+    }
+    return aborted;
+  }
+
+  threadpool::parallelFor(blocks.size(), [&](size_t index) { compact(blocks[index]); });
+
+  blocks.erase(std::remove_if(blocks.begin(), blocks.end(), [](const Block& block) { return block.count == 0; }),
+               blocks.end());
+  return count();
+}
+
+std::vector<scanner::Result> scanner::Session::results(size_t offset, size_t limit) const {
+  std::vector<Result> results;
+
+  for (auto& block : blocks) {
+    if (results.size() >= limit) break;
+
+    if (offset >= block.count) {
+      offset -= block.count;
+      continue;
+    }
+
+    if (block.sparse) {
+      for (size_t i = offset; i < block.offsets.size() && results.size() < limit; i++) {
+        results.push_back({block.base + block.offsets[i], toNumber(type, &block.values[i * size])});
+      }
+    } else {
+      size_t skipped = 0;
+
+      for (size_t word = 0; word < block.bitmap.size() && results.size() < limit; word++) {
+        for (size_t bit = 0; bit < 64 && results.size() < limit; bit++) {
+          if (!(block.bitmap[word] >> bit & 1)) continue;
+          if (skipped++ < offset) continue;
+
+          size_t slotOffset = (word * 64 + bit) * alignment;
+          results.push_back({block.base + slotOffset, toNumber(type, &block.snapshot[slotOffset])});
+        }
+      }
+    }
+
+    offset = 0;
+  }
+
+  return results;
+}
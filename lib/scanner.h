@@ -0,0 +1,99 @@
+#pragma once
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+
+#include <windows.h>
+#else
+#include "compat.h"
+#endif
+#include <stdint.h>
+#include <atomic>
+#include <vector>
+#include "region.h"
+
+// A first-scan/next-scan value scanner. A session finds every address holding a value and then narrows the
+// candidates down scan by scan.
+//
+// Memory is split into blocks. While a block has many candidates they are kept as a bitmap (one bit per aligned
+// slot) alongside a snapshot of the block's memory. Once it becomes cheaper, the block switches to a sorted array of
+// offsets and the value at each of them. Dense blocks are compared with SIMD, sparse blocks are re-read with one
+// vectored read per block rather than one read per address.
+namespace scanner {
+enum ValueType { T_BYTE, T_INT32, T_INT64, T_FLOAT, T_DOUBLE };
+
+enum Compare { EXACT, NOT_EQUAL, GREATER, LESS, BETWEEN, CHANGED, UNCHANGED, INCREASED, DECREASED };
+
+// The value(s) a scan compares against. Integers use `integer`/`integerMax`, floating point types use
+// `number`/`numberMax` and accept values within `tolerance` as equal.
+struct Condition {
+  Compare compare;
+  int64_t integer;
+  int64_t integerMax;
+  double number;
+  double numberMax;
+  double tolerance;
+};
+
+struct Result {
+  DWORD64 address;
+  double value;
+};
+
+// Returned by scans that were cancelled.
+const size_t aborted = (size_t)-1;
+
+size_t valueSize(ValueType type);
+
+// True if the comparison needs the values from a previous scan.
+bool isRelative(Compare compare);
+
+class Session {
+ public:
+  // `alignment` is the distance between candidate addresses, 0 for the size of the value.
+  Session(HANDLE handle, ValueType type, size_t alignment, const region::Filter& filter);
+
+  // Finds every address in the filtered regions that satisfies the condition. Relative comparisons are not allowed.
+  // Returns the number of candidates.
+  //
+  // Both scans stop once `cancelled` (if given) is set, and then return `aborted` and leave the session's candidates as
+  // they were before the scan. Candidates a next scan had already re-read keep the values it read, which later
+  // relative comparisons are made against.
+  size_t firstScan(const Condition& condition, const std::atomic<bool>* cancelled = nullptr);
+
+  // Re-reads the current candidates and keeps the ones that satisfy the condition.
+  // Returns the number of candidates left.
+  size_t nextScan(const Condition& condition, const std::atomic<bool>* cancelled = nullptr);
+
+  size_t count() const;
+  bool scanned() const { return started; }
+
+  // Returns up to `limit` candidates starting from the `offset`th one, with the value seen by the last scan.
+  std::vector<Result> results(size_t offset, size_t limit) const;
+
+ private:
+  struct Block {
+    DWORD64 base;
+    size_t size;
+    size_t count;
+    bool sparse;
+
+    std::vector<uint64_t> bitmap;         // dense: one bit per slot
+    std::vector<unsigned char> snapshot;  // dense: the block's memory as of the last scan
+
+    std::vector<uint32_t> offsets;        // sparse: the offset of every candidate, in order
+    std::vector<unsigned char> values;    // sparse: the value of every candidate as of the last scan
+  };
+
+  size_t slots(const Block& block) const;
+  void scanBlock(Block& block, const Condition& condition, std::vector<unsigned char>& buffer);
+  void compact(Block& block);
+
+  HANDLE handle;
+  ValueType type;
+  size_t size;
+  size_t alignment;
+  region::Filter filter;
+  std::vector<Block> blocks;
+  bool started;
+};
+}  // namespace scanner
@@ -0,0 +1,147 @@
+#include "session.h"
+
+#include <string.h>
+#include <algorithm>
+#include <deque>
+#include "addressmap.h"
+#include "process.h"
+#include "threadpool.h"
+
+namespace {
+struct Task {
+  size_t target;
+  size_t index;
+};
+
+// Each lane works through its own tasks from the front, then steals from the back of the other lanes, so a lane held
+// up by a slow target does not leave the tasks dealt to it waiting.
+struct Lane {
+  std::mutex lock;
+  std::deque<Task> tasks;
+};
+
+bool take(std::vector<Lane>& lanes, size_t own, Task* task) {
+  for (size_t i = 0; i < lanes.size(); i++) {
+    Lane& lane = lanes[(own + i) % lanes.size()];
+    std::lock_guard<std::mutex> guard(lane.lock);
+    if (lane.tasks.empty()) continue;
+
+    if (i == 0) {
+      *task = lane.tasks.front();
+      lane.tasks.pop_front();
+    } else {
+      *task = lane.tasks.back();
+      lane.tasks.pop_back();
+    }
+
+    return true;
+  }
+
+  return false;
+}
+}  // namespace
+
+const char* session::exitedMessage = "the process has exited";
+
+session::Target::Target(const PROCESSENTRY32& process, HANDLE handle) : process(process), handle(handle), alive(true) {}
+
+session::Target::~Target() {
+  addressmap::invalidate(handle);
+  process::closeProcess(handle);
+}
+
+session::Session::Session(const Filter& filter) : filter(filter) {}
+
+size_t session::Session::refresh(char** errorMessage) {
+  std::vector<PROCESSENTRY32> processes = process::findProcesses(filter.names, filter.ids, errorMessage);
+  if (strcmp(*errorMessage, "")) return 0;
+
+  std::lock_guard<std::mutex> guard(lock);
+
+  all.erase(std::remove_if(all.begin(), all.end(),
+                           [](const std::shared_ptr<Target>& target) {
+                             return !target->alive || !process::isAlive(target->handle);
+                           }),
+            all.end());
+
+  std::set<DWORD> open;
+  for (const std::shared_ptr<Target>& target : all) open.insert(target->process.th32ProcessID);
+
+  size_t added = 0;
+  for (const PROCESSENTRY32& entry : processes) {
+    if (open.count(entry.th32ProcessID)) continue;
+
+    // Processes that cannot be opened, such as ones running as another user, are left out
+    HANDLE handle = process::openProcess(entry);
+    if (handle == NULL) continue;
+
+    all.push_back(std::make_shared<Target>(entry, handle));
+    added++;
+  }
+
+  return added;
+}
+
+session::Targets session::Session::targets() const {
+  std::lock_guard<std::mutex> guard(lock);
+  return all;
+}
+
+void session::Session::close() {
+  std::lock_guard<std::mutex> guard(lock);
+  all.clear();
+}
+
+std::vector<const char*> session::run(const Targets& targets, size_t tasks, const Work& work,
+                                      const std::atomic<bool>& cancelled) {
+  std::vector<const char*> errors(targets.size(), "");
+  std::mutex errorsLock;
+
+  size_t live = 0;
+  for (size_t i = 0; i < targets.size(); i++) {
+    if (targets[i]->alive) {
+      live++;
+    } else {
+      errors[i] = exitedMessage;
+    }
+  }
+
+  size_t total = live * tasks;
+  if (total == 0) return errors;
+
+  // Tasks are dealt out round by round, the first task of every target before the second of any
+  std::vector<Lane> lanes(std::min(threadpool::getThreads(), total));
+  size_t dealt = 0;
+
+  for (size_t index = 0; index < tasks; index++) {
+    for (size_t target = 0; target < targets.size(); target++) {
+      if (targets[target]->alive) lanes[dealt++ % lanes.size()].tasks.push_back({target, index});
+    }
+  }
+
+  threadpool::parallelFor(lanes.size(), [&](size_t own) {
+    Task task;
+
+    while (!cancelled && take(lanes, own, &task)) {
+      Target& target = *targets[task.target];
+      if (!target.alive) continue;
+
+      char* errorMessage = "";
+      work(task.target, task.index, &errorMessage);
+
+      // Failures of a process that exited meanwhile are down to the exit, whatever the task reported
+      bool exited = !process::isAlive(target.handle);
+      if (exited) target.alive = false;
+      if (!exited && !strcmp(errorMessage, "")) continue;
+
+      std::lock_guard<std::mutex> guard(errorsLock);
+      if (exited) {
+        errors[task.target] = exitedMessage;
+      } else if (!strcmp(errors[task.target], "")) {
+        errors[task.target] = errorMessage;
+      }
+    }
+  });
+
+  return errors;
+}
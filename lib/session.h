@@ -0,0 +1,77 @@
+#pragma once
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+
+#include <windows.h>
+#include <TlHelp32.h>
+#else
+#include "compat.h"
+#endif
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+// Monitoring many processes at once, such as every instance of the same program on a machine.
+//
+// A session opens every process that matches its filter from a single list of the processes, and owns their handles.
+// Work is split into tasks per target that run on the thread pool, interleaved so that every target gets its first
+// task started before any gets its second. A target whose process exits is marked dead and reported as such, without
+// failing the work of the others.
+namespace session {
+struct Filter {
+  std::set<std::string> names;  // executable names
+  std::set<DWORD> ids;          // process ids
+};
+
+// A process of the session. The handle is closed with the target, once neither the session nor any work that is
+// still running holds on to it.
+class Target {
+ public:
+  Target(const PROCESSENTRY32& process, HANDLE handle);
+  ~Target();
+
+  Target(const Target&) = delete;
+  Target& operator=(const Target&) = delete;
+
+  const PROCESSENTRY32 process;
+  const HANDLE handle;
+  std::atomic<bool> alive;
+};
+
+typedef std::vector<std::shared_ptr<Target>> Targets;
+
+// Does task number `task` of the target at index `target`, reporting failure through `errorMessage` like the rest of
+// the library.
+typedef std::function<void(size_t target, size_t task, char** errorMessage)> Work;
+
+extern const char* exitedMessage;
+
+class Session {
+ public:
+  explicit Session(const Filter& filter);
+
+  // Opens the processes that match the filter and are not targets yet, and drops the targets that exited. Returns the
+  // number of targets added.
+  size_t refresh(char** errorMessage);
+
+  Targets targets() const;
+
+  // Drops every target. Their handles are closed once the work that is still running on them finishes.
+  void close();
+
+ private:
+  Filter filter;
+  mutable std::mutex lock;
+  Targets all;
+};
+
+// Runs `tasks` tasks for every target and returns the error of each target, "" if all of its tasks succeeded.
+// Targets that are dead, or die along the way, fail with exitedMessage and their remaining tasks are skipped. Tasks
+// that did not start yet are skipped once `cancelled` is set.
+std::vector<const char*> run(const Targets& targets, size_t tasks, const Work& work,
+                             const std::atomic<bool>& cancelled);
+}  // namespace session
@@ -0,0 +1,148 @@
+#include "share.h"
+
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include "batch.h"
+
+namespace {
+const size_t countSize = 8;
+const size_t entrySize = 24;
+
+enum Word { PUBLISHED = 0, CURRENT = 1, SLOTS = 2, SLOT_SIZE = 3, SEQUENCES = 4 };
+
+size_t align(size_t size) {
+  return (size + 7) & ~(size_t)7;
+}
+
+// The header is read with Atomics by JS, which sees the same 32-bit words
+std::atomic<uint32_t>& word(unsigned char* memory, size_t index) {
+  static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "atomics must have the layout of their value");
+  return *(std::atomic<uint32_t>*)(memory + index * sizeof(uint32_t));
+}
+}  // namespace
+
+size_t share::slotSize(const std::vector<Region>& regions) {
+  size_t size = countSize + regions.size() * entrySize;
+  for (const Region& region : regions) size += align(region.size);
+  return size;
+}
+
+size_t share::memorySize(size_t slots, size_t slotSize) {
+  return headerSize + slots * align(slotSize);
+}
+
+share::Publisher::Publisher(HANDLE handle, unsigned char* memory, size_t slots, size_t slotSize)
+    : handle(handle),
+      memory(memory),
+      slots(slots),
+      slotSize(align(slotSize)),
+      published(0),
+      current(0),
+      previous(slots - 1),
+      stopping(false),
+      interval(100) {
+  word(memory, SLOTS).store((uint32_t)slots);
+  word(memory, SLOT_SIZE).store((uint32_t)this->slotSize);
+}
+
+share::Publisher::~Publisher() {
+  stop();
+}
+
+bool share::Publisher::configure(const std::vector<Region>& regions, uint32_t interval) {
+  if (share::slotSize(regions) > slotSize) return false;
+
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    this->regions = regions;
+    this->interval = interval;
+  }
+
+  // A shorter interval takes effect now rather than after the current wait
+  wake.notify_one();
+  return true;
+}
+
+void share::Publisher::start() {
+  if (thread.joinable()) return;
+
+  stopping = false;
+  thread = std::thread(&Publisher::run, this);
+}
+
+void share::Publisher::stop() {
+  if (!thread.joinable()) return;
+
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    stopping = true;
+  }
+
+  wake.notify_one();
+  thread.join();
+}
+
+void share::Publisher::run() {
+  std::unique_lock<std::mutex> guard(lock);
+
+  while (!stopping) {
+    std::vector<Region> publishing = regions;
+    guard.unlock();
+    publish(publishing);
+    guard.lock();
+
+    // Waking early for a new configuration starts a new interval
+    uint32_t waited = interval;
+    wake.wait_for(guard, std::chrono::milliseconds(waited), [&] { return stopping || interval != waited; });
+  }
+}
+
+void share::Publisher::publish(const std::vector<Region>& regions) {
+  // The slot readers are least likely to still be reading: not the latest, and with three slots not the one before
+  size_t next = slots == 2 ? 1 - current : 3 - current - previous;
+  unsigned char* slot = memory + headerSize + next * slotSize;
+  std::atomic<uint32_t>& sequence = word(memory, SEQUENCES + next);
+
+  uint32_t publish = published + 1;
+  sequence.store(publish * 2 - 1);
+
+  // The slot's plain stores below may not become visible before the odd sequence does, or a reader could check the
+  // sequence, see the old values and accept a torn slot
+  std::atomic_thread_fence(std::memory_order_release);
+
+  uint32_t count = (uint32_t)regions.size();
+  memcpy(slot, &count, sizeof(count));
+
+  std::vector<batch::Read> reads(regions.size());
+  size_t offset = countSize + regions.size() * entrySize;
+
+  for (size_t i = 0; i < regions.size(); i++) {
+    reads[i].address = regions[i].address;
+    reads[i].size = regions[i].size;
+    reads[i].buffer = slot + offset;
+    reads[i].ok = false;
+    offset += align(regions[i].size);
+  }
+
+  batch::read(handle, reads);
+
+  for (size_t i = 0; i < regions.size(); i++) {
+    unsigned char* entry = slot + countSize + i * entrySize;
+    double address = (double)regions[i].address;
+    uint32_t fields[4] = {(uint32_t)((unsigned char*)reads[i].buffer - slot), (uint32_t)regions[i].size,
+                          reads[i].ok ? 1u : 0u, 0};
+
+    memcpy(entry, &address, sizeof(address));
+    memcpy(entry + sizeof(address), fields, sizeof(fields));
+  }
+
+  // The even store releases the slot's plain stores, so a reader that sees it sees the complete slot
+  sequence.store(publish * 2);
+  word(memory, CURRENT).store((uint32_t)next);
+  word(memory, PUBLISHED).store(publish);
+
+  previous = current;
+  current = next;
+  published = publish;
+}
@@ -0,0 +1,79 @@
+#pragma once
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+
+#include <windows.h>
+#else
+#include "compat.h"
+#endif
+#include <stdint.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Publishing regions of another process into shared memory (a SharedArrayBuffer) from a background thread, so that
+// any number of worker threads can read them without calling into the addon.
+//
+// The memory starts with a header of 32-bit words, followed by two or three slots of the same size:
+//   [0] number of publishes so far       [2] number of slots
+//   [1] slot holding the latest publish  [3] size of a slot in bytes
+//   [4 + slot] sequence of each slot, odd while the slot is being written
+//
+// A slot holds the number of regions (32 bits, then 32 bits of padding), a table with an entry of { address (f64),
+// offset (u32), size (u32), readable (u32), padding (u32) } per region, then the bytes of every region, each starting
+// on an 8 byte boundary. Offsets are from the start of the slot.
+//
+// Readers take the latest slot, copy what they need and check that its sequence did not change meanwhile. The
+// publisher never writes the latest slot (nor, with three slots, the one before it), so readers rarely have to retry.
+// shared.js implements the reader.
+namespace share {
+const size_t headerSize = 64;
+const size_t maxSlots = 3;
+
+struct Region {
+  DWORD64 address;
+  size_t size;
+};
+
+// Bytes a slot needs to hold the regions.
+size_t slotSize(const std::vector<Region>& regions);
+
+// Bytes of shared memory needed for `slots` slots of `slotSize` bytes.
+size_t memorySize(size_t slots, size_t slotSize);
+
+class Publisher {
+ public:
+  // `memory` must be memorySize(slots, slotSize) bytes, zeroed, and outlive the publisher.
+  Publisher(HANDLE handle, unsigned char* memory, size_t slots, size_t slotSize);
+
+  // Stops the thread.
+  ~Publisher();
+
+  // Replaces the regions and the interval (in milliseconds), from the next publish on. Returns false, changing
+  // nothing, if the regions do not fit in a slot.
+  bool configure(const std::vector<Region>& regions, uint32_t interval);
+
+  void start();
+  void stop();
+
+ private:
+  void run();
+  void publish(const std::vector<Region>& regions);
+
+  HANDLE handle;
+  unsigned char* memory;
+  size_t slots;
+  size_t slotSize;
+  uint32_t published;
+  size_t current;
+  size_t previous;
+
+  std::thread thread;
+  std::mutex lock;
+  std::condition_variable wake;
+  bool stopping;
+  std::vector<Region> regions;
+  uint32_t interval;
+};
+}  // namespace share
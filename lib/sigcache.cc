@@ -0,0 +1,334 @@
+#include "sigcache.h"
+
+#include <stdio.h>
+#include <string.h>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <vector>
+#include "mapfile.h"
+#include "memory.h"
+
+#ifndef _WIN32
+#include <elf.h>
+#endif
+
+namespace {
+const char magic[4] = {'M', 'J', 'S', 'C'};
+const uint32_t version = 1;
+
+struct Header {
+  char magic[4];
+  uint32_t version;
+  uint64_t count;
+};
+
+// Sorted by (path, module, signature). `path` is kept apart from the module's identity so that the entries of an
+// older build of the same file can be found and dropped.
+struct Entry {
+  uint64_t path;
+  uint64_t module;
+  uint64_t signature;
+  uint64_t offset;  // of the match from the module base
+};
+
+bool operator<(const Entry& a, const Entry& b) {
+  if (a.path != b.path) return a.path < b.path;
+  if (a.module != b.module) return a.module < b.module;
+  return a.signature < b.signature;
+}
+
+bool sameKey(const Entry& a, const Entry& b) {
+  return a.path == b.path && a.module == b.module && a.signature == b.signature;
+}
+
+uint64_t hash(const void* data, size_t size, uint64_t seed = 14695981039346656037ULL) {
+  const unsigned char* bytes = (const unsigned char*)data;
+
+  // FNV-1a
+  for (size_t i = 0; i < size; i++) {
+    seed ^= bytes[i];
+    seed *= 1099511628211ULL;
+  }
+
+  return seed;
+}
+
+#ifndef _WIN32
+// Hashes the GNU build-id note of a loaded ELF image, given the page its headers are in.
+template <class Ehdr, class Phdr>
+bool buildId(HANDLE hProcess, uintptr_t base, const unsigned char* page, size_t size, uint64_t* id) {
+  if (size < sizeof(Ehdr)) return false;
+
+  const Ehdr* header = (const Ehdr*)page;
+  if (header->e_phentsize != sizeof(Phdr) || header->e_phoff + header->e_phnum * sizeof(Phdr) > size) return false;
+
+  const Phdr* headers = (const Phdr*)(page + header->e_phoff);
+  uintptr_t lowest = UINTPTR_MAX;
+
+  for (size_t i = 0; i < header->e_phnum; i++) {
+    if (headers[i].p_type == PT_LOAD) lowest = std::min<uintptr_t>(lowest, headers[i].p_vaddr & ~(uintptr_t)0xFFF);
+  }
+
+  if (lowest == UINTPTR_MAX) return false;
+
+  for (size_t i = 0; i < header->e_phnum; i++) {
+    if (headers[i].p_type != PT_NOTE) continue;
+
+    std::vector<unsigned char> notes(std::min<size_t>(headers[i].p_memsz, 0x1000));
+    size_t length = memory::read(hProcess, base - lowest + headers[i].p_vaddr, notes.data(), notes.size());
+
+    // Elf32_Nhdr and Elf64_Nhdr are the same three 32-bit words
+    for (size_t offset = 0; offset + sizeof(Elf64_Nhdr) <= length;) {
+      const Elf64_Nhdr* note = (const Elf64_Nhdr*)&notes[offset];
+      size_t name = offset + sizeof(Elf64_Nhdr);
+      size_t desc = name + ((note->n_namesz + 3) & ~3u);
+      size_t next = desc + ((note->n_descsz + 3) & ~3u);
+      if (next > length) break;
+
+      if (note->n_type == NT_GNU_BUILD_ID && note->n_namesz == 4 && !memcmp(&notes[name], "GNU", 4)) {
+        *id = hash(&notes[desc], note->n_descsz);
+        return true;
+      }
+
+      offset = next;
+    }
+  }
+
+  return false;
+}
+#endif
+
+uint64_t identifySignature(const pattern::Signature& signature) {
+  return hash(signature.mask.data(), signature.mask.size(), hash(signature.bytes.data(), signature.bytes.size()));
+}
+
+std::mutex lock;
+std::string file;
+mapfile::Mapping mapping = mapfile::none();  // the cache file
+const Entry* entries = nullptr;
+size_t count = 0;
+std::vector<Entry> stored;  // not flushed yet, in the order they were stored
+std::atomic<uint64_t> hits(0);
+std::atomic<uint64_t> misses(0);
+
+// Maps the file and checks its header. A file that does not exist yet is an empty cache.
+bool load(char** errorMessage) {
+  entries = nullptr;
+  count = 0;
+
+  if (!mapfile::map(file, mapping) || !mapping.size) return true;
+
+  const Header* header = (const Header*)mapping.data;
+
+  if (mapping.size < sizeof(Header) || memcmp(header->magic, magic, sizeof(magic)) || header->version != version ||
+      (mapping.size - sizeof(Header)) / sizeof(Entry) < header->count) {
+    mapfile::unmap(mapping);
+    *errorMessage = "the file is not a signature cache";
+    return false;
+  }
+
+  entries = (const Entry*)(mapping.data + sizeof(Header));
+  count = (size_t)header->count;
+  return true;
+}
+
+// Where the new file is written before it replaces the cache. Unique per process, so that processes sharing a cache
+// do not write over each other's temporary file (the lock keeps the threads of one process apart).
+std::string temporaryPath() {
+#ifdef _WIN32
+  unsigned long pid = GetCurrentProcessId();
+#else
+  unsigned long pid = (unsigned long)getpid();
+#endif
+  char suffix[32];
+  snprintf(suffix, sizeof(suffix), ".%lu.tmp", pid);
+  return file + suffix;
+}
+
+// Writes the stored matches, with the lock held
+bool flushLocked() {
+  if (file.empty() || stored.empty()) return true;
+
+  // Stored entries replace the ones with the same key, and every entry of a path that now has a new identity
+  std::vector<Entry> merged(stored.rbegin(), stored.rend());
+  std::stable_sort(merged.begin(), merged.end());
+  merged.erase(std::unique(merged.begin(), merged.end(), sameKey), merged.end());
+
+  std::set<uint64_t> paths;
+  std::set<std::pair<uint64_t, uint64_t>> identities;
+
+  for (const Entry& entry : stored) {
+    paths.insert(entry.path);
+    identities.insert({entry.path, entry.module});
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    const Entry& entry = entries[i];
+    bool replaced = paths.count(entry.path) && !identities.count({entry.path, entry.module});
+
+    if (!replaced && !std::binary_search(merged.begin(), merged.end(), entry)) merged.push_back(entry);
+  }
+
+  std::sort(merged.begin(), merged.end());
+
+  Header header;
+  memcpy(header.magic, magic, sizeof(magic));
+  header.version = version;
+  header.count = merged.size();
+
+  std::string temporary = temporaryPath();
+  FILE* output = fopen(temporary.c_str(), "wb");
+  if (!output) return false;
+
+  bool written = fwrite(&header, sizeof(header), 1, output) == 1 &&
+                 fwrite(merged.data(), sizeof(Entry), merged.size(), output) == merged.size();
+  written = fclose(output) == 0 && written;
+
+  // Windows cannot replace a file that is still mapped
+  mapfile::unmap(mapping);
+  entries = nullptr;
+  count = 0;
+
+  if (!written || !mapfile::replace(temporary, file)) {
+    remove(temporary.c_str());
+    char* errorMessage = "";
+    load(&errorMessage);
+    return false;
+  }
+
+  stored.clear();
+  char* errorMessage = "";
+  return load(&errorMessage);
+}
+
+const Entry* lookup(const Entry& key) {
+  for (auto entry = stored.rbegin(); entry != stored.rend(); entry++) {
+    if (sameKey(*entry, key)) return &*entry;
+  }
+
+  const Entry* found = std::lower_bound(entries, entries + count, key);
+  return found != entries + count && sameKey(*found, key) ? found : nullptr;
+}
+}  // namespace
+
+void sigcache::identify(HANDLE hProcess, const MODULEENTRY32& module, uint64_t* path, uint64_t* identity) {
+  uintptr_t base = uintptr_t(module.hModule);
+  unsigned char page[0x1000];
+  size_t size = memory::read(hProcess, base, page, sizeof(page));
+
+  // The headers hold the link time and checksum on Windows, and the layout of the image on Linux
+  uint64_t contents = hash(page, size);
+
+#ifndef _WIN32
+  if (size >= EI_NIDENT && !memcmp(page, ELFMAG, SELFMAG)) {
+    if (page[EI_CLASS] == ELFCLASS64) {
+      buildId<Elf64_Ehdr, Elf64_Phdr>(hProcess, base, page, size, &contents);
+    } else if (page[EI_CLASS] == ELFCLASS32) {
+      buildId<Elf32_Ehdr, Elf32_Phdr>(hProcess, base, page, size, &contents);
+    }
+  }
+#endif
+
+  uint64_t moduleSize = module.modBaseSize;
+  *path = hash(module.szExePath, strlen(module.szExePath));
+  *identity = hash(&moduleSize, sizeof(moduleSize), hash(&contents, sizeof(contents), *path));
+}
+
+bool sigcache::open(const std::string& path, char** errorMessage) {
+  std::lock_guard<std::mutex> guard(lock);
+
+  // Matches found with the previous file go to it
+  flushLocked();
+  mapfile::unmap(mapping);
+  entries = nullptr;
+  count = 0;
+  stored.clear();
+  file = path;
+
+  if (file.empty()) return true;
+
+  if (!load(errorMessage)) {
+    file.clear();
+    return false;
+  }
+
+  return true;
+}
+
+bool sigcache::enabled() {
+  std::lock_guard<std::mutex> guard(lock);
+  return !file.empty();
+}
+
+bool sigcache::find(HANDLE hProcess, const MODULEENTRY32& module, const pattern::Signature& signature,
+                    uintptr_t* match) {
+  if (!enabled() || signature.bytes.empty()) return false;
+
+  Entry key = {0, 0, identifySignature(signature), 0};
+  identify(hProcess, module, &key.path, &key.module);
+
+  uint64_t offset;
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    const Entry* found = lookup(key);
+
+    if (!found) {
+      misses++;
+      return false;
+    }
+
+    offset = found->offset;
+  }
+
+  // The cached match still has to match, in case the module was patched in memory or two identities collided
+  uintptr_t address = uintptr_t(module.hModule) + (uintptr_t)offset;
+  std::vector<unsigned char> bytes(signature.bytes.size());
+
+  if (memory::read(hProcess, address, bytes.data(), bytes.size()) != bytes.size() ||
+      pattern::scan(bytes.data(), bytes.size(), signature) != 0) {
+    misses++;
+    return false;
+  }
+
+  hits++;
+  *match = address;
+  return true;
+}
+
+void sigcache::store(HANDLE hProcess, const MODULEENTRY32& module, const pattern::Signature& signature,
+                     uintptr_t match) {
+  if (!enabled() || signature.bytes.empty()) return;
+
+  Entry entry = {0, 0, identifySignature(signature), (uint64_t)(match - uintptr_t(module.hModule))};
+  identify(hProcess, module, &entry.path, &entry.module);
+
+  std::lock_guard<std::mutex> guard(lock);
+  stored.push_back(entry);
+}
+
+bool sigcache::flush() {
+  std::lock_guard<std::mutex> guard(lock);
+  return flushLocked();
+}
+
+void sigcache::clear() {
+  std::lock_guard<std::mutex> guard(lock);
+
+  mapfile::unmap(mapping);
+  entries = nullptr;
+  count = 0;
+  stored.clear();
+
+  if (!file.empty()) remove(file.c_str());
+}
+
+sigcache::Stats sigcache::stats() {
+  std::lock_guard<std::mutex> guard(lock);
+  Stats stats = {hits, misses, count + stored.size()};
+  return stats;
+}
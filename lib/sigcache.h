@@ -0,0 +1,54 @@
+#pragma once
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+
+#include <windows.h>
+#include <TlHelp32.h>
+#else
+#include "compat.h"
+#endif
+#include <stdint.h>
+#include <string>
+#include "pattern.h"
+
+// An opt-in cache of where signatures matched, kept in a file so that attaching to the same build of a program again
+// skips the scans.
+//
+// Entries are keyed by the module's identity (its path, size, and a hash of its headers, or its build-id on Linux)
+// and by the signature's bytes. Matches are stored relative to the module base, so ASLR does not invalidate them, and
+// are checked against memory before they are trusted. Once a module's identity changes, its old entries are dropped.
+//
+// The file is a header followed by fixed-size entries sorted by key, memory-mapped and binary searched in place.
+namespace sigcache {
+struct Stats {
+  uint64_t hits;
+  uint64_t misses;
+  size_t entries;
+};
+
+// Uses the cache file at `path`, which is created on the first store if it does not exist. An empty path turns the
+// cache off. Returns false, with the cache turned off, if the file exists but is not a cache file.
+bool open(const std::string& path, char** errorMessage);
+
+bool enabled();
+
+// Finds where `signature` matched in `module` before. `match` is an address in the module as it is loaded now.
+bool find(HANDLE hProcess, const MODULEENTRY32& module, const pattern::Signature& signature, uintptr_t* match);
+
+// Remembers a match until the next flush. Stored matches are found by `find` right away.
+void store(HANDLE hProcess, const MODULEENTRY32& module, const pattern::Signature& signature, uintptr_t match);
+
+// Writes stored matches to the file, replacing it in one rename. Called once per batch of scans (findPatterns), when
+// asked to, when the cache is switched to another file and when an environment is torn down, rather than after every
+// scan, since it rewrites the whole file.
+bool flush();
+
+// Removes every entry, from the file too.
+void clear();
+
+Stats stats();
+
+// The module's path on its own, and its identity: its path, size and contents together. Other caches of what is in a
+// module are keyed by the identity too.
+void identify(HANDLE hProcess, const MODULEENTRY32& module, uint64_t* path, uint64_t* identity);
+}  // namespace sigcache
@@ -0,0 +1,409 @@
+#include "snapshot.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include "mapfile.h"
+#include "memory.h"
+#include "module.h"
+
+namespace {
+const char magic[8] = {'M', 'J', 'S', 'D', 'U', 'M', 'P', 0};
+const uint32_t version = 1;
+const uint64_t pageSize = 0x1000;
+
+const uint32_t compressed = 1;
+const uint32_t zeroPage = UINT32_MAX;  // a left out page in the table of a compressed region
+
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t pageSize;
+  uint32_t moduleCount;
+  uint32_t regionCount;
+  uint64_t modules;  // offsets of the tables
+  uint64_t regions;
+};
+
+struct Module {
+  uint64_t base;
+  uint64_t size;
+  char name[256];
+  char path[264];
+};
+
+// Sorted by base address.
+struct Region {
+  uint64_t base;
+  uint64_t size;
+  uint32_t protect;
+  uint32_t type;
+  int32_t module;  // index into the module table, or -1
+  uint32_t flags;
+  uint64_t data;   // offset of the first stored page
+  uint64_t pages;  // offset of the page table if compressed, 0 otherwise
+};
+
+struct Dump {
+  mapfile::Mapping mapping;
+  const Module* modules;
+  const Region* regions;
+  size_t moduleCount;
+  size_t regionCount;
+
+  ~Dump() {
+    mapfile::unmap(mapping);
+  }
+
+  const Region* find(DWORD64 address) const {
+    const Region* next = std::upper_bound(regions, regions + regionCount, address,
+                                          [](DWORD64 address, const Region& region) { return address < region.base; });
+    if (next == regions) return nullptr;
+
+    const Region* region = next - 1;
+    return address - region->base < region->size ? region : nullptr;
+  }
+
+  // The stored bytes of the page at `address`, or null for a left out page.
+  const unsigned char* page(const Region& region, DWORD64 address) const {
+    uint64_t index = (address - region.base) / pageSize;
+
+    if (!(region.flags & compressed)) return mapping.data + region.data + index * pageSize;
+
+    uint32_t stored = ((const uint32_t*)(mapping.data + region.pages))[index];
+    return stored == zeroPage ? nullptr : mapping.data + region.data + stored * pageSize;
+  }
+};
+
+std::mutex lock;
+std::map<intptr_t, std::shared_ptr<const Dump>> dumps;
+intptr_t nextId = 0;
+
+std::shared_ptr<const Dump> dumpOf(HANDLE handle) {
+  std::lock_guard<std::mutex> guard(lock);
+  auto found = dumps.find(snapshot::firstHandle - (intptr_t)handle);
+  return found == dumps.end() ? nullptr : found->second;
+}
+
+bool isZero(const unsigned char* page) {
+  const uint64_t* words = (const uint64_t*)page;
+
+  for (size_t i = 0; i < pageSize / sizeof(uint64_t); i++) {
+    if (words[i]) return false;
+  }
+
+  return true;
+}
+
+// Writes through `output`, keeping track of the offset since fseek cannot go past 2GB everywhere.
+class Writer {
+ public:
+  explicit Writer(FILE* output) : output(output), position(0), failed(false) {}
+
+  void write(const void* data, size_t size) {
+    if (failed || !size) return;
+    failed = fwrite(data, 1, size, output) != size;
+    position += size;
+  }
+
+  void align() {
+    static const unsigned char zeros[pageSize] = {0};
+    write(zeros, (size_t)((pageSize - position % pageSize) % pageSize));
+  }
+
+  FILE* output;
+  uint64_t position;
+  bool failed;
+};
+
+}  // namespace
+
+bool snapshot::dump(HANDLE hProcess, const std::string& path, const region::Filter& filter, bool compress,
+                    Summary* summary, char** errorMessage, const std::atomic<bool>* cancelled) {
+  std::vector<MEMORY_BASIC_INFORMATION> selected = region::select(hProcess, filter);
+
+  char* moduleError = "";
+  std::vector<MODULEENTRY32> modules = owns(hProcess) ? getModules(hProcess)
+                                                      : module::getModules(GetProcessId(hProcess), &moduleError);
+  std::sort(modules.begin(), modules.end(),
+            [](const MODULEENTRY32& a, const MODULEENTRY32& b) { return a.modBaseAddr < b.modBaseAddr; });
+
+  FILE* output = fopen(path.c_str(), "wb");
+  if (!output) {
+    *errorMessage = "unable to create the dump file";
+    return false;
+  }
+
+  Writer writer(output);
+  Header header = {};
+  memcpy(header.magic, magic, sizeof(magic));
+  header.version = version;
+  header.pageSize = (uint32_t)pageSize;
+  writer.write(&header, sizeof(header));
+  writer.align();
+
+  std::vector<Region> regions;
+  std::vector<unsigned char> buffer(region::bufferSize);
+  summary->regions = 0;
+  summary->bytes = 0;
+
+  for (auto& selection : selected) {
+    if (cancelled && *cancelled) break;
+
+    // Regions are whole pages, but the filter may have clipped one anywhere
+    DWORD64 start = (DWORD64)selection.BaseAddress & ~(pageSize - 1);
+    DWORD64 end = ((DWORD64)selection.BaseAddress + selection.RegionSize + pageSize - 1) & ~(pageSize - 1);
+    if (!regions.empty() && start < regions.back().base + regions.back().size) {
+      start = regions.back().base + regions.back().size;
+    }
+    if (start >= end) continue;
+
+    Region entry = {start, end - start, selection.Protect, selection.Type, -1, compress ? compressed : 0, 0, 0};
+    entry.data = writer.position;
+
+    auto next = std::upper_bound(modules.begin(), modules.end(), start, [](DWORD64 address, const MODULEENTRY32& m) {
+      return address < (DWORD64)m.modBaseAddr;
+    });
+    if (next != modules.begin() && start - (DWORD64)(next - 1)->modBaseAddr < (next - 1)->modBaseSize) {
+      entry.module = (int32_t)(next - 1 - modules.begin());
+    }
+
+    std::vector<uint32_t> pages;
+
+    for (DWORD64 address = start; address < end && !(cancelled && *cancelled);) {
+      SIZE_T size = (SIZE_T)std::min<DWORD64>(buffer.size(), end - address);
+      region::readFilled(hProcess, address, buffer.data(), size);
+
+      if (!compress) {
+        writer.write(buffer.data(), size);
+      } else {
+        for (SIZE_T offset = 0; offset < size; offset += (SIZE_T)pageSize) {
+          if (isZero(&buffer[offset])) {
+            pages.push_back(zeroPage);
+            continue;
+          }
+
+          pages.push_back((uint32_t)((writer.position - entry.data) / pageSize));
+          writer.write(&buffer[offset], (size_t)pageSize);
+        }
+      }
+
+      address += size;
+    }
+
+    // The region cut short is dropped along with the file
+    if (cancelled && *cancelled) break;
+
+    if (compress) {
+      entry.pages = writer.position;
+      writer.write(pages.data(), pages.size() * sizeof(uint32_t));
+      writer.align();
+    }
+
+    regions.push_back(entry);
+    summary->regions++;
+    summary->bytes += entry.size;
+  }
+
+  if (cancelled && *cancelled) {
+    fclose(output);
+    remove(path.c_str());
+    *errorMessage = "the dump was cancelled";
+    return false;
+  }
+
+  std::vector<Module> table(modules.size());
+  for (size_t i = 0; i < modules.size(); i++) {
+    table[i].base = (uint64_t)modules[i].modBaseAddr;
+    table[i].size = modules[i].modBaseSize;
+    strncpy(table[i].name, modules[i].szModule, sizeof(table[i].name) - 1);
+    strncpy(table[i].path, modules[i].szExePath, sizeof(table[i].path) - 1);
+  }
+
+  header.moduleCount = (uint32_t)table.size();
+  header.modules = writer.position;
+  writer.write(table.data(), table.size() * sizeof(Module));
+
+  header.regionCount = (uint32_t)regions.size();
+  header.regions = writer.position;
+  writer.write(regions.data(), regions.size() * sizeof(Region));
+
+  // The header is written last, so a dump that was cut short is never mistaken for a complete one
+  bool written = !writer.failed && fseek(output, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, output) == 1;
+  written = fclose(output) == 0 && written;
+
+  if (!written) {
+    remove(path.c_str());
+    *errorMessage = "unable to write the dump file";
+    return false;
+  }
+
+  return true;
+}
+
+HANDLE snapshot::open(const std::string& path, char** errorMessage) {
+  std::shared_ptr<Dump> dump = std::make_shared<Dump>();
+
+  if (!mapfile::map(path, dump->mapping)) {
+    *errorMessage = "unable to open the dump file";
+    return NULL;
+  }
+
+  const unsigned char* data = dump->mapping.data;
+  uint64_t size = dump->mapping.size;
+  const Header* header = (const Header*)data;
+
+  bool valid = size >= sizeof(Header) && !memcmp(header->magic, magic, sizeof(magic)) &&
+               header->version == version && header->pageSize == pageSize && header->modules <= size &&
+               (size - header->modules) / sizeof(Module) >= header->moduleCount && header->regions <= size &&
+               (size - header->regions) / sizeof(Region) >= header->regionCount;
+
+  if (valid) {
+    dump->modules = (const Module*)(data + header->modules);
+    dump->regions = (const Region*)(data + header->regions);
+    dump->moduleCount = header->moduleCount;
+    dump->regionCount = header->regionCount;
+
+    // Every page a region can point at has to be in the file, so reads never need to check
+    for (size_t i = 0; valid && i < dump->regionCount; i++) {
+      const Region& region = dump->regions[i];
+      uint64_t pages = region.size / pageSize;
+
+      valid = region.size % pageSize == 0 &&
+              (i == 0 || region.base >= dump->regions[i - 1].base + dump->regions[i - 1].size) &&
+              (region.module == -1 || (region.module >= 0 && (uint64_t)region.module < dump->moduleCount));
+
+      if (valid && !(region.flags & compressed)) {
+        valid = region.data <= size && (size - region.data) / pageSize >= pages;
+      } else if (valid) {
+        valid = region.pages <= size && (size - region.pages) / sizeof(uint32_t) >= pages;
+
+        const uint32_t* table = (const uint32_t*)(data + region.pages);
+        uint64_t stored = valid && region.data <= size ? (size - region.data) / pageSize : 0;
+
+        for (uint64_t page = 0; valid && page < pages; page++) {
+          valid = table[page] == zeroPage || table[page] < stored;
+        }
+      }
+    }
+  }
+
+  if (!valid) {
+    *errorMessage = "the file is not a memory dump";
+    return NULL;
+  }
+
+  std::lock_guard<std::mutex> guard(lock);
+  intptr_t id = nextId++;
+  dumps[id] = dump;
+  return (HANDLE)(firstHandle - id);
+}
+
+bool snapshot::close(HANDLE handle) {
+  std::lock_guard<std::mutex> guard(lock);
+  return dumps.erase(firstHandle - (intptr_t)handle) != 0;
+}
+
+SIZE_T snapshot::read(HANDLE handle, DWORD64 address, void* buffer, SIZE_T size) {
+  std::shared_ptr<const Dump> dump = dumpOf(handle);
+  if (!dump) return 0;
+
+  // Like ReadProcessMemory, stops at the first byte that is not in the dump
+  SIZE_T total = 0;
+
+  while (total < size) {
+    DWORD64 cursor = address + total;
+    const Region* region = dump->find(cursor);
+    if (!region) break;
+
+    SIZE_T chunk = (SIZE_T)std::min<DWORD64>(pageSize - (cursor & (pageSize - 1)), size - total);
+    const unsigned char* page = dump->page(*region, cursor);
+    unsigned char* destination = (unsigned char*)buffer + total;
+
+    if (page) {
+      memcpy(destination, page + (cursor & (pageSize - 1)), chunk);
+    } else {
+      memset(destination, 0, chunk);
+    }
+
+    total += chunk;
+  }
+
+  return total;
+}
+
+std::vector<MEMORY_BASIC_INFORMATION> snapshot::getRegions(HANDLE handle) {
+  std::vector<MEMORY_BASIC_INFORMATION> regions;
+  std::shared_ptr<const Dump> dump = dumpOf(handle);
+  if (!dump) return regions;
+
+  for (size_t i = 0; i < dump->regionCount; i++) {
+    const Region& stored = dump->regions[i];
+    MEMORY_BASIC_INFORMATION region;
+    memset(&region, 0, sizeof(region));
+
+    region.BaseAddress = (PVOID)stored.base;
+    region.AllocationBase = stored.module >= 0 ? (PVOID)dump->modules[stored.module].base : (PVOID)stored.base;
+    region.RegionSize = (SIZE_T)stored.size;
+    region.State = MEM_COMMIT;
+    region.Protect = stored.protect;
+    region.AllocationProtect = stored.protect;
+    region.Type = stored.type;
+    regions.push_back(region);
+  }
+
+  return regions;
+}
+
+std::vector<MODULEENTRY32> snapshot::getModules(HANDLE handle) {
+  std::vector<MODULEENTRY32> modules;
+  std::shared_ptr<const Dump> dump = dumpOf(handle);
+  if (!dump) return modules;
+
+  for (size_t i = 0; i < dump->moduleCount; i++) {
+    const Module& stored = dump->modules[i];
+    MODULEENTRY32 module;
+    memset(&module, 0, sizeof(module));
+
+    module.dwSize = sizeof(module);
+    module.modBaseAddr = (BYTE*)stored.base;
+    module.modBaseSize = (DWORD)stored.size;
+    module.hModule = (HMODULE)stored.base;
+    // The stored names may fill their arrays without a terminator
+    snprintf(module.szModule, sizeof(module.szModule), "%.*s", (int)sizeof(stored.name), stored.name);
+    snprintf(module.szExePath, sizeof(module.szExePath), "%.*s", (int)sizeof(stored.path), stored.path);
+    modules.push_back(module);
+  }
+
+  return modules;
+}
+
+std::shared_ptr<const void> snapshot::retain(HANDLE handle) {
+  return dumpOf(handle);
+}
+
+const unsigned char* snapshot::view(HANDLE handle, DWORD64 address, SIZE_T size) {
+  std::shared_ptr<const Dump> dump = dumpOf(handle);
+  if (!dump || !size) return nullptr;
+
+  const Region* region = dump->find(address);
+  if (!region || region->flags & compressed) return nullptr;
+
+  // Uncompressed regions that follow each other in memory also follow each other in the file
+  const unsigned char* start = dump->page(*region, address) + (address & (pageSize - 1));
+  DWORD64 end = address + size;
+
+  while (end > region->base + region->size) {
+    const Region* next = region + 1;
+    if (next == dump->regions + dump->regionCount || next->base != region->base + region->size ||
+        next->flags & compressed || next->data != region->data + region->size) {
+      return nullptr;
+    }
+
+    region = next;
+  }
+
+  return start;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+
+#include <windows.h>
+#include <TlHelp32.h>
+#else
+#include "compat.h"
+#endif
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include "region.h"
+
+// Dumps of a process' memory that can be opened later and read like the process itself.
+//
+// A dump is a header, a table of modules, a table of regions (base, size, protection, type and module) and then the
+// data of every region, each starting on a page boundary. A compressed region leaves out its pages that are all zero
+// and is followed by a table giving the position of every page that was kept.
+//
+// An opened dump is memory-mapped and gets a handle that memory::read, memory::getRegions, module lookups and
+// region::stream recognise, so reading memory and scanning for patterns work on it as on a live process.
+namespace snapshot {
+// Handles of opened dumps count down from here, far below the handles and pseudo-handles of processes.
+const intptr_t firstHandle = -0x10000;
+
+inline bool owns(HANDLE handle) {
+  return (intptr_t)handle <= firstHandle;
+}
+
+struct Summary {
+  size_t regions;
+  uint64_t bytes;  // of memory dumped, before compression
+};
+
+// Writes the regions that pass the filter to `path`, reading them through one buffer. Pages that cannot be read are
+// stored as zeros. Once `cancelled` (if given) is set it stops, removes the file and returns false.
+bool dump(HANDLE hProcess, const std::string& path, const region::Filter& filter, bool compress, Summary* summary,
+          char** errorMessage, const std::atomic<bool>* cancelled = nullptr);
+
+// Opens a dump, returning a handle for it or null.
+HANDLE open(const std::string& path, char** errorMessage);
+
+// Returns false if the handle is not an open dump.
+bool close(HANDLE handle);
+
+SIZE_T read(HANDLE handle, DWORD64 address, void* buffer, SIZE_T size);
+std::vector<MEMORY_BASIC_INFORMATION> getRegions(HANDLE handle);
+std::vector<MODULEENTRY32> getModules(HANDLE handle);
+
+// Keeps a dump mapped for as long as the result is held, even if it is closed in the meantime.
+std::shared_ptr<const void> retain(HANDLE handle);
+
+// Returns the dumped bytes at [address, address + size) in place, or null if they are not stored contiguously (they
+// are not all dumped, or some are in a compressed region). Valid while the dump is retained.
+const unsigned char* view(HANDLE handle, DWORD64 address, SIZE_T size);
+}  // namespace snapshot
@@ -0,0 +1,239 @@
+#include "stats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+
+namespace {
+const size_t maxApis = 256;
+const size_t none = (size_t)-1;
+
+enum Counter { SYSCALLS, READS, BYTES_READ, FAILED_READS, PARTIAL_READS, SCAN_BYTES, SCAN_NANOSECONDS, COUNTERS };
+
+struct ApiCounters {
+  std::atomic<uint64_t> calls;
+  std::atomic<uint64_t> nanoseconds;
+  std::atomic<uint64_t> histogram[stats::buckets];
+};
+
+// Written by its own thread only, so a relaxed load and store is enough, and read by whoever gets the stats
+struct Block {
+  std::atomic<uint64_t> counters[COUNTERS];
+  ApiCounters apis[maxApis];
+};
+
+// Plain totals, for adding blocks up
+struct Sums {
+  uint64_t counters[COUNTERS];
+  uint64_t calls[maxApis];
+  uint64_t nanoseconds[maxApis];
+  uint64_t histogram[maxApis][stats::buckets];
+};
+
+// Never destroyed, like the buffer pool: threads of the libuv pool exit, and retire their blocks, after static objects
+// are torn down
+std::mutex& lock = *new std::mutex();
+std::vector<Block*>& blocks = *new std::vector<Block*>();
+std::unique_ptr<Sums>& retired = *new std::unique_ptr<Sums>();   // the blocks of threads that exited
+std::unique_ptr<Sums>& baseline = *new std::unique_ptr<Sums>();  // the totals at the last reset
+
+const char* names[maxApis];
+size_t registered = 0;
+
+void add(std::atomic<uint64_t>& counter, uint64_t value) {
+  counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+void sum(const Block& block, Sums& sums) {
+  for (size_t i = 0; i < COUNTERS; i++) sums.counters[i] += block.counters[i].load(std::memory_order_relaxed);
+
+  for (size_t api = 0; api < maxApis; api++) {
+    sums.calls[api] += block.apis[api].calls.load(std::memory_order_relaxed);
+    sums.nanoseconds[api] += block.apis[api].nanoseconds.load(std::memory_order_relaxed);
+
+    for (size_t bucket = 0; bucket < stats::buckets; bucket++) {
+      sums.histogram[api][bucket] += block.apis[api].histogram[bucket].load(std::memory_order_relaxed);
+    }
+  }
+}
+
+// Everything counted since the start, with the lock held
+std::unique_ptr<Sums> total() {
+  std::unique_ptr<Sums> sums(new Sums());
+  for (const Block* block : blocks) sum(*block, *sums);
+
+  if (retired) {
+    for (size_t i = 0; i < COUNTERS; i++) sums->counters[i] += retired->counters[i];
+
+    for (size_t api = 0; api < maxApis; api++) {
+      sums->calls[api] += retired->calls[api];
+      sums->nanoseconds[api] += retired->nanoseconds[api];
+      for (size_t bucket = 0; bucket < stats::buckets; bucket++) {
+        sums->histogram[api][bucket] += retired->histogram[api][bucket];
+      }
+    }
+  }
+
+  return sums;
+}
+
+// The block of the calling thread, created the first time it counts something. When the thread exits its counts are
+// moved to `retired`.
+class Owner {
+ public:
+  ~Owner() {
+    if (!block) return;
+
+    std::lock_guard<std::mutex> guard(lock);
+    if (!retired) retired.reset(new Sums());
+    sum(*block, *retired);
+    blocks.erase(std::find(blocks.begin(), blocks.end(), block));
+    delete block;
+  }
+
+  Block& get() {
+    if (!block) {
+      block = new Block();
+      std::lock_guard<std::mutex> guard(lock);
+      blocks.push_back(block);
+    }
+
+    return *block;
+  }
+
+ private:
+  Block* block = nullptr;
+};
+
+thread_local Owner owner;
+
+// The innermost binding running on this thread
+thread_local stats::Call* active = nullptr;
+
+size_t bucket(uint64_t nanoseconds) {
+  size_t width = 0;
+  for (; nanoseconds; nanoseconds >>= 1) width++;
+  return width < stats::buckets ? width : stats::buckets - 1;
+}
+
+void record(size_t api, uint64_t nanoseconds) {
+  if (api >= maxApis) return;
+
+  ApiCounters& counters = owner.get().apis[api];
+  add(counters.calls, 1);
+  add(counters.nanoseconds, nanoseconds);
+  add(counters.histogram[bucket(nanoseconds)], 1);
+}
+}  // namespace
+
+bool stats::enabled() {
+#ifdef MEMORYJS_NO_STATS
+  return false;
+#else
+  return true;
+#endif
+}
+
+stats::Totals stats::get() {
+  std::lock_guard<std::mutex> guard(lock);
+  std::unique_ptr<Sums> sums = total();
+
+  if (baseline) {
+    for (size_t i = 0; i < COUNTERS; i++) sums->counters[i] -= baseline->counters[i];
+
+    for (size_t api = 0; api < maxApis; api++) {
+      sums->calls[api] -= baseline->calls[api];
+      sums->nanoseconds[api] -= baseline->nanoseconds[api];
+      for (size_t bucket = 0; bucket < buckets; bucket++) {
+        sums->histogram[api][bucket] -= baseline->histogram[api][bucket];
+      }
+    }
+  }
+
+  Totals totals;
+  totals.syscalls = sums->counters[SYSCALLS];
+  totals.reads = sums->counters[READS];
+  totals.bytesRead = sums->counters[BYTES_READ];
+  totals.failedReads = sums->counters[FAILED_READS];
+  totals.partialReads = sums->counters[PARTIAL_READS];
+  totals.scanBytes = sums->counters[SCAN_BYTES];
+  totals.scanNanoseconds = sums->counters[SCAN_NANOSECONDS];
+
+  for (size_t api = 0; api < registered; api++) {
+    if (!sums->calls[api]) continue;
+
+    Api entry;
+    entry.name = names[api];
+    entry.calls = sums->calls[api];
+    entry.nanoseconds = sums->nanoseconds[api];
+    std::copy(sums->histogram[api], sums->histogram[api] + buckets, entry.histogram);
+    totals.apis.push_back(entry);
+  }
+
+  return totals;
+}
+
+void stats::reset() {
+  std::lock_guard<std::mutex> guard(lock);
+  baseline = total();
+}
+
+size_t stats::api(const char* name) {
+  std::lock_guard<std::mutex> guard(lock);
+
+  if (registered == maxApis) return none;
+
+  names[registered] = name;
+  return registered++;
+}
+
+void stats::syscalls(uint64_t count) {
+  add(owner.get().counters[SYSCALLS], count);
+}
+
+void stats::read(uint64_t requested, uint64_t bytesRead) {
+  Block& block = owner.get();
+  add(block.counters[READS], 1);
+  add(block.counters[BYTES_READ], bytesRead);
+
+  if (bytesRead == 0 && requested) {
+    add(block.counters[FAILED_READS], 1);
+  } else if (bytesRead < requested) {
+    add(block.counters[PARTIAL_READS], 1);
+  }
+}
+
+void stats::scanned(uint64_t bytes, uint64_t nanoseconds) {
+  Block& block = owner.get();
+  add(block.counters[SCAN_BYTES], bytes);
+  add(block.counters[SCAN_NANOSECONDS], nanoseconds);
+}
+
+uint64_t stats::now() {
+  return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+stats::Call::Call(size_t api) : id(api), start(now()), deferred(false), outer(active) {
+  active = this;
+}
+
+stats::Call::~Call() {
+  active = outer;
+  if (!deferred) record(id, now() - start);
+}
+
+stats::Pending::Pending() : id(none), start(0) {
+  if (!active) return;
+
+  id = active->id;
+  start = active->start;
+  active->deferred = true;
+}
+
+void stats::Pending::finish() const {
+  record(id, now() - start);
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Counters of what the addon does, cheap enough to leave on: how often every binding is called and how long it takes,
+// the system calls and reads made on the target, and how fast memory is scanned.
+//
+// Every thread counts into its own block, which only it writes to, so counting takes no locks and no atomic
+// read-modify-writes. Getting the stats adds the blocks up, and resetting them remembers the totals to subtract.
+//
+// Building with MEMORYJS_NO_STATS defined compiles every counter out of the code that uses MEMORYJS_STATS.
+#ifdef MEMORYJS_NO_STATS
+#define MEMORYJS_STATS(statement)
+#define MEMORYJS_STATS_CALL(name)
+#else
+#define MEMORYJS_STATS(statement) statement
+
+// Times the rest of the enclosing binding, counted under `name`
+#define MEMORYJS_STATS_CALL(name)                    \
+  static const size_t statsApi = stats::api(name); \
+  stats::Call statsCall(statsApi)
+#endif
+
+namespace stats {
+// Latency histogram buckets. Bucket 0 counts calls that took under a nanosecond, bucket i those that took from 2^(i-1)
+// up to 2^i nanoseconds, and the last one everything longer.
+const size_t buckets = 40;
+
+struct Api {
+  std::string name;
+  uint64_t calls;
+  uint64_t nanoseconds;  // in total
+  uint64_t histogram[buckets];
+};
+
+struct Totals {
+  uint64_t syscalls;        // reads and region queries made on live processes
+  uint64_t reads;           // memory requested from the target, one per address read
+  uint64_t bytesRead;
+  uint64_t failedReads;     // reads that got nothing
+  uint64_t partialReads;    // reads that got some of the bytes, but not all
+  uint64_t scanBytes;       // bytes searched by pattern scans
+  uint64_t scanNanoseconds; // time spent searching them, reads left out
+  std::vector<Api> apis;    // the bindings called since the last reset
+};
+
+// false if the counters were compiled out
+bool enabled();
+
+Totals get();
+void reset();
+
+// Returns the id that a binding's calls are counted under. Meant to be kept in a static.
+size_t api(const char* name);
+
+void syscalls(uint64_t count);
+void read(uint64_t requested, uint64_t bytesRead);
+void scanned(uint64_t bytes, uint64_t nanoseconds);
+
+uint64_t now();
+
+// Counts a call of a binding, and how long it took once it goes out of scope.
+class Call {
+ public:
+  explicit Call(size_t api);
+  ~Call();
+
+  Call(const Call&) = delete;
+  Call& operator=(const Call&) = delete;
+
+ private:
+  friend struct Pending;
+
+  size_t id;
+  uint64_t start;
+  bool deferred;
+  Call* outer;
+};
+
+// The timing of a call whose result comes later, on the thread pool. Taken from the call that is running on this
+// thread, which then leaves the timing to it: the call counts as taking until `finish`.
+struct Pending {
+  Pending();
+
+  void finish() const;
+
+  size_t id;
+  uint64_t start;
+};
+
+// Counts the bytes searched while it is in scope, and the time it took.
+class Scan {
+ public:
+  explicit Scan(uint64_t bytes) : bytes(bytes), start(now()) {}
+  ~Scan() { scanned(bytes, now() - start); }
+
+ private:
+  uint64_t bytes;
+  uint64_t start;
+};
+}  // namespace stats
@@ -0,0 +1,109 @@
+#include "symbols.h"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include "addressmap.h"
+#include "sigcache.h"
+
+namespace {
+struct Index {
+  std::vector<module::Symbol> symbols;            // sorted by offset
+  std::unordered_map<std::string, size_t> names;  // name to index into `symbols`
+};
+
+std::mutex lock;
+std::unordered_map<uint64_t, std::shared_ptr<const Index>> indexes;
+
+std::shared_ptr<const Index> getIndex(HANDLE hProcess, const MODULEENTRY32& module, char** errorMessage) {
+  uint64_t path, identity;
+  sigcache::identify(hProcess, module, &path, &identity);
+
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    auto cached = indexes.find(identity);
+    if (cached != indexes.end()) return cached->second;
+  }
+
+  // Parsed outside the lock, so that lookups in other modules do not wait on it. Two threads may both parse the same
+  // module the first time, and the index of whichever finishes first is kept.
+  std::shared_ptr<Index> index = std::make_shared<Index>();
+  if (!module::getSymbols(hProcess, module, index->symbols)) {
+    *errorMessage = "unable to read the symbols of the module";
+    return nullptr;
+  }
+
+  // A symbol in both the dynamic and the static symbol table is kept once
+  std::vector<module::Symbol>& symbols = index->symbols;
+  std::sort(symbols.begin(), symbols.end(), [](const module::Symbol& a, const module::Symbol& b) {
+    return a.offset != b.offset ? a.offset < b.offset : a.name < b.name;
+  });
+  symbols.erase(std::unique(symbols.begin(), symbols.end(),
+                            [](const module::Symbol& a, const module::Symbol& b) {
+                              return a.offset == b.offset && a.name == b.name;
+                            }),
+                symbols.end());
+
+  index->names.reserve(index->symbols.size());
+  for (size_t i = 0; i < index->symbols.size(); i++) index->names.emplace(index->symbols[i].name, i);
+
+  std::lock_guard<std::mutex> guard(lock);
+  return indexes.emplace(identity, index).first->second;
+}
+
+symbols::Symbol toSymbol(const MODULEENTRY32& module, const module::Symbol& symbol) {
+  return {module.szModule, symbol.name, (DWORD64)module.modBaseAddr + symbol.offset, symbol.size};
+}
+}  // namespace
+
+bool symbols::find(HANDLE hProcess, const std::string& moduleName, const std::string& name, Symbol* symbol,
+                   char** errorMessage) {
+  MODULEENTRY32 module;
+  if (!addressmap::findModule(hProcess, moduleName, &module, errorMessage)) return false;
+
+  std::shared_ptr<const Index> index = getIndex(hProcess, module, errorMessage);
+  if (!index) return false;
+
+  auto found = index->names.find(name);
+  if (found == index->names.end()) return false;
+
+  *symbol = toSymbol(module, index->symbols[found->second]);
+  return true;
+}
+
+bool symbols::findForAddress(HANDLE hProcess, DWORD64 address, Symbol* symbol, DWORD64* displacement) {
+  MODULEENTRY32 module;
+  if (!addressmap::findModuleForAddress(hProcess, address, &module)) return false;
+
+  char* errorMessage = "";
+  std::shared_ptr<const Index> index = getIndex(hProcess, module, &errorMessage);
+  if (!index) return false;
+
+  uint64_t offset = address - (DWORD64)module.modBaseAddr;
+  auto after = std::upper_bound(index->symbols.begin(), index->symbols.end(), offset,
+                                [](uint64_t offset, const module::Symbol& symbol) { return offset < symbol.offset; });
+  if (after == index->symbols.begin()) return false;
+
+  const module::Symbol& closest = *(after - 1);
+  if (closest.size && offset - closest.offset >= closest.size) return false;
+
+  *symbol = toSymbol(module, closest);
+  *displacement = offset - closest.offset;
+  return true;
+}
+
+std::vector<symbols::Symbol> symbols::getSymbols(HANDLE hProcess, const std::string& moduleName,
+                                                 char** errorMessage) {
+  std::vector<Symbol> result;
+
+  MODULEENTRY32 module;
+  if (!addressmap::findModule(hProcess, moduleName, &module, errorMessage)) return result;
+
+  std::shared_ptr<const Index> index = getIndex(hProcess, module, errorMessage);
+  if (!index) return result;
+
+  result.reserve(index->symbols.size());
+  for (const module::Symbol& symbol : index->symbols) result.push_back(toSymbol(module, symbol));
+  return result;
+}
@@ -0,0 +1,38 @@
+#pragma once
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+
+#include <windows.h>
+#include <TlHelp32.h>
+#else
+#include "compat.h"
+#endif
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "module.h"
+
+// Looking up the functions and globals modules export, by name or by an address inside them.
+//
+// A module's symbols are read from its image the first time they are looked up and kept in an index, shared by every
+// process that loads the same module (see sigcache::identify), so later lookups are a hash lookup or a binary search.
+namespace symbols {
+struct Symbol {
+  std::string module;
+  std::string name;
+  DWORD64 address;
+  uint64_t size;  // 0 if not known
+};
+
+// Finds a symbol of a module by name. Sets `errorMessage` if the module could not be found or parsed, and returns false
+// without setting it if the module has no such symbol.
+bool find(HANDLE hProcess, const std::string& moduleName, const std::string& name, Symbol* symbol,
+          char** errorMessage);
+
+// Finds the symbol an address is in: the closest one at or below it in the module it belongs to, unless the address is
+// past the end of a symbol whose size is known. `displacement` is how far into the symbol the address is.
+bool findForAddress(HANDLE hProcess, DWORD64 address, Symbol* symbol, DWORD64* displacement);
+
+// Returns every symbol of a module, sorted by address.
+std::vector<Symbol> getSymbols(HANDLE hProcess, const std::string& moduleName, char** errorMessage);
+}  // namespace symbols
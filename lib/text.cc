@@ -0,0 +1,99 @@
+#include "text.h"
+
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include "memory.h"
+
+namespace {
+const DWORD64 pageSize = 0x1000;
+
+// The largest block read at once, in pages.
+const size_t maxBlockPages = 16;
+
+size_t unitSize(text::Encoding encoding) {
+  return encoding == text::UTF16 ? 2 : 1;
+}
+
+// Appends up to `size` bytes at `address` to `out`. If the block as a whole cannot be read it is read again page by
+// page, keeping everything before the first unreadable page. Returns the number of bytes appended.
+SIZE_T append(HANDLE hProcess, DWORD64 address, SIZE_T size, std::string& out) {
+  size_t start = out.size();
+  out.resize(start + size);
+
+  SIZE_T total = memory::read(hProcess, address, &out[start], size);
+
+  if (total < size) {
+    total = 0;
+
+    while (total < size) {
+      DWORD64 cursor = address + total;
+      SIZE_T chunk = std::min<DWORD64>(pageSize - (cursor & (pageSize - 1)), size - total);
+      SIZE_T bytesRead = memory::read(hProcess, cursor, &out[start + total], chunk);
+
+      total += bytesRead;
+      if (bytesRead < chunk) break;
+    }
+  }
+
+  out.resize(start + total);
+  return total;
+}
+
+// Returns the offset of the first zero code unit in data[from, to), or `to` if there is none.
+size_t findTerminator(const char* data, size_t from, size_t to, size_t unit) {
+  if (unit == 1) {
+    const void* terminator = memchr(data + from, 0, to - from);
+    return terminator ? (const char*)terminator - data : to;
+  }
+
+  for (size_t i = from; i + 2 <= to; i += 2) {
+    if (!data[i] && !data[i + 1]) return i;
+  }
+
+  return to;
+}
+}  // namespace
+
+text::Status text::read(HANDLE hProcess, DWORD64 address, Encoding encoding, size_t maxLength, std::string& out) {
+  size_t unit = unitSize(encoding);
+  size_t limit = maxLength * unit;
+  size_t checked = 0;
+  size_t pages = 1;
+
+  out.clear();
+
+  while (out.size() < limit) {
+    DWORD64 cursor = address + out.size();
+    SIZE_T wanted = (SIZE_T)(pageSize - (cursor & (pageSize - 1)) + (pages - 1) * pageSize);
+    wanted = std::min<SIZE_T>(wanted, limit - out.size());
+
+    SIZE_T bytesRead = append(hProcess, cursor, wanted, out);
+
+    // Only whole code units are searched, a code unit split across blocks is searched once its block is read
+    size_t end = out.size() - out.size() % unit;
+    size_t terminator = findTerminator(out.data(), checked, end, unit);
+
+    if (terminator < end) {
+      out.resize(terminator);
+      return OK;
+    }
+
+    checked = end;
+    if (bytesRead < wanted) return UNREADABLE;
+
+    pages = std::min(pages * 2, maxBlockPages);
+  }
+
+  return NO_TERMINATOR;
+}
+
+text::Status text::readFixed(HANDLE hProcess, DWORD64 address, Encoding encoding, size_t length, std::string& out) {
+  size_t unit = unitSize(encoding);
+
+  out.clear();
+  if (append(hProcess, address, length * unit, out) < length * unit) return UNREADABLE;
+
+  out.resize(findTerminator(out.data(), 0, out.size(), unit));
+  return OK;
+}
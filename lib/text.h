@@ -0,0 +1,36 @@
+#pragma once
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+
+#include <windows.h>
+#else
+#include "compat.h"
+#endif
+#include <string>
+
+// Reading strings out of another process a block of memory at a time rather than a character at a time.
+namespace text {
+enum Encoding { UTF8, UTF16 };  // UTF16 is little endian, as wchar_t strings are on Windows
+
+enum Status {
+  OK,
+  UNREADABLE,     // memory before the terminator could not be read
+  NO_TERMINATOR,  // no terminator within the maximum length
+};
+
+// The maximum length readMemory has always used.
+const size_t defaultMaxLength = 1000000;
+
+// The longest string V8 can create, in code units. No longer string is read.
+const size_t longest = ((size_t)1 << 29) - 24;
+
+// Reads a string ending in a zero code unit and no longer than `maxLength` code units. Memory is read in blocks
+// that end on page boundaries, starting with the rest of the first page and growing from there, so short strings
+// cost one read and the string's last page is never read past. `out` receives the raw code units, without the
+// terminator.
+Status read(HANDLE hProcess, DWORD64 address, Encoding encoding, size_t maxLength, std::string& out);
+
+// Reads a string of exactly `length` code units, such as a fixed-size char array, cut short at the first zero
+// code unit.
+Status readFixed(HANDLE hProcess, DWORD64 address, Encoding encoding, size_t length, std::string& out);
+}  // namespace text
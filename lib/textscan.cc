@@ -0,0 +1,264 @@
+#include "textscan.h"
+
+#include <string.h>
+#include <algorithm>
+#include "cpu.h"
+#include "threadpool.h"
+
+namespace {
+// A window starts with the two bytes before it, so that a run reaching into it from the window before is recognised
+// as one, and ends with enough of the memory after it to finish the runs that start near its end.
+const size_t before = 2;
+
+// Bytes classified a bitmap word at a time, two words at a time for UTF-16
+const size_t block = 128;
+
+struct Window {
+  DWORD64 address;
+  SIZE_T size;
+  bool continued;  // the memory before the window is part of the same run of regions
+  SIZE_T after;    // bytes read past the window
+};
+
+// Sets bit i of printable[i / 64] if byte i is printable ASCII or a tab, and of zero[i / 64] if it is 0. `size` is a
+// multiple of 64.
+typedef void (*Classify)(const unsigned char* data, size_t size, uint64_t* printable, uint64_t* zero);
+
+void classifyScalar(const unsigned char* data, size_t size, uint64_t* printable, uint64_t* zero) {
+  for (size_t word = 0; word < size / 64; word++) {
+    uint64_t p = 0, z = 0;
+
+    for (size_t bit = 0; bit < 64; bit++) {
+      unsigned char byte = data[word * 64 + bit];
+      p |= (uint64_t)((byte >= 0x20 && byte < 0x7F) || byte == '\t') << bit;
+      z |= (uint64_t)(byte == 0) << bit;
+    }
+
+    printable[word] = p;
+    zero[word] = z;
+  }
+}
+
+#ifdef MEMORYJS_X86
+MEMORYJS_TARGET("sse2")
+void classifySSE2(const unsigned char* data, size_t size, uint64_t* printable, uint64_t* zero) {
+  // Bytes from 0x80 up are negative as signed chars, so the signed comparisons leave them out
+  const __m128i space = _mm_set1_epi8(0x1F);
+  const __m128i del = _mm_set1_epi8(0x7F);
+  const __m128i tab = _mm_set1_epi8('\t');
+  const __m128i nul = _mm_setzero_si128();
+
+  for (size_t word = 0; word < size / 64; word++) {
+    uint64_t p = 0, z = 0;
+
+    for (size_t part = 0; part < 4; part++) {
+      __m128i bytes = _mm_loadu_si128((const __m128i*)(data + word * 64 + part * 16));
+      __m128i text = _mm_and_si128(_mm_cmpgt_epi8(bytes, space), _mm_cmplt_epi8(bytes, del));
+      text = _mm_or_si128(text, _mm_cmpeq_epi8(bytes, tab));
+
+      p |= (uint64_t)(uint32_t)_mm_movemask_epi8(text) << (part * 16);
+      z |= (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, nul)) << (part * 16);
+    }
+
+    printable[word] = p;
+    zero[word] = z;
+  }
+}
+
+MEMORYJS_TARGET("avx2")
+void classifyAVX2(const unsigned char* data, size_t size, uint64_t* printable, uint64_t* zero) {
+  const __m256i space = _mm256_set1_epi8(0x1F);
+  const __m256i del = _mm256_set1_epi8(0x7F);
+  const __m256i tab = _mm256_set1_epi8('\t');
+  const __m256i nul = _mm256_setzero_si256();
+
+  for (size_t word = 0; word < size / 64; word++) {
+    uint64_t p = 0, z = 0;
+
+    for (size_t part = 0; part < 2; part++) {
+      __m256i bytes = _mm256_loadu_si256((const __m256i*)(data + word * 64 + part * 32));
+      __m256i text = _mm256_and_si256(_mm256_cmpgt_epi8(bytes, space), _mm256_cmpgt_epi8(del, bytes));
+      text = _mm256_or_si256(text, _mm256_cmpeq_epi8(bytes, tab));
+
+      p |= (uint64_t)(uint32_t)_mm256_movemask_epi8(text) << (part * 32);
+      z |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, nul)) << (part * 32);
+    }
+
+    printable[word] = p;
+    zero[word] = z;
+  }
+}
+#endif
+
+Classify classifier() {
+#ifdef MEMORYJS_X86
+  static const Classify best = cpu::hasAVX2() ? classifyAVX2 : cpu::hasSSE2() ? classifySSE2 : classifyScalar;
+#else
+  static const Classify best = classifyScalar;
+#endif
+  return best;
+}
+
+// Packs the even bits of `bits` into the low 32 bits
+uint64_t evenBits(uint64_t bits) {
+  bits &= 0x5555555555555555ull;
+  bits = (bits | (bits >> 1)) & 0x3333333333333333ull;
+  bits = (bits | (bits >> 2)) & 0x0F0F0F0F0F0F0F0Full;
+  bits = (bits | (bits >> 4)) & 0x00FF00FF00FF00FFull;
+  bits = (bits | (bits >> 8)) & 0x0000FFFF0000FFFFull;
+  return (bits | (bits >> 16)) & 0x00000000FFFFFFFFull;
+}
+
+// Calls `found(start, length)` for every run of set bits among the first `count` bits of `bits`
+template <typename Found>
+void runs(const uint64_t* bits, size_t count, Found found) {
+  size_t words = (count + 63) / 64;
+  size_t position = 0;
+
+  while (position < count) {
+    size_t word = position / 64;
+    uint64_t set = bits[word] & (~0ull << (position % 64));
+    while (!set && ++word < words) set = bits[word];
+    if (!set) return;
+
+    size_t start = word * 64 + cpu::ctz64(set);
+    if (start >= count) return;
+
+    uint64_t clear = ~bits[word] & (~0ull << (start % 64));
+    while (!clear && ++word < words) clear = ~bits[word];
+
+    size_t end = clear ? std::min(count, word * 64 + cpu::ctz64(clear)) : count;
+    found(start, end - start);
+    position = end;
+  }
+}
+
+bool keep(const std::string& text, const std::vector<std::string>& filters) {
+  if (filters.empty()) return true;
+
+  for (const std::string& filter : filters) {
+    if (text.find(filter) != std::string::npos) return true;
+  }
+
+  return false;
+}
+
+struct Scan {
+  const textscan::Options& options;
+  std::vector<unsigned char> buffer;
+  std::vector<uint64_t> printable, zero, units;
+
+  // Reads the window and appends the strings that start in it to `matches`, at most `room` of them
+  void window(HANDLE hProcess, const Window& window, size_t room, std::vector<textscan::Match>& matches) {
+    size_t total = before + window.size + window.after;
+    size_t padded = (total + block - 1) / block * block;
+
+    if (window.continued) {
+      region::readFilled(hProcess, window.address - before, buffer.data(), total);
+    } else {
+      memset(buffer.data(), 0, before);
+      region::readFilled(hProcess, window.address, buffer.data() + before, total - before);
+    }
+    memset(buffer.data() + total, 0, padded - total);
+
+    classifier()(buffer.data(), padded, printable.data(), zero.data());
+    size_t end = before + window.size;
+
+    // Runs that start in the bytes before the window were found with the window before, and runs that start after it
+    // are found with the window after
+    if (options.encodings & textscan::ASCII) {
+      runs(printable.data(), total, [&](size_t start, size_t length) {
+        if (start < before || start >= end || length < options.minLength || matches.size() >= room) return;
+
+        std::string text((const char*)buffer.data() + start, std::min(length, options.maxLength));
+        if (keep(text, options.filters)) {
+          matches.push_back({window.address + start - before, textscan::ASCII, std::move(text)});
+        }
+      });
+    }
+
+    if (options.encodings & textscan::UTF16) {
+      // A code unit is text if its low byte is printable and its high byte is zero
+      for (size_t word = 0; word < padded / 64; word += 2) {
+        uint64_t low = evenBits(printable[word] & (zero[word] >> 1));
+        uint64_t high = evenBits(printable[word + 1] & (zero[word + 1] >> 1));
+        units[word / 2] = low | (high << 32);
+      }
+
+      runs(units.data(), total / 2, [&](size_t start, size_t length) {
+        if (start * 2 < before || start * 2 >= end || length < options.minLength || matches.size() >= room) return;
+
+        std::string text(std::min(length, options.maxLength), '\0');
+        for (size_t i = 0; i < text.size(); i++) text[i] = (char)buffer[(start + i) * 2];
+
+        if (keep(text, options.filters)) {
+          matches.push_back({window.address + start * 2 - before, textscan::UTF16, std::move(text)});
+        }
+      });
+    }
+  }
+};
+}  // namespace
+
+textscan::Options textscan::defaults() {
+  Options options = {4, 256, ASCII | UTF16, {}, 100000};
+  return options;
+}
+
+std::vector<textscan::Match> textscan::find(HANDLE hProcess, const region::Filter& filter, const Options& requested,
+                                            const std::atomic<bool>* cancelled) {
+  Options options = requested;
+  options.minLength = std::max<size_t>(options.minLength, 1);
+  options.maxLength = std::max(options.maxLength, options.minLength);
+
+  // Enough to see whole any run that starts in a window and is at most maxLength UTF-16 code units long
+  SIZE_T lookahead = (SIZE_T)options.maxLength * 2;
+
+  // Adjacent regions are split into windows as one run of memory, so text that straddles them is found whole
+  std::vector<Window> windows;
+  std::vector<MEMORY_BASIC_INFORMATION> regions = region::select(hProcess, filter);
+
+  for (size_t i = 0; i < regions.size();) {
+    DWORD64 start = (DWORD64)regions[i].BaseAddress;
+    DWORD64 end = start + regions[i].RegionSize;
+    for (i++; i < regions.size() && (DWORD64)regions[i].BaseAddress == end; i++) end += regions[i].RegionSize;
+
+    for (DWORD64 address = start; address < end; address += region::bufferSize) {
+      SIZE_T size = (SIZE_T)std::min<DWORD64>(region::bufferSize, end - address);
+      SIZE_T after = (SIZE_T)std::min<DWORD64>(lookahead, end - address - size);
+      windows.push_back({address, size, address > start, after});
+    }
+  }
+
+  std::vector<std::vector<Match>> found(windows.size());
+  std::atomic<size_t> next(0);
+  std::atomic<size_t> count(0);
+
+  threadpool::parallelFor(std::min(threadpool::getThreads(), windows.size()), [&](size_t) {
+    size_t capacity = (before + region::bufferSize + lookahead + block - 1) / block * block;
+    Scan scan = {options, std::vector<unsigned char>(capacity), std::vector<uint64_t>(capacity / 64),
+                 std::vector<uint64_t>(capacity / 64), std::vector<uint64_t>(capacity / 128)};
+    size_t index;
+
+    while (!(cancelled && *cancelled) && count < options.limit && (index = next++) < windows.size()) {
+      scan.window(hProcess, windows[index], options.limit - std::min<size_t>(count, options.limit), found[index]);
+
+      // UTF-16 runs were appended after the ASCII ones
+      std::sort(found[index].begin(), found[index].end(),
+                [](const Match& a, const Match& b) { return a.address < b.address; });
+      count += found[index].size();
+    }
+  });
+
+  std::vector<Match> matches;
+  matches.reserve(std::min<size_t>(count, options.limit));
+
+  for (std::vector<Match>& window : found) {
+    for (Match& match : window) {
+      if (matches.size() == options.limit) return matches;
+      matches.push_back(std::move(match));
+    }
+  }
+
+  return matches;
+}
@@ -0,0 +1,47 @@
+#pragma once
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+
+#include <windows.h>
+#else
+#include "compat.h"
+#endif
+#include <stddef.h>
+#include <atomic>
+#include <string>
+#include <vector>
+#include "region.h"
+
+// Finding the text in a process' memory, the way `strings` finds it in a file: every run of printable ASCII
+// characters (and tabs) at least a minimum length long, and every such run of UTF-16LE code units.
+//
+// Memory is split into windows that are read and scanned on the thread pool. Each window's bytes are classified into
+// bitmaps of printable and zero bytes with SIMD, and the runs are found a 64-bit word of the bitmaps at a time.
+namespace textscan {
+enum Encoding { ASCII = 1, UTF16 = 2 };
+
+struct Options {
+  size_t minLength;                  // shortest run reported, in characters
+  size_t maxLength;                  // longer runs are cut to this many characters
+  int encodings;                     // the encodings looked for, ASCII, UTF16 or both
+  std::vector<std::string> filters;  // if any, only text containing one of these is kept
+  size_t limit;                      // most strings returned
+};
+
+Options defaults();
+
+// The largest minLength and maxLength. Every window is read this many UTF-16 code units past its end.
+const size_t longestRun = (size_t)1 << 20;
+
+struct Match {
+  DWORD64 address;
+  Encoding encoding;
+  std::string text;  // one byte per character, UTF-16 text included
+};
+
+// Scans the regions that pass the filter and returns the strings found, in address order. Once `limit` strings are
+// found the scan stops, so when there are more of them the ones returned are not necessarily the first. Stops early
+// once `cancelled` (if given) is set.
+std::vector<Match> find(HANDLE hProcess, const region::Filter& filter, const Options& options,
+                        const std::atomic<bool>* cancelled = nullptr);
+}  // namespace textscan
@@ -0,0 +1,137 @@
+#include "threadpool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+struct Job {
+  const std::function<void(size_t)>* task;
+  size_t count;
+  std::atomic<size_t> next;
+  std::atomic<size_t> finished;
+  std::mutex mutex;
+  std::condition_variable done;
+
+  // Runs tasks until every index has been handed out.
+  void help() {
+    size_t completed = 0;
+    size_t index;
+
+    while ((index = next.fetch_add(1)) < count) {
+      (*task)(index);
+      completed++;
+    }
+
+    if (completed && finished.fetch_add(completed) + completed == count) {
+      std::lock_guard<std::mutex> lock(mutex);
+      done.notify_all();
+    }
+  }
+};
+
+class Pool {
+ public:
+  void resize(size_t threads) {
+    std::lock_guard<std::mutex> resizeLock(resizeMutex);
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    wake.notify_all();
+
+    for (auto& worker : workers) worker.join();
+    workers.clear();
+
+    stopping = false;
+    size = threads ? threads : std::max<size_t>(1, std::thread::hardware_concurrency());
+
+    // The thread calling parallelFor does its share of the work, so start one fewer.
+    for (size_t i = 1; i < size; i++) workers.emplace_back([this] { work(); });
+  }
+
+  size_t threads() const { return size; }
+
+  void run(size_t count, const std::function<void(size_t)>& task) {
+    if (count == 0) return;
+
+    auto job = std::make_shared<Job>();
+    job->task = &task;
+    job->count = count;
+    job->next = 0;
+    job->finished = 0;
+
+    size_t helpers = std::min<size_t>(size, count) - 1;
+    if (helpers) {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t i = 0; i < helpers; i++) queue.push_back(job);
+      }
+      wake.notify_all();
+    }
+
+    job->help();
+
+    std::unique_lock<std::mutex> lock(job->mutex);
+    job->done.wait(lock, [&] { return job->finished == job->count; });
+  }
+
+ private:
+  void work() {
+    while (true) {
+      std::shared_ptr<Job> job;
+
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        wake.wait(lock, [this] { return stopping || !queue.empty(); });
+
+        // Drain the queue before stopping so no caller is left waiting on a job.
+        if (queue.empty()) return;
+
+        job = queue.front();
+        queue.pop_front();
+      }
+
+      job->help();
+    }
+  }
+
+  std::mutex resizeMutex;
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::deque<std::shared_ptr<Job>> queue;
+  std::vector<std::thread> workers;
+  std::atomic<size_t> size{1};
+  bool stopping = false;
+};
+
+// The pool is never destroyed, its threads must not be joined while the process is tearing down static objects.
+Pool& pool() {
+  static Pool* instance = [] {
+    Pool* pool = new Pool();
+    pool->resize(0);
+    return pool;
+  }();
+
+  return *instance;
+}
+}  // namespace
+
+void threadpool::setThreads(size_t threads) {
+  pool().resize(threads);
+}
+
+size_t threadpool::getThreads() {
+  return pool().threads();
+}
+
+void threadpool::parallelFor(size_t count, const std::function<void(size_t)>& task) {
+  pool().run(count, task);
+}
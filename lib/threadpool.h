@@ -0,0 +1,15 @@
+#pragma once
+
+#include <stddef.h>
+#include <functional>
+
+// A process-wide pool of worker threads for splitting large jobs (pattern scans and the like) across cores.
+namespace threadpool {
+// Sets the number of threads used by parallelFor, including the calling thread. 0 means one per hardware thread.
+void setThreads(size_t threads);
+size_t getThreads();
+
+// Calls `task(i)` for every i in [0, count), spread across the pool, and returns once all of them have finished.
+// Indices are handed out in increasing order. The calling thread takes part, so nested calls cannot deadlock.
+void parallelFor(size_t count, const std::function<void(size_t)>& task);
+}  // namespace threadpool
@@ -0,0 +1,167 @@
+#include "watch.h"
+
+#include <string.h>
+#include <chrono>
+
+watch::Sampler::Sampler(HANDLE handle, const std::vector<Location>& locations)
+    : handle(handle), wasReadable(locations.size()), reads(locations.size()), sampled(false) {
+  size_t total = 0;
+
+  for (const Location& location : locations) {
+    offsets.push_back(total);
+    total += datatype::size(location.type);
+  }
+
+  current.resize(total);
+  previous.resize(total);
+
+  for (size_t i = 0; i < locations.size(); i++) {
+    reads[i].address = locations[i].address;
+    reads[i].size = datatype::size(locations[i].type);
+    reads[i].ok = false;
+  }
+}
+
+std::vector<size_t> watch::Sampler::sample() {
+  current.swap(previous);
+
+  for (size_t i = 0; i < reads.size(); i++) {
+    wasReadable[i] = reads[i].ok;
+    reads[i].buffer = &current[offsets[i]];
+  }
+
+  batch::read(handle, reads);
+
+  std::vector<size_t> changed;
+  if (!sampled) {
+    sampled = true;
+    return changed;
+  }
+
+  for (size_t i = 0; i < reads.size(); i++) {
+    if (reads[i].ok != wasReadable[i]) {
+      changed.push_back(i);
+    } else if (reads[i].ok && memcmp(&current[offsets[i]], &previous[offsets[i]], reads[i].size)) {
+      changed.push_back(i);
+    }
+  }
+
+  return changed;
+}
+
+watch::Subscription::Subscription(HANDLE handle, const std::vector<Location>& locations, uint32_t interval,
+                                  const Deliver& deliver)
+    : sampler(handle, locations),
+      size(locations.size()),
+      interval(interval),
+      deliverChanges(deliver),
+      stopped(false),
+      stopping(false),
+      queued(false),
+      dirty(locations.size()),
+      latestReadable(locations.size()),
+      latest(sampler.bytes()),
+      dropped(0) {}
+
+std::shared_ptr<watch::Subscription> watch::Subscription::start(Napi::Env env, Napi::Function callback, HANDLE handle,
+                                                                const std::vector<Location>& locations,
+                                                                uint32_t interval, const Deliver& deliver) {
+  std::shared_ptr<Subscription> subscription(new Subscription(handle, locations, interval, deliver));
+
+  // The thread-safe function keeps its own reference, so the subscription outlives the last queued delivery even
+  // when JS lets go of it first. Its queue holds one call, the subscription coalesces the rest.
+  subscription->function = Napi::ThreadSafeFunction::New(
+      env, callback, "memoryjs.watch", 1, 1,
+      [](Napi::Env, std::shared_ptr<Subscription>* subscription) {
+        (*subscription)->halt();
+        delete subscription;
+      },
+      new std::shared_ptr<Subscription>(subscription));
+
+  subscription->thread = std::thread(&Subscription::run, subscription.get());
+  return subscription;
+}
+
+watch::Subscription::~Subscription() {
+  if (thread.joinable()) thread.join();
+}
+
+void watch::Subscription::stop() {
+  if (stopped) return;
+
+  halt();
+  function.Release();
+}
+
+// Stops the sampler thread without releasing the thread-safe function, which is how it is stopped when the function
+// is finalized (such as when the environment shuts down).
+void watch::Subscription::halt() {
+  stopped = true;
+  if (!thread.joinable()) return;
+
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    stopping = true;
+  }
+
+  wake.notify_one();
+  thread.join();
+}
+
+void watch::Subscription::run() {
+  std::unique_lock<std::mutex> guard(lock);
+
+  while (!stopping) {
+    guard.unlock();
+    std::vector<size_t> changed = sampler.sample();
+    guard.lock();
+
+    if (!changed.empty()) {
+      for (size_t index : changed) {
+        // The value JS has not seen yet is replaced by the newer one
+        if (dirty[index]) dropped++;
+
+        dirty[index] = true;
+        latestReadable[index] = sampler.readable(index);
+        memcpy(&latest[sampler.offset(index)], sampler.value(index), sampler.size(index));
+      }
+
+      // A call that could not be queued (the function is closing) is retried with the next change
+      if (!queued) {
+        queued = function.NonBlockingCall(this, [](Napi::Env env, Napi::Function callback, Subscription* subscription) {
+          subscription->deliver(env, callback);
+        }) == napi_ok;
+      }
+    }
+
+    wake.wait_for(guard, std::chrono::milliseconds(interval), [this] { return stopping; });
+  }
+}
+
+void watch::Subscription::deliver(Napi::Env env, Napi::Function callback) {
+  if (stopped) return;
+
+  std::vector<Change> changes;
+  std::vector<unsigned char> values;
+  uint64_t overwritten;
+
+  {
+    std::lock_guard<std::mutex> guard(lock);
+
+    // Copied out so that the sampler is not blocked while JS runs
+    values = latest;
+    for (size_t i = 0; i < size; i++) {
+      if (!dirty[i]) continue;
+      dirty[i] = false;
+      changes.push_back({i, latestReadable[i], nullptr});
+    }
+
+    overwritten = dropped;
+    dropped = 0;
+    queued = false;
+  }
+
+  for (Change& change : changes) change.value = &values[sampler.offset(change.index)];
+
+  if (!changes.empty()) deliverChanges(env, callback, changes, overwritten);
+}
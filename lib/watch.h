@@ -0,0 +1,105 @@
+#pragma once
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+
+#include <windows.h>
+#else
+#include "compat.h"
+#endif
+#include <napi.h>
+#include <stdint.h>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "batch.h"
+#include "datatype.h"
+
+// Watching values in another process for changes. A sampler thread per subscription reads every watched location in
+// one batch each interval, and only the locations whose value changed are handed to JS.
+namespace watch {
+struct Location {
+  DWORD64 address;
+  datatype::Type type;
+};
+
+struct Change {
+  size_t index;       // into the watched locations
+  bool readable;      // false if the location could not be read
+  const void* value;  // the new value, valid until the delivery returns
+};
+
+// Turns one tick's changes into a JS call. `dropped` is the number of intermediate values that were overwritten
+// because JS had not taken the previous changes yet.
+typedef std::function<void(Napi::Env env, Napi::Function callback, const std::vector<Change>& changes,
+                           uint64_t dropped)>
+    Deliver;
+
+// Reads a set of locations and reports the ones that changed since the previous sample.
+class Sampler {
+ public:
+  Sampler(HANDLE handle, const std::vector<Location>& locations);
+
+  // The first sample only records the values. Returns the indices of the locations that changed.
+  std::vector<size_t> sample();
+
+  // Values are packed one after the other, `offset` is where a location's value starts.
+  size_t offset(size_t index) const { return offsets[index]; }
+  size_t bytes() const { return current.size(); }
+
+  const unsigned char* value(size_t index) const { return &current[offsets[index]]; }
+  SIZE_T size(size_t index) const { return reads[index].size; }
+  bool readable(size_t index) const { return reads[index].ok; }
+
+ private:
+  HANDLE handle;
+  std::vector<size_t> offsets;
+  std::vector<unsigned char> current;
+  std::vector<unsigned char> previous;
+  std::vector<bool> wasReadable;
+  std::vector<batch::Read> reads;
+  bool sampled;
+};
+
+class Subscription {
+ public:
+  // Starts sampling every `interval` milliseconds and calling `callback` through `deliver` with the changes.
+  static std::shared_ptr<Subscription> start(Napi::Env env, Napi::Function callback, HANDLE handle,
+                                             const std::vector<Location>& locations, uint32_t interval,
+                                             const Deliver& deliver);
+
+  ~Subscription();
+
+  // Stops sampling and drops changes that were not delivered yet. Safe to call more than once, and after the
+  // environment finalized the thread-safe function, but only from the main thread.
+  void stop();
+
+ private:
+  Subscription(HANDLE handle, const std::vector<Location>& locations, uint32_t interval, const Deliver& deliver);
+
+  void halt();
+  void run();
+  void deliver(Napi::Env env, Napi::Function callback);
+
+  Sampler sampler;
+  size_t size;
+  uint32_t interval;
+  Deliver deliverChanges;
+  Napi::ThreadSafeFunction function;
+  std::thread thread;
+  bool stopped;
+
+  // Shared with the sampler thread. At most one delivery is queued at a time, changes made while it waits are merged
+  // into `latest` instead, so a slow consumer costs a fixed amount of memory.
+  std::mutex lock;
+  std::condition_variable wake;
+  bool stopping;
+  bool queued;
+  std::vector<bool> dirty;
+  std::vector<bool> latestReadable;
+  std::vector<unsigned char> latest;
+  uint64_t dropped;  // values overwritten since the last delivery
+};
+}  // namespace watch
@@ -0,0 +1,59 @@
+// Reading the regions published by shareRegions. This file does not load the addon, so it can be required from any
+// worker thread; see lib/share.h for the layout of the buffer.
+
+const PUBLISHED = 0;
+const CURRENT = 1;
+const SEQUENCES = 4;
+const HEADER_SIZE = 64;
+const COUNT_SIZE = 8;
+const ENTRY_SIZE = 24;
+
+// Number of times the regions were published, which changes whenever new values are available.
+function getSharedSequence(buffer) {
+  return Atomics.load(new Uint32Array(buffer, 0, HEADER_SIZE / 4), PUBLISHED);
+}
+
+// Copies the latest published regions out of the buffer. Every region comes from the same publish.
+function readSharedRegions(buffer) {
+  const header = new Uint32Array(buffer, 0, HEADER_SIZE / 4);
+  const slotSize = header[3];
+
+  for (;;) {
+    const slot = Atomics.load(header, CURRENT);
+    const sequence = Atomics.load(header, SEQUENCES + slot);
+
+    // The slot is being written, which only happens when the publisher wraps around to it
+    // eslint-disable-next-line no-continue
+    if (sequence % 2 === 1) continue;
+
+    const start = HEADER_SIZE + slot * slotSize;
+    const view = new DataView(buffer, start, slotSize);
+    const count = view.getUint32(0, true);
+    const regions = [];
+
+    for (let i = 0; i < count && COUNT_SIZE + (i + 1) * ENTRY_SIZE <= slotSize; i += 1) {
+      const entry = COUNT_SIZE + i * ENTRY_SIZE;
+      const offset = view.getUint32(entry + 8, true);
+      const size = view.getUint32(entry + 12, true);
+
+      // Only possible if the slot is being written, which the check below catches
+      if (offset + size > slotSize) break;
+
+      regions.push({
+        address: view.getFloat64(entry, true),
+        readable: view.getUint32(entry + 16, true) === 1,
+        bytes: new Uint8Array(buffer.slice(start + offset, start + offset + size)),
+      });
+    }
+
+    // The slot was written again while it was being copied
+    if (Atomics.load(header, SEQUENCES + slot) === sequence) {
+      return { sequence: sequence / 2, regions };
+    }
+  }
+}
+
+module.exports = {
+  getSharedSequence,
+  readSharedRegions,
+};
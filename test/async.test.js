@@ -0,0 +1,128 @@
+// Promise forms, their cancel tokens, and what an aborted operation leaves behind
+const assert = require('assert');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const memoryjs = require('..');
+const native = require('../build/Release/memoryjs');
+const { withFixture } = require('./fixture');
+
+module.exports = {
+  async 'refuses anything but a cancel token in the token slot'() {
+    await withFixture(({ layout, handle }) => {
+      const scan = { start: layout.scan, end: layout.scan + layout.scanSize };
+      const pattern = memoryjs.compilePattern('7A 3B 9E D1');
+
+      assert.throws(() => native.findAllAsync(handle, pattern, scan), /cancel token/);
+      assert.throws(() => native.findAllAsync(handle, pattern, scan, {}), /cancel token/);
+      assert.throws(() => native.readMemoryAsync(handle, layout.int32, 'int32', pattern), /cancel token/);
+    });
+  },
+
+  async 'rejects with an AbortError once aborted'() {
+    await withFixture(async ({ layout, handle }) => {
+      const token = native.createCancelToken();
+      native.cancel(token);
+
+      const scan = { start: layout.scan, end: layout.scan + layout.scanSize };
+      await assert.rejects(native.findAllAsync(handle, '7A 3B 9E D1', scan, token), { name: 'AbortError' });
+    });
+  },
+
+  async 'keeps the result of an operation that finished before it was aborted'() {
+    await withFixture(async ({ child }) => {
+      const token = native.createCancelToken();
+      const opened = native.openProcessAsync(child.pid, token);
+
+      // Set while the operation may already be running: it either never starts, or it resolves with the handle
+      setImmediate(() => native.cancel(token));
+
+      const processObject = await opened.catch((error) => {
+        assert.strictEqual(error.name, 'AbortError');
+        return null;
+      });
+
+      if (processObject) {
+        assert.strictEqual(processObject.th32ProcessID, child.pid);
+        memoryjs.closeProcess(processObject.handle);
+      }
+    });
+  },
+
+  async 'reads batches, strings, structs and pointer chains as promises'() {
+    await withFixture(async ({ layout, handle }) => {
+      const { promises } = memoryjs;
+      const signal = new AbortController().signal;
+
+      const values = await promises.readMemoryBatch(handle, [{ address: layout.int32, type: 'INT32' }], { signal });
+      assert.deepStrictEqual(values, [-123456]);
+
+      const packed = await promises.readMemoryBatch(handle, new Float64Array([layout.double]), 'double');
+      assert.deepStrictEqual(Array.from(packed), [2.25]);
+
+      const text = await promises.readString(handle, layout.shortString, { maxLength: 64, signal });
+      assert.strictEqual(text, 'the quick brown fox jumps over the lazy dog');
+
+      const Vec3 = memoryjs.defineStruct([
+        { name: 'x', type: 'float' }, { name: 'y', type: 'float' }, { name: 'z', type: 'float' },
+      ]);
+      const target = {};
+      assert.strictEqual(await promises.readStruct(handle, layout.vec3, Vec3, { target, signal }), target);
+      assert.deepStrictEqual(target, { x: 1, y: 2, z: 3 });
+
+      const flat = new Float64Array(3);
+      await promises.readStructArray(handle, layout.vec3, Vec3, 1, { target: flat });
+      assert.deepStrictEqual(Array.from(flat), [1, 2, 3]);
+
+      const pointer = await promises.resolvePointerChain(handle, layout.ptr, [0, 0], { type: 'BYTE', signal });
+      assert.deepStrictEqual(pointer, { address: layout.byte, value: 249 });
+
+      const chains = await promises.resolvePointerChains(handle, [{ base: layout.ptr, offsets: [0, 0] }]);
+      assert.deepStrictEqual(Array.from(chains), [layout.byte]);
+    });
+  },
+
+  async 'reads into a buffer only once the read is done'() {
+    await withFixture(async ({ layout, handle }) => {
+      const buffer = Buffer.alloc(8);
+      const reading = memoryjs.promises.readBufferInto(handle, layout.int64, buffer, 0, 8);
+
+      assert.strictEqual(buffer.readBigInt64LE(), 0n);
+      assert.strictEqual(await reading, 8);
+      assert.strictEqual(buffer.readBigInt64LE(), -1234567890123n);
+
+      const bytesRead = await new Promise((resolve, reject) => {
+        memoryjs.readBufferInto(handle, layout.int32, buffer, 4, 4, (error, result) => {
+          if (error) reject(new Error(error));
+          else resolve(result);
+        });
+      });
+      assert.strictEqual(bytesRead, 4);
+      assert.strictEqual(buffer.readInt32LE(4), -123456);
+    });
+  },
+
+  async 'leaves no file behind when a dump is aborted'() {
+    const directory = fs.mkdtempSync(path.join(os.tmpdir(), 'memoryjs-'));
+    const file = path.join(directory, 'fixture.dump');
+
+    try {
+      await withFixture(async ({ layout, handle }) => {
+        const token = native.createCancelToken();
+        const range = { start: layout.scan, end: layout.scan + layout.scanSize };
+        const dump = native.dumpRegionsAsync(handle, file, range, token);
+
+        // Usually part of the way through, otherwise the dump completes and keeps its file
+        setImmediate(() => native.cancel(token));
+
+        const completed = await dump.then(() => true, (error) => {
+          assert.strictEqual(error.name, 'AbortError');
+          return false;
+        });
+        assert.strictEqual(fs.existsSync(file), completed);
+      }, 64);
+    } finally {
+      fs.rmSync(directory, { recursive: true, force: true });
+    }
+  },
+};
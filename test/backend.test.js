@@ -0,0 +1,171 @@
+// The process, memory and module layers against a spawned fixture
+const assert = require('assert');
+const path = require('path');
+const memoryjs = require('..');
+const { FIXTURE, startFixture, stopFixture, withFixture } = require('./fixture');
+
+const VALUES = {
+  byte: 249,
+  short: -1234,
+  int32: -123456,
+  uint32: 123456,
+  int64: -1234567890123,
+  uint64: 1234567890123,
+  float: 3.5,
+  double: 2.25,
+  bool: true,
+};
+
+module.exports = {
+  async 'opens a process by id and by name'() {
+    const { child, layout } = await startFixture();
+
+    try {
+      const byId = memoryjs.openProcess(layout.pid);
+      assert.strictEqual(byId.th32ProcessID, layout.pid);
+      assert.strictEqual(byId.szExeFile, path.basename(FIXTURE));
+      memoryjs.closeProcess(byId.handle);
+
+      const byName = memoryjs.openProcess(path.basename(FIXTURE));
+      assert.ok(byName.handle);
+      memoryjs.closeProcess(byName.handle);
+    } finally {
+      await stopFixture(child);
+    }
+
+    assert.throws(() => memoryjs.openProcess(layout.pid));
+  },
+
+  async 'lists the fixture among the processes'() {
+    await withFixture(({ layout }) => {
+      const processes = memoryjs.getProcesses();
+      assert.ok(processes.some(entry => entry.th32ProcessID === layout.pid));
+    });
+  },
+
+  async 'reads every fixed-size type'() {
+    await withFixture(({ layout, handle }) => {
+      Object.keys(VALUES).forEach((type) => {
+        assert.strictEqual(memoryjs.readMemory(handle, layout[type], type), VALUES[type], type);
+      });
+
+      assert.strictEqual(memoryjs.readMemory(handle, layout.ptr, 'ptr'), layout.byte);
+      assert.deepStrictEqual(memoryjs.readMemory(handle, layout.vec3, 'vec3'), { x: 1, y: 2, z: 3 });
+      assert.deepStrictEqual(memoryjs.readMemory(handle, layout.vec4, 'vec4'), { w: 1, x: 2, y: 3, z: 4 });
+    });
+  },
+
+  async 'reads strings and buffers'() {
+    await withFixture(({ layout, handle }) => {
+      const text = 'the quick brown fox jumps over the lazy dog';
+      assert.strictEqual(memoryjs.readMemory(handle, layout.shortString, 'string'), text);
+      assert.strictEqual(memoryjs.readString(handle, layout.wideString, { encoding: 'utf16' }), text);
+      assert.strictEqual(memoryjs.readString(handle, layout.shortString, { length: 9 }), 'the quick');
+
+      // Wrongly typed or out of range options are refused rather than converted
+      assert.throws(() => memoryjs.readString(handle, layout.shortString, { encoding: 16 }), /encoding/);
+      assert.throws(() => memoryjs.readString(handle, layout.shortString, { length: -1 }), /length/);
+      assert.throws(() => memoryjs.readString(handle, layout.shortString, { maxLength: '64' }), /maxLength/);
+      assert.throws(() => memoryjs.readString(handle, layout.shortString, { length: 2 ** 40 }), /longest/);
+
+      const long = memoryjs.readMemory(handle, layout.longString, 'string');
+      assert.strictEqual(long.length, 4096);
+      assert.strictEqual(long.slice(0, 27), 'abcdefghijklmnopqrstuvwxyza');
+
+      const buffer = memoryjs.readBuffer(handle, layout.shortString, text.length);
+      assert.strictEqual(buffer.toString('latin1'), text);
+
+      // The rare needle is planted 64 bytes before the end of the scan buffer
+      const tail = memoryjs.readBuffer(handle, layout.scan + layout.scanSize - 64, 8);
+      assert.strictEqual(tail.toString('hex'), '7a3b9ed15f62a711');
+    });
+  },
+
+  async 'reads unmapped memory as zeros'() {
+    await withFixture(({ handle }) => {
+      assert.strictEqual(memoryjs.readMemory(handle, 8, 'int32'), 0);
+      assert.deepStrictEqual(memoryjs.readBuffer(handle, 8, 16), Buffer.alloc(16));
+      assert.throws(() => memoryjs.readMemory(handle, 8, 'string'));
+    });
+  },
+
+  async 'lists modules and finds the ones containing an address'() {
+    await withFixture(({ layout, handle }) => {
+      const name = path.basename(FIXTURE);
+      const modules = memoryjs.getModules(layout.pid);
+      const image = modules.find(module => module.szModule === name);
+
+      assert.ok(image, 'the fixture image is a module');
+      assert.ok(image.modBaseSize > 0);
+
+      const found = memoryjs.findModuleForAddress(handle, layout.int32);
+      assert.ok(found, 'the fixture values are in a module');
+      assert.strictEqual(found.szModule, name);
+
+      // The .bss past the end of the file is anonymous memory, but part of the image all the same
+      assert.strictEqual(memoryjs.findModuleForAddress(handle, layout.zeroed).szModule, name);
+
+      const region = memoryjs.findRegion(handle, layout.scan);
+      assert.ok(region.BaseAddress <= layout.scan);
+      assert.ok(region.BaseAddress + region.RegionSize > layout.scan);
+    });
+  },
+
+  async 'reads the static symbols from the file the process mapped'() {
+    await withFixture(({ layout, handle }) => {
+      const name = path.basename(FIXTURE);
+      const symbols = memoryjs.getModuleSymbols(handle, name);
+
+      // Only in the static symbol table, which the loaded image does not have. Mangled, being in a namespace.
+      const values = symbols.find(symbol => symbol.name.includes('valuesE'));
+      assert.ok(values, 'the static symbols are read');
+      assert.strictEqual(values.address, layout.byte);
+    });
+  },
+
+  async 'looks symbols up by name and by an address inside them'() {
+    await withFixture(({ layout, handle }) => {
+      const name = path.basename(FIXTURE);
+      const { name: mangled } = memoryjs.getModuleSymbols(handle, name).find(symbol => symbol.name.includes('valuesE'));
+
+      const values = memoryjs.findSymbol(handle, name, mangled);
+      assert.strictEqual(values.module, name);
+      assert.strictEqual(values.address, layout.byte);
+      assert.ok(values.size > layout.int32 - layout.byte);
+      assert.strictEqual(memoryjs.findSymbol(handle, name, 'no such symbol'), null);
+
+      const inside = memoryjs.addressToSymbol(handle, layout.int32);
+      assert.strictEqual(inside.name, mangled);
+      assert.strictEqual(inside.address, layout.byte);
+      assert.strictEqual(inside.displacement, layout.int32 - layout.byte);
+
+      // Exported by the C library, which the fixture links against dynamically
+      const libc = memoryjs.getModules(layout.pid).find(module => module.szModule.startsWith('libc.so'));
+      const malloc = memoryjs.findSymbol(handle, libc.szModule, 'malloc');
+      assert.ok(malloc.address >= libc.modBaseAddr && malloc.address < libc.modBaseAddr + libc.modBaseSize);
+      assert.strictEqual(memoryjs.addressToSymbol(handle, malloc.address).displacement, 0);
+    });
+  },
+
+  async 'finds several patterns in a module at once'() {
+    await withFixture(({ handle }) => {
+      const name = path.basename(FIXTURE);
+      const signature = '7A 3B 9E D1 5F 62 A7 11';
+      const [plain, offset] = memoryjs.findPatterns(handle, name, [signature, { signature, addressOffset: 4 }]);
+
+      assert.ok(plain > 0);
+      assert.strictEqual(offset, plain + 4);
+      assert.throws(() => memoryjs.findPatterns(handle, name, [{ signature, patternOffset: '1' }]), /numbers/);
+    });
+  },
+
+  async 'finds patterns in the scan buffer'() {
+    await withFixture(({ layout, handle }) => {
+      const scan = { start: layout.scan, end: layout.scan + layout.scanSize };
+      const matches = memoryjs.findAll(handle, '7A 3B 9E D1 5F 62 A7 11', scan);
+
+      assert.deepStrictEqual(Array.from(matches), [layout.scan + layout.scanSize - 64]);
+      assert.deepStrictEqual(memoryjs.findAll(handle, '7A ? 9E ? 5F', scan), matches);
+    });
+  },
+};
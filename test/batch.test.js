@@ -0,0 +1,48 @@
+// readMemoryBatch reads exactly the values asked for, however they are spread
+const assert = require('assert');
+const memoryjs = require('..');
+const { withFixture } = require('./fixture');
+
+module.exports = {
+  async 'reads scattered values without the memory in between'() {
+    await withFixture(({ layout, handle }) => {
+      const addresses = new Float64Array(1000);
+      for (let i = 0; i < addresses.length; i += 1) addresses[i] = layout.scan + i * 4096;
+
+      memoryjs.resetStats();
+      const values = memoryjs.readMemoryBatch(handle, addresses, 'uint32');
+      const { bytesRead } = memoryjs.getStats();
+
+      addresses.forEach((address, i) => {
+        assert.strictEqual(values[i], memoryjs.readBuffer(handle, address, 4).readUInt32LE(0));
+      });
+
+      if (memoryjs.getStats().enabled) assert.strictEqual(bytesRead, 4000);
+    }, 8);
+  },
+
+  async 'reads neighbouring and overlapping values'() {
+    await withFixture(({ layout, handle }) => {
+      const buffer = memoryjs.readBuffer(handle, layout.scan, 8192);
+      const requests = [];
+      for (let offset = 4000; offset < 4200; offset += 3) {
+        requests.push({ address: layout.scan + offset, type: 'int32' });
+      }
+
+      const values = memoryjs.readMemoryBatch(handle, requests);
+      requests.forEach(({ address }, i) => assert.strictEqual(values[i], buffer.readInt32LE(address - layout.scan)));
+    });
+  },
+
+  async 'returns null for the values that cannot be read'() {
+    await withFixture(({ layout, handle }) => {
+      const values = memoryjs.readMemoryBatch(handle, [
+        { address: layout.int32, type: 'int32' },
+        { address: 8, type: 'int32' },
+        { address: layout.double, type: 'double' },
+      ]);
+
+      assert.deepStrictEqual(values, [-123456, null, 2.25]);
+    });
+  },
+};
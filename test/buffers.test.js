@@ -0,0 +1,60 @@
+// Polling readBuffer and readBufferInto keeps memory flat: collected buffers go back to a bounded pool
+const assert = require('assert');
+const v8 = require('v8');
+const vm = require('vm');
+const memoryjs = require('..');
+const { withFixture } = require('./fixture');
+
+v8.setFlagsFromString('--expose-gc');
+const gc = vm.runInNewContext('gc');
+
+const MEGABYTE = 1024 * 1024;
+
+// Polls `rounds` times, collecting garbage in between, and returns the RSS and pool size after each round. Buffers
+// are finalized after the collection, once the event loop gets to run.
+async function poll(rounds, read) {
+  const samples = [];
+
+  for (let round = 0; round < rounds; round += 1) {
+    for (let i = 0; i < 2000; i += 1) read(i);
+    gc();
+    // eslint-disable-next-line no-await-in-loop
+    await new Promise(resolve => setImmediate(resolve));
+    samples.push({ rss: process.memoryUsage().rss, pooled: memoryjs.getStats().pooledBytes });
+  }
+
+  return samples;
+}
+
+module.exports = {
+  async 'readBuffer does not grow memory or the pool'() {
+    await withFixture(async ({ layout, handle }) => {
+      // 2000 reads of 16KB a round, so 32MB a round would be leaked. Without a leak the heap may still keep a round's
+      // worth of freed buffers now and then, so RSS only has to stay well below what a leak would add.
+      const samples = await poll(20, i => memoryjs.readBuffer(handle, layout.scan + (i % 64) * 16384, 16384));
+      const settled = samples[4];
+      const last = samples[samples.length - 1];
+
+      assert.ok(last.rss - settled.rss < 96 * MEGABYTE, `RSS grew from ${settled.rss} to ${last.rss}`);
+
+      // The pool keeps at most 4MB of free buffers of a size, and the smaller buffers of the fixture's other reads
+      const pooled = Math.max(...samples.map(sample => sample.pooled));
+      assert.ok(pooled <= 5 * MEGABYTE, `the pool grew to ${pooled} bytes`);
+    }, 4);
+  },
+
+  async 'readBufferInto does not allocate'() {
+    await withFixture(async ({ layout, handle }) => {
+      const target = Buffer.alloc(16384);
+      const samples = await poll(20, (i) => {
+        const bytesRead = memoryjs.readBufferInto(handle, layout.scan + (i % 64) * 16384, target);
+        assert.strictEqual(bytesRead, target.length);
+      });
+      const settled = samples[4];
+      const last = samples[samples.length - 1];
+
+      assert.ok(last.rss - settled.rss < 16 * MEGABYTE, `RSS grew from ${settled.rss} to ${last.rss}`);
+      assert.strictEqual(last.pooled, settled.pooled);
+    }, 4);
+  },
+};
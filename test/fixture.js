@@ -0,0 +1,69 @@
+// Starts the fixture program (bench/fixture.cc) that the tests read and scan
+const { spawn } = require('child_process');
+const fs = require('fs');
+const path = require('path');
+const memoryjs = require('..');
+
+const FIXTURE = path.join(__dirname, '..', 'build', 'Release', `fixture${process.platform === 'win32' ? '.exe' : ''}`);
+
+// Resolves with the child and the layout it prints once it is ready to be read
+function startFixture(scanMegabytes = 1) {
+  return new Promise((resolve, reject) => {
+    if (!fs.existsSync(FIXTURE)) {
+      reject(new Error(`${FIXTURE} not found, build it with: node-gyp rebuild -- -Dmemoryjs_tests=1`));
+      return;
+    }
+
+    const child = spawn(FIXTURE, [String(scanMegabytes)], { stdio: ['pipe', 'pipe', 'inherit'] });
+    let output = '';
+
+    child.on('error', reject);
+    child.stdout.on('data', (data) => {
+      output += data;
+      const end = output.indexOf('\n');
+      if (end !== -1) resolve({ child, layout: JSON.parse(output.slice(0, end)) });
+    });
+  });
+}
+
+// Has the fixture add one to its `ticks`, and resolves once it has
+function tick(child) {
+  return new Promise((resolve) => {
+    child.stdout.once('data', () => resolve());
+    child.stdin.write('\n');
+  });
+}
+
+// Resolves once the fixture has exited
+function stopFixture(child) {
+  return new Promise((resolve) => {
+    if (child.exitCode !== null || child.signalCode !== null) {
+      resolve();
+      return;
+    }
+
+    child.once('exit', () => resolve());
+    child.stdin.end();
+  });
+}
+
+// Runs `test` with a fresh fixture and a handle to it, then closes both
+async function withFixture(test, scanMegabytes) {
+  const { child, layout } = await startFixture(scanMegabytes);
+  const { handle } = memoryjs.openProcess(layout.pid);
+
+  try {
+    return await test({ child, layout, handle });
+  } finally {
+    memoryjs.closeProcess(handle);
+    await stopFixture(child);
+  }
+}
+
+module.exports = {
+  FIXTURE,
+  startFixture,
+  stopFixture,
+  tick,
+  withFixture,
+};
@@ -0,0 +1,48 @@
+// Runs every test/*.test.js file. Each one exports its tests as an object of name => async function, which throw (for
+// example through `assert`) to fail.
+//
+//   node test/index.js [--filter <regexp>]
+const fs = require('fs');
+const path = require('path');
+
+async function main() {
+  const argv = process.argv.slice(2);
+  const filter = argv[0] === '--filter' ? new RegExp(argv[1]) : null;
+  let failures = 0;
+  let count = 0;
+
+  const files = fs.readdirSync(__dirname).filter(file => file.endsWith('.test.js')).sort();
+
+  // eslint-disable-next-line no-restricted-syntax
+  for (const file of files) {
+    // eslint-disable-next-line global-require, import/no-dynamic-require
+    const tests = require(path.join(__dirname, file));
+
+    // eslint-disable-next-line no-restricted-syntax
+    for (const name of Object.keys(tests)) {
+      const fullName = `${path.basename(file, '.test.js')}: ${name}`;
+
+      if (!filter || filter.test(fullName)) {
+        count += 1;
+
+        try {
+          // eslint-disable-next-line no-await-in-loop
+          await tests[name]();
+          console.log(`ok ${fullName}`);
+        } catch (error) {
+          failures += 1;
+          console.log(`not ok ${fullName}`);
+          console.log(`  ${error.stack.split('\n').join('\n  ')}`);
+        }
+      }
+    }
+  }
+
+  console.log(`${count - failures}/${count} passed`);
+  if (failures) process.exitCode = 1;
+}
+
+main().catch((error) => {
+  console.error(error.stack);
+  process.exitCode = 1;
+});
@@ -0,0 +1,115 @@
+// Checks that every scan kernel finds exactly what compareBytes finds, on synthetic buffers made of few distinct
+// values so that anchors and partial matches are everywhere. Prints the first mismatch and exits with 1.
+#include <stdint.h>
+#include <stdio.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "../lib/cpu.h"
+#include "../lib/pattern.h"
+#include "../lib/threadpool.h"
+
+namespace {
+uint64_t state = 0x9E3779B97F4A7C15ull;
+
+uint32_t next(uint32_t bound) {
+  state ^= state << 13;
+  state ^= state >> 7;
+  state ^= state << 17;
+  return (uint32_t)(state >> 32) % bound;
+}
+
+// A pattern of `length` bytes copied from somewhere in `data`, with about a quarter of them wildcarded
+std::string makePattern(const unsigned char* data, size_t size, size_t length) {
+  static const char digits[] = "0123456789ABCDEF";
+  size_t start = next((uint32_t)(size - length + 1));
+  std::string pattern;
+
+  for (size_t i = 0; i < length; i++) {
+    if (!pattern.empty()) pattern += ' ';
+
+    if (next(4) == 0) {
+      pattern += '?';
+    } else {
+      unsigned char byte = data[start + i];
+      pattern += digits[byte >> 4];
+      pattern += digits[byte & 15];
+    }
+  }
+
+  return pattern;
+}
+
+std::vector<size_t> reference(const unsigned char* data, size_t size, const std::string& pattern, size_t length) {
+  std::vector<size_t> offsets;
+  for (size_t offset = 0; offset + length <= size; offset++) {
+    if (pattern::compareBytes(data + offset, pattern.c_str())) offsets.push_back(offset);
+  }
+  return offsets;
+}
+
+int failures = 0;
+
+void expect(bool ok, const char* what, const std::string& pattern, size_t size, size_t expected, size_t actual) {
+  if (ok || failures++ > 10) return;
+  printf("%s: pattern \"%s\" over %llu bytes, expected %lld, got %lld\n", what, pattern.c_str(),
+         (unsigned long long)size, (long long)expected, (long long)actual);
+}
+}  // namespace
+
+int main() {
+  std::vector<pattern::Kernel> kernels = {pattern::KERNEL_SCALAR};
+#ifdef MEMORYJS_X86
+  if (cpu::hasSSE2()) kernels.push_back(pattern::KERNEL_SSE2);
+  if (cpu::hasAVX2()) kernels.push_back(pattern::KERNEL_AVX2);
+#endif
+
+  const char* names[] = {"auto", "scalar", "sse2", "avx2"};
+
+  // The parallel scans split buffers into chunks even on a single core
+  threadpool::setThreads(4);
+  size_t checks = 0;
+
+  for (int round = 0; round < 4000; round++) {
+    // Sizes around the vector widths, and a few large enough for the parallel scans to split
+    size_t size = round % 100 == 0 ? (3 << 20) + next(4096) : 1 + next(round % 2 ? 80 : 600);
+    uint32_t alphabet = 2 + next(5);
+
+    // One byte of slack in front, so that scans also start at odd addresses
+    std::vector<unsigned char> buffer(size + 1);
+    for (auto& byte : buffer) byte = (unsigned char)(0x40 + next(alphabet));
+    const unsigned char* data = buffer.data() + round % 2;
+
+    size_t length = 1 + next((uint32_t)std::min<size_t>(size, 40));
+    std::string text = makePattern(data, size, length);
+    pattern::Signature signature = pattern::compile(text.c_str());
+
+    if (signature.bytes.size() != length) {
+      expect(false, "compile", text, size, length, signature.bytes.size());
+      continue;
+    }
+
+    std::vector<size_t> expected = reference(data, size, text, length);
+    size_t first = expected.empty() ? pattern::npos : expected[0];
+
+    for (pattern::Kernel kernel : kernels) {
+      size_t found = pattern::scan(data, size, signature, kernel);
+      expect(found == first, names[kernel], text, size, first, found);
+    }
+
+    size_t found = pattern::scanParallel(data, size, signature);
+    expect(found == first, "scanParallel", text, size, first, found);
+
+    std::vector<size_t> all = pattern::scanAll(data, size, signature);
+    expect(all == expected, "scanAll (count)", text, size, expected.size(), all.size());
+
+    std::vector<size_t> many = pattern::scanMany(data, size, {&signature, &signature});
+    expect(many.size() == 2 && many[0] == first && many[1] == first, "scanMany", text, size, first, many[0]);
+
+    checks++;
+  }
+
+  printf("%llu patterns checked against compareBytes with %llu kernels, %d failures\n", (unsigned long long)checks,
+         (unsigned long long)kernels.size(), failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,15 @@
+// Runs the native kernel parity checks of test/kernels.cc
+const assert = require('assert');
+const { spawnSync } = require('child_process');
+const path = require('path');
+
+const KERNELS = path.join(__dirname, '..', 'build', 'Release', `kernels${process.platform === 'win32' ? '.exe' : ''}`);
+
+module.exports = {
+  'every scan kernel matches compareBytes'() {
+    const result = spawnSync(KERNELS, { encoding: 'utf8' });
+
+    assert.ifError(result.error);
+    assert.strictEqual(result.status, 0, result.stdout);
+  },
+};
@@ -0,0 +1,47 @@
+// Mirrors report the granules that changed since their last update, and keep their buffer equal to the target's bytes
+const assert = require('assert');
+const memoryjs = require('..');
+const { tick, withFixture } = require('./fixture');
+
+module.exports = {
+  async 'reports the whole region first and then only what changed'() {
+    await withFixture(async ({ child, layout, handle }) => {
+      const mirror = memoryjs.createMirror(handle, layout.byte, 256, { granularity: 64 });
+      const [first] = memoryjs.updateMirror(mirror);
+
+      assert.deepStrictEqual([first.offset, first.length], [0, 256]);
+      assert.ok(first.bytes.equals(memoryjs.readBuffer(handle, layout.byte, 256)));
+      assert.deepStrictEqual(memoryjs.updateMirror(mirror), []);
+
+      const ticks = memoryjs.createMirror(handle, layout.ticks, 256, { granularity: 64 });
+      memoryjs.updateMirror(ticks);
+      await tick(child);
+      await tick(child);
+
+      const [span, ...rest] = memoryjs.updateMirror(ticks);
+      assert.deepStrictEqual(rest, []);
+      assert.deepStrictEqual([span.offset, span.length], [0, 64]);
+      assert.strictEqual(span.bytes.readUInt32LE(0), 2);
+
+      const { updates, bytesChanged, bytesTransferred } = memoryjs.getMirrorStats(ticks);
+      assert.strictEqual(updates, 2);
+      assert.strictEqual(bytesChanged, 1);
+      assert.strictEqual(bytesTransferred, 256 + 64);
+    });
+  },
+
+  async 'keeps its buffer up to date in place'() {
+    await withFixture(async ({ child, layout, handle }) => {
+      const mirror = memoryjs.createMirror(handle, layout.ticks, 256, { granularity: 16 });
+      const buffer = memoryjs.getMirrorBuffer(mirror);
+
+      assert.deepStrictEqual(Array.from(memoryjs.applyMirror(mirror)), [0, 256]);
+      await tick(child);
+
+      assert.deepStrictEqual(Array.from(memoryjs.applyMirror(mirror)), [0, 16]);
+      assert.strictEqual(buffer.readUInt32LE(0), 1);
+      assert.ok(buffer.equals(memoryjs.readBuffer(handle, layout.ticks, 256)));
+      assert.throws(() => memoryjs.createMirror(handle, layout.ticks, 256, { granularity: 0 }), /positive/);
+    });
+  },
+};
@@ -0,0 +1,30 @@
+// Opaque objects (compiled patterns, layouts, scanners, ...) are only accepted where their own kind is expected
+const assert = require('assert');
+const memoryjs = require('..');
+const native = require('../build/Release/memoryjs');
+const { withFixture } = require('./fixture');
+
+module.exports = {
+  async 'rejects an opaque object of another kind'() {
+    await withFixture(({ layout, handle }) => {
+      const pattern = memoryjs.compilePattern('7A 3B 9E D1');
+      const structure = memoryjs.defineStruct([{ name: 'value', type: 'int32' }]);
+      const scanner = memoryjs.createScanner(handle, 'int32');
+      const token = native.createCancelToken();
+      const scan = { start: layout.scan, end: layout.scan + layout.scanSize };
+
+      assert.throws(() => memoryjs.findAll(handle, structure, scan), /signature/);
+      assert.throws(() => memoryjs.getScanResults(pattern), /scanner/);
+      assert.throws(() => memoryjs.firstScan(token, { compare: 'exact', value: 1 }), /scanner/);
+      assert.throws(() => memoryjs.readStruct(handle, layout.int32, scanner), /defineStruct/);
+      assert.throws(() => native.cancel(scanner), /cancel token/);
+      assert.throws(() => memoryjs.clearPointerCache(pattern), /pointer cache/);
+      assert.throws(() => memoryjs.getMirrorStats(structure), /mirror/);
+      assert.throws(() => memoryjs.closeSession(scanner), /session/);
+      assert.throws(() => memoryjs.unwatch(token), /subscription/);
+
+      assert.strictEqual(Array.from(memoryjs.findAll(handle, pattern, scan)).length, 1);
+      assert.deepStrictEqual(memoryjs.readStruct(handle, layout.int32, structure), { value: -123456 });
+    });
+  },
+};
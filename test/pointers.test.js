@@ -0,0 +1,41 @@
+// Pointer maps, the paths found in them, and rescanning the paths in a process
+const assert = require('assert');
+const path = require('path');
+const memoryjs = require('..');
+const { withFixture } = require('./fixture');
+
+module.exports = {
+  async 'finds the path through a static pointer and keeps it on a rescan'() {
+    await withFixture(async ({ layout, handle }) => {
+      const name = path.basename(require.resolve('../build/Release/fixture'));
+      const image = memoryjs.getModules(layout.pid).find(module => module.szModule === name);
+      const start = image.modBaseAddr;
+      const range = { start, end: start + image.modBaseSize };
+
+      // values.pointer, stored in the image, points at the start of the values
+      const map = memoryjs.createPointerMap(handle, range);
+      const paths = memoryjs.findPointerPaths(map, layout.byte, { depth: 2, maxOffset: 0 });
+      const expected = { module: image.szModule, offsets: [layout.ptr - start, 0] };
+
+      const same = found => found.module === expected.module && String(found.offsets) === String(expected.offsets);
+      assert.ok(paths.some(same));
+
+      const stable = memoryjs.rescanPointerPaths(handle, paths, layout.byte);
+      assert.ok(stable.some(same));
+      assert.deepStrictEqual(memoryjs.rescanPointerPaths(handle, [expected], layout.byte + 8), []);
+
+      const promised = await memoryjs.promises.findPointerPaths(map, layout.byte, { depth: 2, maxOffset: 0 });
+      assert.strictEqual(promised.length, paths.length);
+    });
+  },
+
+  async 'refuses search options that are not non-negative integers'() {
+    await withFixture(({ layout, handle }) => {
+      const map = memoryjs.createPointerMap(handle, { start: layout.byte, end: layout.byte + 64 });
+
+      assert.throws(() => memoryjs.findPointerPaths(map, layout.byte, { depth: '2' }), /non-negative integers/);
+      assert.throws(() => memoryjs.findPointerPaths(map, layout.byte, { maxOffset: -1 }), /non-negative integers/);
+      assert.throws(() => memoryjs.findPointerPaths(map, layout.byte, { limit: 1.5 }), /non-negative integers/);
+    });
+  },
+};
@@ -0,0 +1,109 @@
+// First and next scans, and scanners that are busy or outlive their environment
+const assert = require('assert');
+const path = require('path');
+const { Worker } = require('worker_threads');
+const memoryjs = require('..');
+const native = require('../build/Release/memoryjs');
+const { withFixture } = require('./fixture');
+
+module.exports = {
+  async 'narrows the candidates down to the value'() {
+    await withFixture(({ layout, handle }) => {
+      const scanner = memoryjs.createScanner(handle, 'int32', { start: layout.int32 - 64, end: layout.int32 + 64 });
+
+      assert.ok(memoryjs.firstScan(scanner, { compare: 'exact', value: -123456 }) >= 1);
+      assert.ok(memoryjs.nextScan(scanner, { compare: 'unchanged' }) >= 1);
+
+      const results = memoryjs.getScanResults(scanner);
+      assert.ok(Array.from(results.addresses).includes(layout.int32));
+    });
+  },
+
+  async 'refuses wrongly typed filters and conditions'() {
+    await withFixture(({ layout, handle }) => {
+      const range = { start: layout.int32 - 64, end: layout.int32 + 64 };
+
+      assert.throws(() => memoryjs.createScanner(handle, 'int32', { start: String(range.start) }), /numbers/);
+      assert.throws(() => memoryjs.createScanner(handle, 'int32', { ...range, alignment: '4' }), /numbers/);
+      assert.throws(() => memoryjs.findAll(handle, '7A 3B', { protection: 'rw' }), /numbers/);
+      assert.throws(() => memoryjs.findAll(handle, '7A 3B', { ...range, limit: -1 }), /limit/);
+
+      const scanner = memoryjs.createScanner(handle, 'int32', range);
+      assert.throws(() => memoryjs.firstScan(scanner, { compare: 1, value: 0 }), /comparison/);
+      assert.throws(() => memoryjs.firstScan(scanner, { compare: 'exact', value: '-123456' }), /not a number/);
+
+      assert.ok(memoryjs.firstScan(scanner, { compare: 'exact', value: -123456 }) >= 1);
+    });
+  },
+
+  async 'refuses to use a scanner while it scans'() {
+    await withFixture(async ({ layout, handle }) => {
+      const range = { start: layout.scan, end: layout.scan + layout.scanSize };
+      const scanner = memoryjs.createScanner(handle, 'int32', range);
+      const scan = memoryjs.promises.firstScan(scanner, { compare: 'exact', value: 0 });
+
+      assert.throws(() => memoryjs.getScanResults(scanner), /busy/);
+      assert.throws(() => memoryjs.firstScan(scanner, { compare: 'exact', value: 0 }), /busy/);
+
+      await scan;
+      assert.ok(memoryjs.getScanResults(scanner, 0, 1).count > 0);
+    });
+  },
+
+  async 'leaves the candidates alone when a scan is aborted'() {
+    await withFixture(async ({ layout, handle }) => {
+      const range = { start: layout.scan, end: layout.scan + layout.scanSize };
+      const scanner = memoryjs.createScanner(handle, 'int32', range);
+      const before = memoryjs.firstScan(scanner, { compare: 'exact', value: 0 });
+
+      // Aborted before it starts, and (most of the time) part of the way through
+      const token = native.createCancelToken();
+      native.cancel(token);
+      await assert.rejects(native.nextScanAsync(scanner, { compare: 'changed' }, token), { name: 'AbortError' });
+      assert.strictEqual(memoryjs.getScanResults(scanner, 0, 1).count, before);
+
+      const running = native.createCancelToken();
+      const scan = native.nextScanAsync(scanner, { compare: 'changed' }, running);
+      setImmediate(() => native.cancel(running));
+
+      const after = await scan.catch((error) => {
+        assert.strictEqual(error.name, 'AbortError');
+        return before;
+      });
+      assert.strictEqual(memoryjs.getScanResults(scanner, 0, 1).count, after);
+    }, 16);
+  },
+
+  async 'drops the scans still waiting when a worker exits'() {
+    await withFixture(async ({ layout }) => {
+      const worker = new Worker(`
+        const { workerData, parentPort } = require('worker_threads');
+        const memoryjs = require(workerData.memoryjs);
+        const { handle } = memoryjs.openProcess(workerData.pid);
+        const scanners = [];
+
+        memoryjs.setAsyncConcurrency(1);
+        for (let i = 0; i < 8; i += 1) {
+          const scanner = memoryjs.createScanner(handle, 'int32', workerData.range);
+          scanners.push(scanner);
+          memoryjs.promises.firstScan(scanner, { compare: 'exact', value: 0 }).catch(() => {});
+        }
+
+        parentPort.postMessage('queued');
+      `, {
+        eval: true,
+        workerData: {
+          memoryjs: path.join(__dirname, '..'),
+          pid: layout.pid,
+          range: { start: layout.scan, end: layout.scan + layout.scanSize },
+        },
+      });
+
+      await new Promise((resolve, reject) => {
+        worker.once('message', resolve);
+        worker.once('error', reject);
+      });
+      await worker.terminate();
+    }, 16);
+  },
+};
@@ -0,0 +1,56 @@
+// Sessions read and scan every target, report the ones that exited, and drop them on a refresh
+const assert = require('assert');
+const path = require('path');
+const memoryjs = require('..');
+const { FIXTURE, startFixture, stopFixture } = require('./fixture');
+
+const NAME = path.basename(FIXTURE);
+
+module.exports = {
+  async 'reads every target relative to its own module, and survives one exiting'() {
+    const fixtures = [await startFixture(), await startFixture()];
+    const pids = fixtures.map(({ layout }) => layout.pid);
+    const session = memoryjs.openSession({ pids });
+
+    try {
+      const targets = memoryjs.getSessionTargets(session);
+      assert.deepStrictEqual(targets.map(target => target.th32ProcessID).sort(), pids.slice().sort());
+      assert.ok(targets.every(target => target.alive));
+
+      // The fixture is built the same way both times, so int32 is at the same offset into either module
+      const { layout } = fixtures[0];
+      const base = memoryjs.getModules(layout.pid).find(module => module.szModule === NAME).modBaseAddr;
+      const requests = [{ module: NAME, address: layout.int32 - base, type: memoryjs.INT32 }];
+
+      memoryjs.sessionReadBatch(session, requests).forEach((result) => {
+        assert.strictEqual(result.error, null);
+        assert.deepStrictEqual(result.values, [-123456]);
+      });
+
+      const matches = await memoryjs.promises.sessionFindAll(session, '7A 3B 9E D1 5F 62 A7 11', { limit: 1 });
+      assert.strictEqual(matches.length, 2);
+      matches.forEach((result) => {
+        assert.strictEqual(result.addresses.length, 1);
+        const bytes = memoryjs.readBuffer(result.handle, result.addresses[0], 8);
+        assert.ok(bytes.equals(Buffer.from([0x7A, 0x3B, 0x9E, 0xD1, 0x5F, 0x62, 0xA7, 0x11])));
+      });
+
+      await stopFixture(fixtures[1].child);
+
+      const results = memoryjs.sessionReadBatch(session, requests);
+      const live = results.find(result => result.th32ProcessID === pids[0]);
+      const exited = results.find(result => result.th32ProcessID === pids[1]);
+      assert.deepStrictEqual(live.values, [-123456]);
+      assert.strictEqual(exited.alive, false);
+      assert.strictEqual(exited.error, 'the process has exited');
+
+      assert.strictEqual(memoryjs.refreshSession(session), 0);
+      assert.deepStrictEqual(memoryjs.getSessionTargets(session).map(target => target.th32ProcessID), [pids[0]]);
+    } finally {
+      memoryjs.closeSession(session);
+      await Promise.all(fixtures.map(({ child }) => stopFixture(child)));
+    }
+
+    assert.throws(() => memoryjs.getSessionTargets(session), /closed/);
+  },
+};
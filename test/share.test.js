@@ -0,0 +1,90 @@
+// Regions published into a SharedArrayBuffer, and read back on the main thread and in workers
+const assert = require('assert');
+const path = require('path');
+const { Worker } = require('worker_threads');
+const memoryjs = require('..');
+const { readSharedRegions, getSharedSequence } = require('../shared');
+const { withFixture } = require('./fixture');
+
+const sleep = ms => new Promise(resolve => setTimeout(resolve, ms));
+
+// Resolves once the regions have been published since `sequence`
+async function publishedSince(buffer, sequence) {
+  while (getSharedSequence(buffer) <= sequence) {
+    // eslint-disable-next-line no-await-in-loop
+    await sleep(1);
+  }
+}
+
+// Reads the buffer many times over in a worker while the publisher keeps writing it
+const WORKER = `
+  const { workerData, parentPort } = require('worker_threads');
+  const { readSharedRegions } = require(workerData.shared);
+  const expected = Buffer.from(workerData.expected);
+
+  let sequence = 0;
+  for (let i = 0; i < 20000; i += 1) {
+    const read = readSharedRegions(workerData.buffer);
+    if (read.sequence < sequence) throw new Error('went back to an older publish');
+    if (!Buffer.from(read.regions[0].bytes).equals(expected)) throw new Error('torn or wrong region');
+    sequence = read.sequence;
+  }
+
+  parentPort.postMessage(sequence);
+`;
+
+module.exports = {
+  async 'publishes the regions and their readability'() {
+    await withFixture(async ({ layout, handle }) => {
+      const shared = memoryjs.shareRegions(handle, [
+        { address: layout.vec3, size: 12 },
+        { address: 8, size: 16 },
+      ], { intervalMs: 1 });
+
+      try {
+        await publishedSince(shared.buffer, 0);
+        const { sequence, regions } = readSharedRegions(shared.buffer);
+
+        assert.ok(sequence >= 1);
+        assert.deepStrictEqual(regions.map(region => [region.address, region.readable]), [
+          [layout.vec3, true], [8, false],
+        ]);
+        assert.deepStrictEqual(Buffer.from(regions[0].bytes), memoryjs.readBuffer(handle, layout.vec3, 12));
+
+        // A new configuration is published from the next interval on
+        memoryjs.configureSharedRegions(shared, { regions: [{ address: layout.int32, size: 4 }] });
+        await publishedSince(shared.buffer, getSharedSequence(shared.buffer) + 1);
+
+        const [int32] = readSharedRegions(shared.buffer).regions;
+        assert.strictEqual(Buffer.from(int32.bytes).readInt32LE(), -123456);
+      } finally {
+        memoryjs.stopSharedRegions(shared);
+      }
+    });
+  },
+
+  async 'gives workers whole publishes while they are written'() {
+    await withFixture(async ({ layout, handle }) => {
+      const shared = memoryjs.shareRegions(handle, [{ address: layout.vec3, size: 12 }], { intervalMs: 1 });
+
+      try {
+        await publishedSince(shared.buffer, 0);
+
+        const expected = memoryjs.readBuffer(handle, layout.vec3, 12);
+        const worker = new Worker(WORKER, {
+          eval: true,
+          workerData: { shared: path.join(__dirname, '..', 'shared'), buffer: shared.buffer, expected },
+        });
+
+        const sequence = await new Promise((resolve, reject) => {
+          worker.once('message', resolve);
+          worker.once('error', reject);
+        });
+
+        assert.ok(sequence >= 1);
+      } finally {
+        memoryjs.stopSharedRegions(shared);
+      }
+    });
+  },
+};
@@ -0,0 +1,45 @@
+// The signature cache lets a later start skip the scans an earlier one did
+const assert = require('assert');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const memoryjs = require('..');
+const { withFixture } = require('./fixture');
+
+const RARE = '7A 3B 9E D1 5F 62 A7 11';
+
+module.exports = {
+  async 'a second start finds the signatures without scanning'() {
+    const directory = fs.mkdtempSync(path.join(os.tmpdir(), 'memoryjs-'));
+    const file = path.join(directory, 'signatures.cache');
+
+    try {
+      await withFixture(({ handle }) => {
+        memoryjs.setSignatureCache(file);
+        const first = memoryjs.findPattern(handle, 'fixture', RARE, memoryjs.NORMAL, 0, 0);
+        assert.ok(first > 0);
+
+        // findPattern leaves writing the file to a flush, or to switching the cache
+        assert.ok(!fs.existsSync(file));
+        assert.strictEqual(memoryjs.flushSignatureCache(), true);
+        assert.ok(fs.existsSync(file));
+        assert.deepStrictEqual(fs.readdirSync(directory), ['signatures.cache']);
+
+        // Started again: the cache is opened afresh, and the match comes from it instead of a scan
+        memoryjs.setSignatureCache(null);
+        memoryjs.setSignatureCache(file);
+        memoryjs.resetStats();
+
+        const { hits } = memoryjs.getSignatureCacheStats();
+        const second = memoryjs.findPattern(handle, 'fixture', RARE, memoryjs.NORMAL, 0, 0);
+
+        assert.strictEqual(second, first);
+        assert.strictEqual(memoryjs.getSignatureCacheStats().hits, hits + 1);
+        assert.strictEqual(memoryjs.getStats().scanBytes, 0);
+      });
+    } finally {
+      memoryjs.setSignatureCache(null);
+      fs.rmSync(directory, { recursive: true, force: true });
+    }
+  },
+};
@@ -0,0 +1,66 @@
+// Memory dumps, read back like a process, and the files that are refused as dumps
+const assert = require('assert');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const memoryjs = require('..');
+const { withFixture } = require('./fixture');
+
+// Offsets into the file, from snapshot.cc: the header's module count and region table, and a region's module index
+const MODULE_COUNT = 16;
+const REGIONS = 32;
+const REGION_MODULE = 24;
+
+// Runs `test` with the path of a dump of the fixture's values, which are in its image
+async function withDump(test) {
+  const directory = fs.mkdtempSync(path.join(os.tmpdir(), 'memoryjs-'));
+  const file = path.join(directory, 'fixture.dump');
+
+  try {
+    await withFixture(async ({ layout, handle }) => {
+      const { regions } = memoryjs.dumpRegions(handle, file, { start: layout.int32, end: layout.int32 + 4 });
+      assert.strictEqual(regions, 1);
+      await test({ layout, file });
+    });
+  } finally {
+    fs.rmSync(directory, { recursive: true, force: true });
+  }
+}
+
+module.exports = {
+  async 'reads a dump back like the process'() {
+    await withDump(({ layout, file }) => {
+      const dump = memoryjs.openSnapshot(file);
+
+      try {
+        assert.strictEqual(memoryjs.readMemory(dump, layout.int32, memoryjs.INT32), -123456);
+        assert.ok(memoryjs.findModuleForAddress(dump, layout.int32));
+      } finally {
+        memoryjs.closeProcess(dump);
+      }
+    });
+  },
+
+  async 'refuses a truncated dump'() {
+    await withDump(({ file }) => {
+      fs.truncateSync(file, fs.statSync(file).size - 1);
+      assert.throws(() => memoryjs.openSnapshot(file), /not a memory dump/);
+
+      fs.truncateSync(file, 16);
+      assert.throws(() => memoryjs.openSnapshot(file), /not a memory dump/);
+    });
+  },
+
+  async 'refuses a dump whose region names a module it does not have'() {
+    await withDump(({ file }) => {
+      const data = fs.readFileSync(file);
+      const region = Number(data.readBigUInt64LE(REGIONS));
+
+      assert.ok(data.readInt32LE(region + REGION_MODULE) >= 0, 'the region is in the image');
+      data.writeInt32LE(data.readUInt32LE(MODULE_COUNT), region + REGION_MODULE);
+      fs.writeFileSync(file, data);
+
+      assert.throws(() => memoryjs.openSnapshot(file), /not a memory dump/);
+    });
+  },
+};
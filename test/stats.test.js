@@ -0,0 +1,72 @@
+// Counters start again from zero at a reset, whichever thread counted them
+const assert = require('assert');
+const path = require('path');
+const { Worker } = require('worker_threads');
+const memoryjs = require('..');
+const { withFixture } = require('./fixture');
+
+const WORKER = `
+  const { workerData, parentPort } = require('worker_threads');
+  const memoryjs = require(workerData.memoryjs);
+  const { handle } = memoryjs.openProcess(workerData.pid);
+  memoryjs.readMemory(handle, workerData.address, 'int32');
+  memoryjs.closeProcess(handle);
+  parentPort.postMessage('done');
+`;
+
+function inWorker(layout) {
+  const worker = new Worker(WORKER, {
+    eval: true,
+    workerData: { memoryjs: path.join(__dirname, '..'), pid: layout.pid, address: layout.int32 },
+  });
+
+  return new Promise((resolve, reject) => {
+    worker.once('message', resolve);
+    worker.once('error', reject);
+  }).then(() => worker.terminate());
+}
+
+module.exports = {
+  async 'counts from zero after a reset'() {
+    await withFixture(({ layout, handle }) => {
+      memoryjs.readMemory(handle, layout.int32, memoryjs.INT32);
+      memoryjs.resetStats();
+
+      const reset = memoryjs.getStats();
+      if (!reset.enabled) return;
+
+      assert.strictEqual(reset.reads, 0);
+      assert.strictEqual(reset.bytesRead, 0);
+      assert.strictEqual(reset.apis.readMemory, undefined);
+
+      memoryjs.readMemory(handle, layout.int32, memoryjs.INT32);
+      memoryjs.readMemory(handle, layout.double, memoryjs.DOUBLE);
+
+      const stats = memoryjs.getStats();
+      assert.strictEqual(stats.reads, 2);
+      assert.strictEqual(stats.bytesRead, 12);
+      assert.strictEqual(stats.failedReads, 0);
+      assert.strictEqual(stats.apis.readMemory.calls, 2);
+      assert.strictEqual(stats.apis.readMemory.histogram.reduce((a, b) => a + b), 2);
+    });
+  },
+
+  async 'counts other threads against the same baseline'() {
+    await withFixture(async ({ layout }) => {
+      await inWorker(layout);
+      memoryjs.resetStats();
+
+      const reset = memoryjs.getStats();
+      if (!reset.enabled) return;
+      assert.strictEqual(reset.apis.openProcess, undefined);
+
+      // A reset in this thread leaves out what the earlier worker counted, and a new worker counts from it
+      await inWorker(layout);
+
+      const stats = memoryjs.getStats();
+      assert.strictEqual(stats.apis.openProcess.calls, 1);
+      assert.strictEqual(stats.apis.readMemory.calls, 1);
+      assert.strictEqual(stats.bytesRead, 4);
+    });
+  },
+};
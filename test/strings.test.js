@@ -0,0 +1,61 @@
+// The strings scanner: its encodings, lengths and limit
+const assert = require('assert');
+const memoryjs = require('..');
+const { withFixture } = require('./fixture');
+
+const TEXT = 'the quick brown fox jumps over the lazy dog';
+
+// The strings found between two addresses of the fixture
+function scan(handle, start, end, options = {}) {
+  return memoryjs.getStringResults(memoryjs.findStrings(handle, { start, end, ...options }));
+}
+
+module.exports = {
+  async 'finds ASCII and UTF-16 text in the encodings asked for'() {
+    await withFixture(({ layout, handle }) => {
+      const ascii = scan(handle, layout.shortString, layout.shortString + TEXT.length, { encoding: 'ascii' });
+      assert.deepStrictEqual(ascii.texts, [TEXT]);
+      assert.deepStrictEqual(Array.from(ascii.addresses), [layout.shortString]);
+      assert.deepStrictEqual(Array.from(ascii.encodings), [0]);
+
+      const wide = scan(handle, layout.wideString, layout.wideString + TEXT.length * 2, { encoding: 'utf16' });
+      assert.deepStrictEqual(wide.texts, [TEXT]);
+      assert.deepStrictEqual(Array.from(wide.encodings), [1]);
+
+      // UTF-16 text is no run of printable bytes, every other byte being zero
+      assert.strictEqual(scan(handle, layout.wideString, layout.wideString + TEXT.length * 2, { encoding: 'ascii' })
+        .count, 0);
+    });
+  },
+
+  async 'cuts, skips and stops at the lengths and limit given'() {
+    await withFixture(({ layout, handle }) => {
+      const start = layout.longString;
+      const end = layout.longString + 4096;
+
+      const cut = scan(handle, start, end, { encoding: 'ascii', maxLength: 26 });
+      assert.strictEqual(cut.texts[0], 'abcdefghijklmnopqrstuvwxyz');
+
+      assert.strictEqual(scan(handle, start, end, { encoding: 'ascii', minLength: 4097 }).count, 0);
+      assert.strictEqual(scan(handle, layout.shortString, layout.shortString + TEXT.length, {
+        encoding: 'ascii', filter: ['lazy cat', 'brown fox'],
+      }).count, 1);
+      assert.strictEqual(scan(handle, layout.shortString, layout.shortString + TEXT.length, {
+        encoding: 'ascii', filter: 'lazy cat',
+      }).count, 0);
+      assert.strictEqual(scan(handle, layout.shortString, layout.wideString + TEXT.length * 2, { limit: 1 }).count, 1);
+    });
+  },
+
+  async 'refuses wrongly typed or out of range options'() {
+    await withFixture(({ layout, handle }) => {
+      const range = { start: layout.shortString, end: layout.shortString + TEXT.length };
+
+      assert.throws(() => memoryjs.findStrings(handle, { ...range, minLength: '4' }), /minLength/);
+      assert.throws(() => memoryjs.findStrings(handle, { ...range, maxLength: 2 ** 21 }), /1048576/);
+      assert.throws(() => memoryjs.findStrings(handle, { ...range, limit: -1 }), /limit/);
+      assert.throws(() => memoryjs.findStrings(handle, { ...range, encoding: 2 }), /encoding/);
+      assert.throws(() => memoryjs.findStrings(handle, { ...range, filter: [1] }), /filter/);
+    });
+  },
+};
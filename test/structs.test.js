@@ -0,0 +1,44 @@
+// Struct layouts, and the offsets, counts and targets they are refused for
+const assert = require('assert');
+const memoryjs = require('..');
+const { withFixture } = require('./fixture');
+
+module.exports = {
+  async 'refuses offsets and counts that are not non-negative integers'() {
+    const field = extra => memoryjs.defineStruct([{ name: 'a', type: 'int64', ...extra }]);
+
+    assert.throws(() => field({ offset: -8 }), /non-negative integers/);
+    assert.throws(() => field({ offset: 1.5 }), /non-negative integers/);
+    assert.throws(() => field({ offset: '8' }), /non-negative integers/);
+    assert.throws(() => field({ count: -1 }), /non-negative integers/);
+    assert.throws(() => field({ offset: 2 ** 53 }), /non-negative integers/);
+    assert.throws(() => field({ count: 2 ** 30 }), /largest struct/);
+    assert.throws(() => memoryjs.defineStruct([{ name: 'a', type: 'int32' }], { size: -4 }), /size/);
+  },
+
+  async 'reads structs at their offsets'() {
+    await withFixture(({ layout, handle }) => {
+      const Values = memoryjs.defineStruct([
+        { name: 'int32', type: 'int32', offset: layout.int32 - layout.byte },
+        { name: 'vec3', type: 'float', offset: layout.vec3 - layout.byte, count: 3 },
+      ]);
+
+      assert.deepStrictEqual(memoryjs.readStruct(handle, layout.byte, Values), { int32: -123456, vec3: [1, 2, 3] });
+    });
+  },
+
+  async 'refuses counts and targets before reading'() {
+    await withFixture(({ layout, handle }) => {
+      const Vec3 = memoryjs.defineStruct([
+        { name: 'x', type: 'float' }, { name: 'y', type: 'float' }, { name: 'z', type: 'float' },
+      ]);
+
+      assert.throws(() => memoryjs.readStructArray(handle, layout.vec3, Vec3, -1), /count/);
+      assert.throws(() => memoryjs.readStructArray(handle, layout.vec3, Vec3, 2 ** 32 - 1), /count/);
+
+      // Refused even though the address cannot be read, so before anything was
+      assert.throws(() => memoryjs.readStructArray(handle, 8, Vec3, 2, new Float64Array(5)), /Float64Array/);
+      assert.throws(() => memoryjs.readStruct(handle, 8, Vec3, new Int32Array(3)), /Float64Array/);
+    });
+  },
+};
@@ -0,0 +1,55 @@
+// Subscriptions read on their own thread until they are unwatched or collected
+const assert = require('assert');
+const v8 = require('v8');
+const vm = require('vm');
+const memoryjs = require('..');
+const native = require('../build/Release/memoryjs');
+const { withFixture } = require('./fixture');
+
+v8.setFlagsFromString('--expose-gc');
+const gc = vm.runInNewContext('gc');
+
+const sleep = ms => new Promise(resolve => setTimeout(resolve, ms));
+
+// The sampler threads count their reads, so reads still going on show up in the stats
+async function readsDuring(ms) {
+  const before = memoryjs.getStats().reads;
+  await sleep(ms);
+  return memoryjs.getStats().reads - before;
+}
+
+module.exports = {
+  async 'stops reading once unwatched'() {
+    await withFixture(async ({ layout, handle }) => {
+      const subscription = memoryjs.watch(handle, layout.int32, memoryjs.INT, { intervalMs: 1 }, () => {});
+      assert.ok(await readsDuring(50) > 0);
+
+      memoryjs.unwatch(subscription);
+      assert.strictEqual(await readsDuring(50), 0);
+    });
+  },
+
+  async 'stops reading once the subscription is collected'() {
+    await withFixture(async ({ layout, handle }) => {
+      memoryjs.watch(handle, layout.int32, memoryjs.INT, { intervalMs: 1 }, () => {});
+      assert.ok(await readsDuring(50) > 0);
+
+      // Finalizers run once the event loop gets to run after the collection
+      gc();
+      await sleep(10);
+      assert.strictEqual(await readsDuring(50), 0);
+    });
+  },
+
+  async 'refuses wrongly typed locations and options without starting to read'() {
+    await withFixture(async ({ layout, handle }) => {
+      const watch = (locations, options) => native.watchMemory(handle, locations, options, () => {});
+
+      assert.throws(() => watch([{ address: layout.int32, type: 5 }], {}), /address and a type/);
+      assert.throws(() => watch([{ address: String(layout.int32), type: 'int' }], {}), /address and a type/);
+      assert.throws(() => watch([{ type: 'int' }], {}), /address and a type/);
+      assert.throws(() => watch([{ address: layout.int32, type: 'int' }], { intervalMs: '1' }), /intervalMs/);
+      assert.strictEqual(await readsDuring(50), 0);
+    });
+  },
+};
@@ -0,0 +1,61 @@
+// Handles are shared by every thread of the process, and only let go of once every thread that opened one closed it
+const assert = require('assert');
+const path = require('path');
+const { Worker } = require('worker_threads');
+const memoryjs = require('..');
+const { withFixture } = require('./fixture');
+
+const WORKER = `
+  const { workerData, parentPort } = require('worker_threads');
+  const memoryjs = require(workerData.memoryjs);
+
+  for (let round = 0; round < 200; round += 1) {
+    const { handle } = memoryjs.openProcess(workerData.pid);
+    if (memoryjs.readMemory(handle, workerData.address, 'int32') !== -123456) throw new Error('wrong value');
+    memoryjs.findModuleForAddress(handle, workerData.address);
+    memoryjs.closeProcess(handle);
+  }
+
+  // The main thread's handle is not this thread's to close, and this one is left for the exit to close
+  memoryjs.closeProcess(workerData.handle);
+  memoryjs.openProcess(workerData.pid);
+  parentPort.postMessage('done');
+`;
+
+module.exports = {
+  async 'workers opening and closing the same process leave other handles alone'() {
+    await withFixture(async ({ layout, handle }) => {
+      const workers = [];
+
+      for (let i = 0; i < 8; i += 1) {
+        workers.push(new Worker(WORKER, {
+          eval: true,
+          workerData: {
+            memoryjs: path.join(__dirname, '..'), pid: layout.pid, address: layout.int32, handle,
+          },
+        }));
+      }
+
+      const finished = Promise.all(workers.map(worker => new Promise((resolve, reject) => {
+        worker.once('message', resolve);
+        worker.once('error', reject);
+      })));
+
+      // Reading all along, while the workers open, close and exit
+      let done = false;
+      finished.then(() => { done = true; }, () => { done = true; });
+
+      while (!done) {
+        assert.strictEqual(memoryjs.readMemory(handle, layout.int32, memoryjs.INT32), -123456);
+        // eslint-disable-next-line no-await-in-loop
+        await new Promise(resolve => setImmediate(resolve));
+      }
+
+      await finished;
+      await Promise.all(workers.map(worker => worker.terminate()));
+
+      assert.strictEqual(memoryjs.readMemory(handle, layout.int32, memoryjs.INT32), -123456);
+      assert.ok(memoryjs.findModuleForAddress(handle, layout.int32) !== undefined);
+    });
+  },
+};